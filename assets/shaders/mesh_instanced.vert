@@ -0,0 +1,32 @@
+#version 460 core
+
+layout(location = 0) in vec3 position;
+layout(location = 1) in vec3 normal;
+layout(location = 2) in vec2 texture_coordinates;
+layout(location = 3) in vec4 color;
+
+out VS_OUT
+{
+  vec4 color;
+} vs_out;
+
+uniform mat4 u_projection;
+
+struct Instance
+{
+  mat4 model;
+  vec4 color;
+};
+
+// une entrée par instance du groupe, écrites dans le StreamBuffer du Renderer
+layout(std430, binding = 2) readonly buffer InstanceData
+{
+  Instance instances[];
+};
+
+void main()
+{
+  Instance instance = instances[gl_InstanceID];
+  vs_out.color = color * instance.color;
+  gl_Position = u_projection * instance.model * vec4(position, 1.0);
+}
\ No newline at end of file
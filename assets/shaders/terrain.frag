@@ -0,0 +1,20 @@
+#version 460 core
+
+in VS_OUT
+{
+  vec2 texCoord;
+  flat float layer;
+  float shade;
+} fs_in;
+
+out vec4 FragColor;
+
+// toutes les textures de blocs, liées une fois par frame pour tout le terrain
+layout (binding = 0) uniform sampler2DArray blockTex;
+
+void main()
+{
+  // les coordonnées sont en blocs, REPEAT répète la texture sur les quads fusionnés
+  vec3 albedo = texture(blockTex, vec3(fs_in.texCoord, fs_in.layer)).rgb;
+  FragColor = vec4(albedo * fs_in.shade, 1.0);
+}
\ No newline at end of file
@@ -0,0 +1,30 @@
+#version 460 core
+
+layout(location = 0) in vec3 position;
+layout(location = 1) in vec3 normal;
+layout(location = 2) in vec2 texture_coordinates;
+layout(location = 3) in vec4 color; // rgb : ombre de la face, a : layer du BlockTextureArray (voir BuildChunkMesh)
+
+out VS_OUT
+{
+  vec2 texCoord;
+  flat float layer;
+  float shade;
+} vs_out;
+
+uniform mat4 u_projection;
+
+// une matrice par chunk, toutes écrites en une fois dans le StreamBuffer du Renderer
+// chaque draw passe son index en baseInstance
+layout(std430, binding = 3) readonly buffer TerrainData
+{
+  mat4 models[];
+};
+
+void main()
+{
+  vs_out.texCoord = texture_coordinates;
+  vs_out.layer = color.a;
+  vs_out.shade = color.r;
+  gl_Position = u_projection * models[gl_BaseInstance] * vec4(position, 1.0);
+}
\ No newline at end of file
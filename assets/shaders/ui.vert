@@ -11,7 +11,12 @@ out VS_OUT
 } vs_out;
 
 uniform mat4 u_projection;
-uniform mat4 u_model;
+
+// constantes par draw, écrites dans le StreamBuffer du Renderer
+layout(std140, binding = 1) uniform DrawData
+{
+  mat4 u_model;
+};
 
 void main()
 {
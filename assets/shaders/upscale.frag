@@ -0,0 +1,19 @@
+#version 460 core
+
+in VS_OUT
+{
+  vec2 texCoord;
+} fs_in;
+
+out vec4 FragColor;
+
+layout (binding = 0) uniform sampler2D sceneTex;
+uniform float u_scale;
+
+void main()
+{
+  // le filtre bilinéaire ne doit pas lire les texels hors de la zone dessinée
+  vec2 texel_size = 1.0 / vec2(textureSize(sceneTex, 0));
+  vec2 max_coord = vec2(u_scale) - 0.5 * texel_size;
+  FragColor = vec4(texture(sceneTex, min(fs_in.texCoord, max_coord)).rgb, 1.0);
+}
\ No newline at end of file
@@ -0,0 +1,17 @@
+#version 460 core
+
+layout(location = 0) in vec2 position;
+
+out VS_OUT
+{
+  vec2 texCoord;
+} vs_out;
+
+// partie de la cible réellement dessinée par la scène, entre 0 et 1
+uniform float u_scale;
+
+void main()
+{
+  vs_out.texCoord = (position * 0.5 + 0.5) * u_scale;
+  gl_Position = vec4(position, 0.0, 1.0);
+}
\ No newline at end of file
@@ -0,0 +1,35 @@
+#ifndef VOXL_BOUNDS_H
+#define VOXL_BOUNDS_H
+
+
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "components/mesh.h"
+
+
+// AABB en espace local, calculée une seule fois à partir des sommets du Mesh
+struct Bounds
+{
+  glm::vec3 min;
+  glm::vec3 max;
+};
+
+
+inline Bounds ComputeBounds(const std::vector<Vertex>& vertices)
+{
+  if (vertices.empty()) return Bounds{glm::vec3(0.0f), glm::vec3(0.0f)};
+
+  Bounds bounds{vertices[0].position, vertices[0].position};
+  for (const Vertex& vertex: vertices)
+  {
+    bounds.min = glm::min(bounds.min, vertex.position);
+    bounds.max = glm::max(bounds.max, vertex.position);
+  }
+
+  return bounds;
+}
+
+
+#endif // !VOXL_BOUNDS_H
\ No newline at end of file
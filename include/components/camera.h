@@ -0,0 +1,85 @@
+#ifndef VOXL_CAMERA_H
+#define VOXL_CAMERA_H
+
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <entt/entt.hpp>
+using namespace entt::literals;
+#include <imgui/imgui.h>
+
+#include "components/editor_component.h"
+#include "components/world_matrix.h"
+#include "utils/draw_component_header.h"
+
+
+// caméra perspective, la position et l'orientation viennent du WorldMatrix de la même entité
+struct Camera
+{
+  float fov = 70.0f; // vertical, en degrés
+  float nearPlane = 0.1f;
+  float farPlane = 1000.0f;
+  bool isActive = true;
+};
+
+
+// première caméra active trouvée, entt::null sinon
+inline entt::entity GetActiveCamera(entt::registry& registry)
+{
+  for (auto [entity, camera, transform]: registry.view<Camera, WorldMatrix>().each())
+  {
+    if (camera.isActive) return entity;
+  }
+  return entt::null;
+}
+
+
+// inverse de la matrice monde sans le scale
+inline glm::mat4 GetViewMatrix(const glm::mat4& world)
+{
+  glm::mat4 rigid = world;
+  rigid[0] = glm::vec4(glm::normalize(glm::vec3(world[0])), 0.0f);
+  rigid[1] = glm::vec4(glm::normalize(glm::vec3(world[1])), 0.0f);
+  rigid[2] = glm::vec4(glm::normalize(glm::vec3(world[2])), 0.0f);
+
+  return glm::inverse(rigid);
+}
+
+
+inline glm::mat4 GetProjectionMatrix(const Camera& camera, float aspectRatio)
+{
+  return glm::perspective(glm::radians(camera.fov), aspectRatio, camera.nearPlane, camera.farPlane);
+}
+
+
+template<>
+struct EditorComponent<Camera>
+{
+  static void Display(Camera& camera, entt::registry* registry)
+  {
+    ImGui::PushID(&camera);
+
+    if (DrawComponentHeader("\tCamera"))
+    {
+      ImGui::Checkbox("Is Active", &camera.isActive);
+      ImGui::DragFloat("FOV", &camera.fov, 0.1f, 1.0f, 179.0f);
+      ImGui::DragFloat("Near", &camera.nearPlane, 0.01f, 0.001f, camera.farPlane);
+      ImGui::DragFloat("Far", &camera.farPlane, 1.0f, camera.nearPlane, 100000.0f);
+    }
+    ImGui::PopID();
+  }
+
+  static void Register()
+  {
+    entt::meta_factory<Camera>{}
+      .type(entt::type_id<Camera>().hash())
+      .data<&Camera::fov>("fov"_hs)
+      .data<&Camera::nearPlane>("near_plane"_hs)
+      .data<&Camera::farPlane>("far_plane"_hs)
+      .data<&Camera::isActive>("is_active"_hs)
+      .func<&EditorComponent<Camera>::Display>("display"_hs);
+  }
+};
+
+
+#endif // !VOXL_CAMERA_H
\ No newline at end of file
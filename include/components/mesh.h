@@ -27,8 +27,6 @@ struct Mesh
   unsigned int vao;
   unsigned int vbo;
   unsigned int ebo;
-
-  void* pBuffer; // utile pour le 'persistent mapping', on stocke le pointeur du 'mapping' pour pouvoir copier les données dessus à la volée
 };
 
 
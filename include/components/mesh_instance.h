@@ -0,0 +1,61 @@
+#ifndef VOXL_MESH_INSTANCE_H
+#define VOXL_MESH_INSTANCE_H
+
+
+#include <entt/entt.hpp>
+using namespace entt::literals;
+#include <glm/glm.hpp>
+#include <imgui/imgui.h>
+
+#include "components/editor_component.h"
+#include "components/mesh.h"
+#include "utils/draw_component_header.h"
+
+
+// référence vers un Mesh chargé par le ResourceManager (OBJLoader), partagé entre toutes les entités
+// le Renderer regroupe les MeshInstance visibles par mesh et les dessine en un seul draw instancié
+struct MeshInstance
+{
+  entt::resource<Mesh> mesh;
+  glm::vec4 color{1.0f}; // multiplié par la couleur des sommets
+};
+
+
+// données par instance telles que lues par mesh_instanced.vert (std430)
+struct InstanceData
+{
+  glm::mat4 model;
+  glm::vec4 color;
+};
+
+
+template<>
+struct EditorComponent<MeshInstance>
+{
+  static void Display(MeshInstance& instance, entt::registry* registry)
+  {
+    ImGui::PushID(&instance);
+
+    if (DrawComponentHeader("\tMesh Instance"))
+    {
+      if (instance.mesh)
+        ImGui::Text("Vertices: %zu, Indices: %d", instance.mesh->vertices.size(), instance.mesh->indiceCount);
+      else
+        ImGui::TextDisabled("No mesh");
+
+      ImGui::ColorEdit4("Color", &instance.color.x);
+    }
+    ImGui::PopID();
+  }
+
+  static void Register()
+  {
+    entt::meta_factory<MeshInstance>{}
+      .type(entt::type_id<MeshInstance>().hash())
+      .data<&MeshInstance::color>("color"_hs)
+      .func<&EditorComponent<MeshInstance>::Display>("display"_hs);
+  }
+};
+
+
+#endif // !VOXL_MESH_INSTANCE_H
\ No newline at end of file
@@ -0,0 +1,29 @@
+#ifndef VOXL_OCCLUDER_BOX_H
+#define VOXL_OCCLUDER_BOX_H
+
+
+#include <glm/glm.hpp>
+
+
+static constexpr float OCCLUDER_BOX_RANGE = 96.0f; // au delà les OccluderBox couvrent trop peu de pixels pour cacher quoi que ce soit
+
+
+// boite pleine en espace monde rasterisée dans l'OcclusionBuffer, sans mesh (intérieur solide d'une section de chunk)
+// ! seulement à l'intérieur de géométrie opaque, ce qu'elle couvre n'est plus dessiné
+struct OccluderBox
+{
+  glm::vec3 min;
+  glm::vec3 max;
+};
+
+
+// à moins de OCCLUDER_BOX_RANGE du point de vue, et sans le contenir (noclip dans la roche) sinon elle cacherait tout
+inline bool IsOccluderBoxUseful(const OccluderBox& box, const glm::vec3& viewerPosition)
+{
+  const glm::vec3 closest = glm::clamp(viewerPosition, box.min, box.max);
+  if (closest == viewerPosition) return false;
+  return glm::dot(closest - viewerPosition, closest - viewerPosition) <= OCCLUDER_BOX_RANGE * OCCLUDER_BOX_RANGE;
+}
+
+
+#endif // !VOXL_OCCLUDER_BOX_H
\ No newline at end of file
@@ -0,0 +1,53 @@
+#ifndef VOXL_ORIENTATION_H
+#define VOXL_ORIENTATION_H
+
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <entt/entt.hpp>
+using namespace entt::literals;
+#include <imgui/imgui.h>
+
+#include "components/editor_component.h"
+#include "utils/draw_component_header.h"
+
+
+// orientation optionnelle en quaternion, remplace Transform::rotation quand elle est présente
+// évite les conversions Euler et le gimbal lock pour ce qui tourne librement (caméra, physique)
+struct Orientation
+{
+  glm::quat rotation{1.0f, 0.0f, 0.0f, 0.0f};
+};
+
+
+template<>
+struct EditorComponent<Orientation>
+{
+  static void Display(Orientation& o, entt::registry* registry)
+  {
+    ImGui::PushID(&o);
+
+    if (DrawComponentHeader("\tOrientation"))
+    {
+      float wxyz[4] = { o.rotation.w, o.rotation.x, o.rotation.y, o.rotation.z };
+      if (ImGui::DragFloat4("W X Y Z", wxyz, 0.01f))
+      {
+        glm::quat q(wxyz[0], wxyz[1], wxyz[2], wxyz[3]);
+        o.rotation = glm::length(q) > 0.0f ? glm::normalize(q) : glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+        registry->patch<Orientation>(entt::to_entity(registry->storage<Orientation>(), o));
+      }
+    }
+    ImGui::PopID();
+  }
+
+  static void Register()
+  {
+    entt::meta_factory<Orientation>{}
+      .type(entt::type_id<Orientation>().hash())
+      .data<&Orientation::rotation>("rotation"_hs)
+      .func<&EditorComponent<Orientation>::Display>("display"_hs);
+  }
+};
+
+
+#endif // !VOXL_ORIENTATION_H
\ No newline at end of file
@@ -0,0 +1,79 @@
+#ifndef VOXL_PARENT_H
+#define VOXL_PARENT_H
+
+
+#include <cstdint>
+#include <string>
+
+#include <entt/entt.hpp>
+using namespace entt::literals;
+#include <imgui/imgui.h>
+
+#include "components/editor_component.h"
+#include "components/name.h"
+#include "utils/draw_component_header.h"
+
+
+// parent 3D d'une entité avec Transform, le Transform devient relatif au WorldMatrix du parent
+// ! toujours passer par registry.patch/replace pour changer de parent, TransformSystem reconstruit l'ordre sur ce signal
+struct Parent
+{
+  entt::entity entity = entt::null;
+};
+
+
+template<>
+struct EditorComponent<Parent>
+{
+  static void Display(Parent& parent, entt::registry* registry)
+  {
+    ImGui::PushID(&parent);
+
+    if (DrawComponentHeader("\tParent"))
+    {
+      entt::entity owner = entt::to_entity(registry->storage<Parent>(), parent);
+
+      std::string parent_name = "None";
+      if (parent.entity != entt::null && registry->valid(parent.entity))
+      {
+        parent_name = std::to_string((uint32_t)parent.entity);
+        if (registry->all_of<Name>(parent.entity)) parent_name += " " + registry->get<Name>(parent.entity).buffer;
+      }
+      ImGui::Text("Parent: %s", parent_name.c_str());
+
+      if (parent.entity != entt::null && ImGui::Button("Detach"))
+      {
+        parent.entity = entt::null;
+        registry->patch<Parent>(owner);
+      }
+
+      ImGui::Button("DROP ENTITY HERE TO SET PARENT", ImVec2(ImGui::GetContentRegionAvail().x, 30));
+
+      if (ImGui::BeginDragDropTarget())
+      {
+        if (const ImGuiPayload* payload = ImGui::AcceptDragDropPayload("DND_ENTITY"))
+        {
+          entt::entity dropped_entity = *(const entt::entity*)payload->Data;
+          if (dropped_entity != owner && registry->valid(dropped_entity))
+          {
+            parent.entity = dropped_entity;
+            registry->patch<Parent>(owner);
+          }
+        }
+        ImGui::EndDragDropTarget();
+      }
+    }
+    ImGui::PopID();
+  }
+
+  static void Register()
+  {
+    entt::meta_factory<Parent>{}
+      .type(entt::type_id<Parent>().hash())
+      .data<&Parent::entity>("entity"_hs)
+      .func<&EditorComponent<Parent>::Display>("display"_hs);
+  }
+};
+
+
+#endif // !VOXL_PARENT_H
\ No newline at end of file
@@ -4,6 +4,10 @@
 
 struct Console{};
 struct Canvas{};
+// le Mesh (ou MeshInstance) de l'entité est rasterisé dans l'OcclusionBuffer, à réserver aux gros objets opaques
+struct Occluder{};
+// Mesh d'un chunk ou d'un noeud LOD, dessiné avec le pipeline du terrain : color.a de ses sommets est un layer du BlockTextureArray
+struct Terrain{};
 
 
 #endif // !VOXL_TAGS_H
\ No newline at end of file
@@ -23,16 +23,11 @@ struct TextVertex
 };
 
 
+// géométrie CPU uniquement, elle est recopiée chaque frame dans le StreamBuffer du Renderer
 struct TextMesh
 {
   std::vector<TextVertex> vertices;
   std::vector<unsigned int> indices;
-
-  unsigned int vao;
-  unsigned int vbo;
-  unsigned int ebo;
-
-  void* pBuffer;
 };
 
 
@@ -54,10 +49,6 @@ struct EditorComponent<TextMesh>
       .type(entt::type_id<TextMesh>().hash())
       .data<&TextMesh::vertices>("vertices"_hs)
       .data<&TextMesh::indices>("indices"_hs)
-      .data<&TextMesh::vao>("vao"_hs)
-      .data<&TextMesh::vbo>("vbo"_hs)
-      .data<&TextMesh::ebo>("ebo"_hs)
-      .data<&TextMesh::pBuffer>("p_buffer"_hs)
       .func<&EditorComponent<TextMesh>::Display>("display"_hs);
   }
 };
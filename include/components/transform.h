@@ -29,9 +29,12 @@ struct EditorComponent<Transform>
 
     if (DrawComponentHeader("\tTransform"))
     {
-      ImGui::DragFloat3("Position", &t.position.x, 0.1f);
-      ImGui::DragFloat3("Rotation", &t.rotation.x, 0.1f);
-      ImGui::DragFloat3("Scale", &t.scale.x, 0.1f);
+      bool changed = ImGui::DragFloat3("Position", &t.position.x, 0.1f);
+      changed |= ImGui::DragFloat3("Rotation", &t.rotation.x, 0.1f);
+      changed |= ImGui::DragFloat3("Scale", &t.scale.x, 0.1f);
+
+      // prévient les systèmes qui écoutent on_update<Transform> (culling, ...)
+      if (changed) registry->patch<Transform>(entt::to_entity(registry->storage<Transform>(), t));
     }
     ImGui::PopID();
   }
@@ -0,0 +1,16 @@
+#ifndef VOXL_WORLD_MATRIX_H
+#define VOXL_WORLD_MATRIX_H
+
+
+#include <glm/glm.hpp>
+
+
+// matrice monde en cache, écrite uniquement par TransformSystem quand le Transform change
+// une géométrie statique la calcule donc une seule fois
+struct WorldMatrix
+{
+  glm::mat4 matrix{1.0f};
+};
+
+
+#endif // !VOXL_WORLD_MATRIX_H
\ No newline at end of file
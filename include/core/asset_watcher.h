@@ -0,0 +1,62 @@
+#ifndef VOXL_ASSET_WATCHER_H
+#define VOXL_ASSET_WATCHER_H
+
+
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+
+static constexpr double ASSET_WATCHER_DEBOUNCE = 0.2; // secondes de calme avant de rendre un lot
+static constexpr double ASSET_WATCHER_MAX_DELAY = 1.0; // un lot part quand même si les écritures ne s'arrêtent jamais
+static constexpr double ASSET_WATCHER_SCAN_INTERVAL = 0.5; // sans inotify, intervalle entre deux parcours du dossier
+
+
+// surveille un dossier (récursivement) et renvoie les fichiers modifiés par lots
+// inotify sous Linux, ailleurs on compare les dates de modification à intervalle régulier
+//
+// un éditeur écrit souvent un fichier en plusieurs fois (troncature, écritures partielles, fichier temporaire puis renommage)
+// et un export peut toucher plusieurs fichiers d'affilée (.vert et .frag, metrics.json et atlas.png) :
+// les chemins s'accumulent et ne sont rendus qu'une fois le dossier calme depuis ASSET_WATCHER_DEBOUNCE
+class AssetWatcher
+{
+public:
+  AssetWatcher(const std::string& root = "assets/");
+  ~AssetWatcher();
+  AssetWatcher(const AssetWatcher&) = delete;
+  AssetWatcher& operator=(const AssetWatcher&) = delete;
+
+  // non bloquant, renvoie les chemins modifiés (normalisés, voir NormalizeAssetPath) ou rien si le lot n'est pas encore stable
+  std::vector<std::string> Poll();
+
+private:
+  using Clock = std::chrono::steady_clock;
+
+  std::string _root;
+
+  std::unordered_set<std::string> _pending;
+  Clock::time_point _firstChange;
+  Clock::time_point _lastChange;
+
+#ifdef __linux__
+  int _inotifyFd;
+  std::unordered_map<int, std::string> _watches; // descripteur inotify -> dossier
+
+  // report : signale les fichiers déjà présents (dossier créé ou déplacé pendant que le moteur tourne)
+  void addWatches(const std::string& directory, bool report);
+  void readEvents();
+#else
+  Clock::time_point _lastScan;
+  std::unordered_map<std::string, std::filesystem::file_time_type> _writeTimes;
+
+  void scan(bool report);
+#endif
+
+  void addChange(const std::string& path);
+};
+
+
+#endif // !VOXL_ASSET_WATCHER_H
\ No newline at end of file
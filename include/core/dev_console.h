@@ -25,6 +25,10 @@ public:
 
   void Update();
   void OpenDevConsole(bool* pOpen);
+  // une ligne comme tapée dans la console, "$nom arg1 arg2"
+  void Execute(const std::string& line);
+  // recopie aussi les messages sur la sortie standard, sans fenêtre personne ne lit l'historique
+  inline void SetEcho(bool isEcho) { _isEcho = isEcho; }
 
 private:
   entt::registry* _pRegistry;
@@ -32,6 +36,7 @@ private:
   char _inputBuffer[512];
   std::vector<std::string> _history;
   bool _scrollToBottom = false;
+  bool _isEcho = false;
 
   void onDevConsoleMessage(const DevConsoleMessageEvent& e);
 
@@ -2,42 +2,62 @@
 #define VOXL_ENGINE_H
 
 
+#include <cstdint>
 #include <memory>
+#include <string>
+#include <vector>
 
 #include <entt/fwd.hpp>
 
 #include "resources/font.h"
 
 
+namespace enki { class TaskSet; }
+
 class Window;
 class Renderer;
 class DevConsole;
 class Scene;
+class VoxelWorld;
 
 struct GameContext;
 struct CloseEvent;
 struct ResizeEvent;
 struct GameStateChangeEvent;
+struct SaveWorldEvent;
+struct LoadWorldEvent;
+
+
+static constexpr int HEADLESS_WIDTH = 1280; // écran simulé en headless, la taille de la fenêtre par défaut
+static constexpr int HEADLESS_HEIGHT = 720;
 
 
 class Engine
 {
 public:
-  Engine();
+  // useRenderThread : dessine sur un thread dédié pendant que le thread principal prépare la frame suivante
+  // threadCount : threads du JobSystem, thread principal compris, 0 = un par coeur
+  // isHeadless : ni fenêtre, ni ImGui, ni contexte GL, le Renderer dessine avec le NullRenderBackend (benchs sur CI sans GPU)
+  Engine(bool useRenderThread = false, uint32_t threadCount = 0, bool isHeadless = false);
   ~Engine();
 
-  void Run();
+  // commandLines : lignes de console ("$bench_render 100") exécutées une par frame dès le début
+  // en headless la boucle s'arrête après la dernière, les résultats sont recopiés sur la sortie standard
+  void Run(const std::vector<std::string>& commandLines = {});
 
 private:
   bool _isRunning;
+  bool _isHeadless;
 
   std::unique_ptr<entt::registry> _pRegistry;
   std::unique_ptr<Window> _pWindow;
   std::unique_ptr<Renderer> _pRenderer;
   std::unique_ptr<DevConsole> _pDevConsole;
   std::unique_ptr<Scene> _pScene;
+  std::unique_ptr<VoxelWorld> _pWorld; // détruit en premier, ses jobs et ses buffers ont besoin du TaskScheduler et du Renderer
 
   Font _font;
+  std::unique_ptr<enki::TaskSet> _pCookTask; // $cook_textures en cours ou terminé
 
   bool init();
   void registerCommands();
@@ -46,6 +66,8 @@ private:
 
   void onClose(const CloseEvent& e);
   void onGameStateChange(const GameStateChangeEvent& e);
+  void onSaveWorld(const SaveWorldEvent& e);
+  void onLoadWorld(const LoadWorldEvent& e);
 };
 
 
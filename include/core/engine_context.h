@@ -2,6 +2,7 @@
 #define VOXL_ENGINE_CONTEXT_H
 
 
+#include <cstdint>
 #include <vector>
 
 #include <entt/entt.hpp>
@@ -15,6 +16,11 @@ struct EngineContext
   GameState lastState;
   GameState currentState;
   std::vector<entt::entity> entitiesToDelete;
+  double deltaTime; // en secondes, temps réel de la frame, mis à jour au début de chaque frame
+  uint64_t frameIndex;
+  double tickDeltaTime; // en secondes, pas fixe de la simulation
+  uint64_t tickIndex;
+  float interpolationAlpha; // position de la frame affichée entre les deux derniers ticks
 };
 
 
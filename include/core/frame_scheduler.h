@@ -0,0 +1,79 @@
+#ifndef VOXL_FRAME_SCHEDULER_H
+#define VOXL_FRAME_SCHEDULER_H
+
+
+#include <chrono>
+#include <cstdint>
+
+#include <entt/entt.hpp>
+
+#include "utils/game_state.h"
+#include "utils/screen_info.h"
+
+
+static constexpr double DEFAULT_TICK_RATE = 60.0; // ticks de simulation par seconde
+static constexpr int MAX_TICKS_PER_FRAME = 5; // au delà la simulation ralentit au lieu de rattraper indéfiniment
+static constexpr double MAX_FRAME_DELTA = 0.25; // un freeze (breakpoint, déplacement de fenêtre) ne compte pas plus que ça
+
+// limites de framerate, 0 = illimité
+static constexpr double MENU_FRAME_RATE = 60.0; // console et éditeur
+static constexpr double BACKGROUND_FRAME_RATE = 30.0; // fenêtre sans le focus
+static constexpr double MINIMIZED_FRAME_RATE = 10.0; // rien n'est dessiné, on ne fait que la simulation et les events
+
+
+// découpe le temps réel en ticks de simulation fixes et limite le framerate
+//
+// la simulation avance toujours de GetTickDelta() par tick, elle est donc déterministe quelle que soit la vitesse d'affichage
+// le reste de l'accumulateur (GetAlpha) sert à interpoler l'affichage entre les deux derniers ticks
+//
+// while (Tick()) { simulation(GetTickDelta()); }
+// interpolation(GetAlpha()); rendu;
+// WaitForNextFrame(GetTargetFrameRate(...));
+class FrameScheduler
+{
+public:
+  FrameScheduler(entt::registry* registry);
+  ~FrameScheduler();
+
+  // renvoie le temps réel écoulé depuis la frame précédente (borné) et l'ajoute à l'accumulateur
+  double BeginFrame();
+  // true tant qu'il reste un tick à exécuter pour cette frame
+  bool Tick();
+  // dort puis attend activement la fin de la frame, pour tomber pile sur le framerate visé sans brûler un coeur
+  void WaitForNextFrame(double targetFrameRate);
+
+  double GetTargetFrameRate(const ScreenInfo& screenInfo, GameState state) const;
+
+  void SetTickRate(double tickRate);
+  inline void SetMaxFrameRate(double frameRate) { _maxFrameRate = frameRate; }
+
+  inline double GetTickDelta() const { return _tickDelta; }
+  inline uint64_t GetTickIndex() const { return _tickIndex; }
+  inline float GetAlpha() const { return (float)(_accumulator / _tickDelta); }
+
+private:
+  using Clock = std::chrono::steady_clock;
+
+  entt::registry* _pRegistry;
+
+  Clock::time_point _frameStart;
+  double _tickDelta;
+  double _accumulator;
+  uint64_t _tickIndex;
+  int _ticksThisFrame;
+
+  double _maxFrameRate; // au premier plan, en jeu
+
+  // erreur mesurée d'un sleep de 1 ms (moyenne + écart type), on attend activement en dessous
+  double _sleepEstimate;
+  double _sleepMean;
+  double _sleepM2;
+  uint64_t _sleepCount;
+
+  void updateSleepEstimate(double observed);
+
+  void registerCommands();
+};
+
+
+#endif // !VOXL_FRAME_SCHEDULER_H
\ No newline at end of file
@@ -0,0 +1,132 @@
+#ifndef VOXL_JOB_SYSTEM_H
+#define VOXL_JOB_SYSTEM_H
+
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <enkiTS/TaskScheduler.h>
+#include <entt/entt.hpp>
+
+
+class Profiler;
+
+
+// temps d'un ParallelFor nommé, cumulé depuis le dernier FlushTimings
+struct JobTiming
+{
+  float wallMs; // sur le thread qui attend
+  float busyMs; // somme des partitions sur tous les threads
+  uint32_t calls;
+  uint32_t partitions;
+};
+
+
+// le TaskScheduler enkiTS du moteur, dans registry.ctx() : tous les systèmes qui veulent du parallélisme passent par lui
+// aucun autre thread de travail ne doit être créé ailleurs, ils se battraient pour les mêmes coeurs
+class JobSystem
+{
+public:
+  // threadCount : threads au total, thread principal compris, 0 = un par coeur
+  JobSystem(uint32_t threadCount = 0);
+  ~JobSystem();
+
+  JobSystem(const JobSystem&) = delete;
+  JobSystem& operator=(const JobSystem&) = delete;
+
+  inline enki::TaskScheduler& GetScheduler() { return _scheduler; }
+  inline uint32_t GetThreadCount() const { return _scheduler.GetNumTaskThreads(); }
+
+  // f(start, end, threadnum) sur [0, count[, partitions d'au moins minRange, sur le thread appelant si count <= minRange
+  // name : mesuré dans les timings (nullptr pour ne rien mesurer), doit rester le même d'une frame à l'autre
+  template<typename F>
+  void ParallelFor(const char* name, uint32_t count, uint32_t minRange, F&& f);
+
+  // f(entity) pour chaque entité d'une vue ou d'un storage EnTT
+  // les entités sont réparties d'après le storage qui mène la vue, f ne doit écrire que dans les composants de son entité
+  template<typename View, typename F>
+  void ParallelForEach(const char* name, const View& view, uint32_t minRange, F&& f);
+
+  // depuis n'importe quel thread, exécuté par le thread principal au prochain RunPinnedTasks (GL, registry...)
+  void RunOnMainThread(std::function<void()> function);
+  // une fois par frame sur le thread principal
+  void RunPinnedTasks();
+
+  // pousse les timings dans le Profiler ("Job <name>" et "Job <name> busy") puis les remet à zéro
+  void FlushTimings(Profiler& profiler);
+
+private:
+  enki::TaskScheduler _scheduler;
+
+  std::mutex _pinnedMutex;
+  std::vector<std::unique_ptr<enki::LambdaPinnedTask>> _pinnedTasks;
+
+  std::mutex _timingMutex;
+  std::unordered_map<std::string, JobTiming> _timings;
+
+  void recordTiming(const char* name, float wallMs, float busyMs, uint32_t partitions);
+};
+
+
+template<typename F>
+void JobSystem::ParallelFor(const char* name, uint32_t count, uint32_t minRange, F&& f)
+{
+  if (count == 0) return;
+
+  const auto start = std::chrono::steady_clock::now();
+
+  std::atomic<int64_t> busy_nanoseconds = 0;
+  std::atomic<uint32_t> partitions = 0;
+  const bool is_inline = count <= minRange || _scheduler.GetNumTaskThreads() <= 1;
+  if (is_inline) f(0u, count, _scheduler.GetThreadNum());
+  else
+  {
+    enki::TaskSet task(count, [&](enki::TaskSetPartition range, uint32_t threadnum)
+    {
+      const auto partition_start = std::chrono::steady_clock::now();
+      f(range.start, range.end, threadnum);
+      if (!name) return;
+
+      busy_nanoseconds.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - partition_start).count(), std::memory_order_relaxed);
+      partitions.fetch_add(1, std::memory_order_relaxed);
+    });
+    task.m_MinRange = minRange;
+
+    _scheduler.AddTaskSetToPipe(&task);
+    _scheduler.WaitforTask(&task);
+  }
+
+  if (!name) return;
+
+  const float wall_ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+  if (is_inline) recordTiming(name, wall_ms, wall_ms, 1);
+  else recordTiming(name, wall_ms, (float)busy_nanoseconds.load() / 1000000.0f, partitions.load());
+}
+
+
+template<typename View, typename F>
+void JobSystem::ParallelForEach(const char* name, const View& view, uint32_t minRange, F&& f)
+{
+  const auto* pHandle = view.handle();
+  if (!pHandle) return;
+
+  // le storage qui mène la vue peut contenir des entités qui n'ont pas les autres composants
+  ParallelFor(name, (uint32_t)pHandle->size(), minRange, [&](uint32_t start, uint32_t end, uint32_t threadnum)
+  {
+    for (uint32_t i = start; i < end; i++)
+    {
+      const entt::entity entity = (*pHandle)[i];
+      if (view.contains(entity)) f(entity);
+    }
+  });
+}
+
+
+#endif // !VOXL_JOB_SYSTEM_H
\ No newline at end of file
@@ -0,0 +1,134 @@
+#ifndef VOXL_PROFILER_H
+#define VOXL_PROFILER_H
+
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <entt/entt.hpp>
+
+
+class RenderBackend;
+
+
+static constexpr int PROFILER_HISTORY_SIZE = 240; // ~4 secondes à 60 fps
+static constexpr int PROFILER_QUERY_LATENCY = 4; // on lit les requêtes GPU avec quelques frames de retard pour ne jamais bloquer
+static constexpr int PROFILER_MAX_OPEN_SCOPES = 64;
+static constexpr int PROFILER_MAX_FRAME_SAMPLES = 256; // au-delà le vecteur grandit, une fois
+
+
+struct ProfileTrack
+{
+  std::string name;
+  bool isGpu;
+  std::array<float, PROFILER_HISTORY_SIZE> history{}; // en millisecondes
+  int head = 0;
+  int count = 0;
+
+  void Push(float ms);
+  float Last() const;
+  float Percentile(float p) const;
+};
+
+
+struct ProfileStats
+{
+  float last;
+  float p50;
+  float p95;
+  float p99;
+};
+
+
+class Profiler
+{
+public:
+  Profiler(entt::registry* registry);
+  ~Profiler();
+
+  // le backend n'existe qu'après Renderer::Init, sans lui on ne mesure que le CPU
+  void SetBackend(RenderBackend* backend);
+
+  void BeginFrame(double deltaTime);
+
+  // le nom doit être une chaîne littérale (ou qui vit aussi longtemps que le profiler)
+  // ~ on ne garde que le pointeur, la std::string du track n'est construite qu'au report
+  void BeginCpu(const char* name);
+  void EndCpu(const char* name);
+
+  void BeginGpu(const char* name);
+  void EndGpu();
+
+  // mesure faite ailleurs (JobSystem), ajoutée comme un scope CPU
+  void AddCpuSample(const std::string& name, float ms);
+
+  void DisplayOverlay(bool* pOpen);
+
+  ProfileStats GetStats(const std::string& name, bool isGpu);
+  // somme des dernières mesures des scopes GPU encore utilisés, 0 sans backend
+  // ~ le temps GPU d'une frame d'il y a PROFILER_QUERY_LATENCY frames
+  float GetGpuFrameTime() const;
+
+  inline bool* GetOverlayOpen() { return &_isOverlayOpen; }
+
+private:
+  struct CpuScope
+  {
+    const char* name;
+    std::chrono::steady_clock::time_point start;
+  };
+
+  // mesure pas encore rangée dans son track
+  struct CpuSample
+  {
+    const char* name;
+    float ms;
+  };
+
+  struct GpuTimer
+  {
+    std::array<unsigned int, PROFILER_QUERY_LATENCY> queries{};
+    std::array<bool, PROFILER_QUERY_LATENCY> pending{};
+    int track;
+    uint64_t lastFrame = 0; // dernière frame où le scope a été ouvert
+  };
+
+  entt::registry* _pRegistry;
+  RenderBackend* _pBackend;
+
+  uint64_t _frameIndex;
+  bool _isOverlayOpen;
+
+  std::vector<ProfileTrack> _tracks;
+  std::unordered_map<std::string, int> _cpuTracks;
+  std::unordered_map<std::string, int> _gpuTracks;
+  std::unordered_map<const char*, int> _cpuTracksByPointer;
+  std::vector<CpuScope> _openScopes;
+  std::vector<CpuSample> _cpuSamples;
+  std::unordered_map<std::string, GpuTimer> _gpuTimers;
+  GpuTimer* _pActiveGpuTimer;
+
+  int getTrack(const std::string& name, bool isGpu);
+  void flushCpuSamples();
+  void collectGpuResults();
+
+  void registerCommands();
+};
+
+
+// mesure le CPU d'un bloc de code, le nom doit être une chaîne littérale
+struct ProfileScope
+{
+  Profiler& profiler;
+  const char* name;
+
+  ProfileScope(Profiler& p, const char* n) : profiler(p), name(n) { profiler.BeginCpu(name); }
+  ~ProfileScope() { profiler.EndCpu(name); }
+};
+
+
+#endif // !VOXL_PROFILER_H
\ No newline at end of file
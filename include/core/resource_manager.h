@@ -4,14 +4,27 @@
 
 #include <unordered_map>
 #include <any>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
 #include <string>
+#include <tuple>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
 #include <entt/entt.hpp>
+#include <glad/glad.h>
 
 #include "loaders/font_loader.h"
 #include "resources/traits.h"
+#include "resources/retired_gl_objects.h"
+#include "utils/normalize_asset_path.h"
+
+
+// une frame extraite peut être dessinée pendant la suivante (thread de rendu), on garde de la marge
+static constexpr uint64_t RESOURCE_RETIRE_FRAMES = 3;
 
 
 class ResourceManager
@@ -36,12 +49,39 @@ public:
   inline auto& GetFontCache() { return getCacheInternal<Font, FontLoader>(); }
   inline std::vector<std::string>& GetFontNames() { return _names; }
 
+  // recharge en place les ressources qui dépendent de ces fichiers, renvoie le nombre de ressources rechargées
+  // les entt::resource déjà distribués restent valides, seul le contenu de la ressource change
+  // seuls les loaders qui ont GetAssetPaths et Reload sont concernés (Font, Shader, Texture)
+  // ! sur le thread principal, avec son contexte GL
+  size_t Reload(const std::vector<std::string>& paths, uint64_t frameIndex);
+  // libère les objets GL remplacés il y a au moins RESOURCE_RETIRE_FRAMES frames
+  void ReleaseRetired(uint64_t frameIndex);
+
 private:
+  struct ReloadEntry
+  {
+    std::vector<std::string> paths; // tels que renvoyés par Loader::GetAssetPaths
+    std::function<bool(const std::vector<std::string>&, RetiredGLObjects&)> reload;
+  };
+
+  struct RetiredBatch
+  {
+    uint64_t frameIndex;
+    RetiredGLObjects objects;
+  };
+
   std::unordered_map<entt::id_type, std::any> _caches;
   std::vector<std::string> _names;
 
+  std::vector<ReloadEntry> _reloadEntries;
+  std::unordered_map<std::string, std::vector<std::pair<size_t, std::string>>> _reloadIndices; // chemin normalisé -> (entrée, chemin du loader)
+  std::deque<RetiredBatch> _retired;
+
   template<typename Resource, typename Loader>
   entt::resource_cache<Resource, Loader>& getCacheInternal(); 
+
+  template<typename Resource, typename Loader, typename... SavedArgs>
+  void registerReload(entt::resource<Resource> handle, std::tuple<SavedArgs...> args);
 };
 
 
@@ -66,7 +106,12 @@ template<typename Resource, typename... Args>
 inline auto ResourceManager::LoadByID(entt::id_type id, Args&&... args)
 {
   using Loader = typename ResourceTraits<Resource>::Loader;
-  return getCacheInternal<Resource, Loader>().load(id, std::forward<Args>(args)...);
+
+  // copie des arguments pour pouvoir rappeler le loader lors d'un rechargement
+  auto saved_args = std::make_tuple(std::decay_t<Args>(args)...);
+  auto result = getCacheInternal<Resource, Loader>().load(id, std::forward<Args>(args)...);
+  if (result.second && result.first->second) registerReload<Resource, Loader>(result.first->second, std::move(saved_args));
+  return result;
 }
 
 
@@ -90,4 +135,58 @@ inline entt::resource_cache<Resource, Loader>& ResourceManager::getCacheInternal
 }
 
 
+template<typename Resource, typename Loader, typename... SavedArgs>
+inline void ResourceManager::registerReload(entt::resource<Resource> handle, std::tuple<SavedArgs...> args)
+{
+  if constexpr (requires(const SavedArgs&... a) { Loader::GetAssetPaths(a...); })
+  {
+    ReloadEntry entry;
+    entry.paths = std::apply([](const auto&... a) { return Loader::GetAssetPaths(a...); }, args);
+    entry.reload = [handle, args](const std::vector<std::string>& changedPaths, RetiredGLObjects& retired)
+    {
+      return std::apply([&](const auto&... a) { return Loader{}.Reload(*handle, changedPaths, retired, a...); }, args);
+    };
+
+    const size_t index = _reloadEntries.size();
+    for (const auto& path: entry.paths) _reloadIndices[NormalizeAssetPath(path)].emplace_back(index, path);
+    _reloadEntries.push_back(std::move(entry));
+  }
+}
+
+
+inline size_t ResourceManager::Reload(const std::vector<std::string>& paths, uint64_t frameIndex)
+{
+  // une ressource dont plusieurs fichiers ont changé (.vert et .frag) n'est rechargée qu'une fois, dans l'ordre de chargement
+  std::map<size_t, std::vector<std::string>> changed;
+  for (const auto& path: paths)
+  {
+    auto it = _reloadIndices.find(NormalizeAssetPath(path));
+    if (it == _reloadIndices.end()) continue;
+    for (const auto& [index, loader_path]: it->second) changed[index].push_back(loader_path);
+  }
+
+  RetiredGLObjects retired;
+  size_t reloaded = 0;
+  for (const auto& [index, changed_paths]: changed)
+  {
+    if (_reloadEntries[index].reload(changed_paths, retired)) reloaded++;
+  }
+
+  if (!retired.Empty()) _retired.push_back(RetiredBatch{ .frameIndex = frameIndex, .objects = std::move(retired) });
+  return reloaded;
+}
+
+
+inline void ResourceManager::ReleaseRetired(uint64_t frameIndex)
+{
+  while (!_retired.empty() && frameIndex >= _retired.front().frameIndex + RESOURCE_RETIRE_FRAMES)
+  {
+    RetiredGLObjects& objects = _retired.front().objects;
+    if (!objects.textures.empty()) glDeleteTextures((int)objects.textures.size(), objects.textures.data());
+    for (unsigned int program: objects.programs) glDeleteProgram(program);
+    _retired.pop_front();
+  }
+}
+
+
 #endif // !VOXL_RESOURCE_MANAGER_H
\ No newline at end of file
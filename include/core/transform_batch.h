@@ -0,0 +1,39 @@
+#ifndef VOXL_TRANSFORM_BATCH_H
+#define VOXL_TRANSFORM_BATCH_H
+
+
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+
+// calcule beaucoup de matrices translate * rotate * scale d'un coup
+// les entrées sont rangées en SoA pour que le kernel SSE traite 4 transforms par itération
+// la rotation est toujours un quaternion, les angles d'Euler sont convertis à l'ajout
+class TransformBatch
+{
+public:
+  TransformBatch() = default;
+  ~TransformBatch() = default;
+
+  void Clear();
+  void Reserve(size_t count);
+
+  // angles en degrés, même ordre que GetTransformMatrix (X puis Y puis Z)
+  void Push(const glm::vec3& position, const glm::vec3& eulerDegrees, const glm::vec3& scale);
+  void Push(const glm::vec3& position, const glm::quat& orientation, const glm::vec3& scale);
+
+  // écrit Size() matrices dans out
+  void Compose(glm::mat4* out) const;
+
+  inline size_t Size() const { return _px.size(); }
+
+private:
+  std::vector<float> _px, _py, _pz;
+  std::vector<float> _qw, _qx, _qy, _qz;
+  std::vector<float> _sx, _sy, _sz;
+};
+
+
+#endif // !VOXL_TRANSFORM_BATCH_H
\ No newline at end of file
@@ -0,0 +1,11 @@
+#ifndef VOXL_LOAD_WORLD_EVENT_H
+#define VOXL_LOAD_WORLD_EVENT_H
+
+
+struct LoadWorldEvent
+{
+  const char* name = "LOAD_WORLD_EVENT";
+};
+
+
+#endif // !VOXL_LOAD_WORLD_EVENT_H
\ No newline at end of file
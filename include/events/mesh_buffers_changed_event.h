@@ -0,0 +1,16 @@
+#ifndef VOXL_MESH_BUFFERS_CHANGED_EVENT_H
+#define VOXL_MESH_BUFFERS_CHANGED_EVENT_H
+
+
+// des buffers de Mesh réécrits (ou détruits) par le contexte principal
+// le thread de rendu doit recréer le VAO qu'il a en cache pour ce couple, sinon il peut lire l'ancien contenu
+// envoyé avec trigger : il doit arriver dans le snapshot de la frame où le buffer est réécrit
+struct MeshBuffersChangedEvent
+{
+  const char* name = "MESH_BUFFERS_CHANGED_EVENT";
+  unsigned int vertexBuffer;
+  unsigned int indexBuffer;
+};
+
+
+#endif // !VOXL_MESH_BUFFERS_CHANGED_EVENT_H
\ No newline at end of file
@@ -0,0 +1,11 @@
+#ifndef VOXL_SAVE_WORLD_EVENT_H
+#define VOXL_SAVE_WORLD_EVENT_H
+
+
+struct SaveWorldEvent
+{
+  const char* name = "SAVE_WORLD_EVENT";
+};
+
+
+#endif // !VOXL_SAVE_WORLD_EVENT_H
\ No newline at end of file
@@ -0,0 +1,38 @@
+#ifndef VOXL_DYNAMIC_RESOLUTION_H
+#define VOXL_DYNAMIC_RESOLUTION_H
+
+
+static constexpr float DYNAMIC_RESOLUTION_MIN_SCALE = 0.5f;
+static constexpr float DYNAMIC_RESOLUTION_MAX_SCALE = 1.0f;
+static constexpr float DYNAMIC_RESOLUTION_STEP = 1.0f / 32.0f; // l'échelle est arrondie pour ne pas bouger à chaque frame
+static constexpr float DYNAMIC_RESOLUTION_HEADROOM = 0.9f; // vise 90% du budget pour absorber les pics
+static constexpr float DYNAMIC_RESOLUTION_SMOOTHING = 0.2f; // poids de la nouvelle mesure dans la moyenne glissante
+static constexpr int DYNAMIC_RESOLUTION_COOLDOWN = 8; // frames entre deux changements, plus que la latence des timers GPU
+
+
+// régulateur de l'échelle de rendu du monde (par axe) à partir du temps GPU d'une frame
+// le coût du monde suit le nombre de pixels, donc l'échelle est corrigée par la racine du rapport budget / mesure
+// descend dès que le budget est dépassé, remonte seulement avec une marge de deux pas pour ne pas osciller
+class DynamicResolution
+{
+public:
+  DynamicResolution(float targetMilliseconds = 1000.0f / 60.0f);
+  ~DynamicResolution() = default;
+
+  // gpuMilliseconds <= 0 : pas de mesure (pas de timers GPU), l'échelle ne bouge pas
+  float Update(float gpuMilliseconds);
+  void Reset();
+
+  inline void SetTarget(float milliseconds) { _targetMilliseconds = milliseconds; }
+  inline float GetTarget() const { return _targetMilliseconds; }
+  inline float GetScale() const { return _scale; }
+
+private:
+  float _targetMilliseconds;
+  float _scale;
+  float _filteredMilliseconds; // 0 tant qu'aucune mesure n'a été faite à l'échelle actuelle
+  int _cooldown;
+};
+
+
+#endif // !VOXL_DYNAMIC_RESOLUTION_H
\ No newline at end of file
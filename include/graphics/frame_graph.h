@@ -0,0 +1,137 @@
+#ifndef VOXL_FRAME_GRAPH_H
+#define VOXL_FRAME_GRAPH_H
+
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <vector>
+
+#include <entt/core/hashed_string.hpp>
+
+#include "graphics/render_backend.h"
+
+
+class Profiler;
+
+class FrameGraph;
+
+
+using FrameGraphResource = uint32_t;
+
+static constexpr FrameGraphResource FRAME_GRAPH_INVALID_RESOURCE = UINT32_MAX;
+
+
+// deux ressources transitoires avec la même description peuvent partager une texture si leurs durées de vie ne se croisent pas
+struct FrameGraphTextureDesc
+{
+  int width;
+  int height;
+  TextureFormat format;
+
+  bool operator==(const FrameGraphTextureDesc&) const = default;
+};
+
+
+// donné au setup d'une passe pour déclarer ce qu'elle lit et ce qu'elle écrit
+// les ressources sont retrouvées par leur nom, une passe peut lire une ressource créée par une passe ajoutée après elle
+class FrameGraphBuilder
+{
+public:
+  FrameGraphBuilder(FrameGraph& graph, uint32_t pass) : _graph(graph), _pass(pass) {}
+
+  // cible transitoire, sa texture n'existe qu'entre la première et la dernière passe qui l'utilisent
+  FrameGraphResource Create(const entt::hashed_string& name, const FrameGraphTextureDesc& desc);
+  // une lecture voit toutes les écritures de la ressource, sauf celles des passes ajoutées après si la passe l'écrit aussi
+  FrameGraphResource Read(const entt::hashed_string& name);
+  // les textures écrites deviennent les attachments de la passe, la couleur dans l'ordre des appels
+  FrameGraphResource Write(const entt::hashed_string& name);
+  // la passe est gardée même si personne ne lit ce qu'elle écrit
+  void SetSideEffect();
+
+private:
+  FrameGraph& _graph;
+  uint32_t _pass;
+};
+
+
+// passes reconstruites à chaque frame : Reset, Import/AddPass, Compile puis Execute
+// Compile retire les passes dont le résultat n'est jamais lu, les ordonne d'après leurs dépendances et partage les textures transitoires
+// les textures et les framebuffers sont gardés d'une frame à l'autre tant que les mêmes descriptions reviennent
+// ! à n'utiliser que sur le thread qui dessine, les framebuffers ne sont pas partagés entre contextes
+class FrameGraph
+{
+public:
+  using SetupFunction = std::function<void(FrameGraphBuilder&)>;
+  using ExecuteFunction = std::function<void(RenderBackend&, const FrameGraph&)>;
+
+  FrameGraph() = default;
+  ~FrameGraph() = default;
+
+  void Reset();
+  // cible qui existe en dehors du graph (0 = framebuffer par défaut), une passe qui l'écrit n'est jamais retirée
+  FrameGraphResource ImportFramebuffer(const entt::hashed_string& name, unsigned int framebuffer, int width, int height);
+  // name doit rester valide jusqu'à Execute (littéral), c'est aussi le nom du scope GPU dans le Profiler
+  void AddPass(const char* name, const SetupFunction& setup, ExecuteFunction execute);
+
+  // false si le graph est invalide (ressource jamais créée, cycle...), l'erreur est dans la console
+  bool Compile();
+  // bind les attachments et règle le viewport avant chaque passe, le framebuffer par défaut est remis à la fin
+  void Execute(RenderBackend& backend, Profiler* pProfiler);
+  // dans le contexte qui a créé les textures
+  void Destroy(RenderBackend& backend);
+
+  // texture d'une ressource transitoire, uniquement pendant Execute
+  unsigned int GetTexture(const entt::hashed_string& name) const;
+
+  inline size_t GetPassCount() const { return _passes.size(); }
+  inline size_t GetExecutedPassCount() const { return _order.size(); }
+  inline size_t GetTransientTextureCount() const { return _slots.size(); }
+
+private:
+  friend class FrameGraphBuilder;
+
+  struct Resource
+  {
+    entt::id_type name;
+    const char* debugName;
+    FrameGraphTextureDesc desc;
+    bool isCreated;
+    bool isImported;
+    unsigned int framebuffer; // ressource importée uniquement
+    std::vector<uint32_t> writers; // passes, dans l'ordre d'ajout
+    std::vector<uint32_t> readers;
+    uint32_t slot; // texture partagée, après Compile
+  };
+
+  struct Pass
+  {
+    const char* name;
+    ExecuteFunction execute;
+    std::vector<FrameGraphResource> reads;
+    std::vector<FrameGraphResource> writes;
+    bool hasSideEffect;
+    bool isUsed;
+  };
+
+  struct Texture
+  {
+    FrameGraphTextureDesc desc;
+    unsigned int handle;
+  };
+
+  std::vector<Resource> _resources;
+  std::vector<Pass> _passes;
+  std::vector<uint32_t> _order; // passes gardées, dans l'ordre d'exécution
+  std::vector<FrameGraphTextureDesc> _slots; // textures transitoires après partage
+
+  std::vector<Texture> _textures; // index = slot pendant Execute, gardées pour la frame suivante
+  std::map<std::vector<unsigned int>, unsigned int> _framebuffers; // attachments -> framebuffer
+
+  FrameGraphResource findOrAddResource(const entt::hashed_string& name);
+  void acquireTextures(RenderBackend& backend);
+  unsigned int getFramebuffer(RenderBackend& backend, const Pass& pass, int& width, int& height);
+};
+
+
+#endif // !VOXL_FRAME_GRAPH_H
\ No newline at end of file
@@ -0,0 +1,43 @@
+#ifndef VOXL_FRUSTUM_H
+#define VOXL_FRUSTUM_H
+
+
+#include <glm/glm.hpp>
+
+
+// ordre: gauche, droite, bas, haut, near, far
+// plan (a, b, c, d) avec la normale vers l'intérieur, un point p est dedans si dot(abc, p) + d >= 0
+struct Frustum
+{
+  glm::vec4 planes[6];
+};
+
+
+// méthode de Gribb/Hartmann, marche pour n'importe quelle matrice de projection OpenGL (z entre -w et w)
+inline Frustum ExtractFrustum(const glm::mat4& viewProjection)
+{
+  // glm est column-major, on reconstruit les lignes
+  glm::vec4 row0(viewProjection[0][0], viewProjection[1][0], viewProjection[2][0], viewProjection[3][0]);
+  glm::vec4 row1(viewProjection[0][1], viewProjection[1][1], viewProjection[2][1], viewProjection[3][1]);
+  glm::vec4 row2(viewProjection[0][2], viewProjection[1][2], viewProjection[2][2], viewProjection[3][2]);
+  glm::vec4 row3(viewProjection[0][3], viewProjection[1][3], viewProjection[2][3], viewProjection[3][3]);
+
+  Frustum frustum;
+  frustum.planes[0] = row3 + row0;
+  frustum.planes[1] = row3 - row0;
+  frustum.planes[2] = row3 + row1;
+  frustum.planes[3] = row3 - row1;
+  frustum.planes[4] = row3 + row2;
+  frustum.planes[5] = row3 - row2;
+
+  for (auto& plane: frustum.planes)
+  {
+    float length = glm::length(glm::vec3(plane));
+    if (length > 0.0f) plane /= length;
+  }
+
+  return frustum;
+}
+
+
+#endif // !VOXL_FRUSTUM_H
\ No newline at end of file
@@ -0,0 +1,88 @@
+#ifndef VOXL_GL_RENDER_BACKEND_H
+#define VOXL_GL_RENDER_BACKEND_H
+
+
+#include <unordered_map>
+#include <vector>
+
+#include "graphics/render_backend.h"
+
+
+class GLRenderBackend : public RenderBackend
+{
+public:
+  GLRenderBackend();
+  ~GLRenderBackend() override = default;
+
+  inline RenderBackendType GetType() const override { return RenderBackendType::OPENGL; }
+
+  unsigned int CreateBuffer(size_t size, const void* data, BufferUsage usage) override;
+  void UpdateBuffer(unsigned int buffer, size_t offset, size_t size, const void* data) override;
+  void DestroyBuffer(unsigned int buffer) override;
+
+  unsigned int CreatePersistentBuffer(size_t size, void** ppMapped) override;
+
+  uint64_t InsertFence() override;
+  bool WaitFence(uint64_t fence, uint64_t timeoutNanoseconds) override;
+  void DeleteFence(uint64_t fence) override;
+  void WaitFenceOnGpu(uint64_t fence) override;
+
+  unsigned int CreateVertexArray(const VertexLayout& layout, unsigned int vertexBuffer, unsigned int indexBuffer) override;
+  void DestroyVertexArray(unsigned int vertexArray) override;
+
+  unsigned int CreateTexture(const TextureDesc& desc, const void* pixels) override;
+  void DestroyTexture(unsigned int texture) override;
+
+  unsigned int CreatePipeline(const PipelineDesc& desc) override;
+  void DestroyPipeline(unsigned int pipeline) override;
+  void SetPipelineProgram(unsigned int pipeline, unsigned int program) override;
+
+  unsigned int CreateFramebuffer(const unsigned int* colorTextures, int colorCount, unsigned int depthTexture) override;
+  void DestroyFramebuffer(unsigned int framebuffer) override;
+  void BindFramebuffer(unsigned int framebuffer) override;
+
+  void SetViewport(int x, int y, int width, int height) override;
+  void SetClearColor(const glm::vec4& color) override;
+  void Clear() override;
+
+  void BindPipeline(unsigned int pipeline) override;
+  void SetUniform(const entt::hashed_string& name, const glm::mat4& value) override;
+  void SetUniform(const entt::hashed_string& name, float value) override;
+  void BindTexture(unsigned int unit, unsigned int texture) override;
+  void BindUniformBuffer(unsigned int binding, unsigned int buffer, size_t offset, size_t size) override;
+  size_t GetUniformBufferAlignment() const override;
+  void BindStorageBuffer(unsigned int binding, unsigned int buffer, size_t offset, size_t size) override;
+  size_t GetStorageBufferAlignment() const override;
+  void DrawIndexed(unsigned int vertexArray, int indexCount, size_t firstIndex, int baseVertex) override;
+  void DrawIndexedInstanced(unsigned int vertexArray, int indexCount, int instanceCount, size_t firstIndex, int baseVertex, uint32_t baseInstance) override;
+
+  unsigned int CreateTimerQuery() override;
+  void DestroyTimerQuery(unsigned int query) override;
+  void BeginTimerQuery(unsigned int query) override;
+  void EndTimerQuery() override;
+  bool GetTimerQueryResult(unsigned int query, uint64_t& nanoseconds) override;
+
+private:
+  struct Pipeline
+  {
+    PipelineDesc desc;
+    std::unordered_map<entt::id_type, int> uniformLocations; // évite un glGetUniformLocation par draw
+  };
+
+  std::vector<Pipeline> _pipelines; // handle = index + 1, 0 reste invalide
+  unsigned int _currentPipeline = 0;
+  unsigned int _currentVertexArray = 0;
+  mutable size_t _uniformBufferAlignment; // interrogé au premier appel, quand le contexte existe
+  mutable size_t _storageBufferAlignment;
+
+  // cache de l'état fixe pour ne pas renvoyer les mêmes glEnable/glDisable à chaque pipeline
+  int _blend = -1;
+  int _depthTest = -1;
+  int _cullFace = -1;
+
+  int getUniformLocation(const entt::hashed_string& name);
+  bool hasProgram() const;
+};
+
+
+#endif // !VOXL_GL_RENDER_BACKEND_H
\ No newline at end of file
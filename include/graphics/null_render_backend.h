@@ -0,0 +1,118 @@
+#ifndef VOXL_NULL_RENDER_BACKEND_H
+#define VOXL_NULL_RENDER_BACKEND_H
+
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "graphics/render_backend.h"
+
+
+enum class RenderCommandType
+{
+  CREATE_BUFFER,
+  CREATE_PERSISTENT_BUFFER,
+  UPDATE_BUFFER,
+  DESTROY_BUFFER,
+  CREATE_VERTEX_ARRAY,
+  DESTROY_VERTEX_ARRAY,
+  CREATE_TEXTURE,
+  DESTROY_TEXTURE,
+  CREATE_PIPELINE,
+  DESTROY_PIPELINE,
+  SET_PIPELINE_PROGRAM,
+  CREATE_FRAMEBUFFER,
+  DESTROY_FRAMEBUFFER,
+  BIND_FRAMEBUFFER,
+  SET_VIEWPORT,
+  SET_CLEAR_COLOR,
+  CLEAR,
+  BIND_PIPELINE,
+  SET_UNIFORM,
+  BIND_TEXTURE,
+  BIND_UNIFORM_BUFFER,
+  BIND_STORAGE_BUFFER,
+  DRAW_INDEXED,
+  DRAW_INDEXED_INSTANCED,
+};
+
+
+struct RecordedCommand
+{
+  RenderCommandType type;
+  unsigned int handle; // buffer, texture, pipeline ou vao selon la commande
+  uint64_t value; // taille, unit, id de l'uniform, nombre d'indices ou d'instances
+};
+
+
+// backend sans GPU : distribue des handles factices, compte tout et enregistre les commandes
+// permet de mesurer le coût CPU du rendu sans contexte OpenGL
+class NullRenderBackend : public RenderBackend
+{
+public:
+  NullRenderBackend(bool recordCommands = true);
+  ~NullRenderBackend() override = default;
+
+  inline RenderBackendType GetType() const override { return RenderBackendType::NONE; }
+
+  unsigned int CreateBuffer(size_t size, const void* data, BufferUsage usage) override;
+  void UpdateBuffer(unsigned int buffer, size_t offset, size_t size, const void* data) override;
+  void DestroyBuffer(unsigned int buffer) override;
+
+  unsigned int CreatePersistentBuffer(size_t size, void** ppMapped) override;
+
+  uint64_t InsertFence() override;
+  bool WaitFence(uint64_t fence, uint64_t timeoutNanoseconds) override;
+  void DeleteFence(uint64_t fence) override;
+  void WaitFenceOnGpu(uint64_t fence) override;
+
+  unsigned int CreateVertexArray(const VertexLayout& layout, unsigned int vertexBuffer, unsigned int indexBuffer) override;
+  void DestroyVertexArray(unsigned int vertexArray) override;
+
+  unsigned int CreateTexture(const TextureDesc& desc, const void* pixels) override;
+  void DestroyTexture(unsigned int texture) override;
+
+  unsigned int CreatePipeline(const PipelineDesc& desc) override;
+  void DestroyPipeline(unsigned int pipeline) override;
+  void SetPipelineProgram(unsigned int pipeline, unsigned int program) override;
+
+  unsigned int CreateFramebuffer(const unsigned int* colorTextures, int colorCount, unsigned int depthTexture) override;
+  void DestroyFramebuffer(unsigned int framebuffer) override;
+  void BindFramebuffer(unsigned int framebuffer) override;
+
+  void SetViewport(int x, int y, int width, int height) override;
+  void SetClearColor(const glm::vec4& color) override;
+  void Clear() override;
+
+  void BindPipeline(unsigned int pipeline) override;
+  void SetUniform(const entt::hashed_string& name, const glm::mat4& value) override;
+  void SetUniform(const entt::hashed_string& name, float value) override;
+  void BindTexture(unsigned int unit, unsigned int texture) override;
+  void BindUniformBuffer(unsigned int binding, unsigned int buffer, size_t offset, size_t size) override;
+  size_t GetUniformBufferAlignment() const override;
+  void BindStorageBuffer(unsigned int binding, unsigned int buffer, size_t offset, size_t size) override;
+  size_t GetStorageBufferAlignment() const override;
+  void DrawIndexed(unsigned int vertexArray, int indexCount, size_t firstIndex, int baseVertex) override;
+  void DrawIndexedInstanced(unsigned int vertexArray, int indexCount, int instanceCount, size_t firstIndex, int baseVertex, uint32_t baseInstance) override;
+
+  unsigned int CreateTimerQuery() override;
+  void DestroyTimerQuery(unsigned int query) override;
+  void BeginTimerQuery(unsigned int query) override;
+  void EndTimerQuery() override;
+  bool GetTimerQueryResult(unsigned int query, uint64_t& nanoseconds) override;
+
+  inline const std::vector<RecordedCommand>& GetCommands() const { return _commands; }
+  inline void ClearCommands() { _commands.clear(); }
+
+private:
+  bool _recordCommands;
+  unsigned int _nextHandle;
+  std::vector<RecordedCommand> _commands;
+  std::unordered_map<unsigned int, std::vector<uint8_t>> _persistentMemory; // mémoire CPU qui remplace le mapping GPU
+
+  void record(RenderCommandType type, unsigned int handle = 0, uint64_t value = 0);
+};
+
+
+#endif // !VOXL_NULL_RENDER_BACKEND_H
\ No newline at end of file
@@ -0,0 +1,80 @@
+#ifndef VOXL_OCCLUSION_BUFFER_H
+#define VOXL_OCCLUSION_BUFFER_H
+
+
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "components/mesh.h"
+
+
+class JobSystem;
+
+
+static constexpr int OCCLUSION_WIDTH = 256;
+static constexpr int OCCLUSION_HEIGHT = 128;
+static constexpr int OCCLUSION_BAND_HEIGHT = 16; // lignes par tâche de rasterisation
+static constexpr int OCCLUSION_LEVEL_COUNT = 8; // 256x128 jusqu'à 2x1
+
+
+// depth buffer CPU basse résolution rempli par quelques gros occulteurs, puis réduit en pyramide Hi-Z (max de chaque bloc 2x2)
+// une AABB est cachée si son point le plus proche est derrière le max de la pyramide sur tout son rectangle écran
+// ! les occulteurs doivent rester à l'intérieur de la géométrie dessinée, sinon des objets visibles disparaissent
+class OcclusionBuffer
+{
+public:
+  OcclusionBuffer();
+  ~OcclusionBuffer() = default;
+
+  // oublie les occulteurs de la frame précédente, viewProjection sert jusqu'au prochain Begin
+  void Begin(const glm::mat4& viewProjection);
+
+  // triangles d'un mesh en espace local, clippés contre le near plane, les deux faces sont rasterisées
+  void AddOccluder(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices, const glm::mat4& model);
+  // boite pleine en espace monde, pour les sections de chunk entièrement solides
+  void AddOccluderBox(const glm::vec3& min, const glm::vec3& max);
+
+  // une tâche par bande de OCCLUSION_BAND_HEIGHT lignes, puis construction de la pyramide
+  // sans JobSystem tout est fait sur le thread appelant
+  void Rasterize(JobSystem* pJobs);
+
+  // true si l'AABB monde peut être visible, toujours le cas si elle coupe le near plane
+  bool IsVisible(const glm::vec3& min, const glm::vec3& max) const;
+
+  inline size_t GetTriangleCount() const { return _triangles.size(); }
+  // profondeur [0, 1] du niveau 0, ligne 0 en bas comme OpenGL
+  inline const float* GetDepth() const { return _levels.data(); }
+
+private:
+  // E(x, y) = a * x + b * y + c pour chaque arête (>= 0 dedans) et pour la profondeur, x et y en pixels entiers
+  // le décalage au centre du pixel est déjà dans c
+  struct ScreenTriangle
+  {
+    float edgeA[3];
+    float edgeB[3];
+    float edgeC[3];
+    float depthA;
+    float depthB;
+    float depthC;
+    int minX;
+    int maxX;
+    int minY;
+    int maxY;
+  };
+
+  glm::mat4 _viewProjection;
+  std::vector<ScreenTriangle> _triangles;
+
+  std::vector<float> _levels; // tous les niveaux à la suite, le 0 en tête
+  int _levelOffsets[OCCLUSION_LEVEL_COUNT];
+
+  void addTriangle(const glm::vec4& a, const glm::vec4& b, const glm::vec4& c);
+  void addScreenTriangle(const glm::vec4& a, const glm::vec4& b, const glm::vec4& c);
+  void rasterizeBand(int band);
+  void buildHiZ();
+};
+
+
+#endif // !VOXL_OCCLUSION_BUFFER_H
\ No newline at end of file
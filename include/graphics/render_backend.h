@@ -0,0 +1,159 @@
+#ifndef VOXL_RENDER_BACKEND_H
+#define VOXL_RENDER_BACKEND_H
+
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <entt/core/hashed_string.hpp>
+
+
+enum class RenderBackendType
+{
+  OPENGL,
+  NONE, // aucun contexte GPU, enregistre juste les commandes (benchmarks headless)
+};
+
+
+enum class BufferUsage
+{
+  STATIC,
+  DYNAMIC,
+};
+
+
+enum class TextureFormat
+{
+  R8,
+  RG8,
+  RGB8,
+  RGBA8,
+  RGBA16F, // cibles de rendu HDR
+  DEPTH24, // attachment de profondeur
+};
+
+
+struct VertexAttribute
+{
+  unsigned int location;
+  int components; // toujours des floats pour le moment
+  size_t offset;
+};
+
+
+struct VertexLayout
+{
+  size_t stride;
+  std::vector<VertexAttribute> attributes;
+};
+
+
+struct TextureDesc
+{
+  int width;
+  int height;
+  TextureFormat format;
+  bool linearFilter = true;
+  bool clampToEdge = true;
+};
+
+
+// un pipeline = un programme + l'état fixe dont il a besoin
+struct PipelineDesc
+{
+  unsigned int program;
+  bool blend;
+  bool depthTest;
+  bool cullFace;
+};
+
+
+struct RenderStats
+{
+  uint32_t drawCalls;
+  uint64_t indices;
+  uint64_t instances;
+  uint32_t pipelineBinds;
+  uint32_t textureBinds;
+  uint32_t uniformUploads;
+  uint32_t bufferUploads;
+  uint64_t bytesUploaded;
+};
+
+
+// tout ce que le Renderer envoie au GPU passe par cette interface
+// les handles sont des unsigned int comme les handles OpenGL pour rester compatible avec Mesh/TextMesh
+class RenderBackend
+{
+public:
+  virtual ~RenderBackend() = default;
+
+  virtual RenderBackendType GetType() const = 0;
+
+  virtual unsigned int CreateBuffer(size_t size, const void* data, BufferUsage usage) = 0;
+  virtual void UpdateBuffer(unsigned int buffer, size_t offset, size_t size, const void* data) = 0;
+  virtual void DestroyBuffer(unsigned int buffer) = 0;
+
+  // buffer mappé une fois pour toute (persistent + coherent), l'appelant gère la synchro avec les fences
+  virtual unsigned int CreatePersistentBuffer(size_t size, void** ppMapped) = 0;
+
+  virtual uint64_t InsertFence() = 0;
+  virtual bool WaitFence(uint64_t fence, uint64_t timeoutNanoseconds) = 0; // false si le timeout expire
+  virtual void DeleteFence(uint64_t fence) = 0;
+  // les prochaines commandes de ce contexte attendent la fence d'un autre contexte, sans bloquer le CPU
+  virtual void WaitFenceOnGpu(uint64_t fence) = 0;
+
+  virtual unsigned int CreateVertexArray(const VertexLayout& layout, unsigned int vertexBuffer, unsigned int indexBuffer) = 0;
+  virtual void DestroyVertexArray(unsigned int vertexArray) = 0;
+
+  virtual unsigned int CreateTexture(const TextureDesc& desc, const void* pixels) = 0;
+  virtual void DestroyTexture(unsigned int texture) = 0;
+
+  virtual unsigned int CreatePipeline(const PipelineDesc& desc) = 0;
+  virtual void DestroyPipeline(unsigned int pipeline) = 0;
+  // remplace le programme quand une compilation asynchrone se termine, les draws d'un pipeline sans programme (0) sont ignorés
+  virtual void SetPipelineProgram(unsigned int pipeline, unsigned int program) = 0;
+
+  // cible de rendu faite de textures de CreateTexture (depthTexture peut être 0), le framebuffer 0 est celui de la fenêtre
+  virtual unsigned int CreateFramebuffer(const unsigned int* colorTextures, int colorCount, unsigned int depthTexture) = 0;
+  virtual void DestroyFramebuffer(unsigned int framebuffer) = 0;
+  virtual void BindFramebuffer(unsigned int framebuffer) = 0;
+
+  virtual void SetViewport(int x, int y, int width, int height) = 0;
+  virtual void SetClearColor(const glm::vec4& color) = 0;
+  virtual void Clear() = 0;
+
+  // les uniforms s'appliquent toujours au pipeline actuellement bind
+  virtual void BindPipeline(unsigned int pipeline) = 0;
+  virtual void SetUniform(const entt::hashed_string& name, const glm::mat4& value) = 0;
+  virtual void SetUniform(const entt::hashed_string& name, float value) = 0;
+  virtual void BindTexture(unsigned int unit, unsigned int texture) = 0;
+  virtual void BindUniformBuffer(unsigned int binding, unsigned int buffer, size_t offset, size_t size) = 0;
+  virtual size_t GetUniformBufferAlignment() const = 0;
+  virtual void BindStorageBuffer(unsigned int binding, unsigned int buffer, size_t offset, size_t size) = 0;
+  virtual size_t GetStorageBufferAlignment() const = 0;
+  // firstIndex et baseVertex permettent de dessiner depuis n'importe quelle région d'un buffer partagé
+  virtual void DrawIndexed(unsigned int vertexArray, int indexCount, size_t firstIndex = 0, int baseVertex = 0) = 0;
+  // gl_InstanceID va de 0 à instanceCount - 1, les données par instance sont lues dans un storage buffer
+  // baseInstance arrive tel quel dans gl_BaseInstance, pour indexer des données par draw sans rebind
+  virtual void DrawIndexedInstanced(unsigned int vertexArray, int indexCount, int instanceCount, size_t firstIndex = 0, int baseVertex = 0, uint32_t baseInstance = 0) = 0;
+
+  // requêtes GL_TIME_ELAPSED, elles ne peuvent pas être imbriquées
+  // GetTimerQueryResult ne bloque jamais, renvoie false si le GPU n'a pas encore fini
+  virtual unsigned int CreateTimerQuery() = 0;
+  virtual void DestroyTimerQuery(unsigned int query) = 0;
+  virtual void BeginTimerQuery(unsigned int query) = 0;
+  virtual void EndTimerQuery() = 0;
+  virtual bool GetTimerQueryResult(unsigned int query, uint64_t& nanoseconds) = 0;
+
+  inline const RenderStats& GetStats() const { return _stats; }
+  inline void ResetStats() { _stats = RenderStats{}; }
+
+protected:
+  RenderStats _stats{};
+};
+
+
+#endif // !VOXL_RENDER_BACKEND_H
\ No newline at end of file
@@ -0,0 +1,114 @@
+#ifndef VOXL_RENDER_SNAPSHOT_H
+#define VOXL_RENDER_SNAPSHOT_H
+
+
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <imgui/imgui.h>
+
+#include "components/mesh_instance.h"
+#include "components/text_mesh.h"
+
+
+// un mesh avec son propre Mesh, dessiné avec meshPipeline, terrainPipeline (entités Terrain) ou uiPipeline (fond des textes)
+// vertexArray n'est valide que dans le contexte du thread principal, vertexBuffer + indexBuffer permettent d'en recréer un ailleurs
+struct MeshDrawPacket
+{
+  unsigned int vertexArray;
+  unsigned int vertexBuffer;
+  unsigned int indexBuffer;
+  int indexCount;
+  glm::mat4 model;
+};
+
+
+// un groupe de MeshInstance qui partagent le même mesh, leurs données sont dans RenderSnapshot::instances
+struct InstanceDrawPacket
+{
+  unsigned int vertexArray;
+  unsigned int vertexBuffer;
+  unsigned int indexBuffer;
+  int indexCount;
+  uint32_t firstInstance;
+  uint32_t instanceCount;
+};
+
+
+// les sommets et les indices sont dans RenderSnapshot::textVertices/textIndices
+struct TextDrawPacket
+{
+  unsigned int fontTexture;
+  float pixelRange;
+  uint32_t firstVertex;
+  uint32_t vertexCount;
+  uint32_t firstIndex;
+  uint32_t indexCount;
+  bool hasBackground;
+  MeshDrawPacket background;
+};
+
+
+// tout ce qu'il faut pour dessiner une frame, sans jamais toucher au registry
+// écrit par Renderer::Extract sur le thread principal puis lu tel quel par Renderer::Execute (éventuellement sur le thread de rendu)
+// les vectors gardent leur capacité d'une frame à l'autre pour ne pas réallouer
+struct RenderSnapshot
+{
+  uint64_t frameIndex = 0;
+  int viewportWidth = 0;
+  int viewportHeight = 0;
+  glm::vec4 clearColor{0.0f};
+  glm::mat4 ortho{1.0f};
+
+  // programmes à utiliser, ils changent quand une compilation asynchrone se termine
+  unsigned int textProgram = 0;
+  unsigned int uiProgram = 0;
+  unsigned int instancedProgram = 0;
+  unsigned int upscaleProgram = 0;
+  unsigned int terrainProgram = 0;
+
+  // BlockTextureArray::handle, lié une seule fois pour tous les terrainMeshes
+  unsigned int blockTextures = 0;
+
+  // en résolution dynamique la scène n'occupe que renderScale * viewport (par axe) de sa cible
+  bool isDynamicResolution = false;
+  float renderScale = 1.0f;
+
+  bool hasCamera = false;
+  glm::mat4 viewProjection{1.0f};
+
+  // seulement avec le thread de rendu : fence posée après les uploads du contexte principal, attendue puis supprimée par le thread de rendu
+  uint64_t uploadFence = 0;
+  // (vbo << 32 | ebo) réécrits ou détruits depuis le snapshot précédent, leur VAO en cache est oublié avant de dessiner
+  std::vector<uint64_t> changedMeshes;
+
+  std::vector<MeshDrawPacket> terrainMeshes;
+  std::vector<MeshDrawPacket> meshes;
+  std::vector<InstanceDrawPacket> instanceGroups;
+  std::vector<InstanceData> instances;
+
+  std::vector<TextDrawPacket> texts;
+  std::vector<TextVertex> textVertices;
+  std::vector<unsigned int> textIndices;
+
+  // soit les données d'ImGui de la frame (rendu sur le thread principal), soit uiDrawData
+  const ImDrawData* pUiDrawData = nullptr;
+  ImDrawData uiDrawData; // copie possédée par le snapshot, voir CopyUiDrawData
+
+  RenderSnapshot() = default;
+  ~RenderSnapshot();
+  RenderSnapshot(const RenderSnapshot&) = delete;
+  RenderSnapshot& operator=(const RenderSnapshot&) = delete;
+
+  void Clear();
+  // clone les listes d'ImGui pour qu'un autre thread puisse les dessiner pendant la frame suivante
+  // ! les textures d'ImGui doivent déjà être à jour, les ImTextureRef sont résolues en ImTextureID ici
+  void CopyUiDrawData(const ImDrawData* drawData);
+
+private:
+  void clearUiDrawData();
+};
+
+
+#endif // !VOXL_RENDER_SNAPSHOT_H
\ No newline at end of file
@@ -2,21 +2,86 @@
 #define VOXL_RENDERER_H
 
 
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
 #include <SDL3/SDL_video.h>
 #include <entt/entity/fwd.hpp>
+#include <entt/resource/resource.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
+#include "graphics/render_backend.h"
+#include "graphics/dynamic_resolution.h"
+#include "graphics/frame_graph.h"
+#include "graphics/occlusion_buffer.h"
+#include "graphics/render_snapshot.h"
+#include "graphics/stream_buffer.h"
+#include "resources/block_texture_array.h"
+#include "resources/shader.h"
+#include "systems/visibility_system.h"
+
 
 class Window;
 
+class Profiler;
+
 struct ResizeEvent;
-struct Shader;
+struct MeshBuffersChangedEvent;
+struct Mesh;
+
+
+static constexpr size_t RENDER_STREAM_REGION_SIZE = 16 * 1024 * 1024; // par frame en vol, ~200k instances visibles
+static constexpr unsigned int UI_DRAW_DATA_BINDING = 1;
+static constexpr unsigned int INSTANCE_DATA_BINDING = 2;
+static constexpr unsigned int TERRAIN_DATA_BINDING = 3;
+
+
+// tout ce dont Execute a besoin pour un backend donné, créé dans le contexte qui dessine
+struct RenderResources
+{
+  unsigned int textPipeline;
+  unsigned int uiPipeline;
+  unsigned int meshPipeline; // meshes 3D, depth test et pas de blend
+  unsigned int instancedPipeline; // même état que meshPipeline, les matrices viennent d'un storage buffer
+  unsigned int upscalePipeline; // recopie la scène rendue en basse résolution sur toute la fenêtre
+  unsigned int terrainPipeline; // chunks et noeuds LOD, textures du BlockTextureArray
+  unsigned int textVertexArray; // lit les sommets et les indices directement dans le StreamBuffer
+  unsigned int fullscreenVertexArray; // un triangle qui couvre tout l'écran
+  unsigned int fullscreenVertexBuffer;
+  unsigned int fullscreenIndexBuffer;
+  StreamBuffer* pStream;
+
+  // programmes actuellement dans les pipelines, mis à jour quand une compilation asynchrone se termine
+  unsigned int textProgram;
+  unsigned int uiProgram;
+  unsigned int instancedProgram;
+  unsigned int upscaleProgram;
+  unsigned int terrainProgram;
+
+  // les VAO ne sont pas partagés entre contextes, le thread de rendu recrée ceux des meshes à partir de (vbo << 32 | ebo)
+  // un buffer réécrit par le contexte principal doit être rattaché ici pour que son contenu soit visible (GL 4.6 §5.3.3)
+  // un buffer détruit (ChunkMeshPool::Trim) libère son nom, qui peut revenir dans une autre clé
+  // dans les deux cas le VAO en cache est oublié avant les draws, voir RenderSnapshot::changedMeshes
+  bool isSharedContext;
+  std::unordered_map<uint64_t, unsigned int> meshVertexArrays;
+
+  // reconstruit à chaque frame, ses textures et framebuffers appartiennent à ce contexte
+  FrameGraph frameGraph;
+};
 
 
 class Renderer
 {
 public:
-  Renderer(entt::registry* registry, Window* window);
+  // useRenderThread : le contexte GL et tous les draws passent sur un thread dédié qui consomme les snapshots
+  // le thread principal ne fait plus qu'extraire la frame suivante pendant que la précédente est dessinée
+  Renderer(entt::registry* registry, Window* window, RenderBackendType backendType = RenderBackendType::OPENGL, bool useRenderThread = false);
   ~Renderer();
   
   bool Init();
@@ -26,19 +91,105 @@ public:
   void Render();
   void EndFrame();
 
+  // lit le registry et remplit le snapshot, toujours sur le thread principal
+  void Extract(RenderSnapshot& snapshot);
+  // envoie un snapshot sur n'importe quel backend dans la cible déjà bind, sans frame graph ni clear (benchmark headless)
+  // une frame normale passe par les passes de executeFrame
+  void Execute(RenderBackend& backend, RenderResources& resources, const RenderSnapshot& snapshot);
+
+  inline RenderBackend& GetBackend() { return *_pBackend; }
+  // pour créer et remplir des buffers depuis le thread principal (meshes de chunks) pendant que _pBackend dessine
+  inline RenderBackend& GetUploadBackend() { return _pUploadBackend ? *_pUploadBackend : *_pBackend; }
+  inline bool IsHeadless() const { return _backendType == RenderBackendType::NONE; }
+  inline bool IsRenderThreaded() const { return _useRenderThread; }
+
 private:
   entt::registry* _pRegistry;
   Window* _pWindow;
   SDL_GLContext _glCtx;
+  SDL_GLContext _renderGlCtx; // partagé avec _glCtx, courant uniquement sur le thread de rendu
+
+  RenderBackendType _backendType;
+  std::unique_ptr<RenderBackend> _pBackend; // utilisé uniquement par le thread qui dessine
+  std::unique_ptr<RenderBackend> _pUploadBackend; // seulement avec le thread de rendu, utilisé uniquement par le thread principal
 
-  Shader* _pTextShader;
-  Shader* _pUIShader;
+  std::unique_ptr<StreamBuffer> _pStream;
+  RenderResources _resources;
 
   glm::mat4 _ortho;
+  glm::vec4 _clearColor;
+  int _viewportWidth;
+  int _viewportHeight;
+
+  // double buffer : le thread principal écrit _snapshots[_writeIndex] pendant que le thread de rendu lit _snapshots[_readIndex]
+  bool _useRenderThread;
+  std::thread _renderThread;
+  std::mutex _snapshotMutex;
+  std::condition_variable _snapshotCondition;
+  RenderSnapshot _snapshots[2];
+  int _writeIndex;
+  int _readIndex;
+  std::vector<uint64_t> _changedMeshes; // reçus depuis le dernier Extract, passés au snapshot suivant
+  uint64_t _submittedFrames;
+  uint64_t _renderedFrames;
+  bool _stopRenderThread;
+
+  // compilés en asynchrone, rien n'est dessiné avec un pipeline tant que son shader n'est pas prêt
+  entt::resource<Shader> _textShader;
+  entt::resource<Shader> _uiShader;
+  entt::resource<Shader> _instancedShader;
+  entt::resource<Shader> _upscaleShader;
+  entt::resource<Shader> _terrainShader;
+
+  // toutes les textures du terrain, liées une seule fois par frame pour tous les chunks (executeTerrain)
+  entt::resource<BlockTextureArray> _blockTextures;
+
+  VisibilitySystem _visibility;
+  std::vector<entt::entity> _visible; // gardé entre les frames pour ne pas réallouer
+  std::vector<std::pair<const Mesh*, entt::entity>> _instances; // MeshInstance visibles, triées par mesh
+
+  // rempli chaque frame avec les entités Occluder et les OccluderBox proches, ce qu'il cache n'est pas extrait
+  bool _useOcclusion;
+  OcclusionBuffer _occlusion;
+
+  // le monde est rendu dans une cible hors écran à une échelle réglée d'après le temps GPU, l'UI reste en résolution native
+  bool _useDynamicResolution;
+  DynamicResolution _dynamicResolution;
+
+  static RenderResources createResources(RenderBackend& backend, StreamBuffer& stream, unsigned int textProgram, unsigned int uiProgram, unsigned int instancedProgram, unsigned int terrainProgram);
+  static void destroyResources(RenderBackend& backend, RenderResources& resources);
+  static void applyPrograms(RenderBackend& backend, RenderResources& resources, const RenderSnapshot& snapshot);
+  static void dropChangedVertexArrays(RenderBackend& backend, RenderResources& resources, const RenderSnapshot& snapshot);
+  static unsigned int getMeshVertexArray(RenderBackend& backend, RenderResources& resources, unsigned int vertexArray, unsigned int vertexBuffer, unsigned int indexBuffer);
 
   void registerCommands();
+  void registerBenchCommand();
+  void registerCullingBenchCommand();
+  void registerOcclusionBenchCommand();
+
+  bool rasterizeOccluders(const glm::mat4& viewProjection, const glm::vec3& viewerPosition);
+  // Extract sans ce qui ne doit arriver qu'une fois par frame dessinée (VAO à refaire, pas de la résolution dynamique), pour les benchs
+  void extractScene(RenderSnapshot& snapshot);
+  void extractMeshes(RenderSnapshot& snapshot);
+  void extractInstances(RenderSnapshot& snapshot);
+  void extractTexts(RenderSnapshot& snapshot);
+
+  void executeTerrain(RenderBackend& backend, RenderResources& resources, const RenderSnapshot& snapshot);
+  void executeMeshes(RenderBackend& backend, RenderResources& resources, const RenderSnapshot& snapshot);
+  void executeInstances(RenderBackend& backend, RenderResources& resources, const RenderSnapshot& snapshot);
+  void executeTexts(RenderBackend& backend, RenderResources& resources, const RenderSnapshot& snapshot);
+  void executeUpscale(RenderBackend& backend, RenderResources& resources, const RenderSnapshot& snapshot, unsigned int sceneTexture);
+  void executeFrame(const RenderSnapshot& snapshot, Profiler* pProfiler);
+
+  bool startRenderThread();
+  void stopRenderThread();
+  void renderThreadLoop();
+  void publishSnapshot();
+
+  void pollShaders();
 
   void onResize(const ResizeEvent& e);
+  void onMeshBuffersChanged(const MeshBuffersChangedEvent& e);
 };
 
 
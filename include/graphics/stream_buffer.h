@@ -0,0 +1,64 @@
+#ifndef VOXL_STREAM_BUFFER_H
+#define VOXL_STREAM_BUFFER_H
+
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "graphics/render_backend.h"
+
+
+static constexpr int STREAM_BUFFER_REGIONS = 3; // triple buffering, le CPU écrit pendant que le GPU lit les 2 frames précédentes
+
+
+struct StreamAllocation
+{
+  void* pData; // nullptr si la région de la frame est pleine
+  size_t offset; // offset absolu dans le buffer
+  size_t size;
+};
+
+
+// un seul buffer persistant découpé en STREAM_BUFFER_REGIONS régions, une par frame en vol
+// chaque région est protégée par une fence et allouée linéairement (bump allocator)
+// on évite ainsi les map/unmap et la synchro implicite du driver
+class StreamBuffer
+{
+public:
+  StreamBuffer(RenderBackend& backend, size_t regionSize);
+  ~StreamBuffer();
+
+  StreamBuffer(const StreamBuffer&) = delete;
+  StreamBuffer& operator=(const StreamBuffer&) = delete;
+
+  // attend que le GPU ait fini de lire la région qu'on va réécrire
+  void BeginFrame();
+  // pose la fence de la région courante, à appeler après le dernier draw qui l'utilise
+  void EndFrame();
+
+  // alignment n'a pas besoin d'être une puissance de 2 (ex: sizeof(TextVertex) pour le baseVertex)
+  StreamAllocation Allocate(size_t size, size_t alignment);
+
+  inline unsigned int GetBuffer() const { return _buffer; }
+  inline size_t GetRegionSize() const { return _regionSize; }
+  inline size_t GetUsed() const { return _head - _region * _regionSize; }
+  inline uint32_t GetStallCount() const { return _stallCount; }
+
+private:
+  RenderBackend& _backend;
+
+  unsigned int _buffer;
+  uint8_t* _pMapped;
+
+  size_t _regionSize;
+  int _region;
+  size_t _head; // prochain octet libre, absolu
+
+  std::array<uint64_t, STREAM_BUFFER_REGIONS> _fences{};
+  uint32_t _stallCount; // nombre de fois où le CPU a dû attendre le GPU
+  bool _hasWarnedOverflow;
+};
+
+
+#endif // !VOXL_STREAM_BUFFER_H
\ No newline at end of file
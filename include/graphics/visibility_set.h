@@ -0,0 +1,51 @@
+#ifndef VOXL_VISIBILITY_SET_H
+#define VOXL_VISIBILITY_SET_H
+
+
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "graphics/frustum.h"
+
+
+class OcclusionBuffer;
+
+
+// AABB monde de tous les objets affichables, rangées en SoA pour être testées 4 ou 8 à la fois
+// les ids sont libres (on utilise l'index des entités), les slots restent compacts grâce au swap-remove
+class VisibilitySet
+{
+public:
+  VisibilitySet() = default;
+  ~VisibilitySet() = default;
+
+  void Set(uint32_t id, const glm::vec3& min, const glm::vec3& max);
+  void Remove(uint32_t id);
+  void Clear();
+
+  // remplit visible avec les ids dont l'AABB touche le frustum
+  void Cull(const Frustum& frustum, std::vector<uint32_t>& visible) const;
+  // retire de visible (résultat de Cull) les ids cachés derrière les occulteurs, l'ordre est conservé
+  void CullOccluded(const OcclusionBuffer& occlusion, std::vector<uint32_t>& visible) const;
+
+  inline bool Contains(uint32_t id) const { return id < _slots.size() && _slots[id] != INVALID_SLOT; }
+  inline size_t Size() const { return _ids.size(); }
+
+private:
+  static constexpr uint32_t INVALID_SLOT = UINT32_MAX;
+
+  std::vector<uint32_t> _ids; // slot -> id
+  std::vector<uint32_t> _slots; // id -> slot
+
+  std::vector<float> _minX;
+  std::vector<float> _minY;
+  std::vector<float> _minZ;
+  std::vector<float> _maxX;
+  std::vector<float> _maxY;
+  std::vector<float> _maxZ;
+};
+
+
+#endif // !VOXL_VISIBILITY_SET_H
\ No newline at end of file
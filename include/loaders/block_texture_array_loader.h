@@ -0,0 +1,44 @@
+#ifndef VOXL_BLOCK_TEXTURE_ARRAY_LOADER_H
+#define VOXL_BLOCK_TEXTURE_ARRAY_LOADER_H
+
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "resources/block_texture_array.h"
+#include "resources/retired_gl_objects.h"
+
+
+class JobSystem;
+
+
+// construit un BlockTextureArray depuis assets/blocks/<name>.json
+//
+// {
+//   "tileSize": 16,
+//   "blocks": [
+//     { "name": "stone", "textures": { "all": "stone.png" } },
+//     { "name": "grass", "textures": { "top": "grass_top.png", "bottom": "dirt.png", "side": "grass_side.png" } }
+//   ]
+// }
+//
+// faces : east, west, top, bottom, south, north, "side" couvre les 4 faces latérales et "all" les 6, la plus précise l'emporte
+// les chemins sont relatifs à assets/blocks/, un fichier utilisé plusieurs fois n'occupe qu'un layer
+struct BlockTextureArrayLoader
+{
+  using result_type = std::shared_ptr<BlockTextureArray>;
+
+  // décodage et mips de chaque layer sur ces workers, nullptr : tout sur le thread principal
+  static inline JobSystem* pJobSystem = nullptr;
+
+  result_type operator()(const std::string& manifestName);
+
+  // le manifest et les textures qu'il référence au moment du chargement
+  static std::vector<std::string> GetAssetPaths(const std::string& manifestName);
+  // reconstruit tout le tableau, les ids des blocs suivent le nouveau manifest
+  bool Reload(BlockTextureArray& blockTextures, const std::vector<std::string>& changedPaths, RetiredGLObjects& retired, const std::string& manifestName);
+};
+
+
+#endif // !VOXL_BLOCK_TEXTURE_ARRAY_LOADER_H
\ No newline at end of file
@@ -4,18 +4,25 @@
 
 #include <string>
 #include <memory>
+#include <vector>
 
 #include <nlohmann/json.hpp>
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 
 #include "resources/font.h"
+#include "resources/retired_gl_objects.h"
 
 struct FontLoader
 {
   using result_type = std::shared_ptr<Font>;
 
   result_type operator()(const std::string& fontName);
+
+  // metrics.json et atlas.png, pour le rechargement à chaud
+  static std::vector<std::string> GetAssetPaths(const std::string& fontName);
+  // ne relit que les fichiers modifiés, la Font est modifiée en place pour que les pointeurs des Text restent valides
+  bool Reload(Font& font, const std::vector<std::string>& changedPaths, RetiredGLObjects& retired, const std::string& fontName);
 };
 
 
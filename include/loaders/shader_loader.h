@@ -6,79 +6,207 @@
 #include <vector>
 #include <memory>
 
+#include <SDL3/SDL_video.h>
 #include <glad/glad.h>
 
 #include "resources/shader.h"
+#include "resources/retired_gl_objects.h"
+#include "utils/program_binary_cache.h"
 #include "utils/read_file.h"
 
 
+// GL_KHR_parallel_shader_compile n'est pas dans notre glad
+static constexpr GLenum SHADER_COMPLETION_STATUS_KHR = 0x91B1;
+using PFN_MAX_SHADER_COMPILER_THREADS = void (APIENTRY*)(GLuint count);
+
+
 struct ShaderLoader
 {
   using result_type = std::shared_ptr<Shader>;
 
+  // true si le driver compile en parallèle et permet d'interroger l'avancement sans bloquer
+  static inline bool isParallelCompileSupported = false;
+
+  // à appeler une fois après le chargement de GL, active les threads de compilation du driver si l'extension existe
+  static void EnableParallelCompile()
+  {
+    const char* extensions[] = { "GL_KHR_parallel_shader_compile", "GL_ARB_parallel_shader_compile" };
+    const char* functions[] = { "glMaxShaderCompilerThreadsKHR", "glMaxShaderCompilerThreadsARB" };
+
+    for (int i = 0; i < 2; i++)
+    {
+      if (!SDL_GL_ExtensionSupported(extensions[i])) continue;
+
+      auto max_shader_compiler_threads = (PFN_MAX_SHADER_COMPILER_THREADS)SDL_GL_GetProcAddress(functions[i]);
+      if (max_shader_compiler_threads) max_shader_compiler_threads(0xFFFFFFFF); // autant que le driver veut
+      isParallelCompileSupported = true;
+      return;
+    }
+  }
+
   result_type operator()(const std::string& name)
+  {
+    return (*this)(name, ShaderCompileMode::SYNC);
+  }
+
+  // en ASYNC le Shader renvoyé utilise fallbackProgram jusqu'à ce que PollShader le passe à READY
+  // le programme de secours doit avoir les mêmes entrées (attributs, uniforms, bindings) que celui attendu, ou 0 pour ne rien dessiner
+  result_type operator()(const std::string& name, ShaderCompileMode mode, unsigned int fallbackProgram = 0)
   {
     Shader shader;
 
     std::string base = "assets/shaders/";
-
-    unsigned int vertex = glCreateShader(GL_VERTEX_SHADER);
     std::string vertex_source = ReadFile(base + name + ".vert");
-    const char* vertex_source_c = vertex_source.c_str();
-    glShaderSource(vertex, 1, &vertex_source_c, nullptr);
-    glCompileShader(vertex);
+    std::string fragment_source = ReadFile(base + name + ".frag");
 
-    int success;
-    glGetShaderiv(vertex, GL_COMPILE_STATUS, &success);
-    if (!success)
+    // un programme déjà linké avec ces sources sur ce driver est rechargé tel quel, sans compilation
+    const bool use_binary_cache = IsProgramBinarySupported();
+    const uint64_t binary_key = GetProgramBinaryKey(vertex_source, fragment_source);
+    if (use_binary_cache)
     {
-      int log_length;
-      glGetShaderiv(vertex, GL_INFO_LOG_LENGTH, &log_length);
-      std::vector<char> info_log(log_length);
-      glGetShaderInfoLog(vertex, log_length, &log_length, info_log.data());
-      std::cout << "[LoadShader] " << name << " - Failed to compile vertex shader: " << info_log.data() << "\n";
-      
-      return nullptr;
+      shader.program = LoadProgramBinary(name, binary_key);
+      if (shader.program) return std::make_shared<Shader>(shader);
     }
 
-    unsigned int fragment = glCreateShader(GL_FRAGMENT_SHADER);
-    std::string fragment_source = ReadFile(base + name + ".frag");
-    const char* fragment_source_c = fragment_source.c_str();
-    glShaderSource(fragment, 1, &fragment_source_c, nullptr);
-    glCompileShader(fragment);
+    unsigned int vertex = compileShader(GL_VERTEX_SHADER, vertex_source);
+    unsigned int fragment = compileShader(GL_FRAGMENT_SHADER, fragment_source);
 
-    glGetShaderiv(fragment, GL_COMPILE_STATUS, &success);
-    if (!success)
+    unsigned int program = glCreateProgram();
+    glAttachShader(program, vertex);
+    glAttachShader(program, fragment);
+    if (use_binary_cache) glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    glLinkProgram(program);
+
+    shader.name = name;
+    shader.pendingProgram = program;
+    shader.pendingVertex = vertex;
+    shader.pendingFragment = fragment;
+    shader.binaryKey = use_binary_cache ? binary_key : 0;
+    shader.status = ShaderStatus::COMPILING;
+
+    if (mode == ShaderCompileMode::ASYNC)
     {
-      int log_length;
-      glGetShaderiv(fragment, GL_INFO_LOG_LENGTH, &log_length);
-      std::vector<char> info_log(log_length);
-      glGetShaderInfoLog(fragment, log_length, &log_length, info_log.data());
-      std::cout << "[LoadShader] " << name << " - Failed to compile fragment shader: " << info_log.data() << "\n";
-      
-      return nullptr;
+      shader.program = fallbackProgram;
+      return std::make_shared<Shader>(shader);
     }
 
-    shader.program = glCreateProgram();
-    glAttachShader(shader.program, vertex);
-    glAttachShader(shader.program, fragment);
-    glLinkProgram(shader.program);
+    // en synchrone, interroger le statut attend la fin de la compilation
+    if (!FinishShader(shader)) return nullptr;
+    return std::make_shared<Shader>(shader);
+  }
+
+  // .vert et .frag, pour le rechargement à chaud (le mode et le programme de secours n'y changent rien)
+  template<typename... Rest>
+  static std::vector<std::string> GetAssetPaths(const std::string& name, const Rest&...)
+  {
+    std::string base = "assets/shaders/";
+    return { base + name + ".vert", base + name + ".frag" };
+  }
+
+  // toujours synchrone : un shader qui ne compile plus garde son programme actuel, l'erreur est dans la console
+  // les pipelines récupèrent le nouveau programme à la prochaine extraction (Renderer::applyPrograms)
+  template<typename... Rest>
+  bool Reload(Shader& shader, const std::vector<std::string>&, RetiredGLObjects& retired, const std::string& name, const Rest&...)
+  {
+    result_type fresh = (*this)(name, ShaderCompileMode::SYNC);
+    if (!fresh) return false;
+
+    // une compilation asynchrone encore en cours est terminée pour libérer ses objets
+    // en COMPILING ou FAILED, program est le programme de secours qui appartient à un autre Shader
+    if (shader.status == ShaderStatus::COMPILING) FinishShader(shader);
+    if (shader.status == ShaderStatus::READY && shader.program) retired.programs.push_back(shader.program);
+
+    shader = *fresh;
+    return true;
+  }
 
-    glGetProgramiv(shader.program, GL_LINK_STATUS, &success);
-    if (!success)
+  // vérifie la compilation et le link, puis libère les shaders intermédiaires
+  // ! bloque si la compilation n'est pas terminée, passer par PollShader pour ne jamais attendre
+  static bool FinishShader(Shader& shader)
+  {
+    bool success = checkShader(shader.name, shader.pendingVertex, "vertex") && checkShader(shader.name, shader.pendingFragment, "fragment");
+
+    if (success)
     {
-      int log_length;
-      glGetProgramiv(shader.program, GL_INFO_LOG_LENGTH, &log_length);
-      std::vector<char> info_log(log_length);
-      glGetProgramInfoLog(shader.program, log_length, &log_length, info_log.data());
-      std::cout << "[LoadShader] " << name << " - Failed to link program: " << info_log.data() << "\n";
+      int linked;
+      glGetProgramiv(shader.pendingProgram, GL_LINK_STATUS, &linked);
+      if (!linked)
+      {
+        int log_length;
+        glGetProgramiv(shader.pendingProgram, GL_INFO_LOG_LENGTH, &log_length);
+        std::vector<char> info_log(log_length + 1, '\0');
+        glGetProgramInfoLog(shader.pendingProgram, log_length, &log_length, info_log.data());
+        std::cout << "[LoadShader] " << shader.name << " - Failed to link program: " << info_log.data() << "\n";
+        success = false;
+      }
+    }
 
-      return nullptr;
+    glDetachShader(shader.pendingProgram, shader.pendingVertex);
+    glDetachShader(shader.pendingProgram, shader.pendingFragment);
+    glDeleteShader(shader.pendingVertex);
+    glDeleteShader(shader.pendingFragment);
+
+    if (success)
+    {
+      if (shader.binaryKey) SaveProgramBinary(shader.name, shader.binaryKey, shader.pendingProgram);
+      shader.program = shader.pendingProgram;
+      shader.status = ShaderStatus::READY;
+    }
+    else
+    {
+      // on garde le programme de secours
+      glDeleteProgram(shader.pendingProgram);
+      shader.status = ShaderStatus::FAILED;
     }
 
-    return std::make_shared<Shader>(shader);
+    shader.pendingProgram = 0;
+    shader.pendingVertex = 0;
+    shader.pendingFragment = 0;
+    return success;
+  }
+
+private:
+  static unsigned int compileShader(GLenum type, const std::string& source)
+  {
+    unsigned int shader = glCreateShader(type);
+    const char* source_c = source.c_str();
+    glShaderSource(shader, 1, &source_c, nullptr);
+    glCompileShader(shader);
+    return shader;
+  }
+
+  static bool checkShader(const std::string& name, unsigned int shader, const char* stage)
+  {
+    int success;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+    if (success) return true;
+
+    int log_length;
+    glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &log_length);
+    std::vector<char> info_log(log_length + 1, '\0');
+    glGetShaderInfoLog(shader, log_length, &log_length, info_log.data());
+    std::cout << "[LoadShader] " << name << " - Failed to compile " << stage << " shader: " << info_log.data() << "\n";
+    return false;
   }
 };
 
 
+// à appeler chaque frame sur un Shader chargé en ASYNC, renvoie true quand il n'est plus en compilation (READY ou FAILED)
+// sans GL_KHR_parallel_shader_compile il n'y a aucun moyen de savoir sans attendre, le premier appel termine donc la compilation
+inline bool PollShader(Shader& shader)
+{
+  if (shader.status != ShaderStatus::COMPILING) return true;
+
+  if (ShaderLoader::isParallelCompileSupported)
+  {
+    int is_complete = 0;
+    glGetProgramiv(shader.pendingProgram, SHADER_COMPLETION_STATUS_KHR, &is_complete);
+    if (!is_complete) return false;
+  }
+
+  ShaderLoader::FinishShader(shader);
+  return true;
+}
+
+
 #endif // !VOXL_SHADER_LOADER_H
\ No newline at end of file
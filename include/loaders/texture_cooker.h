@@ -0,0 +1,60 @@
+#ifndef VOXL_TEXTURE_COOKER_H
+#define VOXL_TEXTURE_COOKER_H
+
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "resources/cooked_texture.h"
+
+
+class JobSystem;
+
+
+// textures cuites à côté du cache des shaders, recréées dès que la source change
+static constexpr const char* COOKED_TEXTURE_DIRECTORY = "cache/textures/";
+static constexpr uint32_t TEXTURE_COOK_ROWS_PER_TASK = 8; // lignes de pixels (mips) ou de blocs (compression) par tâche
+
+
+struct TextureCookSettings
+{
+  TextureCompression compression = TextureCompression::AUTO;
+  bool allowS3TC = true; // BC1/BC3 passent par une extension, sans elle AUTO choisit BC7
+};
+
+
+// un niveau de mip décodé, 4 octets par pixel
+struct MipLevel
+{
+  uint32_t width;
+  uint32_t height;
+  std::vector<uint8_t> rgba;
+};
+
+
+// complète levels (qui contient le niveau 0) jusqu'à 1x1, filtre boîte 2x2
+// chaque niveau dépend du précédent, seules les lignes d'un niveau sont réparties sur pJobs (nullptr : thread appelant)
+void GenerateMipChain(std::vector<MipLevel>& levels, JobSystem* pJobs);
+
+// "ui/icon_close.png" -> "cache/textures/ui/icon_close.png.vxtx"
+std::string GetCookedTexturePath(const std::string& texPath);
+
+// taille et date de la source + réglages, 0 si la source n'existe pas
+// on ne relit pas la source : savoir si un fichier cuit est à jour ne coûte qu'un stat
+uint64_t GetCookedTextureKey(const std::string& sourcePath, const TextureCookSettings& settings);
+
+// true si data est un fichier cuit complet et cohérent pour cette clé
+bool IsCookedTextureValid(const uint8_t* data, size_t size, uint64_t key);
+
+// décode la source, génère toute la chaîne de mips puis compresse chaque niveau
+// mips et blocs sont répartis sur les workers de pJobs (nullptr : tout sur le thread appelant)
+bool CookTexture(const std::string& sourcePath, const std::string& cookedPath, uint64_t key, const TextureCookSettings& settings, JobSystem* pJobs);
+
+// cuisson hors ligne de tout assets/textures/, seules les textures périmées sont refaites
+// renvoie le nombre de textures cuites
+size_t CookTextures(const TextureCookSettings& settings, JobSystem* pJobs);
+
+
+#endif // !VOXL_TEXTURE_COOKER_H
\ No newline at end of file
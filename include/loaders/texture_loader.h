@@ -4,15 +4,42 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "resources/texture.h"
+#include "resources/retired_gl_objects.h"
 
 
+class JobSystem;
+
+
+// GL_EXT_texture_compression_s3tc n'est pas dans notre glad
+static constexpr unsigned int COMPRESSED_RGB_S3TC_DXT1_EXT = 0x83F0;
+static constexpr unsigned int COMPRESSED_RGBA_S3TC_DXT5_EXT = 0x83F3;
+
+
+// charge la version cuite de la texture (cache/textures/, voir texture_cooker.h) et la cuit d'abord si elle est absente ou périmée
+// le fichier cuit est projeté en mémoire et ses mips compressés partent directement vers GL, sans décodage
+// si la cuisson échoue on retombe sur le PNG décodé, sans mips ni compression
 struct TextureLoader
 {
   using result_type = std::shared_ptr<Texture>;
 
+  // workers pour la cuisson au premier lancement, nullptr : tout sur le thread principal
+  static inline JobSystem* pJobSystem = nullptr;
+  // sans S3TC, BC1/BC3 sont remplacés par BC7 à la cuisson
+  static inline bool isS3TCSupported = false;
+
+  // à appeler une fois après le chargement de GL
+  static void EnableCompression();
+
   result_type operator()(const std::string& texPath);
+
+  // fichiers dont dépend la texture, pour le rechargement à chaud
+  static std::vector<std::string> GetAssetPaths(const std::string& texPath);
+  // recuit puis réutilise le même handle si la taille, le format et le nombre de mips n'ont pas changé, sinon l'ancien part dans retired
+  // en cas d'échec la texture reste telle quelle
+  bool Reload(Texture& texture, const std::vector<std::string>& changedPaths, RetiredGLObjects& retired, const std::string& texPath);
 };
 
 
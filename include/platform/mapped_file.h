@@ -0,0 +1,42 @@
+#ifndef VOXL_MAPPED_FILE_H
+#define VOXL_MAPPED_FILE_H
+
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+
+// fichier projeté en mémoire en lecture seule (mmap / MapViewOfFile)
+// les pages ne sont lues qu'au premier accès et restent dans le cache de l'OS, pas de copie dans un buffer à nous
+class MappedFile
+{
+public:
+  MappedFile() = default;
+  ~MappedFile();
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+  MappedFile(MappedFile&& other) noexcept;
+  MappedFile& operator=(MappedFile&& other) noexcept;
+
+  // false si le fichier n'existe pas ou est vide
+  // allowWriters : le fichier reste ouvert en écriture ailleurs (RegionFile), la projection ne voit pas ce qui est ajouté après Open
+  bool Open(const std::string& path, bool allowWriters = false);
+  void Close();
+
+  inline bool IsOpen() const { return _pData != nullptr; }
+  inline const uint8_t* GetData() const { return _pData; }
+  inline size_t GetSize() const { return _size; }
+
+private:
+  const uint8_t* _pData = nullptr;
+  size_t _size = 0;
+
+#ifdef _WIN32
+  void* _file = nullptr; // HANDLE
+  void* _mapping = nullptr; // HANDLE
+#endif
+};
+
+
+#endif // !VOXL_MAPPED_FILE_H
\ No newline at end of file
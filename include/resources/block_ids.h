@@ -0,0 +1,34 @@
+#ifndef VOXL_BLOCK_IDS_H
+#define VOXL_BLOCK_IDS_H
+
+
+#include <cstdint>
+#include <string_view>
+
+
+// ids des blocs tels qu'ils sont écrits dans les chunks et les fichiers de région
+// seule source des ids : le manifest des textures (assets/blocks/) s'y réfère par nom, le réordonner ne change aucun bloc
+// ! ne jamais renuméroter, un nouveau bloc s'ajoute à la fin
+static constexpr uint16_t BLOCK_AIR = 0;
+static constexpr uint16_t BLOCK_STONE = 1;
+static constexpr uint16_t BLOCK_DIRT = 2;
+static constexpr uint16_t BLOCK_GRASS = 3;
+static constexpr uint16_t BLOCK_SAND = 4;
+static constexpr uint16_t BLOCK_COUNT = 5;
+
+// nom de chaque bloc dans le manifest, indexé par id
+static constexpr std::string_view BLOCK_NAMES[BLOCK_COUNT] = { "air", "stone", "dirt", "grass", "sand" };
+
+
+// BLOCK_AIR si le nom n'est pas dans la table
+inline uint16_t FindBlockId(std::string_view name)
+{
+  for (uint16_t id = BLOCK_AIR + 1; id < BLOCK_COUNT; id++)
+  {
+    if (BLOCK_NAMES[id] == name) return id;
+  }
+  return BLOCK_AIR;
+}
+
+
+#endif // !VOXL_BLOCK_IDS_H
\ No newline at end of file
@@ -0,0 +1,52 @@
+#ifndef VOXL_BLOCK_TEXTURE_ARRAY_H
+#define VOXL_BLOCK_TEXTURE_ARRAY_H
+
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "resources/block_ids.h"
+
+
+// ordre des faces d'un bloc, aussi utilisé par le mesher
+enum class BlockFace : uint8_t
+{
+  EAST, // +X
+  WEST, // -X
+  TOP, // +Y
+  BOTTOM, // -Y
+  SOUTH, // +Z
+  NORTH, // -Z
+  COUNT
+};
+
+
+static constexpr uint16_t BLOCK_MISSING_LAYER = 0; // damier magenta généré par le loader, pour les textures absentes ou invalides
+
+
+// toutes les textures de blocs dans un seul GL_TEXTURE_2D_ARRAY, un layer par fichier
+// le terrain entier se dessine avec un seul bind, le shader reçoit le layer dans ses sommets
+struct BlockTextureArray
+{
+  unsigned int handle;
+  uint32_t tileSize;
+  uint32_t layerCount;
+  uint32_t levelCount;
+
+  // faceLayers[blockId * BlockFace::COUNT + face] pour les BLOCK_COUNT ids de block_ids.h
+  // l'air et les blocs absents du manifest n'ont que des BLOCK_MISSING_LAYER
+  std::vector<uint16_t> faceLayers;
+  std::unordered_map<std::string, uint16_t> blockIds; // nom du manifest -> id de block_ids.h
+
+  inline uint16_t GetLayer(uint16_t blockId, BlockFace face) const
+  {
+    return faceLayers[(size_t)blockId * (size_t)BlockFace::COUNT + (size_t)face];
+  }
+
+  inline uint16_t GetBlockCount() const { return (uint16_t)(faceLayers.size() / (size_t)BlockFace::COUNT); }
+};
+
+
+#endif // !VOXL_BLOCK_TEXTURE_ARRAY_H
\ No newline at end of file
@@ -0,0 +1,64 @@
+#ifndef VOXL_COOKED_TEXTURE_H
+#define VOXL_COOKED_TEXTURE_H
+
+
+#include <cstdint>
+
+
+// conteneur des textures cuites, inspiré de KTX2 mais réduit à ce que le loader utilise
+//
+// [CookedTextureHeader][CookedTextureLevel x levelCount][niveaux compressés, chacun aligné sur COOKED_TEXTURE_ALIGNMENT]
+// le niveau 0 est le plus grand, chaque niveau est prêt à passer tel quel à glCompressedTextureSubImage2D
+static constexpr uint32_t COOKED_TEXTURE_MAGIC = 0x58545856; // "VXTX"
+static constexpr uint32_t COOKED_TEXTURE_VERSION = 1;
+static constexpr uint32_t COOKED_TEXTURE_MAX_LEVELS = 16;
+static constexpr uint32_t COOKED_TEXTURE_ALIGNMENT = 16;
+
+
+enum class TextureCompression : uint32_t
+{
+  AUTO, // selon les canaux de la source : BC4 (R), BC5 (RG), BC1 (RGB), BC7 (RGBA)
+  BC1, // RGB, 4 bits par pixel
+  BC3, // RGBA, 8 bits par pixel, alpha séparé
+  BC4, // R, 4 bits par pixel
+  BC5, // RG, 8 bits par pixel
+  BC7, // RGBA, 8 bits par pixel, meilleure qualité que BC3
+};
+
+
+struct CookedTextureHeader
+{
+  uint32_t magic;
+  uint32_t version;
+  uint64_t sourceKey; // voir GetCookedTextureKey, une source modifiée invalide le fichier
+  uint32_t compression; // TextureCompression, jamais AUTO
+  uint32_t width;
+  uint32_t height;
+  uint32_t levelCount;
+};
+
+
+struct CookedTextureLevel
+{
+  uint64_t offset; // depuis le début du fichier
+  uint32_t size;
+  uint32_t width;
+  uint32_t height;
+  uint32_t padding;
+};
+
+
+// 8 octets par bloc de 4x4 pour BC1 et BC4, 16 pour les autres
+inline uint32_t GetCompressedBlockSize(TextureCompression compression)
+{
+  return (compression == TextureCompression::BC1 || compression == TextureCompression::BC4) ? 8 : 16;
+}
+
+
+inline uint32_t GetCompressedLevelSize(TextureCompression compression, uint32_t width, uint32_t height)
+{
+  return ((width + 3) / 4) * ((height + 3) / 4) * GetCompressedBlockSize(compression);
+}
+
+
+#endif // !VOXL_COOKED_TEXTURE_H
\ No newline at end of file
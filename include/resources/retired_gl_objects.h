@@ -0,0 +1,19 @@
+#ifndef VOXL_RETIRED_GL_OBJECTS_H
+#define VOXL_RETIRED_GL_OBJECTS_H
+
+
+#include <vector>
+
+
+// objets GL remplacés par un rechargement à chaud
+// une frame déjà extraite (thread de rendu) peut encore les utiliser, ResourceManager les libère quelques frames plus tard
+struct RetiredGLObjects
+{
+  std::vector<unsigned int> textures;
+  std::vector<unsigned int> programs;
+
+  inline bool Empty() const { return textures.empty() && programs.empty(); }
+};
+
+
+#endif // !VOXL_RETIRED_GL_OBJECTS_H
\ No newline at end of file
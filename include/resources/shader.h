@@ -2,9 +2,37 @@
 #define VOXL_SHADER_H
 
 
+#include <cstdint>
+#include <string>
+
+
+enum class ShaderCompileMode
+{
+  SYNC, // compile et link bloquants, le programme est prêt au retour du loader
+  ASYNC, // tout est soumis au driver, le programme est récupéré plus tard par PollShader
+};
+
+
+enum class ShaderStatus
+{
+  READY,
+  COMPILING,
+  FAILED,
+};
+
+
 struct Shader
 {
-  unsigned int program;
+  unsigned int program; // programme de secours (ou 0) tant que status != READY
+
+  ShaderStatus status = ShaderStatus::READY;
+
+  // compilation en cours, uniquement pour ShaderCompileMode::ASYNC
+  std::string name;
+  unsigned int pendingProgram = 0;
+  unsigned int pendingVertex = 0;
+  unsigned int pendingFragment = 0;
+  uint64_t binaryKey = 0;
 };
 
 
@@ -2,6 +2,7 @@
 #define VOXL_RESOURCE_TRAITS_H
 
 
+#include "loaders/block_texture_array_loader.h"
 #include "loaders/font_loader.h"
 #include "loaders/obj_loader.h"
 #include "loaders/shader_loader.h"
@@ -10,6 +11,7 @@
 
 template<typename T> struct ResourceTraits {};
 
+template<> struct ResourceTraits<BlockTextureArray> { using Loader = BlockTextureArrayLoader; };
 template<> struct ResourceTraits<Font> { using Loader = FontLoader; };
 template<> struct ResourceTraits<Mesh> { using Loader = OBJLoader; };
 template<> struct ResourceTraits<Shader> { using Loader = ShaderLoader; };
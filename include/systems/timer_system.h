@@ -2,26 +2,49 @@
 #define VOXL_TIMER_SYSTEM_H
 
 
-#include <entt/entt.hpp>
+#include <cstdint>
 #include <iostream>
+#include <vector>
+
+#include <entt/entt.hpp>
 
 #include "components/timer.h"
+#include "core/job_system.h"
+
+
+static constexpr uint32_t TIMER_ENTITIES_PER_TASK = 4096; // en dessous le décompte reste sur le thread appelant
 
 
 struct TimerSystem
 {
   void Update(entt::registry& registry, double dt)
   {
-    registry.view<Timer>().each([&registry, dt](const auto& entity, auto& timer){
-      if (timer.isActive) timer.time -= dt;
+    auto view = registry.view<Timer>();
 
-      if (timer.time <= 0.0)
-      {
-        registry.destroy(entity);
-        std::cout << "[TimerSystem] entity destroyed\n";
-      }
-    });
+    // chaque entité n'écrit que dans son Timer, le décompte peut être réparti
+    auto countdown = [&view, dt](entt::entity entity)
+    {
+      Timer& timer = view.get<Timer>(entity);
+      if (timer.isActive) timer.time -= dt;
+    };
+    if (auto* pJobs = registry.ctx().find<JobSystem>()) pJobs->ParallelForEach("TimerSystem", view, TIMER_ENTITIES_PER_TASK, countdown);
+    else for (auto entity: view) countdown(entity);
+
+    // la destruction touche aux storages du registry, elle reste sur le thread appelant
+    _expired.clear();
+    for (auto [entity, timer]: view.each())
+    {
+      if (timer.time <= 0.0) _expired.push_back(entity);
+    }
+    for (entt::entity entity: _expired)
+    {
+      registry.destroy(entity);
+      std::cout << "[TimerSystem] entity destroyed\n";
+    }
   }
+
+private:
+  std::vector<entt::entity> _expired; // gardé entre les ticks pour ne pas réallouer
 };
 
 
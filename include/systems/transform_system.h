@@ -0,0 +1,380 @@
+#ifndef VOXL_TRANSFORM_SYSTEM_H
+#define VOXL_TRANSFORM_SYSTEM_H
+
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+#include <entt/entt.hpp>
+#include <glm/glm.hpp>
+
+#include "core/job_system.h"
+#include "core/transform_batch.h"
+#include "components/orientation.h"
+#include "components/parent.h"
+#include "components/transform.h"
+#include "components/world_matrix.h"
+
+
+static constexpr uint32_t TRANSFORM_ROOTS_PER_TASK = 64; // sous-arbres racines traités par partition du JobSystem
+
+
+// tient à jour le WorldMatrix de chaque entité qui a un Transform, relatif au Parent s'il y en a un
+//
+// les matrices sont rangées dans un ordre topologique: chaque sous-arbre racine est contigu et parcouru en largeur,
+// un parent est donc toujours avant ses enfants et la propagation se fait en une seule passe linéaire
+// seules les entités signalées depuis le dernier Update (et leurs descendants) sont recalculées
+// les sous-arbres racines sont indépendants et sont répartis sur le JobSystem
+//
+// Update est appelé à chaque tick de simulation, Interpolate à chaque frame affichée
+// les WorldMatrix qui ont bougé pendant le dernier tick sont alors interpolées entre leur valeur avant et après ce tick
+//
+// ! les modifications de Transform, Orientation ou Parent doivent passer par registry.patch/replace pour être vues
+struct TransformSystem
+{
+  void Connect(entt::registry& registry)
+  {
+    registry.on_construct<Transform>().connect<&TransformSystem::markStructureDirty>(*this);
+    registry.on_update<Transform>().connect<&TransformSystem::markDirty>(*this);
+    registry.on_destroy<Transform>().connect<&TransformSystem::markStructureDirty>(*this);
+    registry.on_construct<Orientation>().connect<&TransformSystem::markDirty>(*this);
+    registry.on_update<Orientation>().connect<&TransformSystem::markDirty>(*this);
+    registry.on_destroy<Orientation>().connect<&TransformSystem::markDirty>(*this);
+    registry.on_construct<Parent>().connect<&TransformSystem::markStructureDirty>(*this);
+    registry.on_update<Parent>().connect<&TransformSystem::markStructureDirty>(*this);
+    registry.on_destroy<Parent>().connect<&TransformSystem::markStructureDirty>(*this);
+
+    for (auto entity: registry.view<Transform>()) markDirty(registry, entity);
+    _isStructureDirty = true;
+  }
+
+  void Disconnect(entt::registry& registry)
+  {
+    registry.on_construct<Transform>().disconnect(this);
+    registry.on_update<Transform>().disconnect(this);
+    registry.on_destroy<Transform>().disconnect(this);
+    registry.on_construct<Orientation>().disconnect(this);
+    registry.on_update<Orientation>().disconnect(this);
+    registry.on_destroy<Orientation>().disconnect(this);
+    registry.on_construct<Parent>().disconnect(this);
+    registry.on_update<Parent>().disconnect(this);
+    registry.on_destroy<Parent>().disconnect(this);
+  }
+
+  void Update(entt::registry& registry)
+  {
+    // on repart des matrices exactes du tick précédent, pas de la dernière valeur interpolée
+    for (const InterpolatedMatrix& interpolated: _interpolated)
+    {
+      if (registry.valid(interpolated.entity) && registry.all_of<WorldMatrix>(interpolated.entity))
+        registry.replace<WorldMatrix>(interpolated.entity, WorldMatrix{interpolated.current});
+    }
+    _interpolated.clear();
+
+    if (_isStructureDirty) rebuild(registry);
+    if (_dirty.empty()) return;
+
+    updateLocals(registry);
+    propagate(registry);
+
+    // sur le thread principal, emplace/replace déclenchent les signaux de WorldMatrix (culling)
+    for (uint32_t root: _dirtyRoots)
+    {
+      for (uint32_t slot = _rootStart[root]; slot < _rootStart[root + 1]; slot++)
+      {
+        if (_worldDirty[slot])
+        {
+          entt::entity entity = _order[slot];
+          if (const WorldMatrix* pWorld = registry.try_get<WorldMatrix>(entity))
+          {
+            _interpolated.push_back(InterpolatedMatrix{entity, pWorld->matrix, _world[slot]});
+            registry.replace<WorldMatrix>(entity, WorldMatrix{_world[slot]});
+          }
+          else registry.emplace<WorldMatrix>(entity, WorldMatrix{_world[slot]}); // pas de valeur précédente à interpoler
+        }
+        _localDirty[slot] = 0;
+        _worldDirty[slot] = 0;
+      }
+      _rootDirty[root] = 0;
+    }
+    _dirtyRoots.clear();
+  }
+
+  // alpha entre 0 (tick précédent) et 1 (dernier tick), voir FrameScheduler::GetAlpha
+  // interpolation composante par composante, la rotation d'un tick est assez petite pour ne pas déformer la matrice
+  void Interpolate(entt::registry& registry, float alpha)
+  {
+    for (const InterpolatedMatrix& interpolated: _interpolated)
+    {
+      if (!registry.valid(interpolated.entity) || !registry.all_of<WorldMatrix>(interpolated.entity)) continue;
+
+      glm::mat4 matrix;
+      for (int column = 0; column < 4; column++) matrix[column] = glm::mix(interpolated.previous[column], interpolated.current[column], alpha);
+      registry.replace<WorldMatrix>(interpolated.entity, WorldMatrix{matrix});
+    }
+  }
+
+  inline size_t Size() const { return _order.size(); }
+
+private:
+  static constexpr uint32_t INVALID_SLOT = UINT32_MAX;
+
+  struct InterpolatedMatrix
+  {
+    entt::entity entity;
+    glm::mat4 previous;
+    glm::mat4 current;
+  };
+
+  // ordre topologique, tous les tableaux suivants sont indexés par slot
+  std::vector<entt::entity> _order;
+  std::vector<uint32_t> _parentSlot; // INVALID_SLOT pour une racine
+  std::vector<uint32_t> _rootOf; // sous-arbre racine du slot
+  std::vector<glm::mat4> _local;
+  std::vector<glm::mat4> _world;
+  std::vector<uint8_t> _localDirty;
+  std::vector<uint8_t> _worldDirty; // uint8_t et pas bool, chaque sous-arbre est écrit par un thread différent
+
+  std::vector<uint32_t> _rootStart; // premier slot de chaque sous-arbre racine, plus la fin
+  std::vector<uint8_t> _rootDirty;
+  std::vector<uint32_t> _dirtyRoots;
+
+  std::vector<uint32_t> _slotOf; // index d'entité -> slot
+
+  // scratch de rebuild, gardé pour ne pas réallouer
+  std::vector<entt::entity> _firstChild;
+  std::vector<entt::entity> _nextSibling;
+  std::vector<entt::entity> _roots;
+
+  TransformBatch _batch;
+  std::vector<glm::mat4> _matrices;
+  std::vector<uint32_t> _batchSlots;
+
+  std::vector<InterpolatedMatrix> _interpolated; // entités qui ont bougé pendant le dernier tick
+
+  std::vector<entt::entity> _dirty;
+  std::vector<entt::entity> _queued; // index d'entité -> entité déjà dans _dirty, évite les doublons
+  bool _isStructureDirty = false;
+
+  void markDirty(entt::registry& registry, entt::entity entity)
+  {
+    uint32_t index = entt::to_entity(entity);
+    if (index >= _queued.size()) _queued.resize(index + 1, entt::null);
+    if (_queued[index] == entity) return;
+
+    _queued[index] = entity;
+    _dirty.push_back(entity);
+  }
+
+  void markStructureDirty(entt::registry& registry, entt::entity entity)
+  {
+    _isStructureDirty = true;
+    markDirty(registry, entity);
+  }
+
+  void markRootDirty(uint32_t root)
+  {
+    if (_rootDirty[root]) return;
+    _rootDirty[root] = 1;
+    _dirtyRoots.push_back(root);
+  }
+
+  // reconstruit l'ordre topologique en O(n), les matrices des entités inchangées sont reprises telles quelles
+  void rebuild(entt::registry& registry)
+  {
+    _isStructureDirty = false;
+
+    auto view = registry.view<Transform>();
+
+    size_t capacity = 0;
+    for (auto entity: view) capacity = std::max(capacity, (size_t)entt::to_entity(entity) + 1);
+
+    _firstChild.assign(capacity, entt::null);
+    _nextSibling.assign(capacity, entt::null);
+    _roots.clear();
+
+    for (auto entity: view)
+    {
+      const Parent* pParent = registry.try_get<Parent>(entity);
+      bool has_parent = pParent && pParent->entity != entity && registry.valid(pParent->entity) && registry.all_of<Transform>(pParent->entity);
+      if (!has_parent)
+      {
+        _roots.push_back(entity);
+        continue;
+      }
+
+      uint32_t parent_index = entt::to_entity(pParent->entity);
+      _nextSibling[entt::to_entity(entity)] = _firstChild[parent_index];
+      _firstChild[parent_index] = entity;
+    }
+
+    std::vector<entt::entity> old_order;
+    std::vector<uint32_t> old_parent_slot;
+    std::vector<uint32_t> old_slot_of;
+    std::vector<glm::mat4> old_local;
+    std::vector<glm::mat4> old_world;
+    old_order.swap(_order);
+    old_parent_slot.swap(_parentSlot);
+    old_slot_of.swap(_slotOf);
+    old_local.swap(_local);
+    old_world.swap(_world);
+
+    _slotOf.assign(capacity, INVALID_SLOT);
+    _order.reserve(view.size());
+    _parentSlot.reserve(view.size());
+    _rootOf.clear();
+    _rootStart.clear();
+
+    auto append_subtree = [this](entt::entity root)
+    {
+      uint32_t root_index = (uint32_t)_rootStart.size();
+      uint32_t start = (uint32_t)_order.size();
+      _rootStart.push_back(start);
+
+      _slotOf[entt::to_entity(root)] = start;
+      _order.push_back(root);
+      _parentSlot.push_back(INVALID_SLOT);
+      _rootOf.push_back(root_index);
+
+      // parcours en largeur, _order sert de file
+      for (uint32_t slot = start; slot < _order.size(); slot++)
+      {
+        for (entt::entity child = _firstChild[entt::to_entity(_order[slot])]; child != entt::null; child = _nextSibling[entt::to_entity(child)])
+        {
+          uint32_t child_index = entt::to_entity(child);
+          if (_slotOf[child_index] != INVALID_SLOT) continue;
+
+          _slotOf[child_index] = (uint32_t)_order.size();
+          _order.push_back(child);
+          _parentSlot.push_back(slot);
+          _rootOf.push_back(root_index);
+        }
+      }
+    };
+
+    for (entt::entity root: _roots) append_subtree(root);
+
+    // ce qui n'a pas été atteint depuis une racine forme un cycle, on le casse en prenant une entité comme racine
+    if (_order.size() != view.size())
+    {
+      std::cerr << "[TransformSystem] Parent cycle detected, " << view.size() - _order.size() << " entities detached\n";
+      for (auto entity: view)
+      {
+        if (_slotOf[entt::to_entity(entity)] == INVALID_SLOT) append_subtree(entity);
+      }
+    }
+    _rootStart.push_back((uint32_t)_order.size());
+
+    const size_t count = _order.size();
+    _local.resize(count);
+    _world.resize(count);
+    _localDirty.assign(count, 0);
+    _worldDirty.assign(count, 0);
+    _rootDirty.assign(_rootStart.size() - 1, 0);
+    _dirtyRoots.clear();
+
+    // reprise des anciennes matrices, une entité dont le parent a changé est recalculée
+    for (uint32_t slot = 0; slot < count; slot++)
+    {
+      entt::entity entity = _order[slot];
+      uint32_t index = entt::to_entity(entity);
+
+      uint32_t old_slot = index < old_slot_of.size() ? old_slot_of[index] : INVALID_SLOT;
+      if (old_slot == INVALID_SLOT || old_order[old_slot] != entity)
+      {
+        markDirty(registry, entity);
+        continue;
+      }
+
+      _local[slot] = old_local[old_slot];
+      _world[slot] = old_world[old_slot];
+
+      entt::entity old_parent = old_parent_slot[old_slot] == INVALID_SLOT ? entt::null : old_order[old_parent_slot[old_slot]];
+      entt::entity new_parent = _parentSlot[slot] == INVALID_SLOT ? entt::null : _order[_parentSlot[slot]];
+      if (old_parent != new_parent) markDirty(registry, entity);
+    }
+  }
+
+  void updateLocals(entt::registry& registry)
+  {
+    _batch.Clear();
+    _batch.Reserve(_dirty.size());
+    _batchSlots.clear();
+
+    for (entt::entity entity: _dirty)
+    {
+      uint32_t index = entt::to_entity(entity);
+      if (_queued[index] == entity) _queued[index] = entt::null;
+
+      if (!registry.valid(entity)) continue;
+
+      // on_destroy<Transform> est appelé avant la suppression, on enlève le cache ici
+      const Transform* pTransform = registry.try_get<Transform>(entity);
+      if (!pTransform)
+      {
+        registry.remove<WorldMatrix>(entity);
+        continue;
+      }
+
+      uint32_t slot = index < _slotOf.size() ? _slotOf[index] : INVALID_SLOT;
+      if (slot == INVALID_SLOT || _order[slot] != entity) continue;
+
+      if (const Orientation* pOrientation = registry.try_get<Orientation>(entity))
+        _batch.Push(pTransform->position, pOrientation->rotation, pTransform->scale);
+      else
+        _batch.Push(pTransform->position, pTransform->rotation, pTransform->scale);
+      _batchSlots.push_back(slot);
+    }
+    _dirty.clear();
+
+    _matrices.resize(_batch.Size());
+    _batch.Compose(_matrices.data());
+
+    for (size_t i = 0; i < _batchSlots.size(); i++)
+    {
+      uint32_t slot = _batchSlots[i];
+      _local[slot] = _matrices[i];
+      _localDirty[slot] = 1;
+      markRootDirty(_rootOf[slot]);
+    }
+  }
+
+  void propagateRoots(uint32_t begin, uint32_t end)
+  {
+    for (uint32_t i = begin; i < end; i++)
+    {
+      uint32_t root = _dirtyRoots[i];
+      for (uint32_t slot = _rootStart[root]; slot < _rootStart[root + 1]; slot++)
+      {
+        uint32_t parent = _parentSlot[slot];
+        bool is_dirty = _localDirty[slot] || (parent != INVALID_SLOT && _worldDirty[parent]);
+        if (!is_dirty) continue;
+
+        _worldDirty[slot] = 1;
+        _world[slot] = (parent != INVALID_SLOT) ? _world[parent] * _local[slot] : _local[slot];
+      }
+    }
+  }
+
+  void propagate(entt::registry& registry)
+  {
+    const uint32_t root_count = (uint32_t)_dirtyRoots.size();
+
+    auto* pJobs = registry.ctx().find<JobSystem>();
+    if (!pJobs)
+    {
+      propagateRoots(0, root_count);
+      return;
+    }
+
+    pJobs->ParallelFor("TransformSystem", root_count, TRANSFORM_ROOTS_PER_TASK, [this](uint32_t start, uint32_t end, uint32_t threadnum)
+    {
+      propagateRoots(start, end);
+    });
+  }
+};
+
+
+#endif // !VOXL_TRANSFORM_SYSTEM_H
\ No newline at end of file
@@ -0,0 +1,165 @@
+#ifndef VOXL_VISIBILITY_SYSTEM_H
+#define VOXL_VISIBILITY_SYSTEM_H
+
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include <entt/entt.hpp>
+#include <glm/glm.hpp>
+
+#include "components/bounds.h"
+#include "components/mesh.h"
+#include "components/mesh_instance.h"
+#include "components/text.h"
+#include "components/world_matrix.h"
+#include "graphics/frustum.h"
+#include "graphics/occlusion_buffer.h"
+#include "graphics/visibility_set.h"
+
+
+// garde à jour les AABB monde des meshes 3D (Mesh ou MeshInstance + WorldMatrix, sans Text) dans un VisibilitySet
+// seules les entités dont le WorldMatrix ou le mesh a changé sont recalculées, via les signaux du registry
+struct VisibilitySystem
+{
+  void Connect(entt::registry& registry)
+  {
+    registry.on_construct<WorldMatrix>().connect<&VisibilitySystem::markDirty>(*this);
+    registry.on_update<WorldMatrix>().connect<&VisibilitySystem::markDirty>(*this);
+    registry.on_destroy<WorldMatrix>().connect<&VisibilitySystem::markDirty>(*this);
+    registry.on_construct<Mesh>().connect<&VisibilitySystem::markMeshDirty>(*this);
+    registry.on_update<Mesh>().connect<&VisibilitySystem::markMeshDirty>(*this);
+    registry.on_destroy<Mesh>().connect<&VisibilitySystem::markMeshDirty>(*this);
+    registry.on_construct<MeshInstance>().connect<&VisibilitySystem::markMeshDirty>(*this);
+    registry.on_update<MeshInstance>().connect<&VisibilitySystem::markMeshDirty>(*this);
+    registry.on_destroy<MeshInstance>().connect<&VisibilitySystem::markMeshDirty>(*this);
+    registry.on_construct<Text>().connect<&VisibilitySystem::markDirty>(*this);
+    registry.on_destroy<Text>().connect<&VisibilitySystem::markDirty>(*this);
+
+    // tout ce qui existe déjà
+    for (auto entity: registry.view<Mesh, WorldMatrix>()) markMeshDirty(registry, entity);
+    for (auto entity: registry.view<MeshInstance, WorldMatrix>()) markMeshDirty(registry, entity);
+  }
+
+  void Disconnect(entt::registry& registry)
+  {
+    registry.on_construct<WorldMatrix>().disconnect(this);
+    registry.on_update<WorldMatrix>().disconnect(this);
+    registry.on_destroy<WorldMatrix>().disconnect(this);
+    registry.on_construct<Mesh>().disconnect(this);
+    registry.on_update<Mesh>().disconnect(this);
+    registry.on_destroy<Mesh>().disconnect(this);
+    registry.on_construct<MeshInstance>().disconnect(this);
+    registry.on_update<MeshInstance>().disconnect(this);
+    registry.on_destroy<MeshInstance>().disconnect(this);
+    registry.on_construct<Text>().disconnect(this);
+    registry.on_destroy<Text>().disconnect(this);
+  }
+
+  void Update(entt::registry& registry)
+  {
+    for (entt::entity entity: _dirty)
+    {
+      uint32_t index = entt::to_entity(entity);
+      if (_queued[index] == entity) _queued[index] = entt::null;
+      bool has_mesh_changed = index < _meshChanged.size() && _meshChanged[index] == entity;
+      if (has_mesh_changed) _meshChanged[index] = entt::null;
+
+      // on_destroy est appelé avant la suppression du composant, donc on vérifie ici et pas dans le signal
+      bool is_renderable = registry.valid(entity) && registry.any_of<Mesh, MeshInstance>(entity) && registry.all_of<WorldMatrix>(entity) && !registry.all_of<Text>(entity);
+      if (!is_renderable)
+      {
+        if (index < _tracked.size() && _tracked[index] == entity)
+        {
+          _set.Remove(index);
+          _tracked[index] = entt::null;
+        }
+        continue;
+      }
+
+      // les bornes locales ne dépendent que du mesh, pas besoin de les refaire quand seul le WorldMatrix bouge
+      Bounds* pBounds = registry.try_get<Bounds>(entity);
+      if (!pBounds || has_mesh_changed) pBounds = &registry.emplace_or_replace<Bounds>(entity, getLocalBounds(registry, entity));
+
+      // AABB transformée par centre/demi-taille, |M| * extents donne la nouvelle demi-taille
+      const glm::mat4& model = registry.get<WorldMatrix>(entity).matrix;
+      glm::vec3 center = glm::vec3(model * glm::vec4((pBounds->min + pBounds->max) * 0.5f, 1.0f));
+      glm::vec3 extents = (pBounds->max - pBounds->min) * 0.5f;
+      glm::mat3 abs_model = glm::mat3(glm::abs(glm::vec3(model[0])), glm::abs(glm::vec3(model[1])), glm::abs(glm::vec3(model[2])));
+      glm::vec3 world_extents = abs_model * extents;
+
+      if (index >= _tracked.size()) _tracked.resize(index + 1, entt::null);
+      _tracked[index] = entity;
+      _set.Set(index, center - world_extents, center + world_extents);
+    }
+    _dirty.clear();
+  }
+
+  // remplit visible avec les entités dont l'AABB est dans le frustum
+  // pOcclusion : buffer déjà rasterisé pour cette frame, les entités qu'il cache sont retirées
+  void Cull(const Frustum& frustum, std::vector<entt::entity>& visible, const OcclusionBuffer* pOcclusion = nullptr)
+  {
+    _set.Cull(frustum, _visibleIds);
+    if (pOcclusion) _set.CullOccluded(*pOcclusion, _visibleIds);
+
+    visible.clear();
+    visible.reserve(_visibleIds.size());
+    for (uint32_t id: _visibleIds) visible.push_back(_tracked[id]);
+  }
+
+  inline size_t Size() const { return _set.Size(); }
+
+private:
+  VisibilitySet _set;
+  std::vector<entt::entity> _tracked; // index d'entité -> entité suivie (version comprise)
+
+  std::vector<entt::entity> _dirty;
+  std::vector<entt::entity> _queued; // index d'entité -> entité déjà dans _dirty, évite les doublons
+  std::vector<entt::entity> _meshChanged; // index d'entité -> entité dont les Bounds sont à refaire
+  std::vector<uint32_t> _visibleIds;
+
+  // un mesh partagé n'est parcouru qu'une fois, quel que soit le nombre d'instances
+  std::unordered_map<const Mesh*, Bounds> _sharedBounds;
+
+  Bounds getLocalBounds(entt::registry& registry, entt::entity entity)
+  {
+    if (const Mesh* pMesh = registry.try_get<Mesh>(entity))
+    {
+      // mesh sans copie CPU (chunks) : les Bounds posées par son créateur font foi
+      const Bounds* pBounds = registry.try_get<Bounds>(entity);
+      if (pMesh->vertices.empty() && pBounds) return *pBounds;
+      return ComputeBounds(pMesh->vertices);
+    }
+
+    const MeshInstance& instance = registry.get<MeshInstance>(entity);
+    if (!instance.mesh) return Bounds{glm::vec3(0.0f), glm::vec3(0.0f)};
+
+    const Mesh* pMesh = &*instance.mesh;
+    auto it = _sharedBounds.find(pMesh);
+    if (it == _sharedBounds.end()) it = _sharedBounds.emplace(pMesh, ComputeBounds(pMesh->vertices)).first;
+    return it->second;
+  }
+
+  void markDirty(entt::registry& registry, entt::entity entity)
+  {
+    uint32_t index = entt::to_entity(entity);
+    if (index >= _queued.size()) _queued.resize(index + 1, entt::null);
+    if (_queued[index] == entity) return;
+
+    _queued[index] = entity;
+    _dirty.push_back(entity);
+  }
+
+  void markMeshDirty(entt::registry& registry, entt::entity entity)
+  {
+    uint32_t index = entt::to_entity(entity);
+    if (index >= _meshChanged.size()) _meshChanged.resize(index + 1, entt::null);
+    _meshChanged[index] = entity;
+
+    markDirty(registry, entity);
+  }
+};
+
+
+#endif // !VOXL_VISIBILITY_SYSTEM_H
\ No newline at end of file
@@ -0,0 +1,27 @@
+#ifndef VOXL_HASH_STRINGS_H
+#define VOXL_HASH_STRINGS_H
+
+
+#include <cstdint>
+#include <initializer_list>
+#include <string_view>
+
+
+// FNV-1a 64 bits, chaque partie est terminée par un 0 pour que ("ab", "c") et ("a", "bc") diffèrent
+inline uint64_t HashStrings(std::initializer_list<std::string_view> parts)
+{
+  uint64_t hash = 14695981039346656037ull;
+  for (std::string_view part: parts)
+  {
+    for (char c: part)
+    {
+      hash ^= (uint8_t)c;
+      hash *= 1099511628211ull;
+    }
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+
+#endif // !VOXL_HASH_STRINGS_H
\ No newline at end of file
@@ -0,0 +1,89 @@
+#ifndef VOXL_LOCK_FREE_QUEUE_H
+#define VOXL_LOCK_FREE_QUEUE_H
+
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+
+// file bornée sans verrou, plusieurs producteurs et plusieurs consommateurs (séquences par case, à la Vyukov)
+// CAPACITY est une puissance de 2, Push échoue quand la file est pleine plutôt que d'attendre
+template<typename T, size_t CAPACITY>
+class LockFreeQueue
+{
+  static_assert(CAPACITY >= 2 && (CAPACITY & (CAPACITY - 1)) == 0, "LockFreeQueue: CAPACITY must be a power of 2");
+
+public:
+  LockFreeQueue()
+    : _enqueuePosition(0),
+      _dequeuePosition(0)
+  {
+    for (size_t i = 0; i < CAPACITY; i++) _cells[i].sequence.store(i, std::memory_order_relaxed);
+  }
+
+  LockFreeQueue(const LockFreeQueue&) = delete;
+  LockFreeQueue& operator=(const LockFreeQueue&) = delete;
+
+  bool Push(const T& value)
+  {
+    size_t position = _enqueuePosition.load(std::memory_order_relaxed);
+    for (;;)
+    {
+      Cell& cell = _cells[position & (CAPACITY - 1)];
+      const size_t sequence = cell.sequence.load(std::memory_order_acquire);
+      const intptr_t difference = (intptr_t)sequence - (intptr_t)position;
+
+      // case libre pour ce tour : on la réserve, sinon un autre producteur est passé avant
+      if (difference == 0)
+      {
+        if (_enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+        {
+          cell.value = value;
+          cell.sequence.store(position + 1, std::memory_order_release);
+          return true;
+        }
+      }
+      else if (difference < 0) return false;
+      else position = _enqueuePosition.load(std::memory_order_relaxed);
+    }
+  }
+
+  bool Pop(T& value)
+  {
+    size_t position = _dequeuePosition.load(std::memory_order_relaxed);
+    for (;;)
+    {
+      Cell& cell = _cells[position & (CAPACITY - 1)];
+      const size_t sequence = cell.sequence.load(std::memory_order_acquire);
+      const intptr_t difference = (intptr_t)sequence - (intptr_t)(position + 1);
+
+      if (difference == 0)
+      {
+        if (_dequeuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+        {
+          value = cell.value;
+          cell.sequence.store(position + CAPACITY, std::memory_order_release);
+          return true;
+        }
+      }
+      else if (difference < 0) return false;
+      else position = _dequeuePosition.load(std::memory_order_relaxed);
+    }
+  }
+
+private:
+  struct Cell
+  {
+    std::atomic<size_t> sequence;
+    T value;
+  };
+
+  // producteurs et consommateurs sur des lignes de cache différentes
+  alignas(64) Cell _cells[CAPACITY];
+  alignas(64) std::atomic<size_t> _enqueuePosition;
+  alignas(64) std::atomic<size_t> _dequeuePosition;
+};
+
+
+#endif // !VOXL_LOCK_FREE_QUEUE_H
\ No newline at end of file
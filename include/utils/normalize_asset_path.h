@@ -0,0 +1,16 @@
+#ifndef VOXL_NORMALIZE_ASSET_PATH_H
+#define VOXL_NORMALIZE_ASSET_PATH_H
+
+
+#include <filesystem>
+#include <string>
+
+
+// même chemin => même chaîne, quels que soient les séparateurs ("assets\\textures/./a.png" -> "assets/textures/a.png")
+inline std::string NormalizeAssetPath(const std::string& path)
+{
+  return std::filesystem::path(path).lexically_normal().generic_string();
+}
+
+
+#endif // !VOXL_NORMALIZE_ASSET_PATH_H
\ No newline at end of file
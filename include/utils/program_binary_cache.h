@@ -0,0 +1,132 @@
+#ifndef VOXL_PROGRAM_BINARY_CACHE_H
+#define VOXL_PROGRAM_BINARY_CACHE_H
+
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+#include <glad/glad.h>
+
+#include "utils/hash_strings.h"
+
+
+// cache disque des programmes linkés (glGetProgramBinary), un fichier par shader
+// la clé couvre les sources et le driver, un changement de l'un ou de l'autre invalide l'entrée
+// le driver peut quand même refuser un binaire valide (mise à jour sans changement de version), on recompile alors
+static constexpr const char* PROGRAM_BINARY_CACHE_DIRECTORY = "cache/shaders/";
+static constexpr uint32_t PROGRAM_BINARY_MAGIC = 0x42535856; // "VXSB"
+static constexpr uint32_t PROGRAM_BINARY_VERSION = 1;
+
+
+struct ProgramBinaryHeader
+{
+  uint32_t magic;
+  uint32_t version;
+  uint64_t key;
+  uint32_t format; // GLenum renvoyé par glGetProgramBinary
+  uint32_t size;
+};
+
+
+// ! nécessite un contexte GL courant
+inline uint64_t GetProgramBinaryKey(const std::string& vertexSource, const std::string& fragmentSource)
+{
+  auto gl_string = [](GLenum name) -> std::string_view
+  {
+    const GLubyte* value = glGetString(name);
+    return value ? std::string_view(reinterpret_cast<const char*>(value)) : std::string_view();
+  };
+
+  return HashStrings({ vertexSource, fragmentSource, gl_string(GL_VENDOR), gl_string(GL_RENDERER), gl_string(GL_VERSION) });
+}
+
+
+// certains drivers n'exposent aucun format, le cache est alors désactivé
+inline bool IsProgramBinarySupported()
+{
+  int format_count = 0;
+  glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &format_count);
+  return format_count > 0;
+}
+
+
+// renvoie 0 si l'entrée est absente, périmée ou refusée par le driver
+inline unsigned int LoadProgramBinary(const std::string& name, uint64_t key)
+{
+  std::ifstream file(PROGRAM_BINARY_CACHE_DIRECTORY + name + ".bin", std::ios::binary);
+  if (!file.is_open()) return 0;
+
+  ProgramBinaryHeader header{};
+  if (!file.read(reinterpret_cast<char*>(&header), sizeof(header))) return 0;
+  if (header.magic != PROGRAM_BINARY_MAGIC || header.version != PROGRAM_BINARY_VERSION || header.key != key || header.size == 0) return 0;
+
+  std::vector<char> binary(header.size);
+  if (!file.read(binary.data(), header.size)) return 0;
+
+  unsigned int program = glCreateProgram();
+  glProgramBinary(program, header.format, binary.data(), (int)header.size);
+
+  int success;
+  glGetProgramiv(program, GL_LINK_STATUS, &success);
+  if (!success)
+  {
+    std::cout << "[LoadShader] " << name << " - Cached program binary rejected by the driver, recompiling\n";
+    glDeleteProgram(program);
+    return 0;
+  }
+
+  return program;
+}
+
+
+// à appeler après un link réussi, le programme doit avoir GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+inline void SaveProgramBinary(const std::string& name, uint64_t key, unsigned int program)
+{
+  int length = 0;
+  glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+  if (length <= 0) return;
+
+  std::vector<char> binary(length);
+  GLenum format = 0;
+  glGetProgramBinary(program, length, &length, &format, binary.data());
+  if (length <= 0) return;
+
+  std::error_code error;
+  std::filesystem::create_directories(PROGRAM_BINARY_CACHE_DIRECTORY, error);
+  if (error)
+  {
+    std::cerr << "[LoadShader] Failed to create '" << PROGRAM_BINARY_CACHE_DIRECTORY << "': " << error.message() << "\n";
+    return;
+  }
+
+  // écrit à côté puis renomme, un crash pendant l'écriture ne laisse pas de fichier tronqué
+  std::string path = PROGRAM_BINARY_CACHE_DIRECTORY + name + ".bin";
+  std::string temporary_path = path + ".tmp";
+  {
+    std::ofstream file(temporary_path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) return;
+
+    ProgramBinaryHeader header{
+      .magic = PROGRAM_BINARY_MAGIC,
+      .version = PROGRAM_BINARY_VERSION,
+      .key = key,
+      .format = (uint32_t)format,
+      .size = (uint32_t)length
+    };
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(binary.data(), length);
+    if (!file) return;
+  }
+
+  std::filesystem::rename(temporary_path, path, error);
+  if (error) std::cerr << "[LoadShader] Failed to write '" << path << "': " << error.message() << "\n";
+}
+
+
+#endif // !VOXL_PROGRAM_BINARY_CACHE_H
\ No newline at end of file
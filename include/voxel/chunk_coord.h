@@ -0,0 +1,51 @@
+#ifndef VOXL_CHUNK_COORD_H
+#define VOXL_CHUNK_COORD_H
+
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+#include <glm/glm.hpp>
+
+
+static constexpr int CHUNK_SIZE = 32; // blocs par côté, une puissance de 2
+static constexpr int CHUNK_SHIFT = 5;
+static constexpr int CHUNK_AREA = CHUNK_SIZE * CHUNK_SIZE;
+static constexpr int CHUNK_VOLUME = CHUNK_SIZE * CHUNK_SIZE * CHUNK_SIZE;
+
+
+// position d'un chunk cubique en unités de chunk, le bloc (x, y, z) du monde est dans le chunk (x >> 5, y >> 5, z >> 5)
+struct ChunkCoord
+{
+  int x;
+  int y;
+  int z;
+
+  bool operator==(const ChunkCoord&) const = default;
+
+  inline ChunkCoord Offset(int dx, int dy, int dz) const { return ChunkCoord{ x + dx, y + dy, z + dz }; }
+  // coin minimum du chunk en blocs
+  inline glm::ivec3 GetOrigin() const { return glm::ivec3(x, y, z) * CHUNK_SIZE; }
+};
+
+
+inline ChunkCoord GetChunkCoord(const glm::ivec3& block)
+{
+  // décalage arithmétique : les négatifs tombent bien dans le chunk -1
+  return ChunkCoord{ block.x >> CHUNK_SHIFT, block.y >> CHUNK_SHIFT, block.z >> CHUNK_SHIFT };
+}
+
+
+struct ChunkCoordHash
+{
+  size_t operator()(const ChunkCoord& coord) const
+  {
+    // grands nombres premiers, assez pour un unordered_map de quelques milliers de chunks
+    uint64_t hash = (uint64_t)(uint32_t)coord.x * 73856093ull ^ (uint64_t)(uint32_t)coord.y * 19349663ull ^ (uint64_t)(uint32_t)coord.z * 83492791ull;
+    return (size_t)hash;
+  }
+};
+
+
+#endif // !VOXL_CHUNK_COORD_H
\ No newline at end of file
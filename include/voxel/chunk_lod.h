@@ -0,0 +1,73 @@
+#ifndef VOXL_CHUNK_LOD_H
+#define VOXL_CHUNK_LOD_H
+
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "voxel/chunk_coord.h"
+#include "voxel/chunk_mesher.h"
+#include "voxel/chunk_section.h"
+#include "voxel/terrain_generator.h"
+
+
+static constexpr int CHUNK_LOD_MAX_LEVELS = 3; // cellules de 2, 4 puis 8 blocs
+static constexpr int CHUNK_LOD_DEFAULT_LEVELS = 3;
+
+
+// un noeud de niveau level couvre 2^level x 2^level colonnes de chunks (le niveau 0 est une colonne)
+// il a toujours CHUNK_SIZE cellules de côté en x et z, une cellule fait 2^level blocs de côté
+//
+// carré de la distance, en colonnes, entre la colonne de la caméra et la colonne du noeud la plus proche
+inline int64_t GetLodNodeDistance2(const glm::ivec2& viewerColumn, int level, const glm::ivec2& node)
+{
+  const int size = 1 << level;
+  const glm::ivec2 min_column = node * size;
+  const glm::ivec2 max_column = min_column + (size - 1);
+  const glm::ivec2 delta = glm::max(glm::max(min_column - viewerColumn, viewerColumn - max_column), glm::ivec2(0));
+  return (int64_t)delta.x * delta.x + (int64_t)delta.y * delta.y;
+}
+
+
+// le noeud laisse la place à ses 4 enfants du niveau inférieur (des colonnes pleine résolution au niveau 1)
+// les anneaux doublent de largeur à chaque niveau : le niveau L va de radius * 2^(L-1) à radius * 2^L colonnes
+// un enfant n'est jamais plus proche que son parent, les anneaux s'emboîtent sans trou ni recouvrement
+inline bool IsLodNodeSubdivided(const glm::ivec2& viewerColumn, int level, const glm::ivec2& node, int radius)
+{
+  const int64_t limit = (int64_t)radius << (level - 1);
+  return radius > 0 && GetLodNodeDistance2(viewerColumn, level, node) <= limit * limit;
+}
+
+
+// mémoire réutilisée d'un noeud à l'autre, une par thread
+struct ChunkLodScratch
+{
+  std::vector<int32_t> heights; // CHUNK_AREA, hauteur au centre de chaque colonne de cellules
+  std::vector<uint16_t> cells; // CHUNK_AREA x hauteur du noeud, rangées selon GetBlockIndex
+  std::vector<uint16_t> blocks; // CHUNK_VOLUME, un chunk sauvegardé décodé
+  std::vector<ChunkSection> sections; // les cellules découpées en tranches de CHUNK_SIZE pour le mesher
+  ChunkMeshScratch mesh;
+};
+
+
+// factor^3 blocs d'un chunk -> une cellule
+// la cellule est pleine si au moins la moitié de ses blocs le sont, elle prend alors le bloc le plus fréquent de sa plus haute couche non vide
+// (l'herbe reste en surface au lieu de disparaître sous la terre qui est plus nombreuse)
+// pCells : cellules du noeud, celles du chunk commencent à cellOrigin
+void DownsampleChunk(const uint16_t* pBlocks, int factor, uint16_t* pCells, const glm::ivec3& cellOrigin);
+
+// cellules d'un noeud directement depuis le générateur, une hauteur échantillonnée au centre de chaque colonne de cellules
+// même règle que DownsampleChunk en supposant la colonne de blocs représentative de sa cellule
+void GenerateLodCells(const TerrainGenerator& generator, int level, const glm::ivec2& node, int cellHeight, ChunkLodScratch& scratch);
+
+// greedy mesh des cellules, en blocs et relatif au coin bas du noeud
+// les côtés du noeud sont traités comme de l'air : les faces de bord descendent jusqu'au bas du terrain
+// et servent de jupes qui cachent les fissures avec les niveaux voisins (et avec les chunks pleine résolution)
+// les coordonnées de texture sont aussi en blocs, une cellule de 2^level blocs répète la texture comme les chunks
+void BuildLodMesh(int level, int sectionCount, const std::vector<uint16_t>& faceLayers, ChunkLodScratch& scratch, ChunkMeshScratch& output);
+
+
+#endif // !VOXL_CHUNK_LOD_H
\ No newline at end of file
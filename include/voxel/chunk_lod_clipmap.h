@@ -0,0 +1,162 @@
+#ifndef VOXL_CHUNK_LOD_CLIPMAP_H
+#define VOXL_CHUNK_LOD_CLIPMAP_H
+
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include <enkiTS/TaskScheduler.h>
+#include <entt/entt.hpp>
+#include <glm/glm.hpp>
+
+#include "components/bounds.h"
+#include "graphics/render_backend.h"
+#include "utils/lock_free_queue.h"
+#include "voxel/chunk_lod.h"
+#include "voxel/chunk_mesh_pool.h"
+#include "voxel/chunk_mesher.h"
+#include "voxel/terrain_generator.h"
+
+
+class ChunkLodClipmap;
+class JobSystem;
+class RegionStorage;
+class VoxelWorld;
+
+
+static constexpr size_t CHUNK_LOD_MAX_JOBS = 16; // noeuds en vol + résultats pas encore uploadés, une puissance de 2
+static constexpr float CHUNK_LOD_UPLOAD_BUDGET_MS = 1.0f; // par frame, au moins un noeud passe quand même
+
+
+// un noeud LOD à construire sur un worker : cellules générées, chunks sauvegardés réduits par-dessus, puis greedy mesh
+struct ChunkLodJob : enki::ITaskSet
+{
+  ChunkLodClipmap* pOwner;
+  uint32_t slot;
+
+  int level;
+  glm::ivec2 node;
+  std::atomic<bool> isCancelled; // noeud plus voulu : le worker rend le slot sans rien construire
+  std::vector<uint16_t> faceLayers; // copie de ChunkLodClipmap::_faceLayers à l'envoi, comme ChunkMeshJob
+
+  ChunkMeshScratch output; // en blocs, relatif au coin bas du noeud
+  Bounds bounds;
+
+  void ExecuteRange(enki::TaskSetPartition range, uint32_t threadnum) override;
+};
+
+
+// terrain lointain en anneaux de niveaux de détail autour des colonnes pleine résolution du ChunkStreamer
+//
+// le niveau L (1 à GetLevelCount) a des cellules de 2^L blocs, ses noeuds gardent le coût d'une colonne de chunks
+// pour une surface 4^L fois plus grande : avec 3 niveaux la vue porte 8 fois plus loin que le rayon du streamer
+// les noeuds sont construits sur les workers du JobSystem et uploadés sous budget, comme les meshes de chunks
+// un noeud qui n'est plus voulu reste affiché jusqu'à ce que ce qui le remplace (parent, enfants ou colonnes) soit prêt
+class ChunkLodClipmap
+{
+public:
+  ChunkLodClipmap(entt::registry* registry, RenderBackend* pUploadBackend, ChunkMeshPool* pMeshPool, JobSystem* pJobs, RegionStorage* pStorage,
+    const TerrainSettings& settings = TerrainSettings{});
+  ~ChunkLodClipmap();
+
+  ChunkLodClipmap(const ChunkLodClipmap&) = delete;
+  ChunkLodClipmap& operator=(const ChunkLodClipmap&) = delete;
+
+  // 0 : plus de terrain lointain, les noeuds affichés sont détruits
+  void SetLevelCount(int levelCount);
+  inline int GetLevelCount() const { return _levelCount; }
+
+  // radius : rayon du ChunkStreamer, les anneaux commencent là où il s'arrête
+  void Update(VoxelWorld& world, int radius, const glm::vec3& viewerPosition, const glm::vec3& viewerForward, uint64_t frameIndex);
+  void WaitAll();
+  // rend les buffers des noeuds au ChunkMeshPool, avant sa destruction
+  void Clear(uint64_t frameIndex);
+
+  // un noeud construit couvre la colonne, ou aucun n'en a besoin (hors des anneaux, ou niveaux désactivés)
+  // le streamer attend ce moment pour décharger une colonne, sans quoi un trou apparaîtrait le temps de construire le noeud
+  bool IsColumnCovered(int x, int z) const;
+  // la colonne a changé dans les régions : le noeud actif qui la couvre est reconstruit, l'ancien mesh reste affiché en attendant
+  void InvalidateColumn(int x, int z);
+  // layers des textures de blocs (voir BuildChunkMesh), les noeuds actifs sont reconstruits s'ils changent
+  void SetFaceLayers(const std::vector<uint16_t>& faceLayers);
+
+  inline size_t GetNodeCount() const { return _nodes.size(); }
+  inline size_t GetTriangleCount() const { return _triangleCount; }
+
+private:
+  friend struct ChunkLodJob;
+
+  struct NodeKey
+  {
+    int level;
+    int x;
+    int z;
+
+    bool operator==(const NodeKey&) const = default;
+  };
+
+  struct NodeKeyHash
+  {
+    size_t operator()(const NodeKey& key) const
+    {
+      return ChunkCoordHash{}(ChunkCoord{ key.x, key.level, key.z });
+    }
+  };
+
+  struct Node
+  {
+    entt::entity entity = entt::null;
+    ChunkLodJob* pJob = nullptr;
+    uint32_t triangleCount = 0;
+    bool isActive = false; // dans les anneaux actuels, sinon affiché en attendant son remplaçant
+    bool isBuilt = false; // mesh uploadé (éventuellement vide)
+  };
+
+  entt::registry* _pRegistry;
+  RenderBackend* _pUploadBackend;
+  ChunkMeshPool* _pMeshPool;
+  enki::TaskScheduler* _pScheduler;
+  RegionStorage* _pStorage;
+  TerrainGenerator _generator;
+  int _levelCount;
+  int _sectionCounts[CHUNK_LOD_MAX_LEVELS + 1]; // tranches de CHUNK_SIZE cellules par noeud, selon le niveau
+  std::vector<uint16_t> _faceLayers;
+
+  std::vector<std::unique_ptr<ChunkLodJob>> _jobs;
+  std::vector<uint32_t> _freeSlots; // thread principal uniquement
+  std::vector<ChunkLodScratch> _scratches; // un par thread, indexé par threadnum
+  LockFreeQueue<uint32_t, CHUNK_LOD_MAX_JOBS> _completed;
+
+  std::unordered_map<NodeKey, Node, NodeKeyHash> _nodes;
+  std::vector<std::pair<float, NodeKey>> _requests; // noeuds actifs à construire, triés
+  size_t _nextRequest;
+  std::vector<NodeKey> _retired; // affichés mais plus actifs
+  std::vector<NodeKey> _overlapped; // niveau 1 actifs dont les colonnes sont peut-être encore chargées (marge du streamer)
+  std::vector<ChunkLodJob*> _ready; // construits, pas encore uploadés
+  size_t _triangleCount;
+
+  glm::ivec2 _viewerColumn;
+  glm::vec2 _viewerForward;
+  int _radius;
+  bool _isViewDirty;
+
+  float getPriority(const NodeKey& key) const;
+  void refreshNodes();
+  void activate(int level, const glm::ivec2& node);
+  bool isColumnCovered(const VoxelWorld& world, int level, const glm::ivec2& node) const;
+  bool isAreaReady(const VoxelWorld& world, int level, const glm::ivec2& node) const;
+  bool isCovered(const VoxelWorld& world, const NodeKey& key) const;
+  void updateOverlapped(const VoxelWorld& world, uint64_t frameIndex);
+  void retireNodes(const VoxelWorld& world, uint64_t frameIndex);
+  void uploadNodes(uint64_t frameIndex);
+  void submitNodes();
+  void destroyNodeEntity(Node& node, uint64_t frameIndex);
+  void release(ChunkLodJob* pJob);
+};
+
+
+#endif // !VOXL_CHUNK_LOD_CLIPMAP_H
\ No newline at end of file
@@ -0,0 +1,70 @@
+#ifndef VOXL_CHUNK_MESH_POOL_H
+#define VOXL_CHUNK_MESH_POOL_H
+
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <unordered_map>
+
+#include <entt/fwd.hpp>
+
+#include "components/mesh.h"
+#include "graphics/render_backend.h"
+#include "voxel/chunk_mesher.h"
+
+
+static constexpr uint64_t CHUNK_MESH_REUSE_FRAMES = 3; // comme RESOURCE_RETIRE_FRAMES, une frame extraite peut encore être dessinée
+static constexpr uint64_t CHUNK_MESH_TRIM_FRAMES = 600; // un buffer libre pas réutilisé depuis ~10 s à 60 fps est détruit
+static constexpr uint32_t CHUNK_MESH_MIN_VERTICES = 1024;
+static constexpr size_t CHUNK_MESH_SIZE_CLASSES = 16; // CHUNK_MESH_MIN_VERTICES << 15 sommets au plus, bien au-delà du pire chunk
+
+
+// buffers GPU des meshes de chunks, recyclés d'un chunk à l'autre
+// un chunk remeshé reçoit toujours d'autres buffers : ceux qu'il avait sont peut-être encore lus par le thread de rendu
+// les buffers libres sont rangés par classe de taille (puissances de 2), un chunk ne reçoit que des buffers de sa classe
+// chaque classe est une file dans l'ordre de libération : acquire et Trim ne regardent que la tête, la plus ancienne
+// un buffer réutilisé ou détruit est signalé au Renderer (MeshBuffersChangedEvent), qui oublie le VAO qu'il a dessus
+class ChunkMeshPool
+{
+public:
+  // pDispatcher : prévient le Renderer quand des buffers déjà dessinés sont réécrits (MeshBuffersChangedEvent)
+  explicit ChunkMeshPool(entt::dispatcher* pDispatcher = nullptr);
+  ~ChunkMeshPool() = default;
+
+  // remplace la géométrie du Mesh par celle du scratch, un scratch vide rend juste les anciens buffers
+  // ! sur un thread qui a un contexte GL (ou un backend headless)
+  void Upload(RenderBackend& backend, Mesh& mesh, const ChunkMeshScratch& scratch, uint64_t frameIndex);
+  // le Mesh ne pointe plus sur rien, ses buffers seront réutilisables dans CHUNK_MESH_REUSE_FRAMES frames
+  void Release(Mesh& mesh, uint64_t frameIndex);
+  // détruit les buffers libres depuis CHUNK_MESH_TRIM_FRAMES frames, une fois par frame
+  void Trim(RenderBackend& backend, uint64_t frameIndex);
+  // les buffers encore attachés à un Mesh sont détruits par le Renderer avec les autres Mesh
+  void Destroy(RenderBackend& backend);
+
+  inline size_t GetFreeCount() const { return _freeCount; }
+  inline size_t GetLiveCount() const { return _live.size(); }
+
+private:
+  entt::dispatcher* _pDispatcher;
+
+  struct Buffers
+  {
+    unsigned int vao;
+    unsigned int vbo;
+    unsigned int ebo;
+    uint32_t sizeClass;
+    uint64_t releaseFrame;
+  };
+
+  std::array<std::deque<Buffers>, CHUNK_MESH_SIZE_CLASSES> _free; // par classe, les plus anciens devant
+  size_t _freeCount;
+  std::unordered_map<unsigned int, Buffers> _live; // vbo -> buffers attachés à un Mesh
+
+  Buffers acquire(RenderBackend& backend, uint32_t vertexCount, uint32_t indexCount, uint64_t frameIndex);
+  void destroy(RenderBackend& backend, const Buffers& buffers);
+};
+
+
+#endif // !VOXL_CHUNK_MESH_POOL_H
\ No newline at end of file
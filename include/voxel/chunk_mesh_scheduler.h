@@ -0,0 +1,89 @@
+#ifndef VOXL_CHUNK_MESH_SCHEDULER_H
+#define VOXL_CHUNK_MESH_SCHEDULER_H
+
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <enkiTS/TaskScheduler.h>
+
+#include "components/bounds.h"
+#include "resources/block_texture_array.h"
+#include "utils/lock_free_queue.h"
+#include "voxel/chunk_coord.h"
+#include "voxel/chunk_mesher.h"
+#include "voxel/chunk_section.h"
+
+
+static constexpr size_t CHUNK_MESH_MAX_JOBS = 64; // jobs en vol + résultats pas encore uploadés, une puissance de 2
+
+
+class ChunkMeshScheduler;
+class JobSystem;
+
+
+// un chunk à mesher sur un worker enkiTS, avec sa propre copie de la section et des voisines
+// le monde peut donc être modifié pendant que le job tourne, la version dit à quel état correspond le mesh
+struct ChunkMeshJob : enki::ITaskSet
+{
+  ChunkMeshScheduler* pOwner;
+  uint32_t slot;
+
+  ChunkCoord coord;
+  uint64_t version;
+  bool isUrgent;
+  std::atomic<bool> isCancelled; // chunk déchargé : le worker rend le slot sans mesher
+
+  ChunkSection section;
+  ChunkSection neighbors[(size_t)BlockFace::COUNT];
+  bool hasNeighbor[(size_t)BlockFace::COUNT];
+  std::vector<uint16_t> faceLayers; // copie aussi, le BlockTextureArray peut être rechargé pendant le job
+
+  // vertices et indices échangés avec le scratch du worker, pas de copie
+  ChunkMeshScratch output;
+  Bounds bounds;
+  Bounds occluder; // FindOccluderBox, valide si hasOccluder
+  bool hasOccluder;
+
+  void ExecuteRange(enki::TaskSetPartition range, uint32_t threadnum) override;
+};
+
+
+// répartit le meshing des chunks sur le TaskScheduler du JobSystem, chaque worker a son scratch
+// les jobs finis reviennent par une file sans verrou, le thread principal les récupère avec PopCompleted
+// sans JobSystem, Submit meshe tout de suite sur le thread appelant
+class ChunkMeshScheduler
+{
+public:
+  ChunkMeshScheduler(JobSystem* pJobs);
+  ~ChunkMeshScheduler();
+
+  ChunkMeshScheduler(const ChunkMeshScheduler&) = delete;
+  ChunkMeshScheduler& operator=(const ChunkMeshScheduler&) = delete;
+
+  // nullptr si tous les jobs sont pris, isUrgent passe devant les autres tâches du TaskScheduler
+  // faceLayers : voir BuildChunkMesh
+  ChunkMeshJob* Submit(ChunkCoord coord, uint64_t version, const ChunkSection& section, const ChunkNeighbors& neighbors, const std::vector<uint16_t>& faceLayers, bool isUrgent);
+  // un job terminé, son output reste valide jusqu'à Release
+  ChunkMeshJob* PopCompleted();
+  void Release(ChunkMeshJob* pJob);
+  void WaitAll();
+
+  inline size_t GetFreeCount() const { return _freeSlots.size(); }
+  inline size_t GetWorkerCount() const { return _scratches.size(); }
+
+private:
+  friend struct ChunkMeshJob;
+
+  enki::TaskScheduler* _pScheduler;
+  std::vector<std::unique_ptr<ChunkMeshJob>> _jobs;
+  std::vector<uint32_t> _freeSlots; // thread principal uniquement
+  std::vector<ChunkMeshScratch> _scratches; // un par thread enkiTS, indexé par threadnum
+  LockFreeQueue<uint32_t, CHUNK_MESH_MAX_JOBS> _completed;
+};
+
+
+#endif // !VOXL_CHUNK_MESH_SCHEDULER_H
\ No newline at end of file
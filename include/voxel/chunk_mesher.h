@@ -0,0 +1,55 @@
+#ifndef VOXL_CHUNK_MESHER_H
+#define VOXL_CHUNK_MESHER_H
+
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "components/bounds.h"
+#include "components/mesh.h"
+#include "resources/block_texture_array.h"
+#include "voxel/chunk_section.h"
+
+
+static constexpr int CHUNK_PADDED_SIZE = CHUNK_SIZE + 2; // une couche de blocs des voisins autour du chunk
+static constexpr int CHUNK_PADDED_VOLUME = CHUNK_PADDED_SIZE * CHUNK_PADDED_SIZE * CHUNK_PADDED_SIZE;
+
+
+// sections voisines dans l'ordre de BlockFace, nullptr = pas chargée, traitée comme de l'air
+struct ChunkNeighbors
+{
+  const ChunkSection* pSections[(size_t)BlockFace::COUNT] = {};
+};
+
+
+// mémoire réutilisée d'un chunk à l'autre, une par thread de meshing
+// les sommets sont en coordonnées locales au chunk, la WorldMatrix de l'entité place le chunk
+struct ChunkMeshScratch
+{
+  std::vector<uint16_t> blocks; // CHUNK_VOLUME, sortie de ChunkSection::Decode
+  std::vector<uint16_t> padded; // CHUNK_PADDED_VOLUME, x varie le plus vite puis z puis y comme GetBlockIndex
+  std::vector<uint16_t> mask; // CHUNK_AREA, layer + 1 de la face visible dans la tranche courante, 0 sinon
+
+  std::vector<Vertex> vertices;
+  std::vector<unsigned int> indices;
+
+  inline size_t GetTriangleCount() const { return indices.size() / 3; }
+};
+
+
+// fusionne les faces visibles coplanaires et adjacentes de même texture en quads aussi grands que possible
+// une face n'est visible que si le bloc d'à coté est de l'air, bordure des voisins comprise
+// faceLayers : BlockTextureArray::faceLayers, le layer de chaque quad va dans color.a de ses sommets
+// un bloc absent de la table (tableau pas encore chargé) prend BLOCK_MISSING_LAYER
+void BuildChunkMesh(const ChunkSection& section, const ChunkNeighbors& neighbors, const std::vector<uint16_t>& faceLayers, ChunkMeshScratch& scratch);
+// un quad par face visible, pour comparer (benchmark)
+void BuildChunkMeshNaive(const ChunkSection& section, const ChunkNeighbors& neighbors, const std::vector<uint16_t>& faceLayers, ChunkMeshScratch& scratch);
+
+// plus longue suite de couches horizontales entièrement solides, en coordonnées locales, pour l'OcclusionBuffer
+// la boite ne contient que des blocs pleins, elle reste donc derrière les faces dessinées
+// false si aucune couche n'est pleine (section d'air, surface trop découpée)
+bool FindOccluderBox(const ChunkSection& section, Bounds& box);
+
+
+#endif // !VOXL_CHUNK_MESHER_H
\ No newline at end of file
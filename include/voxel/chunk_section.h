@@ -0,0 +1,93 @@
+#ifndef VOXL_CHUNK_SECTION_H
+#define VOXL_CHUNK_SECTION_H
+
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "resources/block_texture_array.h"
+#include "voxel/chunk_coord.h"
+
+
+static constexpr size_t SECTION_PALETTE_LINEAR_LIMIT = 16; // au delà, la palette garde un index bloc -> entrée
+
+
+// index dans les tableaux à plat (Decode, Encode, mesher), x varie le plus vite
+inline uint32_t GetBlockIndex(int x, int y, int z)
+{
+  return (uint32_t)((y * CHUNK_SIZE + z) * CHUNK_SIZE + x);
+}
+
+
+// CHUNK_VOLUME blocs d'un chunk cubique, compressés par palette
+// chaque bloc est un index dans la palette sur 1, 2, 4, 8 ou 16 bits, rangés sans chevauchement dans des mots de 64 bits
+// une section d'un seul bloc (air, roche...) n'a pas d'indices du tout, la mémoire suit le nombre de blocs différents
+// la palette grandit quand un bloc inconnu arrive et rétrécit quand assez d'entrées ne sont plus utilisées
+class ChunkSection
+{
+public:
+  ChunkSection(uint16_t block = BLOCK_AIR);
+  ~ChunkSection() = default;
+
+  inline uint16_t Get(int x, int y, int z) const { return _palette[getPaletteIndex(GetBlockIndex(x, y, z))]; }
+  inline uint16_t Get(uint32_t index) const { return _palette[getPaletteIndex(index)]; }
+  void Set(int x, int y, int z, uint16_t block);
+  void Set(uint32_t index, uint16_t block);
+  void Fill(uint16_t block);
+
+  // pBlocks : CHUNK_VOLUME blocs rangés selon GetBlockIndex
+  void Decode(uint16_t* pBlocks) const;
+  void Encode(const uint16_t* pBlocks);
+
+  inline bool IsUniform() const { return _bits == 0; }
+  inline uint16_t GetUniformBlock() const { return _palette[0]; } // seulement si IsUniform
+  inline int GetBitsPerBlock() const { return _bits; }
+  inline size_t GetPaletteSize() const { return _palette.size() - _freeEntries.size(); }
+  size_t GetMemoryUsage() const;
+
+  // état brut pour la sauvegarde (region_file), les entrées libres de la palette en font partie
+  inline const std::vector<uint16_t>& GetPalette() const { return _palette; }
+  inline const std::vector<uint64_t>& GetWords() const { return _words; }
+  // inverse de GetPalette/GetWords, false (section inchangée) si les indices ne correspondent pas à la palette
+  bool Assign(int bits, std::vector<uint16_t> palette, std::vector<uint64_t> words);
+
+private:
+  std::vector<uint16_t> _palette;
+  std::vector<uint16_t> _counts; // nombre de blocs qui pointent sur chaque entrée, 0 = entrée libre
+  std::vector<uint16_t> _freeEntries;
+  std::unordered_map<uint16_t, uint16_t> _paletteIndex; // bloc -> entrée, seulement pour les grandes palettes
+
+  std::vector<uint64_t> _words;
+  int _bits; // 0 = uniforme
+  int _log2Bits;
+  uint64_t _mask;
+
+  inline uint16_t getPaletteIndex(uint32_t index) const
+  {
+    if (_bits == 0) return 0;
+
+    const uint32_t shift = 6 - _log2Bits; // log2 du nombre d'indices par mot
+    const uint32_t offset = (index & ((1u << shift) - 1)) << _log2Bits;
+    return (uint16_t)((_words[index >> shift] >> offset) & _mask);
+  }
+
+  inline void setPaletteIndex(uint32_t index, uint16_t entry)
+  {
+    const uint32_t shift = 6 - _log2Bits;
+    const uint32_t offset = (index & ((1u << shift) - 1)) << _log2Bits;
+    uint64_t& word = _words[index >> shift];
+    word = (word & ~(_mask << offset)) | ((uint64_t)entry << offset);
+  }
+
+  int findEntry(uint16_t block) const;
+  uint16_t addEntry(uint16_t block);
+  void releaseEntry(uint16_t entry);
+  void setBits(int bits);
+  void repack(int bits, const uint16_t* pRemap);
+  void shrink();
+};
+
+
+#endif // !VOXL_CHUNK_SECTION_H
\ No newline at end of file
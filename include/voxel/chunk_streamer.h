@@ -0,0 +1,153 @@
+#ifndef VOXL_CHUNK_STREAMER_H
+#define VOXL_CHUNK_STREAMER_H
+
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include <enkiTS/TaskScheduler.h>
+#include <glm/glm.hpp>
+
+#include "utils/lock_free_queue.h"
+#include "voxel/chunk_coord.h"
+#include "voxel/chunk_lod.h"
+#include "voxel/chunk_section.h"
+#include "voxel/terrain_generator.h"
+
+
+class ChunkStreamer;
+class JobSystem;
+class RegionStorage;
+class VoxelWorld;
+
+
+static constexpr int CHUNK_STREAM_DEFAULT_RADIUS = 8; // colonnes de chunks autour de la caméra
+static constexpr int CHUNK_STREAM_UNLOAD_MARGIN = 2; // une colonne n'est déchargée qu'au delà du rayon + marge
+static constexpr int CHUNK_STREAM_TOP_Y = 5; // plus haut chunk cherché dans les régions
+static constexpr size_t CHUNK_STREAM_MAX_JOBS = 32; // colonnes en vol, une puissance de 2
+static constexpr float CHUNK_STREAM_BUDGET_MS = 2.0f; // par frame sur le thread principal : colonnes reçues puis déchargements
+static constexpr float CHUNK_STREAM_BEHIND_WEIGHT = 3.0f; // derrière la caméra, une colonne compte comme 4 fois plus loin
+static constexpr float CHUNK_STREAM_TURN_COS = 0.94f; // au delà de ~20° de rotation, l'ordre des requêtes est refait
+
+
+// distance pondérée par la direction de vue, forward normalisé (ou nul : pas de préférence)
+// les chunks tout proches ne sont pas pénalisés, le joueur peut s'y retourner à tout moment
+template<typename Vec>
+inline float GetViewWeightedDistance(const Vec& delta, const Vec& forward)
+{
+  const float distance = glm::length(delta);
+  if (distance < 1.5f) return distance;
+
+  const float facing = glm::dot(delta, forward) / distance;
+  return distance * (1.0f + CHUNK_STREAM_BEHIND_WEIGHT * 0.5f * (1.0f - facing));
+}
+
+
+// une colonne de chunks lue dans les régions ou générée, sur un worker
+struct ChunkColumnJob : enki::ITaskSet
+{
+  ChunkStreamer* pOwner;
+  uint32_t slot;
+
+  ChunkCoord column; // y inutilisé
+  std::atomic<bool> isCancelled; // le worker s'arrête au chunk suivant
+
+  std::vector<GeneratedChunk> chunks;
+
+  void ExecuteRange(enki::TaskSetPartition range, uint32_t threadnum) override;
+};
+
+
+// tampons de génération d'un worker
+struct ChunkColumnScratch
+{
+  std::unique_ptr<TerrainColumn> pColumn;
+  std::vector<uint16_t> blocks;
+};
+
+
+// garde chargées les colonnes de chunks dans un rayon autour de la caméra
+// le rayon est arrondi aux blocs de 2 x 2 colonnes des noeuds LOD de niveau 1, qui prennent le relais au delà
+//
+// les colonnes manquantes sont demandées de la plus importante à la moins importante (distance pondérée par la vue)
+// les slots de jobs vont toujours aux colonnes les plus importantes : quand la caméra tourne ou se téléporte,
+// les jobs devenus moins importants que les requêtes en attente sont annulés, comme ceux sortis du rayon
+// le thread principal n'applique les colonnes reçues et ne décharge que sous CHUNK_STREAM_BUDGET_MS par frame
+// une colonne générée n'est pas écrite sur le disque tant qu'elle n'est pas modifiée, la seed suffit à la refaire
+class ChunkStreamer
+{
+public:
+  ChunkStreamer(JobSystem* pJobs, RegionStorage* pStorage, const TerrainSettings& settings = TerrainSettings{});
+  ~ChunkStreamer();
+
+  ChunkStreamer(const ChunkStreamer&) = delete;
+  ChunkStreamer& operator=(const ChunkStreamer&) = delete;
+
+  // 0 : plus rien n'est chargé, les colonnes déjà là sont déchargées
+  void SetRadius(int radius);
+  inline int GetRadius() const { return _radius; }
+
+  // viewerForward : direction de la caméra, normalisée ou non
+  void Update(VoxelWorld& world, const glm::vec3& viewerPosition, const glm::vec3& viewerForward);
+  void WaitAll();
+
+  // chargée et appliquée au VoxelWorld, pas seulement demandée
+  inline bool IsColumnLoaded(int x, int z) const
+  {
+    auto it = _columns.find(ChunkCoord{ x, 0, z });
+    return it != _columns.end() && !it->second.pJob;
+  }
+
+  inline const TerrainGenerator& GetGenerator() const { return _generator; }
+  inline size_t GetColumnCount() const { return _columns.size(); }
+  inline size_t GetRequestCount() const { return _requests.size() - _nextRequest; }
+  inline size_t GetInFlightCount() const { return CHUNK_STREAM_MAX_JOBS - _freeSlots.size(); }
+  inline uint64_t GetCancelledCount() const { return _cancelledCount; }
+
+private:
+  friend struct ChunkColumnJob;
+
+  struct Column
+  {
+    ChunkColumnJob* pJob; // nullptr une fois chargée
+  };
+
+  enki::TaskScheduler* _pScheduler;
+  RegionStorage* _pStorage;
+  TerrainGenerator _generator;
+  int _radius;
+
+  std::vector<std::unique_ptr<ChunkColumnJob>> _jobs;
+  std::vector<uint32_t> _freeSlots; // thread principal uniquement
+  std::vector<ChunkColumnScratch> _scratches; // un par thread, indexé par threadnum
+  LockFreeQueue<uint32_t, CHUNK_STREAM_MAX_JOBS> _completed;
+
+  std::unordered_map<ChunkCoord, Column, ChunkCoordHash> _columns; // chargées ou en vol, y = 0
+  std::vector<std::pair<float, ChunkCoord>> _requests; // colonnes manquantes, triées
+  size_t _nextRequest;
+  std::vector<ChunkColumnJob*> _ready; // reçues, pas encore appliquées
+  std::vector<ChunkCoord> _unloadQueue;
+
+  glm::ivec2 _viewerColumn;
+  glm::vec2 _viewerForward;
+  bool _isViewDirty;
+  uint64_t _cancelledCount;
+
+  bool isInRange(ChunkCoord column, int radius) const;
+  float getPriority(ChunkCoord column) const;
+  void refreshRequests();
+  void collectColumns();
+  void applyColumns(VoxelWorld& world, std::chrono::steady_clock::time_point start);
+  void unloadColumns(VoxelWorld& world, std::chrono::steady_clock::time_point start);
+  void submitColumns();
+  void cancel(ChunkColumnJob* pJob);
+  void release(ChunkColumnJob* pJob);
+};
+
+
+#endif // !VOXL_CHUNK_STREAMER_H
\ No newline at end of file
@@ -0,0 +1,157 @@
+#ifndef VOXL_REGION_FILE_H
+#define VOXL_REGION_FILE_H
+
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "platform/mapped_file.h"
+#include "voxel/chunk_coord.h"
+#include "voxel/chunk_section.h"
+
+
+static constexpr const char* REGION_DIRECTORY = "saves/world/regions/";
+
+static constexpr int REGION_SIZE = 32; // chunks par côté en x et z
+static constexpr int REGION_SHIFT = 5;
+static constexpr int REGION_HEIGHT = 4; // chunks en y, les colonnes de terrain tiennent dans 1 ou 2 régions
+static constexpr int REGION_HEIGHT_SHIFT = 2;
+static constexpr uint32_t REGION_CHUNK_COUNT = REGION_SIZE * REGION_SIZE * REGION_HEIGHT;
+
+static constexpr size_t REGION_SECTOR_SIZE = 4096; // une page : un chunk de moins de 4 Ko est lu en un seul défaut de page
+static constexpr uint32_t REGION_HEADER_SECTORS = (uint32_t)(REGION_CHUNK_COUNT * 2 * sizeof(uint32_t) / REGION_SECTOR_SIZE);
+static constexpr uint32_t REGION_MAX_CHUNK_SECTORS = 255; // le nombre de secteurs tient sur 8 bits de l'emplacement
+
+
+struct RegionCoord
+{
+  int x;
+  int y;
+  int z;
+
+  bool operator==(const RegionCoord&) const = default;
+};
+
+
+struct RegionCoordHash
+{
+  size_t operator()(const RegionCoord& coord) const
+  {
+    return ChunkCoordHash{}(ChunkCoord{ coord.x, coord.y, coord.z });
+  }
+};
+
+
+inline RegionCoord GetRegionCoord(ChunkCoord coord)
+{
+  return RegionCoord{ coord.x >> REGION_SHIFT, coord.y >> REGION_HEIGHT_SHIFT, coord.z >> REGION_SHIFT };
+}
+
+
+// entrée du chunk dans l'en-tête de sa région
+inline uint32_t GetRegionIndex(ChunkCoord coord)
+{
+  const uint32_t x = (uint32_t)coord.x & (REGION_SIZE - 1);
+  const uint32_t y = (uint32_t)coord.y & (REGION_HEIGHT - 1);
+  const uint32_t z = (uint32_t)coord.z & (REGION_SIZE - 1);
+  return (y * REGION_SIZE + z) * REGION_SIZE + x;
+}
+
+
+inline ChunkCoord GetRegionChunkCoord(RegionCoord region, uint32_t index)
+{
+  const int x = (int)(index % REGION_SIZE);
+  const int z = (int)(index / REGION_SIZE % REGION_SIZE);
+  const int y = (int)(index / (REGION_SIZE * REGION_SIZE));
+  return ChunkCoord{ region.x * REGION_SIZE + x, region.y * REGION_HEIGHT + y, region.z * REGION_SIZE + z };
+}
+
+
+// REGION_CHUNK_COUNT chunks dans un fichier découpé en secteurs de REGION_SECTOR_SIZE octets
+//
+// secteurs 0 à REGION_HEADER_SECTORS - 1 : emplacements (premier secteur << 8 | nombre de secteurs, 0 = absent) puis timestamps
+// ensuite : un chunk par suite de secteurs, longueur et hash sur 4 octets chacun, format sur 1 octet, section compressée (palette + mots RLE)
+//
+// lecture : directement dans le fichier projeté, pas d'ouverture de fichier ni de copie dans un buffer
+// écriture : toujours dans des secteurs libres (trou assez grand ou fin du fichier), l'en-tête ne change qu'une fois les données écrites et flush
+// l'ancienne copie reste donc lisible jusqu'au dernier moment, puis ses secteurs redeviennent libres
+// ! flush rend les données au système, pas au disque : un crash du jeu est couvert, une coupure de courant demanderait un fsync
+// une écriture ferme la projection, elle est rouverte à la lecture suivante
+class RegionFile
+{
+public:
+  RegionFile() = default;
+  ~RegionFile();
+
+  RegionFile(const RegionFile&) = delete;
+  RegionFile& operator=(const RegionFile&) = delete;
+
+  // crée le fichier avec un en-tête vide s'il n'existe pas, les emplacements invalides sont ignorés
+  bool Open(const std::string& path);
+  void Close();
+
+  inline bool IsOpen() const { return _file.is_open(); }
+  inline bool HasChunk(uint32_t index) const { return _locations[index] != 0; }
+  inline uint32_t GetTimestamp(uint32_t index) const { return _timestamps[index]; }
+  inline size_t GetSectorCount() const { return _usedSectors.size(); }
+  size_t GetFreeSectorCount() const;
+
+  // false si le chunk est absent ou si ses données sont invalides
+  bool ReadChunk(uint32_t index, ChunkSection& section);
+  bool WriteChunk(uint32_t index, const ChunkSection& section, uint32_t timestamp);
+  bool RemoveChunk(uint32_t index);
+
+private:
+  std::string _path;
+  std::fstream _file;
+  MappedFile _mapping;
+  std::vector<uint8_t> _payload; // gardé entre les écritures pour ne pas réallouer
+
+  uint32_t _locations[REGION_CHUNK_COUNT];
+  uint32_t _timestamps[REGION_CHUNK_COUNT];
+  std::vector<bool> _usedSectors; // un par secteur du fichier, en-tête compris
+
+  uint32_t allocateSectors(uint32_t count);
+  void releaseSectors(uint32_t location);
+  bool writeAt(uint64_t offset, const void* pData, size_t size);
+  bool writeHeaderEntry(uint32_t index);
+};
+
+
+// les régions d'un monde, ouvertes à la demande et gardées ouvertes
+// utilisable depuis les workers du streaming : un seul appel à la fois, la décompression d'un chunk est courte
+class RegionStorage
+{
+public:
+  RegionStorage(const std::string& directory = REGION_DIRECTORY);
+  ~RegionStorage() = default;
+
+  RegionStorage(const RegionStorage&) = delete;
+  RegionStorage& operator=(const RegionStorage&) = delete;
+
+  bool LoadChunk(ChunkCoord coord, ChunkSection& section);
+  bool SaveChunk(ChunkCoord coord, const ChunkSection& section);
+  bool RemoveChunk(ChunkCoord coord);
+  bool HasChunk(ChunkCoord coord);
+
+  // tous les chunks enregistrés dans le dossier, région par région
+  void ListChunks(std::vector<ChunkCoord>& coords);
+  void Close();
+
+private:
+  std::string _directory;
+  std::mutex _mutex;
+  std::unordered_map<RegionCoord, std::unique_ptr<RegionFile>, RegionCoordHash> _regions; // nullptr : pas de fichier sur le disque
+
+  RegionFile* getRegion(RegionCoord coord, bool create);
+  std::string getRegionPath(RegionCoord coord) const;
+};
+
+
+#endif // !VOXL_REGION_FILE_H
\ No newline at end of file
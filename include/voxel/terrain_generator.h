@@ -0,0 +1,94 @@
+#ifndef VOXL_TERRAIN_GENERATOR_H
+#define VOXL_TERRAIN_GENERATOR_H
+
+
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "voxel/chunk_coord.h"
+#include "voxel/chunk_section.h"
+#include "voxel/terrain_noise.h"
+
+
+class JobSystem;
+
+
+static constexpr uint32_t TERRAIN_COLUMNS_PER_TASK = 2; // colonnes de chunks par partition du JobSystem
+
+
+struct TerrainSettings
+{
+  WarpedNoiseSettings noise = {
+    .seed = 1337,
+    .octaves = { .frequency = 1.0f / 384.0f, .octaves = 6 },
+    .warp = { .frequency = 1.0f / 768.0f, .octaves = 3 },
+    .warpAmplitude = 96.0f
+  };
+  float baseHeight = 32.0f; // en blocs
+  float heightAmplitude = 48.0f;
+  int bottomChunkY = -2; // rien n'est généré en dessous
+  int dirtDepth = 3; // couches de terre sous l'herbe
+
+  uint16_t stoneBlock = BLOCK_STONE;
+  uint16_t dirtBlock = BLOCK_DIRT;
+  uint16_t grassBlock = BLOCK_GRASS;
+};
+
+
+// hauteurs d'une colonne de chunks (même x et z), calculées une fois pour tous ses chunks
+struct TerrainColumn
+{
+  int chunkX;
+  int chunkZ;
+  int32_t heights[CHUNK_AREA]; // y monde du bloc d'herbe, indexé par z * CHUNK_SIZE + x
+  int32_t minHeight;
+  int32_t maxHeight;
+};
+
+
+struct GeneratedChunk
+{
+  ChunkCoord coord;
+  ChunkSection section;
+};
+
+
+// terrain infini en hauteurs : le bruit déformé (terrain_noise.h) donne une hauteur par colonne de blocs
+// même seed, mêmes chunks : le résultat ne dépend ni de l'ordre de génération ni du nombre de threads
+// const et sans état partagé, un même générateur sert tous les workers
+class TerrainGenerator
+{
+public:
+  TerrainGenerator(const TerrainSettings& settings = TerrainSettings{});
+
+  inline const TerrainSettings& GetSettings() const { return _settings; }
+
+  // le bruit est évalué sur les CHUNK_AREA colonnes de blocs en une fois, par paquets SIMD
+  void GenerateColumn(int chunkX, int chunkZ, TerrainColumn& column) const;
+  // CHUNK_AREA hauteurs échantillonnées tous les step blocs à partir de (originX, originZ), pour les niveaux de détail
+  void GenerateHeights(float originX, float originZ, float step, int32_t* pHeights) const;
+  // bloc à la hauteur y d'une colonne dont l'herbe est à height
+  inline uint16_t GetColumnBlock(int32_t y, int32_t height) const
+  {
+    if (y == height) return _settings.grassBlock;
+    if (y < height - _settings.dirtDepth) return _settings.stoneBlock;
+    if (y < height) return _settings.dirtBlock;
+    return BLOCK_AIR;
+  }
+  // false pour un chunk d'air (au dessus du plus haut bloc d'herbe ou sous bottomChunkY), section inchangée
+  // pBlocks : CHUNK_VOLUME blocs de travail
+  bool GenerateSection(const TerrainColumn& column, int chunkY, ChunkSection& section, uint16_t* pBlocks) const;
+  // ajoute les chunks de bottomChunkY jusqu'au plus haut bloc d'herbe
+  void GenerateSections(const TerrainColumn& column, std::vector<GeneratedChunk>& chunks, uint16_t* pBlocks) const;
+
+  // chunks[i] reçoit les chunks de columns[i], les colonnes sont réparties sur le JobSystem (nullptr : thread appelant)
+  void GenerateColumns(JobSystem* pJobs, const std::vector<glm::ivec2>& columns, std::vector<std::vector<GeneratedChunk>>& chunks) const;
+
+private:
+  TerrainSettings _settings;
+};
+
+
+#endif // !VOXL_TERRAIN_GENERATOR_H
\ No newline at end of file
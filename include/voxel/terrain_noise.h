@@ -0,0 +1,43 @@
+#ifndef VOXL_TERRAIN_NOISE_H
+#define VOXL_TERRAIN_NOISE_H
+
+
+#include <cstddef>
+#include <cstdint>
+
+
+// fBm : octaves de bruit simplex dont la fréquence est multipliée par lacunarity et l'amplitude par gain
+struct NoiseOctaves
+{
+  float frequency;
+  int octaves;
+  float lacunarity = 2.0f;
+  float gain = 0.5f;
+};
+
+
+// le point est d'abord déplacé par deux fBm basse fréquence (domain warping), puis le fBm principal y est évalué
+struct WarpedNoiseSettings
+{
+  uint32_t seed;
+  NoiseOctaves octaves;
+  NoiseOctaves warp;
+  float warpAmplitude; // déplacement maximum, dans les unités de x et y
+};
+
+
+// bruit simplex 2D dans [-1, 1], les gradients viennent d'un hash entier des coins : aucune table, rien à initialiser
+float SimplexNoise2D(uint32_t seed, float x, float y);
+
+// pOut[i] = fBm en (pX[i], pY[i]), dans [-1, 1]
+// évalué par paquets de 8 (AVX2) ou 4 (SSE) points, le reste en scalaire
+void FractalNoise2D(uint32_t seed, const NoiseOctaves& octaves, const float* pX, const float* pY, float* pOut, size_t count);
+void WarpedNoise2D(const WarpedNoiseSettings& settings, const float* pX, const float* pY, float* pOut, size_t count);
+// même calcul point par point, identique bit à bit aux versions SIMD tant que le compilateur ne fusionne pas mul et add (FMA)
+void WarpedNoise2DScalar(const WarpedNoiseSettings& settings, const float* pX, const float* pY, float* pOut, size_t count);
+
+// "AVX2", "SSE4.1", "SSE2" ou "scalar", choisi à la compilation
+const char* GetNoiseInstructionSet();
+
+
+#endif // !VOXL_TERRAIN_NOISE_H
\ No newline at end of file
@@ -0,0 +1,119 @@
+#ifndef VOXL_VOXEL_WORLD_H
+#define VOXL_VOXEL_WORLD_H
+
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include <entt/entt.hpp>
+#include <glm/glm.hpp>
+
+#include "graphics/render_backend.h"
+#include "voxel/chunk_coord.h"
+#include "voxel/chunk_lod_clipmap.h"
+#include "voxel/chunk_mesh_pool.h"
+#include "voxel/chunk_mesh_scheduler.h"
+#include "voxel/chunk_section.h"
+#include "voxel/chunk_streamer.h"
+#include "voxel/region_file.h"
+
+
+static constexpr int CHUNK_URGENT_RADIUS = 2; // en chunks, un edit dans ce rayon autour du joueur passe devant tous les autres rebuilds
+static constexpr size_t CHUNK_UPLOAD_BUDGET_BYTES = 4 * 1024 * 1024; // par frame, au moins un mesh passe quand même
+static constexpr float CHUNK_UPLOAD_BUDGET_MS = 2.0f; // idem en temps, un pic de meshes finis ne fait pas sauter une frame
+
+
+// un chunk chargé, son entité (Mesh + WorldMatrix + Bounds) n'existe qu'après le premier mesh
+struct Chunk
+{
+  ChunkSection section;
+  entt::entity entity = entt::null;
+  entt::entity occluder = entt::null; // OccluderBox des couches pleines de la section, même sans mesh (roche enterrée)
+  // versions tirées d'un compteur du monde, un chunk recréé ne peut pas accepter le mesh de l'ancien
+  uint64_t version = 0; // change à chaque modification de la section ou d'une voisine qui la touche
+  uint64_t meshedVersion = 0; // version affichée par le Mesh
+  uint64_t meshingVersion = 0; // version du job en vol ou pas encore uploadé, 0 = aucun, le prochain attend son retour
+  bool isSaved = false; // identique à sa copie dans les fichiers de région
+  ChunkMeshJob* pMeshJob = nullptr; // job de meshingVersion, annulé si le chunk est retiré
+};
+
+
+// les chunks du monde et leurs meshes
+// une modification met le chunk (et les voisins dont la face change) en attente de mesh
+// Update fait avancer le ChunkStreamer, envoie les plus prioritaires au ChunkMeshScheduler et uploade les meshes finis sous un budget par frame
+// au delà du rayon du streamer, le ChunkLodClipmap affiche le terrain en niveaux de détail
+class VoxelWorld
+{
+public:
+  // pUploadBackend : backend du thread principal (Renderer::GetUploadBackend)
+  VoxelWorld(entt::registry* registry, RenderBackend* pUploadBackend);
+  ~VoxelWorld();
+
+  VoxelWorld(const VoxelWorld&) = delete;
+  VoxelWorld& operator=(const VoxelWorld&) = delete;
+
+  // crée ou remplace un chunk entier (génération, chargement), isSaved : la section vient des fichiers de région
+  void SetChunk(ChunkCoord coord, const ChunkSection& section, bool isSaved = false);
+  void RemoveChunk(ChunkCoord coord);
+  // RemoveChunk après avoir écrit le chunk s'il a été modifié, false si l'écriture a échoué (le chunk reste chargé)
+  bool UnloadChunk(ChunkCoord coord);
+  const ChunkSection* GetSection(ChunkCoord coord) const;
+  // colonne chargée par le streamer et tous ses chunks meshés au moins une fois, un noeud LOD peut laisser sa place
+  bool IsColumnReady(int x, int z) const;
+  // le terrain lointain a pris le relais de la colonne, le streamer peut la décharger
+  // les chunks modifiés sont d'abord sauvegardés pour que le noeud LOD reconstruit les montre
+  bool CanUnloadColumn(int x, int z);
+
+  // BLOCK_AIR en dehors des chunks chargés
+  uint16_t GetBlock(const glm::ivec3& block) const;
+  // edit du joueur : remesh prioritaire s'il est près de la caméra
+  void SetBlock(const glm::ivec3& block, uint16_t id);
+
+  // viewerForward oriente le chargement et le meshing vers ce que la caméra regarde
+  void Update(const glm::vec3& viewerPosition, const glm::vec3& viewerForward, uint64_t frameIndex);
+
+  // écrit les chunks modifiés depuis leur dernière sauvegarde, renvoie le nombre de chunks écrits
+  size_t Save();
+  // remplace les chunks chargés par ceux des fichiers de région, renvoie le nombre de chunks lus
+  size_t Load();
+
+  inline ChunkStreamer& GetStreamer() { return _streamer; }
+  inline ChunkLodClipmap& GetLod() { return _lod; }
+  inline size_t GetChunkCount() const { return _chunks.size(); }
+  inline size_t GetPendingCount() const { return _pending.size(); }
+  inline size_t GetReadyCount() const { return _ready.size(); }
+
+private:
+  entt::registry* _pRegistry;
+  RenderBackend* _pUploadBackend;
+
+  std::unordered_map<ChunkCoord, Chunk, ChunkCoordHash> _chunks;
+  std::unordered_map<ChunkCoord, bool, ChunkCoordHash> _pending; // chunk -> modifié par un edit
+  std::vector<std::pair<uint64_t, ChunkCoord>> _dispatchOrder; // gardé entre les frames pour ne pas réallouer
+
+  RegionStorage _storage;
+  ChunkMeshScheduler _meshScheduler;
+  ChunkMeshPool _meshPool;
+  std::vector<ChunkMeshJob*> _ready; // meshes finis, pas encore uploadés
+  ChunkStreamer _streamer; // après _storage : ses jobs lisent les régions jusqu'à sa destruction
+  ChunkLodClipmap _lod; // idem, et après _meshPool qui garde ses buffers
+
+  uint64_t _versionCounter;
+  glm::ivec3 _viewerChunk;
+  glm::vec3 _viewerForward;
+  uint64_t _frameIndex;
+  std::vector<uint16_t> _faceLayers; // copie de BlockTextureArray::faceLayers, vide tant que le Renderer ne l'a pas chargé
+
+  void refreshFaceLayers();
+  void requestMesh(ChunkCoord coord, bool isEdit);
+  void dispatchMeshes();
+  void uploadMeshes(uint64_t frameIndex);
+  void uploadMesh(Chunk& chunk, ChunkMeshJob& job, uint64_t frameIndex);
+  void touchNeighbor(ChunkCoord coord, bool isEdit);
+  void destroyChunkEntity(Chunk& chunk);
+};
+
+
+#endif // !VOXL_VOXEL_WORLD_H
\ No newline at end of file
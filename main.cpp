@@ -10,13 +10,31 @@ extern "C"
 #endif
 
 
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
 #include "core/engine.h"
 
 
 int main(int argc, char* argv[])
 {
-  Engine engine;
-  engine.Run();
+  bool use_render_thread = false;
+  bool is_headless = false;
+  uint32_t thread_count = 0;
+  std::vector<std::string> command_lines; // --run "$bench_render 100", répétable, exécutées dans l'ordre
+  for (int i = 1; i < argc; i++)
+  {
+    if (std::strcmp(argv[i], "--render-thread") == 0) use_render_thread = true;
+    else if (std::strcmp(argv[i], "--headless") == 0) is_headless = true;
+    else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) thread_count = (uint32_t)std::strtoul(argv[++i], nullptr, 10);
+    else if (std::strcmp(argv[i], "--run") == 0 && i + 1 < argc) command_lines.push_back(argv[++i]);
+  }
+
+  Engine engine(use_render_thread, thread_count, is_headless);
+  engine.Run(command_lines);
 
   return 0;
 }
\ No newline at end of file
@@ -0,0 +1,170 @@
+#include "core/asset_watcher.h"
+
+
+#include <algorithm>
+#include <iostream>
+#include <system_error>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+#include "utils/normalize_asset_path.h"
+
+
+#ifdef __linux__
+// inotify prévient tout de suite, seul le debounce compte
+static constexpr double ASSET_WATCHER_QUIET_TIME = ASSET_WATCHER_DEBOUNCE;
+#else
+// un parcours sans changement doit passer entre la dernière modification et l'envoi du lot
+static constexpr double ASSET_WATCHER_QUIET_TIME = std::max(ASSET_WATCHER_DEBOUNCE, ASSET_WATCHER_SCAN_INTERVAL);
+#endif
+
+
+AssetWatcher::AssetWatcher(const std::string& root)
+  : _root(NormalizeAssetPath(root))
+{
+#ifdef __linux__
+  _inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (_inotifyFd < 0)
+  {
+    std::cerr << "[AssetWatcher] Failed to init inotify, hot reload disabled\n";
+    return;
+  }
+  addWatches(_root, false);
+#else
+  // état de départ, rien n'est signalé
+  scan(false);
+  _lastScan = Clock::now();
+#endif
+}
+
+
+AssetWatcher::~AssetWatcher()
+{
+#ifdef __linux__
+  if (_inotifyFd >= 0) close(_inotifyFd); // retire aussi tous les watches
+#endif
+}
+
+
+std::vector<std::string> AssetWatcher::Poll()
+{
+#ifdef __linux__
+  if (_inotifyFd >= 0) readEvents();
+#else
+  if (std::chrono::duration<double>(Clock::now() - _lastScan).count() >= ASSET_WATCHER_SCAN_INTERVAL)
+  {
+    scan(true);
+    _lastScan = Clock::now();
+  }
+#endif
+
+  if (_pending.empty()) return {};
+
+  Clock::time_point now = Clock::now();
+  double quiet = std::chrono::duration<double>(now - _lastChange).count();
+  double waiting = std::chrono::duration<double>(now - _firstChange).count();
+  if (quiet < ASSET_WATCHER_QUIET_TIME && waiting < ASSET_WATCHER_MAX_DELAY) return {};
+
+  std::vector<std::string> paths(_pending.begin(), _pending.end());
+  _pending.clear();
+  return paths;
+}
+
+
+void AssetWatcher::addChange(const std::string& path)
+{
+  Clock::time_point now = Clock::now();
+  if (_pending.empty()) _firstChange = now;
+  _lastChange = now;
+  _pending.insert(path);
+}
+
+
+#ifdef __linux__
+void AssetWatcher::addWatches(const std::string& directory, bool report)
+{
+  // IN_CLOSE_WRITE : fin d'écriture, IN_MOVED_TO : sauvegarde par fichier temporaire puis renommage
+  // IN_CREATE : uniquement pour surveiller les nouveaux dossiers
+  int watch = inotify_add_watch(_inotifyFd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+  if (watch < 0)
+  {
+    std::cerr << "[AssetWatcher] Failed to watch '" << directory << "'\n";
+    return;
+  }
+  _watches[watch] = directory;
+
+  // les fichiers écrits avant que le watch existe n'ont généré aucun event
+  std::error_code error;
+  for (const auto& entry: std::filesystem::directory_iterator(directory, error))
+  {
+    if (entry.is_directory(error)) addWatches(NormalizeAssetPath(entry.path().string()), report);
+    else if (report && entry.is_regular_file(error)) addChange(NormalizeAssetPath(entry.path().string()));
+  }
+}
+
+
+void AssetWatcher::readEvents()
+{
+  alignas(inotify_event) char buffer[4096];
+
+  while (true)
+  {
+    // non bloquant : -1 (EAGAIN) quand il n'y a plus rien à lire
+    ssize_t length = read(_inotifyFd, buffer, sizeof(buffer));
+    if (length <= 0) return;
+
+    for (char* p = buffer; p < buffer + length; )
+    {
+      const inotify_event* event = reinterpret_cast<const inotify_event*>(p);
+      p += sizeof(inotify_event) + event->len;
+
+      if (event->mask & IN_Q_OVERFLOW)
+      {
+        std::cerr << "[AssetWatcher] inotify queue overflow, some changes were lost\n";
+        continue;
+      }
+      if (event->mask & IN_IGNORED)
+      {
+        // dossier supprimé ou déplacé
+        _watches.erase(event->wd);
+        continue;
+      }
+
+      auto it = _watches.find(event->wd);
+      if (it == _watches.end() || event->len == 0) continue;
+
+      std::string path = NormalizeAssetPath((std::filesystem::path(it->second) / event->name).string());
+      if (event->mask & IN_ISDIR)
+      {
+        if (event->mask & (IN_CREATE | IN_MOVED_TO)) addWatches(path, true);
+        continue;
+      }
+
+      if (event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO)) addChange(path);
+    }
+  }
+}
+#else
+void AssetWatcher::scan(bool report)
+{
+  std::error_code error;
+  auto options = std::filesystem::directory_options::skip_permission_denied;
+  for (auto it = std::filesystem::recursive_directory_iterator(_root, options, error); !error && it != std::filesystem::recursive_directory_iterator(); it.increment(error))
+  {
+    if (!it->is_regular_file(error)) continue;
+
+    auto write_time = it->last_write_time(error);
+    if (error) continue; // fichier supprimé entre temps
+
+    std::string path = NormalizeAssetPath(it->path().string());
+    auto [known, inserted] = _writeTimes.try_emplace(path, write_time);
+    if (!inserted && known->second == write_time) continue;
+
+    known->second = write_time;
+    if (report) addChange(path);
+  }
+}
+#endif
\ No newline at end of file
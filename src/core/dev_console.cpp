@@ -84,48 +84,7 @@ void DevConsole::OpenDevConsole(bool* pOpen)
     {
       if (strlen(_inputBuffer) > 0)
       {
-        auto& dispatcher = _pRegistry->ctx().get<entt::dispatcher>();
-
-        dispatcher.enqueue(DevConsoleMessageEvent{
-          .level = DebugLevel::NONE,
-          .buffer = _inputBuffer,
-        });
-
-        std::vector<std::string> tokens;
-        std::stringstream ss(_inputBuffer);
-        std::string word;
-
-        // on fait juste du parsing + on accepte que 10 arguments, ça évite de check un long texte pour rien
-        while (std::getline(ss, word, ' ') && tokens.size() < 10) 
-        {
-          tokens.push_back(word);
-        }
-
-        if (!tokens.empty())
-        {
-          // c'est une commande et elle à un nom donc on la process
-          const std::string& CMD_NAME = tokens[0];
-          if (CMD_NAME.size() > 0 && CMD_NAME[0] == '$')
-          {
-            // on récupère les arguments s'il y en a, sinon args sera un vecteur vide ce qui correspond aux commandes sans arguments
-            std::vector<std::string> args;
-            if (tokens.size() > 1) args.assign(tokens.begin() + 1, tokens.end());
-
-            auto& command_manager = _pRegistry->ctx().get<CommandManager>();
-            std::string name = CMD_NAME.substr(1);
-
-            
-            bool does_cmd_exist = command_manager.Execute(name, args);
-            if (!does_cmd_exist) 
-            {
-              dispatcher.enqueue(DevConsoleMessageEvent{
-                .level = DebugLevel::WARNING,
-                .buffer = name + " command doesn't exist",
-              });
-            }
-          }
-        }
-
+        Execute(_inputBuffer);
         _inputBuffer[0] = '\0';
         _scrollToBottom = true;
       }
@@ -142,9 +101,56 @@ void DevConsole::OpenDevConsole(bool* pOpen)
 }
 
 
+void DevConsole::Execute(const std::string& line)
+{
+  auto& dispatcher = _pRegistry->ctx().get<entt::dispatcher>();
+
+  dispatcher.enqueue(DevConsoleMessageEvent{
+    .level = DebugLevel::NONE,
+    .buffer = line,
+  });
+
+  std::vector<std::string> tokens;
+  std::stringstream ss(line);
+  std::string word;
+
+  // on fait juste du parsing + on accepte que 10 arguments, ça évite de check un long texte pour rien
+  while (std::getline(ss, word, ' ') && tokens.size() < 10) 
+  {
+    tokens.push_back(word);
+  }
+
+  if (!tokens.empty())
+  {
+    // c'est une commande et elle à un nom donc on la process
+    const std::string& CMD_NAME = tokens[0];
+    if (CMD_NAME.size() > 0 && CMD_NAME[0] == '$')
+    {
+      // on récupère les arguments s'il y en a, sinon args sera un vecteur vide ce qui correspond aux commandes sans arguments
+      std::vector<std::string> args;
+      if (tokens.size() > 1) args.assign(tokens.begin() + 1, tokens.end());
+
+      auto& command_manager = _pRegistry->ctx().get<CommandManager>();
+      std::string name = CMD_NAME.substr(1);
+
+      
+      bool does_cmd_exist = command_manager.Execute(name, args);
+      if (!does_cmd_exist) 
+      {
+        dispatcher.enqueue(DevConsoleMessageEvent{
+          .level = DebugLevel::WARNING,
+          .buffer = name + " command doesn't exist",
+        });
+      }
+    }
+  }
+}
+
+
 void DevConsole::onDevConsoleMessage(const DevConsoleMessageEvent& e)
 {
   _history.push_back(GetDebugLevel(e.level) + "> " + e.buffer);
+  if (_isEcho) std::cout << _history.back() << "\n";
 }
 
 void DevConsole::registerCommands()
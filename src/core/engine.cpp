@@ -5,8 +5,13 @@
 #include <memory>
 #include <iostream>
 #include <chrono>
+#include <cmath>
+#include <cstring>
+#include <random>
 #include <stdexcept>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 #include <SDL3/SDL_keyboard.h>
 #include <SDL3/SDL_keycode.h>
@@ -16,31 +21,60 @@ using namespace entt::literals;
 #include <stb_image.h>
 
 #include "core/engine_context.h"
+#include "core/asset_watcher.h"
 #include "core/dev_console.h"
 #include "core/command.h"
 #include "core/command_manager.h"
 #include "core/command_manager.h"
 #include "core/resource_manager.h"
+#include "core/profiler.h"
+#include "core/job_system.h"
+#include "core/frame_scheduler.h"
 #include "core/scene.h"
+#include "core/transform_batch.h"
 #include "platform/window.h"
 #include "platform/input_handler.h"
+#include "graphics/frustum.h"
+#include "graphics/occlusion_buffer.h"
 #include "graphics/renderer.h"
+#include "graphics/visibility_set.h"
+#include "loaders/block_texture_array_loader.h"
 #include "loaders/font_loader.h"
+#include "loaders/texture_cooker.h"
+#include "loaders/texture_loader.h"
 #include "events/close_event.h"
 #include "events/game_state_change_event.h"
+#include "events/load_world_event.h"
+#include "events/save_world_event.h"
 #include "events/dev_console_message_event.h"
 #include "systems/user_control_system.h"
 #include "systems/timer_system.h"
+#include "systems/transform_system.h"
 #include "components/transform.h"
 #include "components/rect_transform.h"
 #include "components/text.h"
 #include "components/ui_node.h"
 #include "components/text_mesh.h"
+#include "components/camera.h"
+#include "components/world_matrix.h"
+#include "components/orientation.h"
+#include "components/parent.h"
+#include "components/mesh_instance.h"
+#include "components/occluder_box.h"
 #include "resources/font.h"
 #include "utils/game_state.h"
+#include "utils/get_transform_matrix.h"
+#include "voxel/chunk_lod_clipmap.h"
+#include "voxel/chunk_mesh_scheduler.h"
+#include "voxel/chunk_mesher.h"
+#include "voxel/chunk_section.h"
+#include "voxel/chunk_streamer.h"
+#include "voxel/terrain_generator.h"
+#include "voxel/terrain_noise.h"
+#include "voxel/voxel_world.h"
 
 
-Engine::Engine() : _isRunning(true) {
+Engine::Engine(bool useRenderThread, uint32_t threadCount, bool isHeadless) : _isRunning(true), _isHeadless(isHeadless) {
   _pRegistry = std::make_unique<entt::registry>();
 
   registerComponents();
@@ -51,28 +85,56 @@ Engine::Engine() : _isRunning(true) {
   
   auto& dispatcher = _pRegistry->ctx().emplace<entt::dispatcher>();
   auto &engine_context = _pRegistry->ctx().emplace<EngineContext>();
+  _pRegistry->ctx().emplace<Profiler>(_pRegistry.get());
+  _pRegistry->ctx().emplace<FrameScheduler>(_pRegistry.get());
+
+  // un thread de travail par coeur en plus du thread principal, sauf si threadCount est donné
+  auto& job_system = _pRegistry->ctx().emplace<JobSystem>(threadCount);
+  // cuisson des textures et construction du tableau de textures des blocs au premier chargement
+  TextureLoader::pJobSystem = &job_system;
+  BlockTextureArrayLoader::pJobSystem = &job_system;
   dispatcher.sink<CloseEvent>().connect<&Engine::onClose>(this);
   dispatcher.sink<GameStateChangeEvent>().connect<&Engine::onGameStateChange>(this);
+  dispatcher.sink<SaveWorldEvent>().connect<&Engine::onSaveWorld>(this);
+  dispatcher.sink<LoadWorldEvent>().connect<&Engine::onLoadWorld>(this);
 
   // TODO être en mode editor par défaut en debug et in_game en release
   dispatcher.enqueue<GameStateChangeEvent>(GameStateChangeEvent{
     .newState = GameState::EDITOR
   });
 
-  _pWindow = std::make_unique<Window>(_pRegistry.get());
-  _pRenderer = std::make_unique<Renderer>(_pRegistry.get(), _pWindow.get());
+  // sans fenêtre, c'est ici que l'écran prend sa taille (Window::Init sinon)
+  if (_isHeadless)
+  {
+    auto& screenInfo = engine_context.screenInfo;
+    screenInfo.width = HEADLESS_WIDTH;
+    screenInfo.height = HEADLESS_HEIGHT;
+    screenInfo.aspectRatio = (float)HEADLESS_WIDTH / (float)HEADLESS_HEIGHT;
+    screenInfo.halfWidth = (float)HEADLESS_WIDTH * 0.5f;
+    screenInfo.halfHeight = (float)HEADLESS_HEIGHT * 0.5f;
+    screenInfo.isMinimized = false;
+  }
+  else _pWindow = std::make_unique<Window>(_pRegistry.get());
+
+  _pRenderer = std::make_unique<Renderer>(_pRegistry.get(), _pWindow.get(), _isHeadless ? RenderBackendType::NONE : RenderBackendType::OPENGL, useRenderThread);
   _pDevConsole = std::make_unique<DevConsole>(_pRegistry.get());
   _pScene = std::make_unique<Scene>(_pRegistry.get());
+  _pWorld = std::make_unique<VoxelWorld>(_pRegistry.get(), &_pRenderer->GetUploadBackend());
 }
 
 Engine::~Engine() 
 {
-  glDeleteTextures(1, &_font.textureHandle);
+  // la tâche appartient à l'Engine, le JobSystem ne doit plus l'exécuter quand elle est libérée
+  if (_pCookTask) _pRegistry->ctx().get<JobSystem>().GetScheduler().WaitforTask(_pCookTask.get());
+
+  if (!_isHeadless) glDeleteTextures(1, &_font.textureHandle);
 }
 
-void Engine::Run() {
+void Engine::Run(const std::vector<std::string>& commandLines) {
   auto& engine_context = _pRegistry->ctx().get<EngineContext>();
   auto& dispatcher = _pRegistry->ctx().emplace<entt::dispatcher>();
+  auto& profiler = _pRegistry->ctx().get<Profiler>();
+  auto& job_system = _pRegistry->ctx().get<JobSystem>();
 
   if (!init()) {
     std::cerr << "[Engine] Failed to init engine\n";
@@ -82,10 +144,13 @@ void Engine::Run() {
 
   UserControlSystem user_control_sys;
   TimerSystem timer_sys;
+  TransformSystem transform_sys;
+  transform_sys.Connect(*_pRegistry);
 
 
-  auto last_frame_time = std::chrono::steady_clock::now();
-  double delta_time;
+  auto& frame_scheduler = _pRegistry->ctx().get<FrameScheduler>();
+  auto& resource_manager = _pRegistry->ctx().get<ResourceManager>();
+  AssetWatcher asset_watcher;
 
   registerHelpCommand(); // maintenant on peut faire $help et afficher tous les helper !
 
@@ -94,52 +159,148 @@ void Engine::Run() {
     .buffer = "Engine ready"
   });
 
+  size_t next_command = 0;
+  if (_isHeadless && commandLines.empty()) _isRunning = false;
+
   while (_isRunning) {
-    auto current_frame_time = std::chrono::steady_clock::now();
-    delta_time = std::chrono::duration<double>(current_frame_time - last_frame_time).count();
-    last_frame_time = current_frame_time;
+    double delta_time = frame_scheduler.BeginFrame();
+
+    engine_context.deltaTime = delta_time;
+    engine_context.frameIndex++;
+    profiler.BeginFrame(delta_time);
+
+    if (_pWindow) _pWindow->PollEvent();
+
+    // une ligne par frame : une commande qui crée des entités les voit extraites avant la suivante
+    if (next_command < commandLines.size()) _pDevConsole->Execute(commandLines[next_command++]);
+
+    // travail renvoyé au thread principal par les workers (GL, registry)
+    {
+      ProfileScope scope(profiler, "PinnedTasks");
+      job_system.RunPinnedTasks();
+    }
+
+    // rechargement à chaud des assets modifiés sur le disque, avant que la frame ne les utilise
+    {
+      ProfileScope scope(profiler, "HotReload");
+      std::vector<std::string> changed_paths = asset_watcher.Poll();
+      if (!changed_paths.empty())
+      {
+        size_t reloaded = resource_manager.Reload(changed_paths, engine_context.frameIndex);
+        if (reloaded > 0)
+        {
+          dispatcher.enqueue(DevConsoleMessageEvent{
+            .level = DebugLevel::INFO,
+            .buffer = "Hot reloaded " + std::to_string(reloaded) + " resource(s)"
+          });
+        }
+      }
+      resource_manager.ReleaseRetired(engine_context.frameIndex);
+    }
+
+    // les entrées sont lues une fois par frame, les touches pressées ne doivent être vues qu'une fois
+    {
+      ProfileScope scope(profiler, "UserControlSystem");
+      user_control_sys.Update(*_pRegistry);
+    }
 
-    _pWindow->PollEvent();
+    // simulation à pas fixe, 0 ou plusieurs ticks selon le temps écoulé
+    {
+      ProfileScope scope(profiler, "Simulation");
+      engine_context.tickDeltaTime = frame_scheduler.GetTickDelta();
+      while (frame_scheduler.Tick())
+      {
+        engine_context.tickIndex = frame_scheduler.GetTickIndex();
+        {
+          ProfileScope scope(profiler, "TimerSystem");
+          timer_sys.Update(*_pRegistry, engine_context.tickDeltaTime);
+        }
+        {
+          ProfileScope scope(profiler, "TransformSystem");
+          transform_sys.Update(*_pRegistry);
+        }
+      }
+      engine_context.interpolationAlpha = frame_scheduler.GetAlpha();
+    }
 
-    user_control_sys.Update(*_pRegistry);
-    timer_sys.Update(*_pRegistry, delta_time);
-    
-    _pRenderer->BeginFrame();
+    // fenêtre minimisée : rien à afficher, la simulation et les events continuent au ralenti
+    if (!engine_context.screenInfo.isMinimized)
+    {
+      _pRenderer->BeginFrame();
+
+      // affichage avec imgui
+      // toujours après NewFrame et avant Render !
+      // les Transform modifiés par l'éditeur sont pris en compte au prochain tick
+      if (!_isHeadless)
+      {
+        ProfileScope scope(profiler, "ImGui");
+        bool is_scene_graph_open = (engine_context.currentState == GameState::EDITOR);
+        if (is_scene_graph_open) _pScene->DisplayGraph(&is_scene_graph_open);
+        bool is_console_open = (engine_context.currentState == GameState::CONSOLE);
+        if (is_console_open) _pDevConsole->OpenDevConsole(&is_console_open);
+        profiler.DisplayOverlay(profiler.GetOverlayOpen());
+      }
+
+      // avant le rendu qui lit les WorldMatrix
+      {
+        ProfileScope scope(profiler, "Interpolation");
+        transform_sys.Interpolate(*_pRegistry, engine_context.interpolationAlpha);
+      }
 
-    // affichage avec imgui
-    // toujours après NewFrame et avant Render !
-    bool is_scene_graph_open = (engine_context.currentState == GameState::EDITOR);
-    if (is_scene_graph_open) _pScene->DisplayGraph(&is_scene_graph_open);
-    bool is_console_open = (engine_context.currentState == GameState::CONSOLE);
-    if (is_console_open) _pDevConsole->OpenDevConsole(&is_console_open);
+      // colonnes de chunks streamées et meshes finis par les workers, uploadés avant l'extraction de la frame
+      {
+        ProfileScope scope(profiler, "VoxelWorld");
+        entt::entity camera_entity = GetActiveCamera(*_pRegistry);
+        glm::mat4 camera_matrix = camera_entity != entt::null ? _pRegistry->get<WorldMatrix>(camera_entity).matrix : glm::mat4(1.0f);
+        // la caméra regarde vers -Z local
+        _pWorld->Update(glm::vec3(camera_matrix[3]), -glm::vec3(camera_matrix[2]), engine_context.frameIndex);
+      }
 
-    _pRenderer->Render();
-    _pRenderer->EndFrame();
+      {
+        ProfileScope scope(profiler, "Render");
+        _pRenderer->Render();
+      }
+      {
+        ProfileScope scope(profiler, "EndFrame");
+        _pRenderer->EndFrame();
+      }
+    }
 
     dispatcher.update();
 
+    if (_isHeadless && next_command == commandLines.size()) _isRunning = false;
+
+    // les ParallelFor de la frame apparaissent dans l'overlay comme des scopes CPU
+    job_system.FlushTimings(profiler);
+
     // TODO Supprimer propement les entités
     if (!engine_context.entitiesToDelete.empty())
     {
       for (auto entity: engine_context.entitiesToDelete) _pRegistry->destroy(entity);
       engine_context.entitiesToDelete.clear();
     }
+
+    frame_scheduler.WaitForNextFrame(frame_scheduler.GetTargetFrameRate(engine_context.screenInfo, engine_context.currentState));
   }
+
+  transform_sys.Disconnect(*_pRegistry);
 }
 
 bool Engine::init() {
-  if (!_pWindow->Init())
+  if (_pWindow && !_pWindow->Init())
     return false;
   if (!_pRenderer->Init())
     return false;
 
+  // les polices créent leur atlas en GL, il n'y a rien pour les afficher en headless
   auto& resource_manager = _pRegistry->ctx().get<ResourceManager>();
-  resource_manager.Load<Font>("Roboto Mono", "roboto_mono");
+  if (!_isHeadless) resource_manager.Load<Font>("Roboto Mono", "roboto_mono");
   // resource_manager.Load<Font>("Google Sans Code", "google_sans_code");
   // resource_manager.Load<Font>("Roboto", "roboto");
   
   if (!_pDevConsole->Init())
     return false;
+  _pDevConsole->SetEcho(_isHeadless);
   
   registerCommands();
 
@@ -191,6 +352,7 @@ void Engine::registerCommands()
     {
       try {
         if (args.size() != 1) throw std::out_of_range("[Engine] $fullscreen needs only 1 arg");
+        if (!_pWindow) throw std::out_of_range("[Engine] $fullscreen needs a window");
         
         size_t last_valid_index;
         int toggle_fullscreen = std::stoi(args[0], &last_valid_index);
@@ -217,6 +379,675 @@ void Engine::registerCommands()
       }
     }
   });
+
+  // remplit une grille d'instances du même mesh, pour tester l'instancing
+  helper = "$spawn_mesh <model> <count> --> 'model' is a file in assets/models without extension, 'count' must be a positive integer";
+  command_manager.Register(Command{
+    .name = "spawn_mesh",
+    .helper = helper,
+    .func = [this, &dispatcher, helper](auto& args)
+    {
+      try {
+        if (args.size() != 2) throw std::out_of_range("[Engine] $spawn_mesh needs 2 args");
+
+        size_t last_valid_index;
+        int count = std::stoi(args[1], &last_valid_index);
+        if (last_valid_index != args[1].size() || count <= 0) throw std::invalid_argument("[Engine] args[1] must be a positive integer");
+
+        auto& resource_manager = _pRegistry->ctx().get<ResourceManager>();
+        // LoadByID et pas Load, qui range le nom dans la liste des polices
+        auto [mesh_it, mesh_loaded] = resource_manager.LoadByID<Mesh>(entt::hashed_string(args[0].c_str()), args[0]);
+        entt::resource<Mesh> mesh = mesh_it->second;
+        if (!mesh || !mesh->vao) throw std::invalid_argument("[Engine] failed to load model " + args[0]);
+
+        int side = (int)std::ceil(std::sqrt((float)count));
+        for (int i = 0; i < count; i++)
+        {
+          auto entity = _pRegistry->create();
+          _pRegistry->emplace<Transform>(entity, Transform{
+            .position = glm::vec3((float)(i % side) * 2.0f, 0.0f, -(float)(i / side) * 2.0f),
+            .rotation = glm::vec3(0.0f),
+            .scale = glm::vec3(1.0f)
+          });
+          _pRegistry->emplace<MeshInstance>(entity, MeshInstance{.mesh = mesh});
+        }
+
+        dispatcher.enqueue(DevConsoleMessageEvent{
+          .level = DebugLevel::INFO,
+          .buffer = "[Engine] spawned " + std::to_string(count) + " instances of " + args[0]
+        });
+      }
+      catch (const std::out_of_range& e) 
+      {
+        dispatcher.enqueue(DevConsoleMessageEvent{
+          .level = DebugLevel::WARNING,
+          .buffer = helper,
+        });
+        std::cerr << e.what() << "\n";
+      }
+      catch (const std::invalid_argument& e)
+      {
+        dispatcher.enqueue(DevConsoleMessageEvent{
+          .level = DebugLevel::WARNING,
+          .buffer = helper,
+        });
+        std::cerr << e.what() << "\n";
+      }
+    }
+  });
+
+
+  // cuit à l'avance toutes les textures de assets/textures, sinon c'est fait au premier chargement de chacune
+  // en tâche de fond, le résultat arrive dans la console quand tout est cuit
+  helper = "$cook_textures --> doesn't need args";
+  command_manager.Register(Command{
+    .name = "cook_textures",
+    .helper = helper,
+    .func = [this, &dispatcher, helper](auto& args)
+    {
+      try {
+        if (!args.empty()) throw std::out_of_range("[Engine] $cook_textures doesn't accept args");
+        if (_pCookTask && !_pCookTask->GetIsComplete()) throw std::out_of_range("[Engine] $cook_textures is already running");
+
+        auto& job_system = _pRegistry->ctx().get<JobSystem>();
+        TextureCookSettings settings{ .allowS3TC = TextureLoader::isS3TCSupported };
+        _pCookTask = std::make_unique<enki::TaskSet>([&job_system, &dispatcher, settings](enki::TaskSetPartition range, uint32_t threadnum)
+        {
+          auto start = std::chrono::steady_clock::now();
+          size_t cooked = CookTextures(settings, &job_system);
+          double cook_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+          // le dispatcher n'est pas thread-safe, le message part du thread principal
+          job_system.RunOnMainThread([&dispatcher, cooked, cook_ms]()
+          {
+            dispatcher.enqueue(DevConsoleMessageEvent{
+              .level = DebugLevel::INFO,
+              .buffer = "[cook_textures] " + std::to_string(cooked) + " textures cooked in " + std::to_string(cook_ms) + " ms"
+            });
+          });
+        });
+        job_system.GetScheduler().AddTaskSetToPipe(_pCookTask.get());
+      }
+      catch (const std::out_of_range& e) 
+      {
+        dispatcher.enqueue(DevConsoleMessageEvent{
+          .level = DebugLevel::WARNING,
+          .buffer = helper,
+        });
+        std::cerr << e.what() << "\n";
+      }
+    }
+  });
+
+
+  // compare le calcul matrice par matrice (GetTransformMatrix) au kernel SIMD de TransformSystem
+  helper = "$bench_transforms <count> --> 'count' must be a positive integer";
+  command_manager.Register(Command{
+    .name = "bench_transforms",
+    .helper = helper,
+    .func = [&dispatcher, helper](auto& args)
+    {
+      try {
+        if (args.size() != 1) throw std::out_of_range("[Engine] $bench_transforms needs only 1 arg");
+
+        size_t last_valid_index;
+        int count = std::stoi(args[0], &last_valid_index);
+        if (last_valid_index != args[0].size() || count <= 0) throw std::invalid_argument("[Engine] args[0] must be a positive integer");
+
+        std::mt19937 rng(1337);
+        std::uniform_real_distribution<float> value(-180.0f, 180.0f);
+
+        std::vector<Transform> transforms(count);
+        for (Transform& t: transforms)
+          t = Transform{glm::vec3(value(rng), value(rng), value(rng)), glm::vec3(value(rng), value(rng), value(rng)), glm::vec3(1.0f)};
+
+        std::vector<glm::mat4> matrices(count);
+
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < count; i++) matrices[i] = GetTransformMatrix(transforms[i]);
+        auto naive_end = std::chrono::steady_clock::now();
+
+        TransformBatch batch;
+        batch.Reserve(count);
+        for (const Transform& t: transforms) batch.Push(t.position, t.rotation, t.scale);
+        batch.Compose(matrices.data());
+        auto batch_end = std::chrono::steady_clock::now();
+
+        dispatcher.enqueue(DevConsoleMessageEvent{
+          .level = DebugLevel::INFO,
+          .buffer = "[bench_transforms] " + std::to_string(count) + " transforms"
+            + "\nnaive: " + std::to_string(std::chrono::duration<double, std::milli>(naive_end - start).count()) + " ms"
+            + "\nbatch: " + std::to_string(std::chrono::duration<double, std::milli>(batch_end - naive_end).count()) + " ms"
+        });
+      }
+      catch (const std::out_of_range& e) 
+      {
+        dispatcher.enqueue(DevConsoleMessageEvent{
+          .level = DebugLevel::WARNING,
+          .buffer = helper,
+        });
+        std::cerr << e.what() << "\n";
+      }
+      catch (const std::invalid_argument& e)
+      {
+        dispatcher.enqueue(DevConsoleMessageEvent{
+          .level = DebugLevel::WARNING,
+          .buffer = helper,
+        });
+        std::cerr << e.what() << "\n";
+      }
+    }
+  });
+
+
+  // meshing greedy contre une face par quad, sur des chunks de collines avec quelques minerais, puis greedy sur tous les workers
+  helper = "$bench_chunk_mesh <count> --> 'count' must be a positive integer";
+  command_manager.Register(Command{
+    .name = "bench_chunk_mesh",
+    .helper = helper,
+    .func = [this, &dispatcher, helper](auto& args)
+    {
+      try {
+        if (args.size() != 1) throw std::out_of_range("[Engine] $bench_chunk_mesh needs only 1 arg");
+
+        size_t last_valid_index;
+        int count = std::stoi(args[0], &last_valid_index);
+        if (last_valid_index != args[0].size() || count <= 0) throw std::invalid_argument("[Engine] args[0] must be a positive integer");
+
+        // roche avec un peu de sable à la place des minerais, terre, herbe
+        std::mt19937 rng(1337);
+        std::uniform_int_distribution<int> ore(0, 99);
+        std::vector<ChunkSection> sections(count);
+        std::vector<uint16_t> blocks(CHUNK_VOLUME);
+        for (int i = 0; i < count; i++)
+        {
+          for (int z = 0; z < CHUNK_SIZE; z++)
+          {
+            for (int x = 0; x < CHUNK_SIZE; x++)
+            {
+              const float world_x = (float)(i * CHUNK_SIZE + x);
+              const int height = 16 + (int)(6.0f * std::sin(world_x * 0.11f) + 5.0f * std::cos(z * 0.17f + i * 0.5f));
+              for (int y = 0; y < CHUNK_SIZE; y++)
+              {
+                uint16_t block = BLOCK_AIR;
+                if (y < height - 3) block = ore(rng) < 2 ? BLOCK_SAND : BLOCK_STONE;
+                else if (y < height) block = BLOCK_DIRT;
+                else if (y == height) block = BLOCK_GRASS;
+                blocks[GetBlockIndex(x, y, z)] = block;
+              }
+            }
+          }
+          sections[i].Encode(blocks.data());
+        }
+
+        ChunkMeshScratch scratch;
+        ChunkNeighbors neighbors;
+        auto block_textures = _pRegistry->ctx().get<ResourceManager>().GetByID<BlockTextureArray>("block_textures"_hs);
+        const std::vector<uint16_t> face_layers = block_textures ? block_textures->faceLayers : std::vector<uint16_t>{};
+        size_t naive_triangles = 0;
+        size_t greedy_triangles = 0;
+
+        auto start = std::chrono::steady_clock::now();
+        for (const ChunkSection& section: sections)
+        {
+          BuildChunkMeshNaive(section, neighbors, face_layers, scratch);
+          naive_triangles += scratch.GetTriangleCount();
+        }
+        auto naive_end = std::chrono::steady_clock::now();
+        for (const ChunkSection& section: sections)
+        {
+          BuildChunkMesh(section, neighbors, face_layers, scratch);
+          greedy_triangles += scratch.GetTriangleCount();
+        }
+        auto greedy_end = std::chrono::steady_clock::now();
+
+        // les mêmes chunks sur tous les workers, via les slots et la file de ChunkMeshScheduler
+        ChunkMeshScheduler mesh_scheduler(_pRegistry->ctx().find<JobSystem>());
+        size_t submitted = 0;
+        size_t completed = 0;
+        while (completed < sections.size())
+        {
+          while (submitted < sections.size() && mesh_scheduler.Submit(ChunkCoord{ (int)submitted, 0, 0 }, submitted + 1, sections[submitted], neighbors, face_layers, false)) submitted++;
+          mesh_scheduler.WaitAll(); // le thread principal meshe aussi pendant l'attente
+          while (ChunkMeshJob* pJob = mesh_scheduler.PopCompleted())
+          {
+            mesh_scheduler.Release(pJob);
+            completed++;
+          }
+        }
+        auto parallel_end = std::chrono::steady_clock::now();
+        const double parallel_ms = std::chrono::duration<double, std::milli>(parallel_end - greedy_end).count();
+
+        dispatcher.enqueue(DevConsoleMessageEvent{
+          .level = DebugLevel::INFO,
+          .buffer = "[bench_chunk_mesh] " + std::to_string(count) + " chunks"
+            + "\nnaive: " + std::to_string(naive_triangles / count) + " triangles/chunk, "
+            + std::to_string(std::chrono::duration<double, std::milli>(naive_end - start).count() / count) + " ms/chunk"
+            + "\ngreedy: " + std::to_string(greedy_triangles / count) + " triangles/chunk, "
+            + std::to_string(std::chrono::duration<double, std::milli>(greedy_end - naive_end).count() / count) + " ms/chunk"
+            + "\ngreedy on " + std::to_string(mesh_scheduler.GetWorkerCount()) + " threads: "
+            + std::to_string(parallel_ms / count) + " ms/chunk, " + std::to_string((int)(count * 1000.0 / parallel_ms)) + " chunks/s"
+        });
+      }
+      catch (const std::out_of_range& e) 
+      {
+        dispatcher.enqueue(DevConsoleMessageEvent{
+          .level = DebugLevel::WARNING,
+          .buffer = helper,
+        });
+        std::cerr << e.what() << "\n";
+      }
+      catch (const std::invalid_argument& e)
+      {
+        dispatcher.enqueue(DevConsoleMessageEvent{
+          .level = DebugLevel::WARNING,
+          .buffer = helper,
+        });
+        std::cerr << e.what() << "\n";
+      }
+    }
+  });
+
+  // colonnes de chunks générées autour de la caméra, ajoutées au VoxelWorld
+  helper = "$generate_terrain <radius> --> 'radius' must be a positive integer (in chunks)";
+  command_manager.Register(Command{
+    .name = "generate_terrain",
+    .helper = helper,
+    .func = [this, &dispatcher, helper](auto& args)
+    {
+      try {
+        if (args.size() != 1) throw std::out_of_range("[Engine] $generate_terrain needs only 1 arg");
+
+        size_t last_valid_index;
+        int radius = std::stoi(args[0], &last_valid_index);
+        if (last_valid_index != args[0].size() || radius <= 0) throw std::invalid_argument("[Engine] args[0] must be a positive integer");
+
+        entt::entity camera_entity = GetActiveCamera(*_pRegistry);
+        glm::vec3 viewer_position = camera_entity != entt::null ? glm::vec3(_pRegistry->get<WorldMatrix>(camera_entity).matrix[3]) : glm::vec3(0.0f);
+        const ChunkCoord center = GetChunkCoord(glm::ivec3(glm::floor(viewer_position)));
+
+        std::vector<glm::ivec2> columns;
+        for (int z = -radius; z <= radius; z++)
+          for (int x = -radius; x <= radius; x++) columns.push_back(glm::ivec2(center.x + x, center.z + z));
+
+        TerrainGenerator generator;
+        std::vector<std::vector<GeneratedChunk>> chunks;
+        auto start = std::chrono::steady_clock::now();
+        generator.GenerateColumns(_pRegistry->ctx().find<JobSystem>(), columns, chunks);
+        const double generate_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        size_t chunk_count = 0;
+        for (const auto& column_chunks: chunks)
+        {
+          for (const GeneratedChunk& chunk: column_chunks) _pWorld->SetChunk(chunk.coord, chunk.section);
+          chunk_count += column_chunks.size();
+        }
+
+        dispatcher.enqueue(DevConsoleMessageEvent{
+          .level = DebugLevel::INFO,
+          .buffer = "[generate_terrain] " + std::to_string(chunk_count) + " chunks in " + std::to_string(generate_ms) + " ms"
+        });
+      }
+      catch (const std::out_of_range& e) 
+      {
+        dispatcher.enqueue(DevConsoleMessageEvent{
+          .level = DebugLevel::WARNING,
+          .buffer = helper,
+        });
+        std::cerr << e.what() << "\n";
+      }
+      catch (const std::invalid_argument& e)
+      {
+        dispatcher.enqueue(DevConsoleMessageEvent{
+          .level = DebugLevel::WARNING,
+          .buffer = helper,
+        });
+        std::cerr << e.what() << "\n";
+      }
+    }
+  });
+
+
+  // rayon de streaming des colonnes de chunks autour de la caméra, 0 décharge tout
+  helper = "$stream_radius <radius> --> 'radius' must be a positive integer or 0 (in chunks)";
+  command_manager.Register(Command{
+    .name = "stream_radius",
+    .helper = helper,
+    .func = [this, &dispatcher, helper](auto& args)
+    {
+      try {
+        if (args.size() != 1) throw std::out_of_range("[Engine] $stream_radius needs only 1 arg");
+
+        size_t last_valid_index;
+        int radius = std::stoi(args[0], &last_valid_index);
+        if (last_valid_index != args[0].size() || radius < 0) throw std::invalid_argument("[Engine] args[0] must be a positive integer or 0");
+
+        ChunkStreamer& streamer = _pWorld->GetStreamer();
+        streamer.SetRadius(radius);
+
+        dispatcher.enqueue(DevConsoleMessageEvent{
+          .level = DebugLevel::INFO,
+          .buffer = "[stream_radius] " + std::to_string(radius) + " chunks, " + std::to_string(streamer.GetColumnCount()) + " columns loaded or loading, "
+            + std::to_string(streamer.GetCancelledCount()) + " requests cancelled so far"
+        });
+      }
+      catch (const std::out_of_range& e) 
+      {
+        dispatcher.enqueue(DevConsoleMessageEvent{
+          .level = DebugLevel::WARNING,
+          .buffer = helper,
+        });
+        std::cerr << e.what() << "\n";
+      }
+      catch (const std::invalid_argument& e)
+      {
+        dispatcher.enqueue(DevConsoleMessageEvent{
+          .level = DebugLevel::WARNING,
+          .buffer = helper,
+        });
+        std::cerr << e.what() << "\n";
+      }
+    }
+  });
+
+
+  // anneaux de niveaux de détail au delà du rayon de streaming, 0 n'affiche que les chunks pleine résolution
+  helper = "$lod_levels <count> --> 'count' must be an integer between 0 and " + std::to_string(CHUNK_LOD_MAX_LEVELS);
+  command_manager.Register(Command{
+    .name = "lod_levels",
+    .helper = helper,
+    .func = [this, &dispatcher, helper](auto& args)
+    {
+      try {
+        if (args.size() != 1) throw std::out_of_range("[Engine] $lod_levels needs only 1 arg");
+
+        size_t last_valid_index;
+        int level_count = std::stoi(args[0], &last_valid_index);
+        if (last_valid_index != args[0].size() || level_count < 0 || level_count > CHUNK_LOD_MAX_LEVELS) throw std::invalid_argument("[Engine] args[0] must be an integer between 0 and " + std::to_string(CHUNK_LOD_MAX_LEVELS));
+
+        ChunkLodClipmap& lod = _pWorld->GetLod();
+        lod.SetLevelCount(level_count);
+
+        dispatcher.enqueue(DevConsoleMessageEvent{
+          .level = DebugLevel::INFO,
+          .buffer = "[lod_levels] " + std::to_string(level_count) + " levels, view distance " + std::to_string(_pWorld->GetStreamer().GetRadius() << level_count) + " chunks, "
+            + std::to_string(lod.GetNodeCount()) + " nodes and " + std::to_string(lod.GetTriangleCount()) + " triangles before the change"
+        });
+      }
+      catch (const std::out_of_range& e) 
+      {
+        dispatcher.enqueue(DevConsoleMessageEvent{
+          .level = DebugLevel::WARNING,
+          .buffer = helper,
+        });
+        std::cerr << e.what() << "\n";
+      }
+      catch (const std::invalid_argument& e)
+      {
+        dispatcher.enqueue(DevConsoleMessageEvent{
+          .level = DebugLevel::WARNING,
+          .buffer = helper,
+        });
+        std::cerr << e.what() << "\n";
+      }
+    }
+  });
+
+
+  // génération de colonnes de chunks : bruit SIMD contre scalaire, puis chunks/s sur un thread et sur tous les workers
+  helper = "$bench_terrain <count> --> 'count' must be a positive integer (columns of chunks)";
+  command_manager.Register(Command{
+    .name = "bench_terrain",
+    .helper = helper,
+    .func = [this, &dispatcher, helper](auto& args)
+    {
+      try {
+        if (args.size() != 1) throw std::out_of_range("[Engine] $bench_terrain needs only 1 arg");
+
+        size_t last_valid_index;
+        int count = std::stoi(args[0], &last_valid_index);
+        if (last_valid_index != args[0].size() || count <= 0) throw std::invalid_argument("[Engine] args[0] must be a positive integer");
+
+        TerrainGenerator generator;
+        const int side = (int)std::ceil(std::sqrt((double)count));
+        std::vector<glm::ivec2> columns(count);
+        for (int i = 0; i < count; i++) columns[i] = glm::ivec2(i % side - side / 2, i / side - side / 2);
+
+        // le bruit seul, sur les colonnes de blocs du premier chunk de chaque colonne
+        std::vector<float> positions_x(CHUNK_AREA);
+        std::vector<float> positions_z(CHUNK_AREA);
+        std::vector<float> simd_noise(CHUNK_AREA);
+        std::vector<float> scalar_noise(CHUNK_AREA);
+        double simd_ms = 0.0;
+        double scalar_ms = 0.0;
+        size_t mismatches = 0;
+        for (const glm::ivec2& column: columns)
+        {
+          for (int i = 0; i < CHUNK_AREA; i++)
+          {
+            positions_x[i] = (float)(column.x * CHUNK_SIZE + i % CHUNK_SIZE);
+            positions_z[i] = (float)(column.y * CHUNK_SIZE + i / CHUNK_SIZE);
+          }
+
+          auto start = std::chrono::steady_clock::now();
+          WarpedNoise2D(generator.GetSettings().noise, positions_x.data(), positions_z.data(), simd_noise.data(), CHUNK_AREA);
+          auto simd_end = std::chrono::steady_clock::now();
+          WarpedNoise2DScalar(generator.GetSettings().noise, positions_x.data(), positions_z.data(), scalar_noise.data(), CHUNK_AREA);
+          auto scalar_end = std::chrono::steady_clock::now();
+
+          simd_ms += std::chrono::duration<double, std::milli>(simd_end - start).count();
+          scalar_ms += std::chrono::duration<double, std::milli>(scalar_end - simd_end).count();
+          mismatches += std::memcmp(simd_noise.data(), scalar_noise.data(), CHUNK_AREA * sizeof(float)) != 0;
+        }
+
+        std::vector<std::vector<GeneratedChunk>> serial_chunks;
+        auto start = std::chrono::steady_clock::now();
+        generator.GenerateColumns(nullptr, columns, serial_chunks);
+        auto serial_end = std::chrono::steady_clock::now();
+
+        JobSystem* pJobs = _pRegistry->ctx().find<JobSystem>();
+        std::vector<std::vector<GeneratedChunk>> parallel_chunks;
+        generator.GenerateColumns(pJobs, columns, parallel_chunks);
+        auto parallel_end = std::chrono::steady_clock::now();
+
+        // déterminisme : mêmes blocs quel que soit le découpage entre les threads
+        size_t chunk_count = 0;
+        size_t different_chunks = 0;
+        std::vector<uint16_t> serial_blocks(CHUNK_VOLUME);
+        std::vector<uint16_t> parallel_blocks(CHUNK_VOLUME);
+        for (int i = 0; i < count; i++)
+        {
+          chunk_count += serial_chunks[i].size();
+          if (serial_chunks[i].size() != parallel_chunks[i].size())
+          {
+            different_chunks += serial_chunks[i].size();
+            continue;
+          }
+          for (size_t j = 0; j < serial_chunks[i].size(); j++)
+          {
+            serial_chunks[i][j].section.Decode(serial_blocks.data());
+            parallel_chunks[i][j].section.Decode(parallel_blocks.data());
+            different_chunks += std::memcmp(serial_blocks.data(), parallel_blocks.data(), CHUNK_VOLUME * sizeof(uint16_t)) != 0;
+          }
+        }
+
+        const double serial_ms = std::chrono::duration<double, std::milli>(serial_end - start).count();
+        const double parallel_ms = std::chrono::duration<double, std::milli>(parallel_end - serial_end).count();
+        const uint32_t thread_count = pJobs ? pJobs->GetThreadCount() : 1;
+        const double parallel_rate = chunk_count * 1000.0 / parallel_ms;
+
+        dispatcher.enqueue(DevConsoleMessageEvent{
+          .level = DebugLevel::INFO,
+          .buffer = "[bench_terrain] " + std::to_string(count) + " columns, " + std::to_string(chunk_count) + " chunks"
+            + "\nnoise " + GetNoiseInstructionSet() + ": " + std::to_string(simd_ms * 1000.0 / count) + " us/column, scalar: "
+            + std::to_string(scalar_ms * 1000.0 / count) + " us/column, " + std::to_string(mismatches) + " mismatches"
+            + "\n1 thread: " + std::to_string((int)(chunk_count * 1000.0 / serial_ms)) + " chunks/s/core"
+            + "\n" + std::to_string(thread_count) + " threads: " + std::to_string((int)parallel_rate) + " chunks/s, "
+            + std::to_string((int)(parallel_rate / thread_count)) + " chunks/s/core, " + std::to_string(different_chunks) + " chunks differ from 1 thread"
+        });
+      }
+      catch (const std::out_of_range& e) 
+      {
+        dispatcher.enqueue(DevConsoleMessageEvent{
+          .level = DebugLevel::WARNING,
+          .buffer = helper,
+        });
+        std::cerr << e.what() << "\n";
+      }
+      catch (const std::invalid_argument& e)
+      {
+        dispatcher.enqueue(DevConsoleMessageEvent{
+          .level = DebugLevel::WARNING,
+          .buffer = helper,
+        });
+        std::cerr << e.what() << "\n";
+      }
+    }
+  });
+
+  // culling du terrain par ses OccluderBox, sans GPU : colonnes générées autour de l'origine, meshées et testées comme par le Renderer
+  // points de vue à hauteur d'yeux sur 3x3 positions, 8 directions, à l'horizontale puis 20° vers le bas
+  helper = "$bench_terrain_occlusion <radius> --> 'radius' must be a positive integer (in chunks)";
+  command_manager.Register(Command{
+    .name = "bench_terrain_occlusion",
+    .helper = helper,
+    .func = [this, &dispatcher, helper](auto& args)
+    {
+      try {
+        if (args.size() != 1) throw std::out_of_range("[Engine] $bench_terrain_occlusion needs only 1 arg");
+
+        size_t last_valid_index;
+        int radius = std::stoi(args[0], &last_valid_index);
+        if (last_valid_index != args[0].size() || radius <= 0) throw std::invalid_argument("[Engine] args[0] must be a positive integer");
+
+        std::vector<glm::ivec2> columns;
+        for (int z = -radius; z <= radius; z++)
+          for (int x = -radius; x <= radius; x++) columns.push_back(glm::ivec2(x, z));
+
+        JobSystem* pJobs = _pRegistry->ctx().find<JobSystem>();
+        TerrainGenerator generator;
+        std::vector<std::vector<GeneratedChunk>> chunks;
+        generator.GenerateColumns(pJobs, columns, chunks);
+
+        std::unordered_map<ChunkCoord, const ChunkSection*, ChunkCoordHash> sections;
+        for (const auto& column_chunks: chunks)
+          for (const GeneratedChunk& chunk: column_chunks) sections[chunk.coord] = &chunk.section;
+
+        // dans l'ordre de BlockFace
+        static constexpr int face_offsets[(size_t)BlockFace::COUNT][3] = {
+          { 1, 0, 0 }, { -1, 0, 0 }, { 0, 1, 0 }, { 0, -1, 0 }, { 0, 0, 1 }, { 0, 0, -1 }
+        };
+
+        ChunkMeshScratch scratch;
+        const std::vector<uint16_t> face_layers;
+        VisibilitySet set;
+        std::vector<size_t> triangles;
+        std::vector<OccluderBox> boxes;
+        for (const auto& [coord, pSection]: sections)
+        {
+          ChunkNeighbors neighbors;
+          for (size_t face = 0; face < (size_t)BlockFace::COUNT; face++)
+          {
+            auto it = sections.find(coord.Offset(face_offsets[face][0], face_offsets[face][1], face_offsets[face][2]));
+            neighbors.pSections[face] = it != sections.end() ? it->second : nullptr;
+          }
+
+          const glm::vec3 origin(coord.GetOrigin());
+          Bounds box;
+          if (FindOccluderBox(*pSection, box)) boxes.push_back(OccluderBox{ origin + box.min, origin + box.max });
+
+          BuildChunkMesh(*pSection, neighbors, face_layers, scratch);
+          if (scratch.indices.empty()) continue;
+          const Bounds bounds = ComputeBounds(scratch.vertices);
+          set.Set((uint32_t)triangles.size(), origin + bounds.min, origin + bounds.max);
+          triangles.push_back(scratch.GetTriangleCount());
+        }
+
+        const Camera camera{};
+        const glm::mat4 projection = GetProjectionMatrix(camera, 16.0f / 9.0f);
+        OcclusionBuffer occlusion;
+        std::vector<uint32_t> in_frustum;
+        std::vector<uint32_t> visible;
+        size_t frustum_chunks = 0;
+        size_t frustum_triangles = 0;
+        size_t visible_chunks = 0;
+        size_t visible_triangles = 0;
+        size_t occluder_triangles = 0;
+        double occlusion_ms = 0.0;
+        int view_count = 0;
+
+        const int spot_step = std::max(1, radius / 2);
+        for (int spot_z = -spot_step; spot_z <= spot_step; spot_z += spot_step)
+        {
+          for (int spot_x = -spot_step; spot_x <= spot_step; spot_x += spot_step)
+          {
+            int32_t heights[CHUNK_AREA];
+            generator.GenerateHeights((float)(spot_x * CHUNK_SIZE), (float)(spot_z * CHUNK_SIZE), 1.0f, heights);
+            const glm::vec3 eye((float)(spot_x * CHUNK_SIZE) + 0.5f, (float)heights[0] + 2.7f, (float)(spot_z * CHUNK_SIZE) + 0.5f);
+
+            for (int heading = 0; heading < 8; heading++)
+            {
+              for (float pitch: { 0.0f, -0.35f })
+              {
+                const float yaw = (float)heading * glm::quarter_pi<float>();
+                const glm::vec3 forward(std::cos(pitch) * std::cos(yaw), std::sin(pitch), std::cos(pitch) * std::sin(yaw));
+                const glm::mat4 view_projection = projection * glm::lookAt(eye, eye + forward, glm::vec3(0.0f, 1.0f, 0.0f));
+
+                set.Cull(ExtractFrustum(view_projection), in_frustum);
+
+                // même sélection et même rasterisation que Renderer::rasterizeOccluders
+                auto start = std::chrono::steady_clock::now();
+                occlusion.Begin(view_projection);
+                for (const OccluderBox& box: boxes)
+                {
+                  if (IsOccluderBoxUseful(box, eye)) occlusion.AddOccluderBox(box.min, box.max);
+                }
+                visible = in_frustum;
+                if (occlusion.GetTriangleCount() > 0)
+                {
+                  occlusion.Rasterize(pJobs);
+                  set.CullOccluded(occlusion, visible);
+                }
+                occlusion_ms += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+                occluder_triangles += occlusion.GetTriangleCount();
+                frustum_chunks += in_frustum.size();
+                visible_chunks += visible.size();
+                for (uint32_t id: in_frustum) frustum_triangles += triangles[id];
+                for (uint32_t id: visible) visible_triangles += triangles[id];
+                view_count++;
+              }
+            }
+          }
+        }
+
+        dispatcher.enqueue(DevConsoleMessageEvent{
+          .level = DebugLevel::INFO,
+          .buffer = "[bench_terrain_occlusion] " + std::to_string(sections.size()) + " sections, " + std::to_string(triangles.size()) + " meshed, "
+            + std::to_string(boxes.size()) + " occluder boxes, " + std::to_string(view_count) + " views"
+            + "\nin frustum: " + std::to_string(frustum_chunks / view_count) + " chunks, " + std::to_string(frustum_triangles / view_count) + " triangles"
+            + "\nvisible: " + std::to_string(visible_chunks / view_count) + " chunks, " + std::to_string(visible_triangles / view_count) + " triangles"
+            + "\noccluders: " + std::to_string(occluder_triangles / view_count) + " triangles, " + std::to_string(occlusion_ms / view_count) + " ms/view"
+        });
+      }
+      catch (const std::out_of_range& e) 
+      {
+        dispatcher.enqueue(DevConsoleMessageEvent{
+          .level = DebugLevel::WARNING,
+          .buffer = helper,
+        });
+        std::cerr << e.what() << "\n";
+      }
+      catch (const std::invalid_argument& e)
+      {
+        dispatcher.enqueue(DevConsoleMessageEvent{
+          .level = DebugLevel::WARNING,
+          .buffer = helper,
+        });
+        std::cerr << e.what() << "\n";
+      }
+    }
+  });
 }
 
 
@@ -268,6 +1099,10 @@ void Engine::registerComponents()
   EditorComponent<Text>::Register();
   EditorComponent<UINode>::Register();
   EditorComponent<TextMesh>::Register();
+  EditorComponent<Camera>::Register();
+  EditorComponent<Orientation>::Register();
+  EditorComponent<Parent>::Register();
+  EditorComponent<MeshInstance>::Register();
 }
 
 
@@ -288,7 +1123,7 @@ void Engine::onGameStateChange(const GameStateChangeEvent& e)
   {
   case GameState::IN_GAME:
     std::cout << "IN_GAME\n";
-    SDL_StopTextInput(_pWindow->GetNativeWindow());
+    if (_pWindow) SDL_StopTextInput(_pWindow->GetNativeWindow());
   break;
 
   case GameState::EDITOR:
@@ -297,7 +1132,37 @@ void Engine::onGameStateChange(const GameStateChangeEvent& e)
 
   case GameState::CONSOLE:
     std::cout << "CONSOLE\n";
-    SDL_StartTextInput(_pWindow->GetNativeWindow());
+    if (_pWindow) SDL_StartTextInput(_pWindow->GetNativeWindow());
   break;
   }
+}
+
+
+void Engine::onSaveWorld(const SaveWorldEvent& e)
+{
+  auto& dispatcher = _pRegistry->ctx().get<entt::dispatcher>();
+
+  auto start = std::chrono::steady_clock::now();
+  size_t saved = _pWorld->Save();
+  const double save_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+  dispatcher.enqueue(DevConsoleMessageEvent{
+    .level = DebugLevel::INFO,
+    .buffer = "Saved " + std::to_string(saved) + " chunk(s) in " + std::to_string(save_ms) + " ms"
+  });
+}
+
+
+void Engine::onLoadWorld(const LoadWorldEvent& e)
+{
+  auto& dispatcher = _pRegistry->ctx().get<entt::dispatcher>();
+
+  auto start = std::chrono::steady_clock::now();
+  size_t loaded = _pWorld->Load();
+  const double load_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+  dispatcher.enqueue(DevConsoleMessageEvent{
+    .level = DebugLevel::INFO,
+    .buffer = "Loaded " + std::to_string(loaded) + " chunk(s) in " + std::to_string(load_ms) + " ms"
+  });
 }
\ No newline at end of file
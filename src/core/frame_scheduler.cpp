@@ -0,0 +1,209 @@
+#include "core/frame_scheduler.h"
+
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include <SDL3/SDL_timer.h>
+
+#include "core/command_manager.h"
+#include "core/command.h"
+#include "events/dev_console_message_event.h"
+
+
+FrameScheduler::FrameScheduler(entt::registry* registry)
+  : _pRegistry(registry),
+    _frameStart(Clock::now()),
+    _tickDelta(1.0 / DEFAULT_TICK_RATE),
+    _accumulator(0.0),
+    _tickIndex(0),
+    _ticksThisFrame(0),
+    _maxFrameRate(0.0),
+    _sleepEstimate(0.005),
+    _sleepMean(0.005),
+    _sleepM2(0.0),
+    _sleepCount(1)
+{
+  registerCommands();
+}
+
+
+FrameScheduler::~FrameScheduler() {}
+
+
+double FrameScheduler::BeginFrame()
+{
+  Clock::time_point now = Clock::now();
+  double delta_time = std::chrono::duration<double>(now - _frameStart).count();
+  _frameStart = now;
+
+  delta_time = std::min(delta_time, MAX_FRAME_DELTA);
+  _accumulator += delta_time;
+  _ticksThisFrame = 0;
+
+  return delta_time;
+}
+
+
+bool FrameScheduler::Tick()
+{
+  if (_accumulator < _tickDelta) return false;
+
+  // trop de retard : on abandonne le temps restant plutôt que d'enchainer les ticks frame après frame
+  if (_ticksThisFrame >= MAX_TICKS_PER_FRAME)
+  {
+    _accumulator = std::fmod(_accumulator, _tickDelta);
+    return false;
+  }
+
+  _accumulator -= _tickDelta;
+  _ticksThisFrame++;
+  _tickIndex++;
+  return true;
+}
+
+
+void FrameScheduler::WaitForNextFrame(double targetFrameRate)
+{
+  if (targetFrameRate <= 0.0) return;
+
+  Clock::time_point deadline = _frameStart + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / targetFrameRate));
+
+  while (true)
+  {
+    Clock::time_point now = Clock::now();
+    double remaining = std::chrono::duration<double>(deadline - now).count();
+    if (remaining <= 0.0) return;
+
+    if (remaining > _sleepEstimate)
+    {
+      // SDL utilise un timer haute résolution quand l'OS en a un, un sleep de 1 ms reste quand même imprécis
+      SDL_DelayNS(1000000);
+      updateSleepEstimate(std::chrono::duration<double>(Clock::now() - now).count());
+    }
+    else
+    {
+      // les dernières fractions de milliseconde en attente active
+      std::this_thread::yield();
+    }
+  }
+}
+
+
+double FrameScheduler::GetTargetFrameRate(const ScreenInfo& screenInfo, GameState state) const
+{
+  if (screenInfo.isMinimized) return MINIMIZED_FRAME_RATE;
+  if (!screenInfo.isFocused) return BACKGROUND_FRAME_RATE;
+
+  if (state != GameState::IN_GAME)
+    return _maxFrameRate > 0.0 ? std::min(_maxFrameRate, MENU_FRAME_RATE) : MENU_FRAME_RATE;
+
+  return _maxFrameRate;
+}
+
+
+void FrameScheduler::SetTickRate(double tickRate)
+{
+  _tickDelta = 1.0 / tickRate;
+  _accumulator = std::min(_accumulator, _tickDelta);
+}
+
+
+void FrameScheduler::updateSleepEstimate(double observed)
+{
+  // Welford, remis à zéro régulièrement pour suivre les changements de charge de la machine
+  if (_sleepCount > 1000)
+  {
+    _sleepMean = _sleepEstimate;
+    _sleepM2 = 0.0;
+    _sleepCount = 1;
+  }
+
+  _sleepCount++;
+  double delta = observed - _sleepMean;
+  _sleepMean += delta / (double)_sleepCount;
+  _sleepM2 += delta * (observed - _sleepMean);
+
+  double deviation = std::sqrt(_sleepM2 / (double)(_sleepCount - 1));
+  _sleepEstimate = _sleepMean + deviation;
+}
+
+
+void FrameScheduler::registerCommands()
+{
+  auto& command_manager = _pRegistry->ctx().get<CommandManager>();
+  auto& dispatcher = _pRegistry->ctx().get<entt::dispatcher>();
+
+  std::string helper = "$set_tick_rate <hz> --> 'hz' must be an integer between 1 and 1000";
+  command_manager.Register(Command{
+    .name = "set_tick_rate",
+    .helper = helper,
+    .func = [this, &dispatcher, helper](auto& args)
+    {
+      try {
+        if (args.size() != 1) throw std::out_of_range("[Engine] $set_tick_rate needs only 1 arg");
+
+        size_t last_valid_index;
+        int tick_rate = std::stoi(args[0], &last_valid_index);
+        if (last_valid_index != args[0].size() || tick_rate < 1 || tick_rate > 1000) throw std::invalid_argument("[Engine] args[0] must be between 1 and 1000 included");
+
+        SetTickRate((double)tick_rate);
+      }
+      catch (const std::out_of_range& e)
+      {
+        dispatcher.enqueue(DevConsoleMessageEvent{
+          .level = DebugLevel::WARNING,
+          .buffer = helper,
+        });
+        std::cerr << e.what() << "\n";
+      }
+      catch (const std::invalid_argument& e)
+      {
+        dispatcher.enqueue(DevConsoleMessageEvent{
+          .level = DebugLevel::WARNING,
+          .buffer = helper,
+        });
+        std::cerr << e.what() << "\n";
+      }
+    }
+  });
+
+
+  helper = "$set_max_fps <fps> --> 'fps' must be a positive integer, 0 to disable the limit";
+  command_manager.Register(Command{
+    .name = "set_max_fps",
+    .helper = helper,
+    .func = [this, &dispatcher, helper](auto& args)
+    {
+      try {
+        if (args.size() != 1) throw std::out_of_range("[Engine] $set_max_fps needs only 1 arg");
+
+        size_t last_valid_index;
+        int frame_rate = std::stoi(args[0], &last_valid_index);
+        if (last_valid_index != args[0].size() || frame_rate < 0) throw std::invalid_argument("[Engine] args[0] must be a positive integer");
+
+        SetMaxFrameRate((double)frame_rate);
+      }
+      catch (const std::out_of_range& e)
+      {
+        dispatcher.enqueue(DevConsoleMessageEvent{
+          .level = DebugLevel::WARNING,
+          .buffer = helper,
+        });
+        std::cerr << e.what() << "\n";
+      }
+      catch (const std::invalid_argument& e)
+      {
+        dispatcher.enqueue(DevConsoleMessageEvent{
+          .level = DebugLevel::WARNING,
+          .buffer = helper,
+        });
+        std::cerr << e.what() << "\n";
+      }
+    }
+  });
+}
\ No newline at end of file
@@ -0,0 +1,66 @@
+#include "core/job_system.h"
+
+
+#include <algorithm>
+
+#include "core/profiler.h"
+
+
+JobSystem::JobSystem(uint32_t threadCount)
+{
+  enki::TaskSchedulerConfig config;
+  if (threadCount > 0) config.numTaskThreadsToCreate = threadCount - 1; // le thread qui initialise est le thread 0
+  _scheduler.Initialize(config);
+}
+
+
+// les tâches épinglées pas encore exécutées doivent quitter le scheduler avant d'être libérées
+JobSystem::~JobSystem()
+{
+  _scheduler.WaitforAllAndShutdown();
+}
+
+
+void JobSystem::RunOnMainThread(std::function<void()> function)
+{
+  auto task = std::make_unique<enki::LambdaPinnedTask>(0, std::move(function));
+
+  // ajoutée au scheduler sous le verrou : avant AddPinnedTask la tâche passe pour terminée et RunPinnedTasks la libérerait
+  std::lock_guard<std::mutex> lock(_pinnedMutex);
+  _scheduler.AddPinnedTask(task.get());
+  _pinnedTasks.push_back(std::move(task));
+}
+
+
+void JobSystem::RunPinnedTasks()
+{
+  _scheduler.RunPinnedTasks();
+
+  std::lock_guard<std::mutex> lock(_pinnedMutex);
+  std::erase_if(_pinnedTasks, [](const std::unique_ptr<enki::LambdaPinnedTask>& task) { return task->GetIsComplete(); });
+}
+
+
+void JobSystem::FlushTimings(Profiler& profiler)
+{
+  std::lock_guard<std::mutex> lock(_timingMutex);
+  for (auto& [name, timing]: _timings)
+  {
+    if (timing.calls == 0) continue;
+
+    profiler.AddCpuSample("Job " + name, timing.wallMs);
+    profiler.AddCpuSample("Job " + name + " busy", timing.busyMs);
+    timing = JobTiming{};
+  }
+}
+
+
+void JobSystem::recordTiming(const char* name, float wallMs, float busyMs, uint32_t partitions)
+{
+  std::lock_guard<std::mutex> lock(_timingMutex);
+  JobTiming& timing = _timings[name];
+  timing.wallMs += wallMs;
+  timing.busyMs += busyMs;
+  timing.calls++;
+  timing.partitions += partitions;
+}
\ No newline at end of file
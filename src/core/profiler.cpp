@@ -0,0 +1,356 @@
+#include "core/profiler.h"
+
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+#include <imgui/imgui.h>
+
+#include "core/command_manager.h"
+#include "events/dev_console_message_event.h"
+#include "graphics/render_backend.h"
+
+
+void ProfileTrack::Push(float ms)
+{
+  history[head] = ms;
+  head = (head + 1) % PROFILER_HISTORY_SIZE;
+  if (count < PROFILER_HISTORY_SIZE) count++;
+}
+
+
+float ProfileTrack::Last() const
+{
+  if (count == 0) return 0.0f;
+  return history[(head + PROFILER_HISTORY_SIZE - 1) % PROFILER_HISTORY_SIZE];
+}
+
+
+float ProfileTrack::Percentile(float p) const
+{
+  if (count == 0) return 0.0f;
+
+  std::array<float, PROFILER_HISTORY_SIZE> sorted;
+  std::copy_n(history.begin(), count, sorted.begin());
+
+  int index = std::clamp((int)(p * (float)(count - 1) + 0.5f), 0, count - 1);
+  std::nth_element(sorted.begin(), sorted.begin() + index, sorted.begin() + count);
+  return sorted[index];
+}
+
+
+Profiler::Profiler(entt::registry* registry)
+  : _pRegistry(registry),
+    _pBackend(nullptr),
+    _frameIndex(0),
+    _isOverlayOpen(false),
+    _pActiveGpuTimer(nullptr)
+{
+  // réservé d'avance pour que les scopes n'allouent rien pendant la frame
+  _openScopes.reserve(PROFILER_MAX_OPEN_SCOPES);
+  _cpuSamples.reserve(PROFILER_MAX_FRAME_SAMPLES);
+
+  registerCommands();
+}
+
+
+Profiler::~Profiler() {}
+
+
+void Profiler::SetBackend(RenderBackend* backend)
+{
+  // les requêtes appartiennent à l'ancien backend, on les détruit avant de changer
+  if (_pBackend)
+  {
+    for (auto& [name, timer]: _gpuTimers)
+    {
+      for (unsigned int query: timer.queries) _pBackend->DestroyTimerQuery(query);
+    }
+  }
+
+  _gpuTimers.clear();
+  _pActiveGpuTimer = nullptr;
+  _pBackend = backend;
+}
+
+
+void Profiler::BeginFrame(double deltaTime)
+{
+  _frameIndex++;
+  flushCpuSamples();
+  _tracks[getTrack("Frame", false)].Push((float)(deltaTime * 1000.0));
+
+  collectGpuResults();
+}
+
+
+void Profiler::BeginCpu(const char* name)
+{
+  _openScopes.push_back(CpuScope{ .name = name, .start = std::chrono::steady_clock::now() });
+}
+
+
+void Profiler::EndCpu(const char* name)
+{
+  auto now = std::chrono::steady_clock::now();
+
+  // les scopes sont presque toujours imbriqués, celui qu'on ferme est en haut de la pile
+  auto it = std::find_if(_openScopes.rbegin(), _openScopes.rend(),
+    [name](const CpuScope& scope) { return scope.name == name || std::strcmp(scope.name, name) == 0; });
+  if (it == _openScopes.rend()) return;
+
+  float ms = std::chrono::duration<float, std::milli>(now - it->start).count();
+  _cpuSamples.push_back(CpuSample{ .name = name, .ms = ms });
+  _openScopes.erase(std::next(it).base());
+}
+
+
+void Profiler::AddCpuSample(const std::string& name, float ms)
+{
+  _tracks[getTrack(name, false)].Push(ms);
+}
+
+
+void Profiler::BeginGpu(const char* name)
+{
+  _pActiveGpuTimer = nullptr;
+  if (!_pBackend) return;
+
+  auto it = _gpuTimers.find(name);
+  if (it == _gpuTimers.end())
+  {
+    GpuTimer timer;
+    for (auto& query: timer.queries) query = _pBackend->CreateTimerQuery();
+    timer.track = getTrack(name, true);
+    it = _gpuTimers.emplace(name, timer).first;
+  }
+
+  GpuTimer& timer = it->second;
+  timer.lastFrame = _frameIndex;
+  int slot = (int)(_frameIndex % PROFILER_QUERY_LATENCY);
+
+  // le GPU a plus de PROFILER_QUERY_LATENCY frames de retard, on saute la mesure plutôt que d'attendre
+  if (timer.pending[slot]) return;
+
+  _pBackend->BeginTimerQuery(timer.queries[slot]);
+  timer.pending[slot] = true;
+  _pActiveGpuTimer = &timer;
+}
+
+
+void Profiler::EndGpu()
+{
+  if (!_pActiveGpuTimer || !_pBackend) return;
+
+  _pBackend->EndTimerQuery();
+  _pActiveGpuTimer = nullptr;
+}
+
+
+ProfileStats Profiler::GetStats(const std::string& name, bool isGpu)
+{
+  flushCpuSamples();
+
+  const auto& tracks = isGpu ? _gpuTracks : _cpuTracks;
+  auto it = tracks.find(name);
+  if (it == tracks.end()) return ProfileStats{};
+
+  const ProfileTrack& track = _tracks[it->second];
+  return ProfileStats{
+    .last = track.Last(),
+    .p50 = track.Percentile(0.50f),
+    .p95 = track.Percentile(0.95f),
+    .p99 = track.Percentile(0.99f),
+  };
+}
+
+
+float Profiler::GetGpuFrameTime() const
+{
+  if (!_pBackend) return 0.0f;
+
+  // un scope qui n'est plus ouvert (passe désactivée) garderait sa dernière valeur pour toujours
+  float total = 0.0f;
+  for (const auto& [name, timer]: _gpuTimers)
+  {
+    if (timer.lastFrame + PROFILER_QUERY_LATENCY < _frameIndex) continue;
+    total += _tracks[timer.track].Last();
+  }
+  return total;
+}
+
+
+void Profiler::DisplayOverlay(bool* pOpen)
+{
+  if (!pOpen || !(*pOpen))
+    return;
+
+  ImGui::PushStyleColor(ImGuiCol_WindowBg, ImVec4(0.075f, 0.075f, 0.075f, 0.75f));
+  ImGui::PushStyleColor(ImGuiCol_TitleBg, ImVec4(0.02f, 0.02f, 0.02f, 0.75f));
+  ImGui::PushStyleColor(ImGuiCol_TitleBgActive, ImVec4(0.01f, 0.01f, 0.01f, 0.75f));
+
+  ImGui::PushStyleVar(ImGuiStyleVar_WindowRounding, 0.0f);
+  ImGui::PushStyleVar(ImGuiStyleVar_WindowBorderSize, 0.0f);
+
+  ImGui::SetNextWindowSize(ImVec2(420, 0), ImGuiCond_FirstUseEver);
+
+  if (ImGui::Begin("Frame Timings", pOpen, ImGuiWindowFlags_NoCollapse))
+  {
+    flushCpuSamples();
+
+    for (const auto& track: _tracks)
+    {
+      if (track.count == 0) continue;
+
+      ImGui::PushID(&track);
+
+      float p50 = track.Percentile(0.50f);
+      float p95 = track.Percentile(0.95f);
+      float p99 = track.Percentile(0.99f);
+
+      ImGui::Text("%s %s", track.isGpu ? "[GPU]" : "[CPU]", track.name.c_str());
+      ImGui::TextDisabled("last %.3f | p50 %.3f | p95 %.3f | p99 %.3f ms", track.Last(), p50, p95, p99);
+
+      // l'historique est circulaire, values_offset permet de l'afficher dans l'ordre
+      int offset = (track.count < PROFILER_HISTORY_SIZE) ? 0 : track.head;
+      ImGui::PlotLines("##history", track.history.data(), track.count, offset, nullptr, 0.0f, p99 * 1.25f + 0.001f, ImVec2(-1, 40));
+
+      ImGui::PopID();
+      ImGui::Separator();
+    }
+  }
+
+  ImGui::End();
+  ImGui::PopStyleVar(2);
+  ImGui::PopStyleColor(3);
+}
+
+
+int Profiler::getTrack(const std::string& name, bool isGpu)
+{
+  auto& tracks = isGpu ? _gpuTracks : _cpuTracks;
+  auto it = tracks.find(name);
+  if (it != tracks.end()) return it->second;
+
+  _tracks.push_back(ProfileTrack{ .name = name, .isGpu = isGpu });
+  int index = (int)_tracks.size() - 1;
+  tracks.emplace(name, index);
+  return index;
+}
+
+
+void Profiler::flushCpuSamples()
+{
+  for (const CpuSample& sample: _cpuSamples)
+  {
+    // la std::string n'est construite que la première fois qu'on croise ce pointeur
+    auto it = _cpuTracksByPointer.find(sample.name);
+    if (it == _cpuTracksByPointer.end())
+      it = _cpuTracksByPointer.emplace(sample.name, getTrack(sample.name, false)).first;
+
+    _tracks[it->second].Push(sample.ms);
+  }
+  _cpuSamples.clear();
+}
+
+
+void Profiler::collectGpuResults()
+{
+  if (!_pBackend) return;
+
+  for (auto& [name, timer]: _gpuTimers)
+  {
+    // de la plus ancienne à la plus récente pour garder l'historique dans l'ordre
+    for (int i = 1; i <= PROFILER_QUERY_LATENCY; i++)
+    {
+      int slot = (int)((_frameIndex + i) % PROFILER_QUERY_LATENCY);
+      if (!timer.pending[slot]) continue;
+
+      uint64_t nanoseconds;
+      if (!_pBackend->GetTimerQueryResult(timer.queries[slot], nanoseconds)) continue;
+
+      _tracks[timer.track].Push((float)((double)nanoseconds / 1000000.0));
+      timer.pending[slot] = false;
+    }
+  }
+}
+
+
+void Profiler::registerCommands()
+{
+  auto& command_manager = _pRegistry->ctx().get<CommandManager>();
+  auto& dispatcher = _pRegistry->ctx().get<entt::dispatcher>();
+
+  std::string helper = "$profiler <toggle> --> 'toggle' must be 0 or 1";
+  command_manager.Register(Command{
+    .name = "profiler",
+    .helper = helper,
+    .func = [this, &dispatcher, helper](auto& args)
+    {
+      try {
+        if (args.size() != 1) throw std::out_of_range("[Engine] $profiler needs only 1 arg");
+
+        size_t last_valid_index;
+        int toggle = std::stoi(args[0], &last_valid_index);
+        if (last_valid_index != args[0].size() || (toggle != 0 && toggle != 1)) throw std::invalid_argument("[Engine] args[0] must be 1 or 0");
+
+        _isOverlayOpen = (bool) toggle;
+      }
+      catch (const std::out_of_range& e)
+      {
+        dispatcher.enqueue(DevConsoleMessageEvent{
+          .level = DebugLevel::WARNING,
+          .buffer = helper,
+        });
+        std::cerr << e.what() << "\n";
+      }
+      catch (const std::invalid_argument& e)
+      {
+        dispatcher.enqueue(DevConsoleMessageEvent{
+          .level = DebugLevel::WARNING,
+          .buffer = helper,
+        });
+        std::cerr << e.what() << "\n";
+      }
+    }
+  });
+
+
+  helper = "$profiler_dump --> doesn't need args";
+  command_manager.Register(Command{
+    .name = "profiler_dump",
+    .helper = helper,
+    .func = [this, &dispatcher, helper](auto& args)
+    {
+      try
+      {
+        if (!args.empty())
+          throw std::out_of_range("[Engine] $profiler_dump doesn't accept args");
+
+        flushCpuSamples();
+        for (const auto& track: _tracks)
+        {
+          char line[256];
+          snprintf(line, sizeof(line), "%s %s: p50 %.3f | p95 %.3f | p99 %.3f ms",
+            track.isGpu ? "[GPU]" : "[CPU]", track.name.c_str(),
+            track.Percentile(0.50f), track.Percentile(0.95f), track.Percentile(0.99f));
+
+          dispatcher.enqueue(DevConsoleMessageEvent{
+            .level = DebugLevel::NONE,
+            .buffer = line,
+          });
+        }
+      }
+      catch (const std::out_of_range &e)
+      {
+        dispatcher.enqueue(DevConsoleMessageEvent{
+          .level = DebugLevel::WARNING,
+          .buffer = helper,
+        });
+        std::cerr << e.what() << "\n";
+      }
+    }
+  });
+}
\ No newline at end of file
@@ -18,7 +18,11 @@ using namespace entt::literals;
 #include "components/text.h"
 #include "components/text_mesh.h"
 #include "components/ui_node.h"
+#include "components/camera.h"
+#include "components/parent.h"
 #include "components/name.h"
+#include "events/load_world_event.h"
+#include "events/save_world_event.h"
 
 
 Scene::Scene(entt::registry* registry)
@@ -160,23 +164,10 @@ void Scene::DisplayGraph(bool* pOpen)
 
       ImGui::Separator();
 
-      if (ImGui::MenuItem("Save"))
-      {
-        dispatcher.enqueue<DevConsoleMessageEvent>(DevConsoleMessageEvent
-          {
-          .level = DebugLevel::INFO, 
-          .buffer = "Saving scene"
-        });
-      }
+      // les chunks vont dans les fichiers de région (voxel/region_file.h), c'est l'Engine qui possède le monde
+      if (ImGui::MenuItem("Save")) dispatcher.enqueue<SaveWorldEvent>(SaveWorldEvent{});
 
-      if (ImGui::MenuItem("Load"))
-      {
-        dispatcher.enqueue<DevConsoleMessageEvent>(DevConsoleMessageEvent
-          {
-          .level = DebugLevel::INFO, 
-          .buffer = "Loading scene"
-        });
-      }
+      if (ImGui::MenuItem("Load")) dispatcher.enqueue<LoadWorldEvent>(LoadWorldEvent{});
       ImGui::EndPopup();
     }
   }
@@ -288,6 +279,19 @@ void Scene::displayInspector()
         addComponent<UINode>();
       }
 
+      if (ImGui::MenuItem("Camera"))
+      {
+        if (_pRegistry->all_of<RectTransform>(_selectedEntity)) _pRegistry->remove<RectTransform>(_selectedEntity);
+        if (!_pRegistry->all_of<Transform>(_selectedEntity)) addComponent<Transform>(Transform{.scale = glm::vec3(1.0f)});
+        addComponent<Camera>();
+      }
+
+      if (ImGui::MenuItem("Parent"))
+      {
+        if (!_pRegistry->all_of<Transform>(_selectedEntity)) addComponent<Transform>(Transform{.scale = glm::vec3(1.0f)});
+        addComponent<Parent>();
+      }
+
       ImGui::EndPopup();
     }
   }
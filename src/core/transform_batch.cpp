@@ -0,0 +1,124 @@
+#include "core/transform_batch.h"
+
+
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <xmmintrin.h>
+#define VOXL_TRANSFORM_SSE
+#endif
+
+
+void TransformBatch::Clear()
+{
+  _px.clear(); _py.clear(); _pz.clear();
+  _qw.clear(); _qx.clear(); _qy.clear(); _qz.clear();
+  _sx.clear(); _sy.clear(); _sz.clear();
+}
+
+
+void TransformBatch::Reserve(size_t count)
+{
+  _px.reserve(count); _py.reserve(count); _pz.reserve(count);
+  _qw.reserve(count); _qx.reserve(count); _qy.reserve(count); _qz.reserve(count);
+  _sx.reserve(count); _sy.reserve(count); _sz.reserve(count);
+}
+
+
+void TransformBatch::Push(const glm::vec3& position, const glm::vec3& eulerDegrees, const glm::vec3& scale)
+{
+  // qx * qy * qz développé, équivalent à rotate(X) * rotate(Y) * rotate(Z)
+  glm::vec3 half = glm::radians(eulerDegrees) * 0.5f;
+  float cx = std::cos(half.x), sx = std::sin(half.x);
+  float cy = std::cos(half.y), sy = std::sin(half.y);
+  float cz = std::cos(half.z), sz = std::sin(half.z);
+
+  glm::quat orientation;
+  orientation.w = cx * cy * cz - sx * sy * sz;
+  orientation.x = sx * cy * cz + cx * sy * sz;
+  orientation.y = cx * sy * cz - sx * cy * sz;
+  orientation.z = cx * cy * sz + sx * sy * cz;
+
+  Push(position, orientation, scale);
+}
+
+
+void TransformBatch::Push(const glm::vec3& position, const glm::quat& orientation, const glm::vec3& scale)
+{
+  _px.push_back(position.x); _py.push_back(position.y); _pz.push_back(position.z);
+  _qw.push_back(orientation.w); _qx.push_back(orientation.x); _qy.push_back(orientation.y); _qz.push_back(orientation.z);
+  _sx.push_back(scale.x); _sy.push_back(scale.y); _sz.push_back(scale.z);
+}
+
+
+void TransformBatch::Compose(glm::mat4* out) const
+{
+  const size_t count = Size();
+  size_t i = 0;
+
+#if defined(VOXL_TRANSFORM_SSE)
+  const __m128 one = _mm_set1_ps(1.0f);
+  const __m128 two = _mm_set1_ps(2.0f);
+  const __m128 zero = _mm_setzero_ps();
+
+  for (; i + 4 <= count; i += 4)
+  {
+    __m128 w = _mm_loadu_ps(&_qw[i]);
+    __m128 x = _mm_loadu_ps(&_qx[i]);
+    __m128 y = _mm_loadu_ps(&_qy[i]);
+    __m128 z = _mm_loadu_ps(&_qz[i]);
+
+    __m128 xx = _mm_mul_ps(x, x), yy = _mm_mul_ps(y, y), zz = _mm_mul_ps(z, z);
+    __m128 xy = _mm_mul_ps(x, y), xz = _mm_mul_ps(x, z), yz = _mm_mul_ps(y, z);
+    __m128 wx = _mm_mul_ps(w, x), wy = _mm_mul_ps(w, y), wz = _mm_mul_ps(w, z);
+
+    __m128 sx = _mm_loadu_ps(&_sx[i]);
+    __m128 sy = _mm_loadu_ps(&_sy[i]);
+    __m128 sz = _mm_loadu_ps(&_sz[i]);
+
+    // une colonne de matrice par groupe de 4 registres (une ligne chacun, 4 entités par registre)
+    __m128 columns[4][4];
+    columns[0][0] = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(yy, zz))), sx);
+    columns[0][1] = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xy, wz)), sx);
+    columns[0][2] = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xz, wy)), sx);
+    columns[0][3] = zero;
+
+    columns[1][0] = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xy, wz)), sy);
+    columns[1][1] = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, zz))), sy);
+    columns[1][2] = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(yz, wx)), sy);
+    columns[1][3] = zero;
+
+    columns[2][0] = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xz, wy)), sz);
+    columns[2][1] = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(yz, wx)), sz);
+    columns[2][2] = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, yy))), sz);
+    columns[2][3] = zero;
+
+    columns[3][0] = _mm_loadu_ps(&_px[i]);
+    columns[3][1] = _mm_loadu_ps(&_py[i]);
+    columns[3][2] = _mm_loadu_ps(&_pz[i]);
+    columns[3][3] = one;
+
+    // transpose pour repasser en AoS, chaque registre devient la colonne c d'une entité
+    for (int c = 0; c < 4; c++)
+    {
+      __m128 r0 = columns[c][0], r1 = columns[c][1], r2 = columns[c][2], r3 = columns[c][3];
+      _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+      _mm_storeu_ps(&out[i + 0][c][0], r0);
+      _mm_storeu_ps(&out[i + 1][c][0], r1);
+      _mm_storeu_ps(&out[i + 2][c][0], r2);
+      _mm_storeu_ps(&out[i + 3][c][0], r3);
+    }
+  }
+#endif
+
+  for (; i < count; i++)
+  {
+    float w = _qw[i], x = _qx[i], y = _qy[i], z = _qz[i];
+    glm::mat4& m = out[i];
+
+    m[0] = glm::vec4(1.0f - 2.0f * (y * y + z * z), 2.0f * (x * y + w * z), 2.0f * (x * z - w * y), 0.0f) * _sx[i];
+    m[1] = glm::vec4(2.0f * (x * y - w * z), 1.0f - 2.0f * (x * x + z * z), 2.0f * (y * z + w * x), 0.0f) * _sy[i];
+    m[2] = glm::vec4(2.0f * (x * z + w * y), 2.0f * (y * z - w * x), 1.0f - 2.0f * (x * x + y * y), 0.0f) * _sz[i];
+    m[3] = glm::vec4(_px[i], _py[i], _pz[i], 1.0f);
+  }
+}
\ No newline at end of file
@@ -0,0 +1,51 @@
+#include "graphics/dynamic_resolution.h"
+
+
+#include <algorithm>
+#include <cmath>
+
+
+DynamicResolution::DynamicResolution(float targetMilliseconds)
+  : _targetMilliseconds(targetMilliseconds),
+    _scale(DYNAMIC_RESOLUTION_MAX_SCALE),
+    _filteredMilliseconds(0.0f),
+    _cooldown(0)
+{
+}
+
+
+float DynamicResolution::Update(float gpuMilliseconds)
+{
+  if (gpuMilliseconds <= 0.0f || _targetMilliseconds <= 0.0f) return _scale;
+
+  // les mesures arrivent avec quelques frames de retard, celles qui précèdent le dernier changement sont ignorées
+  if (_cooldown > 0)
+  {
+    _cooldown--;
+    return _scale;
+  }
+
+  if (_filteredMilliseconds <= 0.0f) _filteredMilliseconds = gpuMilliseconds;
+  else _filteredMilliseconds += (gpuMilliseconds - _filteredMilliseconds) * DYNAMIC_RESOLUTION_SMOOTHING;
+
+  float desired = _scale * std::sqrt(_targetMilliseconds * DYNAMIC_RESOLUTION_HEADROOM / _filteredMilliseconds);
+  desired = std::clamp(desired, DYNAMIC_RESOLUTION_MIN_SCALE, DYNAMIC_RESOLUTION_MAX_SCALE);
+  desired = std::round(desired / DYNAMIC_RESOLUTION_STEP) * DYNAMIC_RESOLUTION_STEP;
+
+  const bool should_lower = desired < _scale;
+  const bool should_raise = desired >= _scale + 2.0f * DYNAMIC_RESOLUTION_STEP || (desired > _scale && desired >= DYNAMIC_RESOLUTION_MAX_SCALE);
+  if (!should_lower && !should_raise) return _scale;
+
+  _scale = std::clamp(desired, DYNAMIC_RESOLUTION_MIN_SCALE, DYNAMIC_RESOLUTION_MAX_SCALE);
+  _filteredMilliseconds = 0.0f;
+  _cooldown = DYNAMIC_RESOLUTION_COOLDOWN;
+  return _scale;
+}
+
+
+void DynamicResolution::Reset()
+{
+  _scale = DYNAMIC_RESOLUTION_MAX_SCALE;
+  _filteredMilliseconds = 0.0f;
+  _cooldown = 0;
+}
\ No newline at end of file
@@ -0,0 +1,382 @@
+#include "graphics/frame_graph.h"
+
+
+#include <algorithm>
+#include <iostream>
+
+#include "core/profiler.h"
+
+
+static bool isDepthFormat(TextureFormat format)
+{
+  return format == TextureFormat::DEPTH24;
+}
+
+
+FrameGraphResource FrameGraphBuilder::Create(const entt::hashed_string& name, const FrameGraphTextureDesc& desc)
+{
+  FrameGraphResource resource = _graph.findOrAddResource(name);
+  FrameGraph::Resource& target = _graph._resources[resource];
+  if (target.isCreated || target.isImported)
+  {
+    std::cerr << "[FrameGraph] " << _graph._passes[_pass].name << " - '" << target.debugName << "' already exists\n";
+    return resource;
+  }
+
+  target.desc = desc;
+  target.isCreated = true;
+  return Write(name);
+}
+
+
+FrameGraphResource FrameGraphBuilder::Read(const entt::hashed_string& name)
+{
+  FrameGraphResource resource = _graph.findOrAddResource(name);
+  _graph._resources[resource].readers.push_back(_pass);
+  _graph._passes[_pass].reads.push_back(resource);
+  return resource;
+}
+
+
+FrameGraphResource FrameGraphBuilder::Write(const entt::hashed_string& name)
+{
+  FrameGraphResource resource = _graph.findOrAddResource(name);
+  std::vector<uint32_t>& writers = _graph._resources[resource].writers;
+  if (std::find(writers.begin(), writers.end(), _pass) == writers.end())
+  {
+    writers.push_back(_pass);
+    _graph._passes[_pass].writes.push_back(resource);
+  }
+  return resource;
+}
+
+
+void FrameGraphBuilder::SetSideEffect()
+{
+  _graph._passes[_pass].hasSideEffect = true;
+}
+
+
+void FrameGraph::Reset()
+{
+  _resources.clear();
+  _passes.clear();
+  _order.clear();
+  _slots.clear();
+}
+
+
+FrameGraphResource FrameGraph::ImportFramebuffer(const entt::hashed_string& name, unsigned int framebuffer, int width, int height)
+{
+  FrameGraphResource resource = findOrAddResource(name);
+  Resource& target = _resources[resource];
+  target.desc = FrameGraphTextureDesc{ .width = width, .height = height, .format = TextureFormat::RGBA8 };
+  target.isImported = true;
+  target.framebuffer = framebuffer;
+  return resource;
+}
+
+
+void FrameGraph::AddPass(const char* name, const SetupFunction& setup, ExecuteFunction execute)
+{
+  _passes.push_back(Pass{ .name = name, .execute = std::move(execute) });
+
+  FrameGraphBuilder builder(*this, (uint32_t)(_passes.size() - 1));
+  setup(builder);
+}
+
+
+bool FrameGraph::Compile()
+{
+  _order.clear();
+  _slots.clear();
+
+  for (const Resource& resource: _resources)
+  {
+    if (!resource.isCreated && !resource.isImported)
+    {
+      std::cerr << "[FrameGraph] '" << resource.debugName << "' is used but never created\n";
+      return false;
+    }
+  }
+
+  // culling : on part des passes qui ont un effet visible (cible importée ou side effect) et on remonte leurs lectures
+  std::vector<uint32_t> pending;
+  for (uint32_t pass = 0; pass < _passes.size(); pass++)
+  {
+    Pass& target = _passes[pass];
+    target.isUsed = target.hasSideEffect;
+    for (FrameGraphResource resource: target.writes) target.isUsed |= _resources[resource].isImported;
+    if (target.isUsed) pending.push_back(pass);
+  }
+
+  while (!pending.empty())
+  {
+    uint32_t pass = pending.back();
+    pending.pop_back();
+
+    for (FrameGraphResource resource: _passes[pass].reads)
+    {
+      for (uint32_t writer: _resources[resource].writers)
+      {
+        if (_passes[writer].isUsed) continue;
+        _passes[writer].isUsed = true;
+        pending.push_back(writer);
+      }
+    }
+  }
+
+  // dépendances : les écritures d'une ressource gardent l'ordre d'ajout, une lecture attend les écritures qu'elle voit
+  const size_t pass_count = _passes.size();
+  std::vector<std::vector<uint32_t>> successors(pass_count);
+  std::vector<uint32_t> predecessor_counts(pass_count, 0);
+  auto add_edge = [&](uint32_t from, uint32_t to)
+  {
+    if (from == to || !_passes[from].isUsed || !_passes[to].isUsed) return;
+    if (std::find(successors[from].begin(), successors[from].end(), to) != successors[from].end()) return;
+    successors[from].push_back(to);
+    predecessor_counts[to]++;
+  };
+
+  for (const Resource& resource: _resources)
+  {
+    for (size_t i = 1; i < resource.writers.size(); i++) add_edge(resource.writers[i - 1], resource.writers[i]);
+
+    for (uint32_t reader: resource.readers)
+    {
+      const bool also_writes = std::find(resource.writers.begin(), resource.writers.end(), reader) != resource.writers.end();
+      for (uint32_t writer: resource.writers)
+      {
+        if (!also_writes || writer < reader) add_edge(writer, reader);
+      }
+    }
+  }
+
+  // Kahn, à égalité la passe ajoutée en premier passe devant
+  std::vector<uint32_t> ready;
+  for (uint32_t pass = 0; pass < pass_count; pass++)
+  {
+    if (_passes[pass].isUsed && predecessor_counts[pass] == 0) ready.push_back(pass);
+  }
+
+  while (!ready.empty())
+  {
+    auto first = std::min_element(ready.begin(), ready.end());
+    uint32_t pass = *first;
+    ready.erase(first);
+    _order.push_back(pass);
+
+    for (uint32_t successor: successors[pass])
+    {
+      if (--predecessor_counts[successor] == 0) ready.push_back(successor);
+    }
+  }
+
+  size_t used_count = 0;
+  for (const Pass& pass: _passes) used_count += pass.isUsed ? 1 : 0;
+  if (_order.size() != used_count)
+  {
+    std::cerr << "[FrameGraph] Dependency cycle between passes\n";
+    _order.clear();
+    return false;
+  }
+
+  // durée de vie de chaque ressource transitoire, en positions dans _order
+  const uint32_t unused = UINT32_MAX;
+  std::vector<uint32_t> first_use(_resources.size(), unused);
+  std::vector<uint32_t> last_use(_resources.size(), 0);
+  for (uint32_t position = 0; position < _order.size(); position++)
+  {
+    const Pass& pass = _passes[_order[position]];
+    for (const auto* pResources: { &pass.reads, &pass.writes })
+    {
+      for (FrameGraphResource resource: *pResources)
+      {
+        if (first_use[resource] == unused) first_use[resource] = position;
+        last_use[resource] = position;
+      }
+    }
+  }
+
+  // aliasing : une texture libérée par une ressource morte est reprise par la suivante de même description
+  std::vector<uint32_t> free_slots;
+  for (uint32_t position = 0; position < _order.size(); position++)
+  {
+    for (FrameGraphResource resource = 0; resource < _resources.size(); resource++)
+    {
+      Resource& target = _resources[resource];
+      if (target.isImported || first_use[resource] != position) continue;
+
+      auto it = std::find_if(free_slots.begin(), free_slots.end(), [&](uint32_t slot){ return _slots[slot] == target.desc; });
+      if (it != free_slots.end())
+      {
+        target.slot = *it;
+        free_slots.erase(it);
+      }
+      else
+      {
+        target.slot = (uint32_t)_slots.size();
+        _slots.push_back(target.desc);
+      }
+    }
+
+    for (FrameGraphResource resource = 0; resource < _resources.size(); resource++)
+    {
+      const Resource& target = _resources[resource];
+      if (!target.isImported && first_use[resource] != unused && last_use[resource] == position) free_slots.push_back(target.slot);
+    }
+  }
+
+  return true;
+}
+
+
+void FrameGraph::Execute(RenderBackend& backend, Profiler* pProfiler)
+{
+  acquireTextures(backend);
+
+  for (uint32_t pass_index: _order)
+  {
+    const Pass& pass = _passes[pass_index];
+
+    int width = 0;
+    int height = 0;
+    unsigned int framebuffer = getFramebuffer(backend, pass, width, height);
+    if (!pass.writes.empty())
+    {
+      backend.BindFramebuffer(framebuffer);
+      backend.SetViewport(0, 0, width, height);
+    }
+
+    if (pProfiler) pProfiler->BeginGpu(pass.name);
+    pass.execute(backend, *this);
+    if (pProfiler) pProfiler->EndGpu();
+  }
+
+  backend.BindFramebuffer(0);
+}
+
+
+void FrameGraph::Destroy(RenderBackend& backend)
+{
+  for (auto& [attachments, framebuffer]: _framebuffers) backend.DestroyFramebuffer(framebuffer);
+  _framebuffers.clear();
+
+  for (const Texture& texture: _textures) backend.DestroyTexture(texture.handle);
+  _textures.clear();
+
+  Reset();
+}
+
+
+unsigned int FrameGraph::GetTexture(const entt::hashed_string& name) const
+{
+  for (const Resource& resource: _resources)
+  {
+    if (resource.name != name.value()) continue;
+    if (resource.isImported || resource.slot >= _textures.size()) return 0;
+    return _textures[resource.slot].handle;
+  }
+  return 0;
+}
+
+
+FrameGraphResource FrameGraph::findOrAddResource(const entt::hashed_string& name)
+{
+  // quelques ressources par frame, une recherche linéaire suffit
+  for (FrameGraphResource resource = 0; resource < _resources.size(); resource++)
+  {
+    if (_resources[resource].name == name.value()) return resource;
+  }
+
+  _resources.push_back(Resource{
+    .name = name.value(),
+    .debugName = name.data(),
+    .desc = FrameGraphTextureDesc{},
+    .isCreated = false,
+    .isImported = false,
+    .framebuffer = 0,
+    .slot = UINT32_MAX
+  });
+  return (FrameGraphResource)(_resources.size() - 1);
+}
+
+
+// les textures de la frame précédente sont reprises si leur description revient, les autres sont détruites
+void FrameGraph::acquireTextures(RenderBackend& backend)
+{
+  std::vector<Texture> previous = std::move(_textures);
+  _textures.clear();
+  bool has_changed = false;
+
+  for (const FrameGraphTextureDesc& desc: _slots)
+  {
+    auto it = std::find_if(previous.begin(), previous.end(), [&](const Texture& texture){ return texture.desc == desc; });
+    if (it != previous.end())
+    {
+      _textures.push_back(*it);
+      previous.erase(it);
+      continue;
+    }
+
+    TextureDesc texture_desc{
+      .width = desc.width,
+      .height = desc.height,
+      .format = desc.format,
+      .linearFilter = true,
+      .clampToEdge = true
+    };
+    _textures.push_back(Texture{ .desc = desc, .handle = backend.CreateTexture(texture_desc, nullptr) });
+    has_changed = true;
+  }
+
+  for (const Texture& texture: previous)
+  {
+    backend.DestroyTexture(texture.handle);
+    has_changed = true;
+  }
+
+  // un handle de texture détruit peut revenir, aucun framebuffer en cache ne doit pointer dessus
+  if (has_changed)
+  {
+    for (auto& [attachments, framebuffer]: _framebuffers) backend.DestroyFramebuffer(framebuffer);
+    _framebuffers.clear();
+  }
+}
+
+
+unsigned int FrameGraph::getFramebuffer(RenderBackend& backend, const Pass& pass, int& width, int& height)
+{
+  std::vector<unsigned int> colors;
+  unsigned int depth = 0;
+
+  for (FrameGraphResource resource: pass.writes)
+  {
+    const Resource& target = _resources[resource];
+    width = target.desc.width;
+    height = target.desc.height;
+
+    if (target.isImported)
+    {
+      if (pass.writes.size() > 1) std::cerr << "[FrameGraph] " << pass.name << " - '" << target.debugName << "' is imported and can't be mixed with other targets\n";
+      return target.framebuffer;
+    }
+
+    unsigned int texture = _textures[target.slot].handle;
+    if (isDepthFormat(target.desc.format)) depth = texture;
+    else colors.push_back(texture);
+  }
+
+  if (colors.empty() && depth == 0) return 0;
+
+  // la profondeur en dernier dans la clé, 0 si absente
+  std::vector<unsigned int> key = colors;
+  key.push_back(depth);
+
+  auto it = _framebuffers.find(key);
+  if (it != _framebuffers.end()) return it->second;
+
+  unsigned int framebuffer = backend.CreateFramebuffer(colors.data(), (int)colors.size(), depth);
+  _framebuffers.emplace(std::move(key), framebuffer);
+  return framebuffer;
+}
\ No newline at end of file
@@ -0,0 +1,465 @@
+#include "graphics/gl_render_backend.h"
+
+
+#include <iostream>
+#include <vector>
+
+#include <glad/glad.h>
+
+
+static void setCapability(GLenum capability, bool enable, int& cached)
+{
+  if (cached == (int)enable) return;
+
+  if (enable) glEnable(capability);
+  else glDisable(capability);
+  cached = (int)enable;
+}
+
+
+// le backend est créé avant le contexte GL, rien à interroger ici
+GLRenderBackend::GLRenderBackend()
+  : _uniformBufferAlignment(0),
+    _storageBufferAlignment(0)
+{}
+
+
+unsigned int GLRenderBackend::CreateBuffer(size_t size, const void* data, BufferUsage usage)
+{
+  unsigned int buffer;
+  glCreateBuffers(1, &buffer);
+
+  GLbitfield flags = (usage == BufferUsage::DYNAMIC) ? GL_DYNAMIC_STORAGE_BIT : 0;
+  glNamedBufferStorage(buffer, size, data, flags);
+
+  if (data)
+  {
+    _stats.bufferUploads++;
+    _stats.bytesUploaded += size;
+  }
+
+  return buffer;
+}
+
+
+void GLRenderBackend::UpdateBuffer(unsigned int buffer, size_t offset, size_t size, const void* data)
+{
+  if (size == 0) return;
+
+  glNamedBufferSubData(buffer, offset, size, data);
+
+  _stats.bufferUploads++;
+  _stats.bytesUploaded += size;
+}
+
+
+void GLRenderBackend::DestroyBuffer(unsigned int buffer)
+{
+  if (buffer) glDeleteBuffers(1, &buffer); // un buffer persistant est démappé implicitement
+}
+
+
+unsigned int GLRenderBackend::CreatePersistentBuffer(size_t size, void** ppMapped)
+{
+  const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+  unsigned int buffer;
+  glCreateBuffers(1, &buffer);
+  glNamedBufferStorage(buffer, size, nullptr, flags);
+  *ppMapped = glMapNamedBufferRange(buffer, 0, size, flags);
+
+  if (!*ppMapped)
+  {
+    glDeleteBuffers(1, &buffer);
+    return 0;
+  }
+
+  return buffer;
+}
+
+
+uint64_t GLRenderBackend::InsertFence()
+{
+  return (uint64_t)(uintptr_t)glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+
+bool GLRenderBackend::WaitFence(uint64_t fence, uint64_t timeoutNanoseconds)
+{
+  if (!fence) return true;
+
+  GLsync sync = (GLsync)(uintptr_t)fence;
+
+  // le premier appel flush pour être sûr que la fence finisse par être atteinte
+  GLenum result = glClientWaitSync(sync, GL_SYNC_FLUSH_COMMANDS_BIT, timeoutNanoseconds);
+  return result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED;
+}
+
+
+void GLRenderBackend::DeleteFence(uint64_t fence)
+{
+  if (fence) glDeleteSync((GLsync)(uintptr_t)fence);
+}
+
+
+// ! la fence doit déjà avoir été flush par le contexte qui l'a créée
+void GLRenderBackend::WaitFenceOnGpu(uint64_t fence)
+{
+  if (fence) glWaitSync((GLsync)(uintptr_t)fence, 0, GL_TIMEOUT_IGNORED);
+}
+
+
+unsigned int GLRenderBackend::CreateVertexArray(const VertexLayout& layout, unsigned int vertexBuffer, unsigned int indexBuffer)
+{
+  unsigned int vao;
+  glCreateVertexArrays(1, &vao);
+
+  glVertexArrayVertexBuffer(vao, 0, vertexBuffer, 0, layout.stride);
+  if (indexBuffer) glVertexArrayElementBuffer(vao, indexBuffer);
+
+  for (const auto& attribute: layout.attributes)
+  {
+    glEnableVertexArrayAttrib(vao, attribute.location);
+    glVertexArrayAttribFormat(vao, attribute.location, attribute.components, GL_FLOAT, GL_FALSE, attribute.offset);
+    glVertexArrayAttribBinding(vao, attribute.location, 0);
+  }
+
+  return vao;
+}
+
+
+void GLRenderBackend::DestroyVertexArray(unsigned int vertexArray)
+{
+  if (!vertexArray) return;
+
+  if (_currentVertexArray == vertexArray) _currentVertexArray = 0;
+  glDeleteVertexArrays(1, &vertexArray);
+}
+
+
+unsigned int GLRenderBackend::CreateTexture(const TextureDesc& desc, const void* pixels)
+{
+  unsigned int internal_format = GL_RGBA8;
+  unsigned int format = GL_RGBA;
+  unsigned int type = GL_UNSIGNED_BYTE;
+  switch (desc.format)
+  {
+    case TextureFormat::R8:
+      internal_format = GL_R8;
+      format = GL_RED;
+    break;
+
+    case TextureFormat::RG8:
+      internal_format = GL_RG8;
+      format = GL_RG;
+    break;
+
+    case TextureFormat::RGB8:
+      internal_format = GL_RGB8;
+      format = GL_RGB;
+    break;
+
+    case TextureFormat::RGBA8:
+      internal_format = GL_RGBA8;
+      format = GL_RGBA;
+    break;
+
+    case TextureFormat::RGBA16F:
+      internal_format = GL_RGBA16F;
+      format = GL_RGBA;
+      type = GL_FLOAT;
+    break;
+
+    case TextureFormat::DEPTH24:
+      internal_format = GL_DEPTH_COMPONENT24;
+      format = GL_DEPTH_COMPONENT;
+      type = GL_FLOAT;
+    break;
+  }
+
+  unsigned int texture;
+  glCreateTextures(GL_TEXTURE_2D, 1, &texture);
+  glTextureStorage2D(texture, 1, internal_format, desc.width, desc.height); // pas de mipmap
+  if (pixels) glTextureSubImage2D(texture, 0, 0, 0, desc.width, desc.height, format, type, pixels);
+
+  GLint filter = desc.linearFilter ? GL_LINEAR : GL_NEAREST;
+  GLint wrap = desc.clampToEdge ? GL_CLAMP_TO_EDGE : GL_REPEAT;
+  glTextureParameteri(texture, GL_TEXTURE_MIN_FILTER, filter);
+  glTextureParameteri(texture, GL_TEXTURE_MAG_FILTER, filter);
+  glTextureParameteri(texture, GL_TEXTURE_WRAP_S, wrap);
+  glTextureParameteri(texture, GL_TEXTURE_WRAP_T, wrap);
+
+  return texture;
+}
+
+
+void GLRenderBackend::DestroyTexture(unsigned int texture)
+{
+  if (texture) glDeleteTextures(1, &texture);
+}
+
+
+unsigned int GLRenderBackend::CreatePipeline(const PipelineDesc& desc)
+{
+  _pipelines.push_back(Pipeline{ .desc = desc });
+  return (unsigned int)_pipelines.size();
+}
+
+
+void GLRenderBackend::DestroyPipeline(unsigned int pipeline)
+{
+  // le programme appartient au ShaderLoader, on oublie juste le cache
+  if (pipeline == 0 || pipeline > _pipelines.size()) return;
+
+  if (_currentPipeline == pipeline) _currentPipeline = 0;
+  _pipelines[pipeline - 1] = Pipeline{};
+}
+
+
+void GLRenderBackend::SetPipelineProgram(unsigned int pipeline, unsigned int program)
+{
+  if (pipeline == 0 || pipeline > _pipelines.size()) return;
+
+  Pipeline& target = _pipelines[pipeline - 1];
+  target.desc.program = program;
+  target.uniformLocations.clear(); // les locations appartiennent à l'ancien programme
+
+  if (_currentPipeline == pipeline) _currentPipeline = 0; // force le prochain glUseProgram
+}
+
+
+unsigned int GLRenderBackend::CreateFramebuffer(const unsigned int* colorTextures, int colorCount, unsigned int depthTexture)
+{
+  unsigned int framebuffer;
+  glCreateFramebuffers(1, &framebuffer);
+
+  std::vector<GLenum> draw_buffers;
+  for (int i = 0; i < colorCount; i++)
+  {
+    glNamedFramebufferTexture(framebuffer, GL_COLOR_ATTACHMENT0 + i, colorTextures[i], 0);
+    draw_buffers.push_back(GL_COLOR_ATTACHMENT0 + i);
+  }
+  if (depthTexture) glNamedFramebufferTexture(framebuffer, GL_DEPTH_ATTACHMENT, depthTexture, 0);
+
+  // une passe de profondeur seule n'écrit aucune couleur
+  if (draw_buffers.empty()) glNamedFramebufferDrawBuffer(framebuffer, GL_NONE);
+  else glNamedFramebufferDrawBuffers(framebuffer, (int)draw_buffers.size(), draw_buffers.data());
+
+  GLenum status = glCheckNamedFramebufferStatus(framebuffer, GL_FRAMEBUFFER);
+  if (status != GL_FRAMEBUFFER_COMPLETE) std::cerr << "[GLRenderBackend] Incomplete framebuffer: 0x" << std::hex << status << std::dec << "\n";
+
+  return framebuffer;
+}
+
+
+void GLRenderBackend::DestroyFramebuffer(unsigned int framebuffer)
+{
+  if (framebuffer) glDeleteFramebuffers(1, &framebuffer);
+}
+
+
+void GLRenderBackend::BindFramebuffer(unsigned int framebuffer)
+{
+  glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+}
+
+
+void GLRenderBackend::SetViewport(int x, int y, int width, int height)
+{
+  glViewport(x, y, width, height);
+}
+
+
+void GLRenderBackend::SetClearColor(const glm::vec4& color)
+{
+  glClearColor(color.r, color.g, color.b, color.a);
+}
+
+
+void GLRenderBackend::Clear()
+{
+  glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+}
+
+
+void GLRenderBackend::BindPipeline(unsigned int pipeline)
+{
+  if (pipeline == 0 || pipeline > _pipelines.size()) return;
+  if (_currentPipeline == pipeline) return;
+
+  const PipelineDesc& desc = _pipelines[pipeline - 1].desc;
+
+  glUseProgram(desc.program);
+
+  setCapability(GL_BLEND, desc.blend, _blend);
+  if (desc.blend) glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+  setCapability(GL_DEPTH_TEST, desc.depthTest, _depthTest);
+  setCapability(GL_CULL_FACE, desc.cullFace, _cullFace);
+
+  _currentPipeline = pipeline;
+  _stats.pipelineBinds++;
+}
+
+
+void GLRenderBackend::SetUniform(const entt::hashed_string& name, const glm::mat4& value)
+{
+  int location = getUniformLocation(name);
+  if (location < 0) return;
+
+  glUniformMatrix4fv(location, 1, GL_FALSE, &value[0][0]);
+  _stats.uniformUploads++;
+}
+
+
+void GLRenderBackend::SetUniform(const entt::hashed_string& name, float value)
+{
+  int location = getUniformLocation(name);
+  if (location < 0) return;
+
+  glUniform1f(location, value);
+  _stats.uniformUploads++;
+}
+
+
+void GLRenderBackend::BindTexture(unsigned int unit, unsigned int texture)
+{
+  glBindTextureUnit(unit, texture);
+  _stats.textureBinds++;
+}
+
+
+void GLRenderBackend::BindUniformBuffer(unsigned int binding, unsigned int buffer, size_t offset, size_t size)
+{
+  glBindBufferRange(GL_UNIFORM_BUFFER, binding, buffer, offset, size);
+}
+
+
+size_t GLRenderBackend::GetUniformBufferAlignment() const
+{
+  if (_uniformBufferAlignment == 0)
+  {
+    int alignment = 256;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    _uniformBufferAlignment = (size_t)alignment;
+  }
+  return _uniformBufferAlignment;
+}
+
+
+void GLRenderBackend::BindStorageBuffer(unsigned int binding, unsigned int buffer, size_t offset, size_t size)
+{
+  glBindBufferRange(GL_SHADER_STORAGE_BUFFER, binding, buffer, offset, size);
+}
+
+
+size_t GLRenderBackend::GetStorageBufferAlignment() const
+{
+  if (_storageBufferAlignment == 0)
+  {
+    int alignment = 256;
+    glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    _storageBufferAlignment = (size_t)alignment;
+  }
+  return _storageBufferAlignment;
+}
+
+
+void GLRenderBackend::DrawIndexed(unsigned int vertexArray, int indexCount, size_t firstIndex, int baseVertex)
+{
+  if (indexCount <= 0 || !hasProgram()) return;
+
+  if (_currentVertexArray != vertexArray)
+  {
+    glBindVertexArray(vertexArray);
+    _currentVertexArray = vertexArray;
+  }
+
+  const void* indices = (const void*)(firstIndex * sizeof(unsigned int));
+  if (baseVertex == 0) glDrawElements(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, indices);
+  else glDrawElementsBaseVertex(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, indices, baseVertex);
+
+  _stats.drawCalls++;
+  _stats.indices += indexCount;
+}
+
+
+void GLRenderBackend::DrawIndexedInstanced(unsigned int vertexArray, int indexCount, int instanceCount, size_t firstIndex, int baseVertex, uint32_t baseInstance)
+{
+  if (indexCount <= 0 || instanceCount <= 0 || !hasProgram()) return;
+
+  if (_currentVertexArray != vertexArray)
+  {
+    glBindVertexArray(vertexArray);
+    _currentVertexArray = vertexArray;
+  }
+
+  const void* indices = (const void*)(firstIndex * sizeof(unsigned int));
+  if (baseInstance != 0) glDrawElementsInstancedBaseVertexBaseInstance(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, indices, instanceCount, baseVertex, baseInstance);
+  else if (baseVertex == 0) glDrawElementsInstanced(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, indices, instanceCount);
+  else glDrawElementsInstancedBaseVertex(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, indices, instanceCount, baseVertex);
+
+  _stats.drawCalls++;
+  _stats.indices += (uint64_t)indexCount * instanceCount;
+  _stats.instances += instanceCount;
+}
+
+
+unsigned int GLRenderBackend::CreateTimerQuery()
+{
+  unsigned int query;
+  glCreateQueries(GL_TIME_ELAPSED, 1, &query);
+  return query;
+}
+
+
+void GLRenderBackend::DestroyTimerQuery(unsigned int query)
+{
+  if (query) glDeleteQueries(1, &query);
+}
+
+
+void GLRenderBackend::BeginTimerQuery(unsigned int query)
+{
+  glBeginQuery(GL_TIME_ELAPSED, query);
+}
+
+
+void GLRenderBackend::EndTimerQuery()
+{
+  glEndQuery(GL_TIME_ELAPSED);
+}
+
+
+bool GLRenderBackend::GetTimerQueryResult(unsigned int query, uint64_t& nanoseconds)
+{
+  int available = 0;
+  glGetQueryObjectiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+  if (!available) return false;
+
+  GLuint64 elapsed = 0;
+  glGetQueryObjectui64v(query, GL_QUERY_RESULT, &elapsed);
+  nanoseconds = elapsed;
+  return true;
+}
+
+
+int GLRenderBackend::getUniformLocation(const entt::hashed_string& name)
+{
+  if (_currentPipeline == 0) return -1;
+
+  Pipeline& pipeline = _pipelines[_currentPipeline - 1];
+  if (!pipeline.desc.program) return -1;
+  auto it = pipeline.uniformLocations.find(name.value());
+  if (it != pipeline.uniformLocations.end()) return it->second;
+
+  int location = glGetUniformLocation(pipeline.desc.program, name.data());
+  pipeline.uniformLocations.emplace(name.value(), location);
+  return location;
+}
+
+
+bool GLRenderBackend::hasProgram() const
+{
+  // sans pipeline on laisse passer, l'appelant gère lui même son programme
+  return _currentPipeline == 0 || _pipelines[_currentPipeline - 1].desc.program != 0;
+}
\ No newline at end of file
@@ -0,0 +1,257 @@
+#include "graphics/null_render_backend.h"
+
+
+NullRenderBackend::NullRenderBackend(bool recordCommands)
+  : _recordCommands(recordCommands),
+    _nextHandle(1)
+{}
+
+
+unsigned int NullRenderBackend::CreateBuffer(size_t size, const void* data, BufferUsage usage)
+{
+  unsigned int buffer = _nextHandle++;
+  if (data)
+  {
+    _stats.bufferUploads++;
+    _stats.bytesUploaded += size;
+  }
+  record(RenderCommandType::CREATE_BUFFER, buffer, size);
+  return buffer;
+}
+
+
+void NullRenderBackend::UpdateBuffer(unsigned int buffer, size_t offset, size_t size, const void* data)
+{
+  if (size == 0) return;
+
+  _stats.bufferUploads++;
+  _stats.bytesUploaded += size;
+  record(RenderCommandType::UPDATE_BUFFER, buffer, size);
+}
+
+
+void NullRenderBackend::DestroyBuffer(unsigned int buffer)
+{
+  _persistentMemory.erase(buffer);
+  record(RenderCommandType::DESTROY_BUFFER, buffer);
+}
+
+
+unsigned int NullRenderBackend::CreatePersistentBuffer(size_t size, void** ppMapped)
+{
+  unsigned int buffer = _nextHandle++;
+  auto& memory = _persistentMemory[buffer];
+  memory.resize(size);
+  *ppMapped = memory.data();
+
+  record(RenderCommandType::CREATE_PERSISTENT_BUFFER, buffer, size);
+  return buffer;
+}
+
+
+// pas de GPU à attendre, les fences sont toujours signalées
+uint64_t NullRenderBackend::InsertFence()
+{
+  return 0;
+}
+
+
+bool NullRenderBackend::WaitFence(uint64_t fence, uint64_t timeoutNanoseconds)
+{
+  return true;
+}
+
+
+void NullRenderBackend::DeleteFence(uint64_t fence) {}
+
+
+void NullRenderBackend::WaitFenceOnGpu(uint64_t fence) {}
+
+
+unsigned int NullRenderBackend::CreateVertexArray(const VertexLayout& layout, unsigned int vertexBuffer, unsigned int indexBuffer)
+{
+  unsigned int vao = _nextHandle++;
+  record(RenderCommandType::CREATE_VERTEX_ARRAY, vao, layout.stride);
+  return vao;
+}
+
+
+void NullRenderBackend::DestroyVertexArray(unsigned int vertexArray)
+{
+  record(RenderCommandType::DESTROY_VERTEX_ARRAY, vertexArray);
+}
+
+
+unsigned int NullRenderBackend::CreateTexture(const TextureDesc& desc, const void* pixels)
+{
+  unsigned int texture = _nextHandle++;
+  record(RenderCommandType::CREATE_TEXTURE, texture, (uint64_t)desc.width * desc.height);
+  return texture;
+}
+
+
+void NullRenderBackend::DestroyTexture(unsigned int texture)
+{
+  record(RenderCommandType::DESTROY_TEXTURE, texture);
+}
+
+
+unsigned int NullRenderBackend::CreatePipeline(const PipelineDesc& desc)
+{
+  unsigned int pipeline = _nextHandle++;
+  record(RenderCommandType::CREATE_PIPELINE, pipeline, desc.program);
+  return pipeline;
+}
+
+
+void NullRenderBackend::DestroyPipeline(unsigned int pipeline)
+{
+  record(RenderCommandType::DESTROY_PIPELINE, pipeline);
+}
+
+
+void NullRenderBackend::SetPipelineProgram(unsigned int pipeline, unsigned int program)
+{
+  record(RenderCommandType::SET_PIPELINE_PROGRAM, pipeline, program);
+}
+
+
+unsigned int NullRenderBackend::CreateFramebuffer(const unsigned int* colorTextures, int colorCount, unsigned int depthTexture)
+{
+  unsigned int framebuffer = _nextHandle++;
+  record(RenderCommandType::CREATE_FRAMEBUFFER, framebuffer, (uint64_t)colorCount);
+  return framebuffer;
+}
+
+
+void NullRenderBackend::DestroyFramebuffer(unsigned int framebuffer)
+{
+  record(RenderCommandType::DESTROY_FRAMEBUFFER, framebuffer);
+}
+
+
+void NullRenderBackend::BindFramebuffer(unsigned int framebuffer)
+{
+  record(RenderCommandType::BIND_FRAMEBUFFER, framebuffer);
+}
+
+
+void NullRenderBackend::SetViewport(int x, int y, int width, int height)
+{
+  record(RenderCommandType::SET_VIEWPORT, 0, ((uint64_t)width << 32) | (uint32_t)height);
+}
+
+
+void NullRenderBackend::SetClearColor(const glm::vec4& color)
+{
+  record(RenderCommandType::SET_CLEAR_COLOR);
+}
+
+
+void NullRenderBackend::Clear()
+{
+  record(RenderCommandType::CLEAR);
+}
+
+
+void NullRenderBackend::BindPipeline(unsigned int pipeline)
+{
+  _stats.pipelineBinds++;
+  record(RenderCommandType::BIND_PIPELINE, pipeline);
+}
+
+
+void NullRenderBackend::SetUniform(const entt::hashed_string& name, const glm::mat4& value)
+{
+  _stats.uniformUploads++;
+  record(RenderCommandType::SET_UNIFORM, 0, name.value());
+}
+
+
+void NullRenderBackend::SetUniform(const entt::hashed_string& name, float value)
+{
+  _stats.uniformUploads++;
+  record(RenderCommandType::SET_UNIFORM, 0, name.value());
+}
+
+
+void NullRenderBackend::BindTexture(unsigned int unit, unsigned int texture)
+{
+  _stats.textureBinds++;
+  record(RenderCommandType::BIND_TEXTURE, texture, unit);
+}
+
+
+void NullRenderBackend::BindUniformBuffer(unsigned int binding, unsigned int buffer, size_t offset, size_t size)
+{
+  record(RenderCommandType::BIND_UNIFORM_BUFFER, buffer, offset);
+}
+
+
+size_t NullRenderBackend::GetUniformBufferAlignment() const
+{
+  return 256; // le pire cas courant coté drivers
+}
+
+
+void NullRenderBackend::BindStorageBuffer(unsigned int binding, unsigned int buffer, size_t offset, size_t size)
+{
+  record(RenderCommandType::BIND_STORAGE_BUFFER, buffer, offset);
+}
+
+
+size_t NullRenderBackend::GetStorageBufferAlignment() const
+{
+  return 256;
+}
+
+
+void NullRenderBackend::DrawIndexed(unsigned int vertexArray, int indexCount, size_t firstIndex, int baseVertex)
+{
+  if (indexCount <= 0) return;
+
+  _stats.drawCalls++;
+  _stats.indices += indexCount;
+  record(RenderCommandType::DRAW_INDEXED, vertexArray, indexCount);
+}
+
+
+void NullRenderBackend::DrawIndexedInstanced(unsigned int vertexArray, int indexCount, int instanceCount, size_t firstIndex, int baseVertex, uint32_t baseInstance)
+{
+  if (indexCount <= 0 || instanceCount <= 0) return;
+
+  _stats.drawCalls++;
+  _stats.indices += (uint64_t)indexCount * instanceCount;
+  _stats.instances += instanceCount;
+  record(RenderCommandType::DRAW_INDEXED_INSTANCED, vertexArray, instanceCount);
+}
+
+
+unsigned int NullRenderBackend::CreateTimerQuery()
+{
+  return _nextHandle++;
+}
+
+
+void NullRenderBackend::DestroyTimerQuery(unsigned int query) {}
+
+
+void NullRenderBackend::BeginTimerQuery(unsigned int query) {}
+
+
+void NullRenderBackend::EndTimerQuery() {}
+
+
+// pas de GPU donc le résultat est toujours disponible et toujours nul
+bool NullRenderBackend::GetTimerQueryResult(unsigned int query, uint64_t& nanoseconds)
+{
+  nanoseconds = 0;
+  return true;
+}
+
+
+void NullRenderBackend::record(RenderCommandType type, unsigned int handle, uint64_t value)
+{
+  if (!_recordCommands) return;
+  _commands.push_back(RecordedCommand{ .type = type, .handle = handle, .value = value });
+}
\ No newline at end of file
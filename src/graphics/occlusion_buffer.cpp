@@ -0,0 +1,351 @@
+#include "graphics/occlusion_buffer.h"
+
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+#include "core/job_system.h"
+
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define VOXL_OCCLUSION_AVX
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define VOXL_OCCLUSION_SSE
+#endif
+
+
+static constexpr int OCCLUSION_BAND_COUNT = OCCLUSION_HEIGHT / OCCLUSION_BAND_HEIGHT;
+static constexpr float OCCLUSION_MIN_AREA = 1e-6f; // en pixels², en dessous le triangle ne couvre rien
+
+// 12 triangles d'une boite, le coin i prend max.x si (i & 4), max.y si (i & 2), max.z si (i & 1)
+static constexpr int BOX_INDICES[36] = {
+  0, 2, 1, 1, 2, 3, // -x
+  4, 5, 6, 5, 7, 6, // +x
+  0, 1, 4, 1, 5, 4, // -y
+  2, 6, 3, 3, 6, 7, // +y
+  0, 4, 2, 2, 4, 6, // -z
+  1, 3, 5, 3, 7, 5, // +z
+};
+
+
+OcclusionBuffer::OcclusionBuffer()
+  : _viewProjection(1.0f)
+{
+  int offset = 0;
+  for (int level = 0; level < OCCLUSION_LEVEL_COUNT; level++)
+  {
+    _levelOffsets[level] = offset;
+    offset += (OCCLUSION_WIDTH >> level) * (OCCLUSION_HEIGHT >> level);
+  }
+  _levels.assign(offset, 1.0f);
+}
+
+
+void OcclusionBuffer::Begin(const glm::mat4& viewProjection)
+{
+  _viewProjection = viewProjection;
+  _triangles.clear();
+}
+
+
+void OcclusionBuffer::AddOccluder(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices, const glm::mat4& model)
+{
+  const glm::mat4 model_view_projection = _viewProjection * model;
+
+  for (size_t i = 0; i + 2 < indices.size(); i += 3)
+  {
+    if (indices[i] >= vertices.size() || indices[i + 1] >= vertices.size() || indices[i + 2] >= vertices.size()) continue;
+
+    addTriangle(
+      model_view_projection * glm::vec4(vertices[indices[i]].position, 1.0f),
+      model_view_projection * glm::vec4(vertices[indices[i + 1]].position, 1.0f),
+      model_view_projection * glm::vec4(vertices[indices[i + 2]].position, 1.0f));
+  }
+}
+
+
+void OcclusionBuffer::AddOccluderBox(const glm::vec3& min, const glm::vec3& max)
+{
+  glm::vec4 corners[8];
+  for (int i = 0; i < 8; i++)
+  {
+    glm::vec3 corner((i & 4) ? max.x : min.x, (i & 2) ? max.y : min.y, (i & 1) ? max.z : min.z);
+    corners[i] = _viewProjection * glm::vec4(corner, 1.0f);
+  }
+
+  for (int i = 0; i < 36; i += 3) addTriangle(corners[BOX_INDICES[i]], corners[BOX_INDICES[i + 1]], corners[BOX_INDICES[i + 2]]);
+}
+
+
+void OcclusionBuffer::Rasterize(JobSystem* pJobs)
+{
+  if (pJobs && !_triangles.empty())
+  {
+    // chaque bande n'écrit que dans ses lignes, aucune synchronisation entre les tâches
+    pJobs->ParallelFor("Occlusion", OCCLUSION_BAND_COUNT, 1, [this](uint32_t start, uint32_t end, uint32_t threadnum)
+    {
+      for (uint32_t band = start; band < end; band++) rasterizeBand((int)band);
+    });
+  }
+  else
+  {
+    for (int band = 0; band < OCCLUSION_BAND_COUNT; band++) rasterizeBand(band);
+  }
+
+  buildHiZ();
+}
+
+
+bool OcclusionBuffer::IsVisible(const glm::vec3& min, const glm::vec3& max) const
+{
+  float min_x = FLT_MAX;
+  float min_y = FLT_MAX;
+  float max_x = -FLT_MAX;
+  float max_y = -FLT_MAX;
+  float min_depth = FLT_MAX;
+
+  // le coin min plus les arêtes de la boite en clip space, un seul produit matrice-vecteur
+  const glm::vec4 base = _viewProjection * glm::vec4(min, 1.0f);
+  const glm::vec4 edge_x = _viewProjection[0] * (max.x - min.x);
+  const glm::vec4 edge_y = _viewProjection[1] * (max.y - min.y);
+  const glm::vec4 edge_z = _viewProjection[2] * (max.z - min.z);
+
+  for (int i = 0; i < 8; i++)
+  {
+    glm::vec4 clip = base;
+    if (i & 4) clip += edge_x;
+    if (i & 2) clip += edge_y;
+    if (i & 1) clip += edge_z;
+
+    // un coin devant le near plane : la projection n'a plus de sens, on garde l'objet
+    if (clip.z < -clip.w || clip.w <= 0.0f) return true;
+
+    float inverse_w = 1.0f / clip.w;
+    float x = (clip.x * inverse_w * 0.5f + 0.5f) * (float)OCCLUSION_WIDTH;
+    float y = (clip.y * inverse_w * 0.5f + 0.5f) * (float)OCCLUSION_HEIGHT;
+    min_x = std::min(min_x, x);
+    max_x = std::max(max_x, x);
+    min_y = std::min(min_y, y);
+    max_y = std::max(max_y, y);
+    min_depth = std::min(min_depth, clip.z * inverse_w * 0.5f + 0.5f);
+  }
+
+  // tous les pixels touchés par le rectangle, même partiellement
+  int x0 = std::max(0, (int)std::floor(min_x));
+  int x1 = std::min(OCCLUSION_WIDTH - 1, (int)std::floor(max_x));
+  int y0 = std::max(0, (int)std::floor(min_y));
+  int y1 = std::min(OCCLUSION_HEIGHT - 1, (int)std::floor(max_y));
+  if (x0 > x1 || y0 > y1) return true; // hors écran, c'est au frustum culling de décider
+
+  // le niveau où le rectangle tient dans 2 ou 3 texels de côté
+  int size = std::max(x1 - x0, y1 - y0) + 1;
+  int level = 0;
+  while (level + 1 < OCCLUSION_LEVEL_COUNT && (size >> level) > 2) level++;
+
+  const float* pLevel = _levels.data() + _levelOffsets[level];
+  const int level_width = OCCLUSION_WIDTH >> level;
+  for (int y = y0 >> level; y <= (y1 >> level); y++)
+  {
+    for (int x = x0 >> level; x <= (x1 >> level); x++)
+    {
+      if (min_depth <= pLevel[y * level_width + x]) return true;
+    }
+  }
+
+  return false;
+}
+
+
+void OcclusionBuffer::addTriangle(const glm::vec4& a, const glm::vec4& b, const glm::vec4& c)
+{
+  // entièrement d'un seul côté d'un plan du frustum (sauf near, clippé plus bas)
+  if (a.x > a.w && b.x > b.w && c.x > c.w) return;
+  if (a.x < -a.w && b.x < -b.w && c.x < -c.w) return;
+  if (a.y > a.w && b.y > b.w && c.y > c.w) return;
+  if (a.y < -a.w && b.y < -b.w && c.y < -c.w) return;
+  if (a.z > a.w && b.z > b.w && c.z > c.w) return;
+
+  // distance au near plane (z = -w en clip space OpenGL)
+  const glm::vec4 input[3] = { a, b, c };
+  const float distances[3] = { a.z + a.w, b.z + b.w, c.z + c.w };
+  if (distances[0] >= 0.0f && distances[1] >= 0.0f && distances[2] >= 0.0f)
+  {
+    addScreenTriangle(a, b, c);
+    return;
+  }
+
+  // Sutherland-Hodgman sur un seul plan, 4 sommets au plus
+  glm::vec4 clipped[4];
+  int clipped_count = 0;
+  for (int i = 0; i < 3; i++)
+  {
+    int next = (i + 1) % 3;
+    if (distances[i] >= 0.0f) clipped[clipped_count++] = input[i];
+    if ((distances[i] >= 0.0f) != (distances[next] >= 0.0f))
+    {
+      float t = distances[i] / (distances[i] - distances[next]);
+      clipped[clipped_count++] = input[i] + (input[next] - input[i]) * t;
+    }
+  }
+
+  for (int i = 1; i + 1 < clipped_count; i++) addScreenTriangle(clipped[0], clipped[i], clipped[i + 1]);
+}
+
+
+void OcclusionBuffer::addScreenTriangle(const glm::vec4& a, const glm::vec4& b, const glm::vec4& c)
+{
+  glm::vec3 screen[3];
+  const glm::vec4* clip[3] = { &a, &b, &c };
+  for (int i = 0; i < 3; i++)
+  {
+    // après le clip contre le near plane w est positif, sauf en projection dégénérée
+    if (clip[i]->w <= 0.0f) return;
+
+    float inverse_w = 1.0f / clip[i]->w;
+    screen[i] = glm::vec3(
+      (clip[i]->x * inverse_w * 0.5f + 0.5f) * (float)OCCLUSION_WIDTH,
+      (clip[i]->y * inverse_w * 0.5f + 0.5f) * (float)OCCLUSION_HEIGHT,
+      std::clamp(clip[i]->z * inverse_w * 0.5f + 0.5f, 0.0f, 1.0f));
+  }
+
+  glm::vec3 ab = screen[1] - screen[0];
+  glm::vec3 ac = screen[2] - screen[0];
+  float area = ab.x * ac.y - ab.y * ac.x;
+  if (std::abs(area) < OCCLUSION_MIN_AREA) return;
+
+  ScreenTriangle triangle;
+  triangle.minX = std::max(0, (int)std::floor(std::min({ screen[0].x, screen[1].x, screen[2].x })));
+  triangle.maxX = std::min(OCCLUSION_WIDTH - 1, (int)std::floor(std::max({ screen[0].x, screen[1].x, screen[2].x })));
+  triangle.minY = std::max(0, (int)std::floor(std::min({ screen[0].y, screen[1].y, screen[2].y })));
+  triangle.maxY = std::min(OCCLUSION_HEIGHT - 1, (int)std::floor(std::max({ screen[0].y, screen[1].y, screen[2].y })));
+  if (triangle.minX > triangle.maxX || triangle.minY > triangle.maxY) return;
+
+  // les faces arrière sont gardées en inversant leurs arêtes, les meshes n'ont pas tous le même sens
+  const float orientation = area > 0.0f ? 1.0f : -1.0f;
+  for (int i = 0; i < 3; i++)
+  {
+    const glm::vec3& v0 = screen[i];
+    const glm::vec3& v1 = screen[(i + 1) % 3];
+    float edge_a = (v0.y - v1.y) * orientation;
+    float edge_b = (v1.x - v0.x) * orientation;
+    triangle.edgeA[i] = edge_a;
+    triangle.edgeB[i] = edge_b;
+    triangle.edgeC[i] = -(edge_a * v0.x + edge_b * v0.y) + 0.5f * (edge_a + edge_b);
+  }
+
+  // plan de profondeur, z/w varie linéairement en espace écran
+  float normal_x = ab.y * ac.z - ab.z * ac.y;
+  float normal_y = ab.z * ac.x - ab.x * ac.z;
+  triangle.depthA = -normal_x / area;
+  triangle.depthB = -normal_y / area;
+  triangle.depthC = screen[0].z - triangle.depthA * screen[0].x - triangle.depthB * screen[0].y + 0.5f * (triangle.depthA + triangle.depthB);
+
+  _triangles.push_back(triangle);
+}
+
+
+void OcclusionBuffer::rasterizeBand(int band)
+{
+  const int band_min_y = band * OCCLUSION_BAND_HEIGHT;
+  const int band_max_y = band_min_y + OCCLUSION_BAND_HEIGHT - 1;
+
+  float* pDepth = _levels.data();
+  std::fill(pDepth + band_min_y * OCCLUSION_WIDTH, pDepth + (band_max_y + 1) * OCCLUSION_WIDTH, 1.0f);
+
+  for (const ScreenTriangle& triangle: _triangles)
+  {
+    if (triangle.maxY < band_min_y || triangle.minY > band_max_y) continue;
+
+    const int min_y = std::max(triangle.minY, band_min_y);
+    const int max_y = std::min(triangle.maxY, band_max_y);
+
+    for (int y = min_y; y <= max_y; y++)
+    {
+      float* pRow = pDepth + y * OCCLUSION_WIDTH;
+      const float fy = (float)y;
+      const float row0 = triangle.edgeB[0] * fy + triangle.edgeC[0];
+      const float row1 = triangle.edgeB[1] * fy + triangle.edgeC[1];
+      const float row2 = triangle.edgeB[2] * fy + triangle.edgeC[2];
+      const float row_depth = triangle.depthB * fy + triangle.depthC;
+
+      int x = triangle.minX;
+
+#if defined(VOXL_OCCLUSION_AVX)
+      // alignés sur 8 pixels, la largeur en est un multiple donc on ne déborde jamais de la ligne
+      x &= ~7;
+      const __m256 offsets = _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f);
+      for (; x <= triangle.maxX; x += 8)
+      {
+        __m256 fx = _mm256_add_ps(_mm256_set1_ps((float)x), offsets);
+        __m256 e0 = _mm256_add_ps(_mm256_mul_ps(fx, _mm256_set1_ps(triangle.edgeA[0])), _mm256_set1_ps(row0));
+        __m256 e1 = _mm256_add_ps(_mm256_mul_ps(fx, _mm256_set1_ps(triangle.edgeA[1])), _mm256_set1_ps(row1));
+        __m256 e2 = _mm256_add_ps(_mm256_mul_ps(fx, _mm256_set1_ps(triangle.edgeA[2])), _mm256_set1_ps(row2));
+        __m256 inside = _mm256_and_ps(
+          _mm256_and_ps(_mm256_cmp_ps(e0, _mm256_setzero_ps(), _CMP_GE_OQ), _mm256_cmp_ps(e1, _mm256_setzero_ps(), _CMP_GE_OQ)),
+          _mm256_cmp_ps(e2, _mm256_setzero_ps(), _CMP_GE_OQ));
+        if (_mm256_movemask_ps(inside) == 0) continue;
+
+        __m256 depth = _mm256_add_ps(_mm256_mul_ps(fx, _mm256_set1_ps(triangle.depthA)), _mm256_set1_ps(row_depth));
+        depth = _mm256_min_ps(_mm256_max_ps(depth, _mm256_setzero_ps()), _mm256_set1_ps(1.0f));
+        __m256 current = _mm256_loadu_ps(pRow + x);
+        _mm256_storeu_ps(pRow + x, _mm256_blendv_ps(current, _mm256_min_ps(current, depth), inside));
+      }
+#elif defined(VOXL_OCCLUSION_SSE)
+      x &= ~3;
+      const __m128 offsets = _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f);
+      for (; x <= triangle.maxX; x += 4)
+      {
+        __m128 fx = _mm_add_ps(_mm_set1_ps((float)x), offsets);
+        __m128 e0 = _mm_add_ps(_mm_mul_ps(fx, _mm_set1_ps(triangle.edgeA[0])), _mm_set1_ps(row0));
+        __m128 e1 = _mm_add_ps(_mm_mul_ps(fx, _mm_set1_ps(triangle.edgeA[1])), _mm_set1_ps(row1));
+        __m128 e2 = _mm_add_ps(_mm_mul_ps(fx, _mm_set1_ps(triangle.edgeA[2])), _mm_set1_ps(row2));
+        __m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(e0, _mm_setzero_ps()), _mm_cmpge_ps(e1, _mm_setzero_ps())), _mm_cmpge_ps(e2, _mm_setzero_ps()));
+        if (_mm_movemask_ps(inside) == 0) continue;
+
+        // pas de blendv en SSE2, on sélectionne avec and/andnot
+        __m128 depth = _mm_add_ps(_mm_mul_ps(fx, _mm_set1_ps(triangle.depthA)), _mm_set1_ps(row_depth));
+        depth = _mm_min_ps(_mm_max_ps(depth, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+        __m128 current = _mm_loadu_ps(pRow + x);
+        __m128 closest = _mm_min_ps(current, depth);
+        _mm_storeu_ps(pRow + x, _mm_or_ps(_mm_and_ps(inside, closest), _mm_andnot_ps(inside, current)));
+      }
+#endif
+
+      // reste (ou tout si pas de SIMD)
+      for (; x <= triangle.maxX; x++)
+      {
+        const float fx = (float)x;
+        if (triangle.edgeA[0] * fx + row0 < 0.0f || triangle.edgeA[1] * fx + row1 < 0.0f || triangle.edgeA[2] * fx + row2 < 0.0f) continue;
+
+        float depth = std::clamp(triangle.depthA * fx + row_depth, 0.0f, 1.0f);
+        pRow[x] = std::min(pRow[x], depth);
+      }
+    }
+  }
+}
+
+
+void OcclusionBuffer::buildHiZ()
+{
+  for (int level = 1; level < OCCLUSION_LEVEL_COUNT; level++)
+  {
+    const float* pSource = _levels.data() + _levelOffsets[level - 1];
+    float* pDestination = _levels.data() + _levelOffsets[level];
+    const int source_width = OCCLUSION_WIDTH >> (level - 1);
+    const int width = OCCLUSION_WIDTH >> level;
+    const int height = OCCLUSION_HEIGHT >> level;
+
+    for (int y = 0; y < height; y++)
+    {
+      const float* pRow0 = pSource + (y * 2) * source_width;
+      const float* pRow1 = pRow0 + source_width;
+      for (int x = 0; x < width; x++)
+      {
+        pDestination[y * width + x] = std::max(std::max(pRow0[x * 2], pRow0[x * 2 + 1]), std::max(pRow1[x * 2], pRow1[x * 2 + 1]));
+      }
+    }
+  }
+}
\ No newline at end of file
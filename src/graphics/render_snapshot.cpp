@@ -0,0 +1,58 @@
+#include "graphics/render_snapshot.h"
+
+
+RenderSnapshot::~RenderSnapshot()
+{
+  clearUiDrawData();
+}
+
+
+void RenderSnapshot::Clear()
+{
+  hasCamera = false;
+  changedMeshes.clear();
+  terrainMeshes.clear();
+  meshes.clear();
+  instanceGroups.clear();
+  instances.clear();
+  texts.clear();
+  textVertices.clear();
+  textIndices.clear();
+  pUiDrawData = nullptr;
+  clearUiDrawData();
+}
+
+
+void RenderSnapshot::CopyUiDrawData(const ImDrawData* drawData)
+{
+  clearUiDrawData();
+  pUiDrawData = nullptr;
+  if (!drawData || !drawData->Valid) return;
+
+  uiDrawData.Valid = true;
+  uiDrawData.TotalIdxCount = drawData->TotalIdxCount;
+  uiDrawData.TotalVtxCount = drawData->TotalVtxCount;
+  uiDrawData.DisplayPos = drawData->DisplayPos;
+  uiDrawData.DisplaySize = drawData->DisplaySize;
+  uiDrawData.FramebufferScale = drawData->FramebufferScale;
+  uiDrawData.OwnerViewport = nullptr;
+  uiDrawData.Textures = nullptr; // les mises à jour de textures restent sur le thread principal
+
+  for (ImDrawList* list: drawData->CmdLists)
+  {
+    ImDrawList* copy = list->CloneOutput();
+    // ImTextureData appartient au contexte ImGui et peut changer pendant la frame suivante
+    for (ImDrawCmd& cmd: copy->CmdBuffer) cmd.TexRef = ImTextureRef(cmd.GetTexID());
+    uiDrawData.CmdLists.push_back(copy);
+  }
+  uiDrawData.CmdListsCount = uiDrawData.CmdLists.Size;
+
+  pUiDrawData = &uiDrawData;
+}
+
+
+void RenderSnapshot::clearUiDrawData()
+{
+  for (ImDrawList* list: uiDrawData.CmdLists) IM_DELETE(list);
+  uiDrawData.Clear();
+}
\ No newline at end of file
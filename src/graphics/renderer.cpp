@@ -1,7 +1,11 @@
 #include "graphics/renderer.h"
 
 
+#include <algorithm>
+#include <chrono>
+#include <cstring>
 #include <iostream>
+#include <random>
 #include <vector>
 
 #include <SDL3/SDL_video.h>
@@ -17,42 +21,96 @@ using namespace entt::literals;
 #include "core/command_manager.h"
 #include "core/command.h"
 #include "core/resource_manager.h"
+#include "core/profiler.h"
+#include "core/job_system.h"
 #include "platform/window.h"
+#include "graphics/gl_render_backend.h"
+#include "graphics/null_render_backend.h"
+#include "graphics/frustum.h"
+#include "graphics/occlusion_buffer.h"
+#include "graphics/visibility_set.h"
 #include "events/resize_event.h"
+#include "events/mesh_buffers_changed_event.h"
 #include "events/dev_console_message_event.h"
-#include "utils/get_transform_matrix.h"
+#include "utils/create_text_mesh.h"
+#include "components/camera.h"
 #include "components/text.h"
 #include "components/text_mesh.h"
 #include "components/mesh.h"
+#include "components/mesh_instance.h"
+#include "components/occluder_box.h"
+#include "components/tags.h"
 #include "components/transform.h"
+#include "components/world_matrix.h"
 #include "resources/shader.h"
+#include "loaders/shader_loader.h"
 #include "resources/texture.h"
 
 
-Renderer::Renderer(entt::registry* registry, Window* window)
+static inline uint64_t getMeshKey(unsigned int vertexBuffer, unsigned int indexBuffer)
+{
+  return ((uint64_t)vertexBuffer << 32) | indexBuffer;
+}
+
+
+Renderer::Renderer(entt::registry* registry, Window* window, RenderBackendType backendType, bool useRenderThread)
   : _pRegistry(registry),
-    _pWindow(window)
+    _pWindow(window),
+    _glCtx(nullptr),
+    _renderGlCtx(nullptr),
+    _backendType(backendType),
+    _resources{},
+    _ortho(1.0f),
+    _clearColor(0.773f, 0.729f, 1.0f, 1.0f),
+    _viewportWidth(0),
+    _viewportHeight(0),
+    _useRenderThread(useRenderThread && backendType == RenderBackendType::OPENGL),
+    _writeIndex(0),
+    _readIndex(0),
+    _submittedFrames(0),
+    _renderedFrames(0),
+    _stopRenderThread(false),
+    _useOcclusion(true),
+    _useDynamicResolution(false)
 {
+  if (_backendType == RenderBackendType::OPENGL) _pBackend = std::make_unique<GLRenderBackend>();
+  else _pBackend = std::make_unique<NullRenderBackend>(false);
+
+  // le backend GL garde des états en cache, le thread principal a le sien quand _pBackend vit sur le thread de rendu
+  if (_useRenderThread && _backendType == RenderBackendType::OPENGL) _pUploadBackend = std::make_unique<GLRenderBackend>();
+
   auto& dispatcher = _pRegistry->ctx().get<entt::dispatcher>();
   dispatcher.sink<ResizeEvent>().connect<&Renderer::onResize>(this);
+  dispatcher.sink<MeshBuffersChangedEvent>().connect<&Renderer::onMeshBuffersChanged>(this);
+
+  _visibility.Connect(*_pRegistry);
 }
 
 
 Renderer::~Renderer()
 {
-  _pRegistry->view<TextMesh>().each([this](TextMesh& mesh){
-    glDeleteVertexArrays(1, &mesh.vao);
-    glDeleteBuffers(1, &mesh.vbo);
-    glDeleteBuffers(1, &mesh.ebo);
-  });
+  if (auto* profiler = _pRegistry->ctx().find<Profiler>()) profiler->SetBackend(nullptr);
+
+  // le thread de rendu détruit ses propres ressources avant de rendre son contexte
+  stopRenderThread();
+
+  _visibility.Disconnect(*_pRegistry);
+
+  if (_pStream)
+  {
+    destroyResources(*_pBackend, _resources);
+    _pStream.reset(); // attend les fences, donc avant de détruire le contexte
+  }
 
   _pRegistry->view<Mesh>().each([this](Mesh& mesh){
-    glDeleteVertexArrays(1, &mesh.vao);
-    glDeleteBuffers(1, &mesh.vbo);
-    glDeleteBuffers(1, &mesh.ebo);
+    _pBackend->DestroyVertexArray(mesh.vao);
+    _pBackend->DestroyBuffer(mesh.vbo);
+    _pBackend->DestroyBuffer(mesh.ebo);
   });
 
-  if (_glCtx) SDL_GL_DestroyContext(_glCtx);
+  if (!_glCtx) return;
+
+  SDL_GL_DestroyContext(_glCtx);
 
   ImGui_ImplOpenGL3_Shutdown();
   ImGui_ImplSDL3_Shutdown();
@@ -62,6 +120,21 @@ Renderer::~Renderer()
 
 bool Renderer::Init()
 {
+  auto& engine_context = _pRegistry->ctx().get<EngineContext>();
+
+  _viewportWidth = engine_context.screenInfo.width;
+  _viewportHeight = engine_context.screenInfo.height;
+  _ortho = glm::ortho(0.0f, (float)_viewportWidth, 0.0f, (float)_viewportHeight, -1.0f, 1.0f);
+
+  // pas de contexte GPU en headless, on crée juste les pipelines factices
+  if (IsHeadless())
+  {
+    _pStream = std::make_unique<StreamBuffer>(*_pBackend, RENDER_STREAM_REGION_SIZE);
+    _resources = createResources(*_pBackend, *_pStream, 0, 0, 0, 0);
+    registerCommands();
+    return true;
+  }
+
   _glCtx = SDL_GL_CreateContext(_pWindow->GetNativeWindow());
   if (!_glCtx)
   {
@@ -99,17 +172,48 @@ bool Renderer::Init()
   ImGui_ImplSDL3_InitForOpenGL(_pWindow->GetNativeWindow(), _glCtx);
   ImGui_ImplOpenGL3_Init();
 
-  auto& engine_context = _pRegistry->ctx().get<EngineContext>();
-  glViewport(0, 0, engine_context.screenInfo.width, engine_context.screenInfo.height);
-  glClearColor(0.773f, 0.729f, 1.0f, 1.0f);
+  // toutes les compilations partent en même temps, les pipelines récupèrent leur programme au fil des frames (pollShaders)
+  ShaderLoader::EnableParallelCompile();
+  TextureLoader::EnableCompression();
 
   auto& resource_manager = _pRegistry->ctx().get<ResourceManager>();
-  resource_manager.LoadByID<Shader>("shader_msdf_font"_hs, "msdf_font");
-  resource_manager.LoadByID<Shader>("shader_ui"_hs, "ui");
+  auto [text_shader, text_loaded] = resource_manager.LoadByID<Shader>("shader_msdf_font"_hs, "msdf_font", ShaderCompileMode::ASYNC);
+  auto [ui_shader, ui_loaded] = resource_manager.LoadByID<Shader>("shader_ui"_hs, "ui", ShaderCompileMode::ASYNC);
+  auto [instanced_shader, instanced_loaded] = resource_manager.LoadByID<Shader>("shader_mesh_instanced"_hs, "mesh_instanced", ShaderCompileMode::ASYNC);
+  auto [upscale_shader, upscale_loaded] = resource_manager.LoadByID<Shader>("shader_upscale"_hs, "upscale", ShaderCompileMode::ASYNC);
+  auto [terrain_shader, terrain_loaded] = resource_manager.LoadByID<Shader>("shader_terrain"_hs, "terrain", ShaderCompileMode::ASYNC);
+  if (!text_shader->second || !ui_shader->second || !instanced_shader->second || !upscale_shader->second || !terrain_shader->second)
+  {
+    std::cerr << "[Renderer] Failed to load shaders\n";
+    return false;
+  }
+
+  _textShader = text_shader->second;
+  _uiShader = ui_shader->second;
+  _instancedShader = instanced_shader->second;
+  _upscaleShader = upscale_shader->second;
+  _terrainShader = terrain_shader->second;
 
   resource_manager.LoadByID<Texture>("tex_icon"_hs, "ui/icon_close.png");
-  
-  _ortho = glm::ortho(0.0f, (float)engine_context.screenInfo.width, 0.0f, (float)engine_context.screenInfo.height, -1.0f, 1.0f);
+
+  // un tableau sans bloc reste utilisable (seul le layer manquant), pas d'échec ici
+  auto [block_textures, block_textures_loaded] = resource_manager.LoadByID<BlockTextureArray>("block_textures"_hs, "blocks");
+  _blockTextures = block_textures->second;
+
+  if (_useRenderThread && !startRenderThread())
+  {
+    std::cerr << "[Renderer] Failed to start render thread, rendering on the main thread: " << SDL_GetError() << "\n";
+    _useRenderThread = false;
+  }
+
+  if (!_useRenderThread)
+  {
+    _pStream = std::make_unique<StreamBuffer>(*_pBackend, RENDER_STREAM_REGION_SIZE);
+    _resources = createResources(*_pBackend, *_pStream, _textShader->program, _uiShader->program, _instancedShader->program, _terrainShader->program);
+
+    // les requêtes de timer ne sont pas partagées entre contextes, pas de timings GPU avec le thread de rendu
+    _pRegistry->ctx().get<Profiler>().SetBackend(_pBackend.get());
+  }
   
   registerCommands();
 
@@ -122,158 +226,1211 @@ void Renderer::BeginFrame()
   auto& screenInfo = _pRegistry->ctx().get<EngineContext>().screenInfo;
   if (screenInfo.isMinimized) return;
 
-  ImGui_ImplOpenGL3_NewFrame();
-  ImGui_ImplSDL3_NewFrame();
-  ImGui::NewFrame();
+  if (!IsHeadless())
+  {
+    ImGui_ImplOpenGL3_NewFrame();
+    ImGui_ImplSDL3_NewFrame();
+    ImGui::NewFrame();
+  }
+}
+
 
-  glClear(GL_COLOR_BUFFER_BIT);
+void Renderer::Render()
+{
+  pollShaders();
+  Extract(_snapshots[_writeIndex]);
 }
 
 
 void Renderer::EndFrame()
 {
-  ImGui::Render();
-  ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+  RenderSnapshot& snapshot = _snapshots[_writeIndex];
 
-  if (_pWindow)
-    _pWindow->SwapBuffers();
+  if (!IsHeadless())
+  {
+    ImGui::Render();
+    ImDrawData* draw_data = ImGui::GetDrawData();
+
+    if (_useRenderThread)
+    {
+      // les textures d'ImGui (atlas des polices) sont mises à jour dans le contexte principal, le snapshot ne garde que leurs ids
+      if (draw_data->Textures)
+      {
+        for (ImTextureData* texture: *draw_data->Textures)
+          if (texture->Status != ImTextureStatus_OK) ImGui_ImplOpenGL3_UpdateTexture(texture);
+      }
+      snapshot.CopyUiDrawData(draw_data);
+
+      // tout ce qui a été créé ou uploadé ici (textures, meshes, ImGui) doit être terminé avant les draws du contexte de rendu
+      // glFlush seul ne garantit que l'envoi, la fence doit quand même être flush pour que l'autre contexte puisse l'attendre
+      snapshot.uploadFence = GetUploadBackend().InsertFence();
+      glFlush();
+    }
+    else snapshot.pUiDrawData = draw_data;
+  }
+
+  if (_useRenderThread)
+  {
+    publishSnapshot();
+    return;
+  }
+
+  executeFrame(snapshot, _pRegistry->ctx().find<Profiler>());
 }
 
 
-void Renderer::Render()
+void Renderer::Extract(RenderSnapshot& snapshot)
 {
-  auto& resource_manager = _pRegistry->ctx().get<ResourceManager>();
-  const auto& textShader = resource_manager.Get<Shader>("shader_msdf_font").handle();
-  const auto& uiShader = resource_manager.Get<Shader>("shader_ui").handle();
+  extractScene(snapshot);
 
-  // afficher l'UI à la fin
-  glEnable(GL_BLEND);
-  glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-  glDisable(GL_DEPTH_TEST);
-  glDisable(GL_CULL_FACE);
-
-  glUseProgram(textShader->program);
-  glUniformMatrix4fv(glGetUniformLocation(textShader->program, "u_projection"), 1, GL_FALSE, &_ortho[0][0]);
-  glUseProgram(uiShader->program);
-  glUniformMatrix4fv(glGetUniformLocation(uiShader->program, "u_projection"), 1, GL_FALSE, &_ortho[0][0]);
-  glUseProgram(0);
-  
-  _pRegistry->view<Text, TextMesh>().each([this, &textShader, &uiShader](auto entity, Text& text, TextMesh& textMesh)
+  // seulement pour les frames dessinées : les VAO à refaire ne sont transmis qu'une fois et le contrôleur avance d'un pas par frame
+  snapshot.changedMeshes.swap(_changedMeshes);
+
+  // le temps GPU vient du Profiler, sans timers (thread de rendu, headless) l'échelle reste où elle est
+  if (_useDynamicResolution)
   {
-    if (text.text.empty()) return;
+    Profiler* pProfiler = _pRegistry->ctx().find<Profiler>();
+    snapshot.renderScale = _dynamicResolution.Update(pProfiler ? pProfiler->GetGpuFrameTime() : 0.0f);
+  }
+}
+
+
+void Renderer::extractScene(RenderSnapshot& snapshot)
+{
+  snapshot.Clear();
+  snapshot.frameIndex = _pRegistry->ctx().get<EngineContext>().frameIndex;
+  snapshot.viewportWidth = _viewportWidth;
+  snapshot.viewportHeight = _viewportHeight;
+  snapshot.clearColor = _clearColor;
+  snapshot.ortho = _ortho;
+  snapshot.textProgram = _textShader ? _textShader->program : 0;
+  snapshot.uiProgram = _uiShader ? _uiShader->program : 0;
+  snapshot.instancedProgram = _instancedShader ? _instancedShader->program : 0;
+  snapshot.upscaleProgram = _upscaleShader ? _upscaleShader->program : 0;
+  snapshot.terrainProgram = _terrainShader ? _terrainShader->program : 0;
+  snapshot.blockTextures = _blockTextures ? _blockTextures->handle : 0;
+  snapshot.isDynamicResolution = _useDynamicResolution;
+  snapshot.renderScale = _useDynamicResolution ? _dynamicResolution.GetScale() : 1.0f;
 
-    if (_pRegistry->all_of<Mesh, Transform>(entity))
+  extractMeshes(snapshot);
+  extractTexts(snapshot);
+}
+
+
+void Renderer::Execute(RenderBackend& backend, RenderResources& resources, const RenderSnapshot& snapshot)
+{
+  executeTerrain(backend, resources, snapshot);
+  executeMeshes(backend, resources, snapshot);
+  executeInstances(backend, resources, snapshot);
+
+  // afficher l'UI à la fin
+  executeTexts(backend, resources, snapshot);
+}
+
+
+// false s'il n'y a aucun occulteur à l'écran, le buffer n'est alors pas à jour
+bool Renderer::rasterizeOccluders(const glm::mat4& viewProjection, const glm::vec3& viewerPosition)
+{
+  Profiler* pProfiler = _pRegistry->ctx().find<Profiler>();
+  if (pProfiler) pProfiler->BeginCpu("Occlusion");
+
+  // les triangles hors écran sont rejetés dès la préparation, pas besoin de passer par le frustum culling
+  _occlusion.Begin(viewProjection);
+  _pRegistry->view<Occluder, WorldMatrix>().each([this](auto entity, const WorldMatrix& worldMatrix)
+  {
+    const Mesh* pMesh = _pRegistry->try_get<Mesh>(entity);
+    if (!pMesh)
     {
-      glUseProgram(uiShader->program);
-      auto model = GetTransformMatrix(_pRegistry->get<Transform>(entity));
-      glUniformMatrix4fv(glGetUniformLocation(uiShader->program, "u_model"), 1, GL_FALSE, &model[0][0]);
-      Mesh& mesh = _pRegistry->get<Mesh>(entity);
-      glBindVertexArray(mesh.vao);
-      glDrawElements(GL_TRIANGLES, mesh.indiceCount, GL_UNSIGNED_INT, nullptr);
-      glUseProgram(0);
+      const MeshInstance* pInstance = _pRegistry->try_get<MeshInstance>(entity);
+      if (pInstance && pInstance->mesh) pMesh = &*pInstance->mesh;
     }
+    if (pMesh) _occlusion.AddOccluder(pMesh->vertices, pMesh->indices, worldMatrix.matrix);
+  });
 
-    glUseProgram(textShader->program);
-    glBindTextureUnit(0, text.pFont->textureHandle);
-    glUniform1f(glGetUniformLocation(textShader->program, "pxRange"), text.pFont->pixelRange);
-    glBindVertexArray(textMesh.vao);
-    glDrawElements(GL_TRIANGLES, textMesh.indices.size(), GL_UNSIGNED_INT, nullptr);
-    glUseProgram(0);
+  // intérieur plein du terrain
+  _pRegistry->view<OccluderBox>().each([this, &viewerPosition](const OccluderBox& box)
+  {
+    if (IsOccluderBoxUseful(box, viewerPosition)) _occlusion.AddOccluderBox(box.min, box.max);
   });
+
+  const bool has_occluders = _occlusion.GetTriangleCount() > 0;
+  if (has_occluders) _occlusion.Rasterize(_pRegistry->ctx().find<JobSystem>());
+
+  if (pProfiler) pProfiler->EndCpu("Occlusion");
+  return has_occluders;
 }
 
 
-void Renderer::registerCommands()
+void Renderer::extractMeshes(RenderSnapshot& snapshot)
 {
-  auto& command_manager = _pRegistry->ctx().get<CommandManager>();
-  auto& dispatcher = _pRegistry->ctx().get<entt::dispatcher>();
+  entt::entity camera_entity = GetActiveCamera(*_pRegistry);
+  if (camera_entity == entt::null) return;
 
-  std::string helper = "$set_clear_color <red> <green> <blue> --> color values must be between 0 and 1";
-  command_manager.Register(Command{
-    .name = "set_clear_color",
-    .helper = helper,
-    .func = [&dispatcher, helper](auto& args)
+  auto& screenInfo = _pRegistry->ctx().get<EngineContext>().screenInfo;
+  const Camera& camera = _pRegistry->get<Camera>(camera_entity);
+  float aspect_ratio = screenInfo.aspectRatio > 0.0f ? screenInfo.aspectRatio : 1.0f;
+  snapshot.hasCamera = true;
+  snapshot.viewProjection = GetProjectionMatrix(camera, aspect_ratio) * GetViewMatrix(_pRegistry->get<WorldMatrix>(camera_entity).matrix);
+
+  // seules les AABB des entités modifiées depuis la dernière frame sont recalculées
+  _visibility.Update(*_pRegistry);
+  const glm::vec3 viewer_position(_pRegistry->get<WorldMatrix>(camera_entity).matrix[3]);
+  const bool use_occlusion = _useOcclusion && rasterizeOccluders(snapshot.viewProjection, viewer_position);
+  _visibility.Cull(ExtractFrustum(snapshot.viewProjection), _visible, use_occlusion ? &_occlusion : nullptr);
+  if (_visible.empty()) return;
+
+  // les MeshInstance sont mises de coté pour être regroupées, les Mesh propres à une entité deviennent un packet chacun
+  _instances.clear();
+
+  for (entt::entity entity: _visible)
+  {
+    const Mesh* pMesh = _pRegistry->try_get<Mesh>(entity);
+    if (!pMesh)
     {
-      try {
-        if (args.size() != 3) throw std::out_of_range("[Engine] $set_clear_color needs 3 args");
-        
-        size_t last_valid_index;
-        float r = std::stof(args[0], &last_valid_index);
-        if (last_valid_index != args[0].size() || r < 0.0f || r > 1.0f) throw std::invalid_argument("[Engine] args[0] must be between 0 and 1 included");
-        float g = std::stof(args[1], &last_valid_index);
-        if (last_valid_index != args[1].size() || g < 0.0f || g > 1.0f) throw std::invalid_argument("[Engine] args[1] must be between 0 and 1 included");
-        float b = std::stof(args[2], &last_valid_index);
-        if (last_valid_index != args[2].size() || b < 0.0f || b > 1.0f) throw std::invalid_argument("[Engine] args[2] must be between 0 and 1 included");
+      const MeshInstance& instance = _pRegistry->get<MeshInstance>(entity);
+      if (instance.mesh) _instances.emplace_back(&*instance.mesh, entity);
+      continue;
+    }
 
-        glClearColor(r, g, b, 1.0f);
-      } 
-      // la dite erreur
-      catch (const std::out_of_range& e) 
-      {
-        dispatcher.enqueue(DevConsoleMessageEvent{
-          .level = DebugLevel::WARNING,
-          .buffer = helper,
-        });
-        std::cerr << e.what() << "\n";
-      }
-      catch (const std::invalid_argument& e)
+    const Mesh& mesh = *pMesh;
+    if (!mesh.vao || mesh.indiceCount <= 0) continue;
+
+    // le terrain a son propre pipeline (et sa texture), il est dessiné à part
+    std::vector<MeshDrawPacket>& packets = _pRegistry->all_of<Terrain>(entity) ? snapshot.terrainMeshes : snapshot.meshes;
+    packets.push_back(MeshDrawPacket{
+      .vertexArray = mesh.vao,
+      .vertexBuffer = mesh.vbo,
+      .indexBuffer = mesh.ebo,
+      .indexCount = mesh.indiceCount,
+      .model = _pRegistry->get<WorldMatrix>(entity).matrix
+    });
+  }
+
+  extractInstances(snapshot);
+}
+
+
+void Renderer::extractInstances(RenderSnapshot& snapshot)
+{
+  if (_instances.empty()) return;
+
+  // un seul matériau pour le moment (le pipeline instancié), donc un groupe = un mesh
+  std::sort(_instances.begin(), _instances.end());
+
+  size_t group_start = 0;
+  while (group_start < _instances.size())
+  {
+    const Mesh* pMesh = _instances[group_start].first;
+    size_t group_end = group_start + 1;
+    while (group_end < _instances.size() && _instances[group_end].first == pMesh) group_end++;
+
+    if (pMesh->vao && pMesh->indiceCount > 0)
+    {
+      snapshot.instanceGroups.push_back(InstanceDrawPacket{
+        .vertexArray = pMesh->vao,
+        .vertexBuffer = pMesh->vbo,
+        .indexBuffer = pMesh->ebo,
+        .indexCount = pMesh->indiceCount,
+        .firstInstance = (uint32_t)snapshot.instances.size(),
+        .instanceCount = (uint32_t)(group_end - group_start)
+      });
+
+      for (size_t i = group_start; i < group_end; i++)
       {
-        dispatcher.enqueue(DevConsoleMessageEvent{
-          .level = DebugLevel::WARNING,
-          .buffer = helper,
+        entt::entity entity = _instances[i].second;
+        snapshot.instances.push_back(InstanceData{
+          .model = _pRegistry->get<WorldMatrix>(entity).matrix,
+          .color = _pRegistry->get<MeshInstance>(entity).color
         });
-        std::cerr << e.what() << "\n";
       }
     }
-  });
 
+    group_start = group_end;
+  }
+}
 
-  helper = "$set_clear_color_rgb <red> <green> <blue> --> color values must be between 0 and 255";
-  command_manager.Register(Command{
-    .name = "set_clear_color_rgb",
-    .helper = helper,
-    .func = [&dispatcher, helper](auto& args)
+
+void Renderer::extractTexts(RenderSnapshot& snapshot)
+{
+  _pRegistry->view<Text, TextMesh>().each([this, &snapshot](auto entity, Text& text, TextMesh& textMesh)
+  {
+    if (text.text.empty()) return;
+
+    TextDrawPacket packet{};
+    if (text.pFont)
     {
-      try {
-        if (args.size() != 3) throw std::out_of_range("[Engine] $set_clear_color_rgb needs 3 args");
-        
-        size_t last_valid_index;
-        int r = std::stoi(args[0], &last_valid_index);
-        if (last_valid_index != args[0].size() || r < 0 || r > 255) throw std::invalid_argument("[Engine] args[0] must be between 0 and 255 included");
-        int g = std::stoi(args[1], &last_valid_index);
-        if (last_valid_index != args[1].size() || g < 0 || g > 255) throw std::invalid_argument("[Engine] args[1] must be between 0 and 255 included");
-        int b = std::stoi(args[2], &last_valid_index);
-        if (last_valid_index != args[2].size() || b < 0 || b > 255) throw std::invalid_argument("[Engine] args[2] must be between 0 and 255 included");
+      packet.fontTexture = text.pFont->textureHandle;
+      packet.pixelRange = text.pFont->pixelRange;
+    }
 
-        glClearColor((float) r / 255.0f, (float) g / 255.0f, (float) b / 255.0f, 1.0f);
-      } 
-      // la dite erreur
-      catch (const std::out_of_range& e) 
+    if (_pRegistry->all_of<Mesh, WorldMatrix>(entity))
+    {
+      const Mesh& mesh = _pRegistry->get<Mesh>(entity);
+      packet.hasBackground = true;
+      packet.background = MeshDrawPacket{
+        .vertexArray = mesh.vao,
+        .vertexBuffer = mesh.vbo,
+        .indexBuffer = mesh.ebo,
+        .indexCount = mesh.indiceCount,
+        .model = _pRegistry->get<WorldMatrix>(entity).matrix
+      };
+    }
+
+    packet.firstVertex = (uint32_t)snapshot.textVertices.size();
+    packet.vertexCount = (uint32_t)textMesh.vertices.size();
+    packet.firstIndex = (uint32_t)snapshot.textIndices.size();
+    packet.indexCount = (uint32_t)textMesh.indices.size();
+    snapshot.textVertices.insert(snapshot.textVertices.end(), textMesh.vertices.begin(), textMesh.vertices.end());
+    snapshot.textIndices.insert(snapshot.textIndices.end(), textMesh.indices.begin(), textMesh.indices.end());
+
+    snapshot.texts.push_back(packet);
+  });
+}
+
+
+void Renderer::executeTerrain(RenderBackend& backend, RenderResources& resources, const RenderSnapshot& snapshot)
+{
+  if (snapshot.terrainMeshes.empty()) return;
+
+  StreamBuffer& stream = *resources.pStream;
+
+  // les matrices de tous les chunks en une seule allocation, chaque draw retrouve la sienne avec gl_BaseInstance
+  // un draw par chunk reste nécessaire : chacun a ses propres buffers dans le ChunkMeshPool
+  const size_t size = sizeof(glm::mat4) * snapshot.terrainMeshes.size();
+  StreamAllocation draw_data = stream.Allocate(size, backend.GetStorageBufferAlignment());
+  if (!draw_data.pData) return;
+
+  for (size_t i = 0; i < snapshot.terrainMeshes.size(); i++)
+    std::memcpy((uint8_t*)draw_data.pData + i * sizeof(glm::mat4), &snapshot.terrainMeshes[i].model[0][0], sizeof(glm::mat4));
+
+  backend.BindPipeline(resources.terrainPipeline);
+  backend.SetUniform("u_projection"_hs, snapshot.viewProjection);
+  backend.BindTexture(0, snapshot.blockTextures);
+  backend.BindStorageBuffer(TERRAIN_DATA_BINDING, stream.GetBuffer(), draw_data.offset, draw_data.size);
+
+  for (size_t i = 0; i < snapshot.terrainMeshes.size(); i++)
+  {
+    const MeshDrawPacket& packet = snapshot.terrainMeshes[i];
+    backend.DrawIndexedInstanced(getMeshVertexArray(backend, resources, packet.vertexArray, packet.vertexBuffer, packet.indexBuffer), packet.indexCount, 1, 0, 0, (uint32_t)i);
+  }
+}
+
+
+void Renderer::executeMeshes(RenderBackend& backend, RenderResources& resources, const RenderSnapshot& snapshot)
+{
+  if (snapshot.meshes.empty()) return;
+
+  StreamBuffer& stream = *resources.pStream;
+
+  backend.BindPipeline(resources.meshPipeline);
+  backend.SetUniform("u_projection"_hs, snapshot.viewProjection);
+
+  for (const MeshDrawPacket& packet: snapshot.meshes)
+  {
+    StreamAllocation draw_data = stream.Allocate(sizeof(glm::mat4), backend.GetUniformBufferAlignment());
+    if (!draw_data.pData) break;
+
+    std::memcpy(draw_data.pData, &packet.model[0][0], sizeof(glm::mat4));
+    backend.BindUniformBuffer(UI_DRAW_DATA_BINDING, stream.GetBuffer(), draw_data.offset, draw_data.size);
+    backend.DrawIndexed(getMeshVertexArray(backend, resources, packet.vertexArray, packet.vertexBuffer, packet.indexBuffer), packet.indexCount);
+  }
+}
+
+
+void Renderer::executeInstances(RenderBackend& backend, RenderResources& resources, const RenderSnapshot& snapshot)
+{
+  if (snapshot.instanceGroups.empty()) return;
+
+  StreamBuffer& stream = *resources.pStream;
+
+  backend.BindPipeline(resources.instancedPipeline);
+  backend.SetUniform("u_projection"_hs, snapshot.viewProjection);
+
+  for (const InstanceDrawPacket& packet: snapshot.instanceGroups)
+  {
+    const size_t size = sizeof(InstanceData) * packet.instanceCount;
+    StreamAllocation allocation = stream.Allocate(size, backend.GetStorageBufferAlignment());
+    if (!allocation.pData) return;
+
+    std::memcpy(allocation.pData, snapshot.instances.data() + packet.firstInstance, size);
+
+    backend.BindStorageBuffer(INSTANCE_DATA_BINDING, stream.GetBuffer(), allocation.offset, allocation.size);
+    backend.DrawIndexedInstanced(getMeshVertexArray(backend, resources, packet.vertexArray, packet.vertexBuffer, packet.indexBuffer), packet.indexCount, (int)packet.instanceCount);
+  }
+}
+
+
+void Renderer::executeTexts(RenderBackend& backend, RenderResources& resources, const RenderSnapshot& snapshot)
+{
+  StreamBuffer& stream = *resources.pStream;
+
+  backend.BindPipeline(resources.textPipeline);
+  backend.SetUniform("u_projection"_hs, snapshot.ortho);
+  backend.BindPipeline(resources.uiPipeline);
+  backend.SetUniform("u_projection"_hs, snapshot.ortho);
+
+  for (const TextDrawPacket& packet: snapshot.texts)
+  {
+    if (packet.hasBackground)
+    {
+      StreamAllocation draw_data = stream.Allocate(sizeof(glm::mat4), backend.GetUniformBufferAlignment());
+      if (draw_data.pData)
       {
-        dispatcher.enqueue(DevConsoleMessageEvent{
-          .level = DebugLevel::WARNING,
-          .buffer = helper,
-        });
-        std::cerr << e.what() << "\n";
+        std::memcpy(draw_data.pData, &packet.background.model[0][0], sizeof(glm::mat4));
+
+        backend.BindPipeline(resources.uiPipeline);
+        backend.BindUniformBuffer(UI_DRAW_DATA_BINDING, stream.GetBuffer(), draw_data.offset, draw_data.size);
+        backend.DrawIndexed(getMeshVertexArray(backend, resources, packet.background.vertexArray, packet.background.vertexBuffer, packet.background.indexBuffer), packet.background.indexCount);
       }
-      catch (const std::invalid_argument& e)
+    }
+
+    if (packet.indexCount == 0) continue;
+
+    // sommets alignés sur leur taille pour que l'offset tombe pile sur un baseVertex
+    StreamAllocation vertices = stream.Allocate(sizeof(TextVertex) * packet.vertexCount, sizeof(TextVertex));
+    StreamAllocation indices = stream.Allocate(sizeof(unsigned int) * packet.indexCount, sizeof(unsigned int));
+    if (!vertices.pData || !indices.pData) continue;
+
+    std::memcpy(vertices.pData, snapshot.textVertices.data() + packet.firstVertex, vertices.size);
+    std::memcpy(indices.pData, snapshot.textIndices.data() + packet.firstIndex, indices.size);
+
+    backend.BindPipeline(resources.textPipeline);
+    backend.BindTexture(0, packet.fontTexture);
+    backend.SetUniform("pxRange"_hs, packet.pixelRange);
+    backend.DrawIndexed(resources.textVertexArray, (int)packet.indexCount, indices.offset / sizeof(unsigned int), (int)(vertices.offset / sizeof(TextVertex)));
+  }
+}
+
+
+void Renderer::executeUpscale(RenderBackend& backend, RenderResources& resources, const RenderSnapshot& snapshot, unsigned int sceneTexture)
+{
+  backend.BindPipeline(resources.upscalePipeline);
+  backend.BindTexture(0, sceneTexture);
+  backend.SetUniform("u_scale"_hs, snapshot.renderScale);
+  backend.DrawIndexed(resources.fullscreenVertexArray, 3);
+}
+
+
+void Renderer::executeFrame(const RenderSnapshot& snapshot, Profiler* pProfiler)
+{
+  _pBackend->ResetStats();
+  _pStream->BeginFrame();
+
+  applyPrograms(*_pBackend, _resources, snapshot);
+  dropChangedVertexArrays(*_pBackend, _resources, snapshot);
+
+  // chaque passe est aussi un scope GPU du Profiler
+  FrameGraph& graph = _resources.frameGraph;
+  graph.Reset();
+  graph.ImportFramebuffer("backbuffer"_hs, 0, snapshot.viewportWidth, snapshot.viewportHeight);
+
+  // en résolution dynamique la scène va dans une cible à la taille de la fenêtre dont seul le coin bas gauche est utilisé
+  // la taille des textures ne change jamais avec l'échelle, le frame graph n'a rien à recréer
+  const bool is_offscreen = snapshot.isDynamicResolution && snapshot.viewportWidth > 0 && snapshot.viewportHeight > 0;
+  const int scene_width = std::max(1, (int)((float)snapshot.viewportWidth * snapshot.renderScale));
+  const int scene_height = std::max(1, (int)((float)snapshot.viewportHeight * snapshot.renderScale));
+
+  graph.AddPass("Scene",
+    [&snapshot, is_offscreen](FrameGraphBuilder& builder)
+    {
+      if (!is_offscreen)
       {
-        dispatcher.enqueue(DevConsoleMessageEvent{
-          .level = DebugLevel::WARNING,
-          .buffer = helper,
-        });
-        std::cerr << e.what() << "\n";
+        builder.Write("backbuffer"_hs);
+        return;
       }
-    }
-  });
+      builder.Create("scene_color"_hs, FrameGraphTextureDesc{ .width = snapshot.viewportWidth, .height = snapshot.viewportHeight, .format = TextureFormat::RGBA8 });
+      builder.Create("scene_depth"_hs, FrameGraphTextureDesc{ .width = snapshot.viewportWidth, .height = snapshot.viewportHeight, .format = TextureFormat::DEPTH24 });
+    },
+    [this, &snapshot, is_offscreen, scene_width, scene_height](RenderBackend& backend, const FrameGraph&)
+    {
+      backend.SetClearColor(snapshot.clearColor);
+      backend.Clear();
+      if (is_offscreen) backend.SetViewport(0, 0, scene_width, scene_height);
+      // le terrain d'abord : il cache presque tout, le depth test rejette le reste plus tôt
+      executeTerrain(backend, _resources, snapshot);
+      executeMeshes(backend, _resources, snapshot);
+      executeInstances(backend, _resources, snapshot);
+    });
+
+  if (is_offscreen)
+  {
+    graph.AddPass("Upscale",
+      [](FrameGraphBuilder& builder)
+      {
+        builder.Read("scene_color"_hs);
+        builder.Write("backbuffer"_hs);
+      },
+      [this, &snapshot](RenderBackend& backend, const FrameGraph& graph)
+      {
+        executeUpscale(backend, _resources, snapshot, graph.GetTexture("scene_color"_hs));
+      });
+  }
+
+  // l'UI se dessine par dessus la scène
+  graph.AddPass("UI",
+    [](FrameGraphBuilder& builder)
+    {
+      builder.Read("backbuffer"_hs);
+      builder.Write("backbuffer"_hs);
+    },
+    [this, &snapshot](RenderBackend& backend, const FrameGraph&)
+    {
+      executeTexts(backend, _resources, snapshot);
+    });
+
+  if (snapshot.pUiDrawData)
+  {
+    graph.AddPass("ImGui",
+      [](FrameGraphBuilder& builder)
+      {
+        builder.Read("backbuffer"_hs);
+        builder.Write("backbuffer"_hs);
+      },
+      [&snapshot](RenderBackend&, const FrameGraph&)
+      {
+        ImGui_ImplOpenGL3_RenderDrawData(const_cast<ImDrawData*>(snapshot.pUiDrawData));
+      });
+  }
+
+  if (graph.Compile()) graph.Execute(*_pBackend, pProfiler);
+
+  _pStream->EndFrame();
+
+  if (_pWindow && !IsHeadless())
+    _pWindow->SwapBuffers();
 }
 
 
-void Renderer::onResize(const ResizeEvent& e)
+bool Renderer::startRenderThread()
+{
+  // le nouveau contexte partage textures, buffers et programmes avec _glCtx, mais pas les VAO ni les fences
+  SDL_GL_SetAttribute(SDL_GL_SHARE_WITH_CURRENT_CONTEXT, 1);
+  _renderGlCtx = SDL_GL_CreateContext(_pWindow->GetNativeWindow());
+  SDL_GL_SetAttribute(SDL_GL_SHARE_WITH_CURRENT_CONTEXT, 0);
+  if (!_renderGlCtx) return false;
+
+  // SDL_GL_CreateContext rend le nouveau contexte courant, le thread principal garde le sien pour les chargements
+  SDL_GL_MakeCurrent(_pWindow->GetNativeWindow(), _glCtx);
+
+  _renderThread = std::thread(&Renderer::renderThreadLoop, this);
+  return true;
+}
+
+
+void Renderer::stopRenderThread()
+{
+  if (!_renderThread.joinable()) return;
+
+  {
+    std::lock_guard<std::mutex> lock(_snapshotMutex);
+    _stopRenderThread = true;
+  }
+  _snapshotCondition.notify_all();
+  _renderThread.join();
+
+  SDL_GL_DestroyContext(_renderGlCtx);
+  _renderGlCtx = nullptr;
+}
+
+
+void Renderer::renderThreadLoop()
+{
+  SDL_GL_MakeCurrent(_pWindow->GetNativeWindow(), _renderGlCtx);
+
+  // tout ce qui dépend du contexte (fences du StreamBuffer, VAO) est créé ici
+  _pStream = std::make_unique<StreamBuffer>(*_pBackend, RENDER_STREAM_REGION_SIZE);
+  _resources = createResources(*_pBackend, *_pStream, 0, 0, 0, 0); // les programmes arrivent avec le premier snapshot
+  _resources.isSharedContext = true;
+
+  while (true)
+  {
+    int index;
+    {
+      std::unique_lock<std::mutex> lock(_snapshotMutex);
+      _snapshotCondition.wait(lock, [this]{ return _stopRenderThread || _renderedFrames != _submittedFrames; });
+      if (_renderedFrames == _submittedFrames) break; // arrêt demandé et plus rien à dessiner
+      index = _readIndex;
+    }
+
+    // le GPU attend les uploads du contexte principal, le thread de rendu continue d'envoyer ses commandes
+    RenderSnapshot& snapshot = _snapshots[index];
+    if (snapshot.uploadFence)
+    {
+      _pBackend->WaitFenceOnGpu(snapshot.uploadFence);
+      _pBackend->DeleteFence(snapshot.uploadFence);
+      snapshot.uploadFence = 0;
+    }
+
+    executeFrame(snapshot, nullptr);
+
+    {
+      std::lock_guard<std::mutex> lock(_snapshotMutex);
+      _renderedFrames++;
+    }
+    _snapshotCondition.notify_all();
+  }
+
+  destroyResources(*_pBackend, _resources);
+  _pStream.reset();
+
+  SDL_GL_MakeCurrent(_pWindow->GetNativeWindow(), nullptr);
+}
+
+
+void Renderer::pollShaders()
+{
+  // sur le thread principal, c'est son contexte qui a lancé les compilations
+  if (_textShader) PollShader(*_textShader);
+  if (_uiShader) PollShader(*_uiShader);
+  if (_instancedShader) PollShader(*_instancedShader);
+  if (_upscaleShader) PollShader(*_upscaleShader);
+  if (_terrainShader) PollShader(*_terrainShader);
+}
+
+
+void Renderer::publishSnapshot()
+{
+  {
+    // au plus une frame en attente : on attend que la précédente soit dessinée avant de réutiliser son snapshot
+    std::unique_lock<std::mutex> lock(_snapshotMutex);
+    _snapshotCondition.wait(lock, [this]{ return _renderedFrames == _submittedFrames; });
+    _readIndex = _writeIndex;
+    _submittedFrames++;
+  }
+  _snapshotCondition.notify_all();
+
+  _writeIndex = 1 - _writeIndex;
+}
+
+
+RenderResources Renderer::createResources(RenderBackend& backend, StreamBuffer& stream, unsigned int textProgram, unsigned int uiProgram, unsigned int instancedProgram, unsigned int terrainProgram)
+{
+  RenderResources resources{};
+  resources.pStream = &stream;
+  resources.textProgram = textProgram;
+  resources.uiProgram = uiProgram;
+  resources.instancedProgram = instancedProgram;
+  resources.terrainProgram = terrainProgram;
+
+  // l'UI est affichée par dessus tout, donc blend et pas de depth test
+  resources.textPipeline = backend.CreatePipeline(PipelineDesc{
+    .program = textProgram,
+    .blend = true,
+    .depthTest = false,
+    .cullFace = false
+  });
+  resources.uiPipeline = backend.CreatePipeline(PipelineDesc{
+    .program = uiProgram,
+    .blend = true,
+    .depthTest = false,
+    .cullFace = false
+  });
+  // même layout de sommets que l'UI (Vertex), seul l'état change
+  resources.meshPipeline = backend.CreatePipeline(PipelineDesc{
+    .program = uiProgram,
+    .blend = false,
+    .depthTest = true,
+    .cullFace = false
+  });
+  resources.instancedPipeline = backend.CreatePipeline(PipelineDesc{
+    .program = instancedProgram,
+    .blend = false,
+    .depthTest = true,
+    .cullFace = false
+  });
+  // les quads du mesher sont anti-horaires vus de l'extérieur, les faces arrière ne sont jamais visibles
+  resources.terrainPipeline = backend.CreatePipeline(PipelineDesc{
+    .program = terrainProgram,
+    .blend = false,
+    .depthTest = true,
+    .cullFace = true
+  });
+
+  VertexLayout text_layout{
+    .stride = sizeof(TextVertex),
+    .attributes = {
+      {0, 3, offsetof(TextVertex, position)}, // position => 0
+      {1, 2, offsetof(TextVertex, textureCoordinates)}, // texCoord => 1
+    }
+  };
+  resources.textVertexArray = backend.CreateVertexArray(text_layout, stream.GetBuffer(), stream.GetBuffer());
+
+  // programme fourni par applyPrograms avec le premier snapshot
+  resources.upscalePipeline = backend.CreatePipeline(PipelineDesc{
+    .program = 0,
+    .blend = false,
+    .depthTest = false,
+    .cullFace = false
+  });
+
+  // un seul triangle deux fois plus grand que l'écran, pas de diagonale au milieu
+  const float fullscreen_vertices[] = { -1.0f, -1.0f, 3.0f, -1.0f, -1.0f, 3.0f };
+  const unsigned int fullscreen_indices[] = { 0, 1, 2 };
+  resources.fullscreenVertexBuffer = backend.CreateBuffer(sizeof(fullscreen_vertices), fullscreen_vertices, BufferUsage::STATIC);
+  resources.fullscreenIndexBuffer = backend.CreateBuffer(sizeof(fullscreen_indices), fullscreen_indices, BufferUsage::STATIC);
+  VertexLayout fullscreen_layout{
+    .stride = sizeof(float) * 2,
+    .attributes = {
+      {0, 2, 0}, // position => 0
+    }
+  };
+  resources.fullscreenVertexArray = backend.CreateVertexArray(fullscreen_layout, resources.fullscreenVertexBuffer, resources.fullscreenIndexBuffer);
+
+  return resources;
+}
+
+
+void Renderer::destroyResources(RenderBackend& backend, RenderResources& resources)
+{
+  for (auto& [key, vertex_array]: resources.meshVertexArrays) backend.DestroyVertexArray(vertex_array);
+  resources.meshVertexArrays.clear();
+
+  backend.DestroyVertexArray(resources.textVertexArray);
+  backend.DestroyPipeline(resources.textPipeline);
+  backend.DestroyPipeline(resources.uiPipeline);
+  backend.DestroyPipeline(resources.meshPipeline);
+  backend.DestroyPipeline(resources.instancedPipeline);
+  backend.DestroyPipeline(resources.upscalePipeline);
+  backend.DestroyPipeline(resources.terrainPipeline);
+  backend.DestroyVertexArray(resources.fullscreenVertexArray);
+  backend.DestroyBuffer(resources.fullscreenVertexBuffer);
+  backend.DestroyBuffer(resources.fullscreenIndexBuffer);
+
+  resources.frameGraph.Destroy(backend);
+}
+
+
+void Renderer::applyPrograms(RenderBackend& backend, RenderResources& resources, const RenderSnapshot& snapshot)
+{
+  if (resources.textProgram != snapshot.textProgram)
+  {
+    backend.SetPipelineProgram(resources.textPipeline, snapshot.textProgram);
+    resources.textProgram = snapshot.textProgram;
+  }
+  if (resources.uiProgram != snapshot.uiProgram)
+  {
+    backend.SetPipelineProgram(resources.uiPipeline, snapshot.uiProgram);
+    backend.SetPipelineProgram(resources.meshPipeline, snapshot.uiProgram);
+    resources.uiProgram = snapshot.uiProgram;
+  }
+  if (resources.instancedProgram != snapshot.instancedProgram)
+  {
+    backend.SetPipelineProgram(resources.instancedPipeline, snapshot.instancedProgram);
+    resources.instancedProgram = snapshot.instancedProgram;
+  }
+  if (resources.upscaleProgram != snapshot.upscaleProgram)
+  {
+    backend.SetPipelineProgram(resources.upscalePipeline, snapshot.upscaleProgram);
+    resources.upscaleProgram = snapshot.upscaleProgram;
+  }
+  if (resources.terrainProgram != snapshot.terrainProgram)
+  {
+    backend.SetPipelineProgram(resources.terrainPipeline, snapshot.terrainProgram);
+    resources.terrainProgram = snapshot.terrainProgram;
+  }
+}
+
+
+void Renderer::dropChangedVertexArrays(RenderBackend& backend, RenderResources& resources, const RenderSnapshot& snapshot)
+{
+  if (!resources.isSharedContext) return;
+
+  // buffers réécrits : recréer le VAO les rattache dans ce contexte, le prochain getMeshVertexArray voit leur nouveau contenu
+  // buffers détruits : le VAO les gardait en vie, leurs noms peuvent déjà servir à d'autres buffers
+  for (uint64_t key: snapshot.changedMeshes)
+  {
+    auto it = resources.meshVertexArrays.find(key);
+    if (it == resources.meshVertexArrays.end()) continue;
+
+    backend.DestroyVertexArray(it->second);
+    resources.meshVertexArrays.erase(it);
+  }
+}
+
+
+unsigned int Renderer::getMeshVertexArray(RenderBackend& backend, RenderResources& resources, unsigned int vertexArray, unsigned int vertexBuffer, unsigned int indexBuffer)
+{
+  if (!resources.isSharedContext) return vertexArray;
+
+  const uint64_t key = getMeshKey(vertexBuffer, indexBuffer);
+  auto it = resources.meshVertexArrays.find(key);
+  if (it != resources.meshVertexArrays.end()) return it->second;
+
+  // même layout que OBJLoader
+  VertexLayout layout{
+    .stride = sizeof(Vertex),
+    .attributes = {
+      {0, 3, offsetof(Vertex, position)}, // position => 0
+      {1, 3, offsetof(Vertex, normal)}, // normal => 1
+      {2, 2, offsetof(Vertex, textureCoordinates)}, // textureCoordinates => 2
+      {3, 4, offsetof(Vertex, color)}, // color => 3
+    }
+  };
+  unsigned int vao = backend.CreateVertexArray(layout, vertexBuffer, indexBuffer);
+  resources.meshVertexArrays.emplace(key, vao);
+  return vao;
+}
+
+
+void Renderer::registerCommands()
+{
+  auto& command_manager = _pRegistry->ctx().get<CommandManager>();
+  auto& dispatcher = _pRegistry->ctx().get<entt::dispatcher>();
+
+  std::string helper = "$set_clear_color <red> <green> <blue> --> color values must be between 0 and 1";
+  command_manager.Register(Command{
+    .name = "set_clear_color",
+    .helper = helper,
+    .func = [this, &dispatcher, helper](auto& args)
+    {
+      try {
+        if (args.size() != 3) throw std::out_of_range("[Engine] $set_clear_color needs 3 args");
+        
+        size_t last_valid_index;
+        float r = std::stof(args[0], &last_valid_index);
+        if (last_valid_index != args[0].size() || r < 0.0f || r > 1.0f) throw std::invalid_argument("[Engine] args[0] must be between 0 and 1 included");
+        float g = std::stof(args[1], &last_valid_index);
+        if (last_valid_index != args[1].size() || g < 0.0f || g > 1.0f) throw std::invalid_argument("[Engine] args[1] must be between 0 and 1 included");
+        float b = std::stof(args[2], &last_valid_index);
+        if (last_valid_index != args[2].size() || b < 0.0f || b > 1.0f) throw std::invalid_argument("[Engine] args[2] must be between 0 and 1 included");
+
+        _clearColor = glm::vec4(r, g, b, 1.0f);
+      } 
+      // la dite erreur
+      catch (const std::out_of_range& e) 
+      {
+        dispatcher.enqueue(DevConsoleMessageEvent{
+          .level = DebugLevel::WARNING,
+          .buffer = helper,
+        });
+        std::cerr << e.what() << "\n";
+      }
+      catch (const std::invalid_argument& e)
+      {
+        dispatcher.enqueue(DevConsoleMessageEvent{
+          .level = DebugLevel::WARNING,
+          .buffer = helper,
+        });
+        std::cerr << e.what() << "\n";
+      }
+    }
+  });
+
+
+  helper = "$set_clear_color_rgb <red> <green> <blue> --> color values must be between 0 and 255";
+  command_manager.Register(Command{
+    .name = "set_clear_color_rgb",
+    .helper = helper,
+    .func = [this, &dispatcher, helper](auto& args)
+    {
+      try {
+        if (args.size() != 3) throw std::out_of_range("[Engine] $set_clear_color_rgb needs 3 args");
+        
+        size_t last_valid_index;
+        int r = std::stoi(args[0], &last_valid_index);
+        if (last_valid_index != args[0].size() || r < 0 || r > 255) throw std::invalid_argument("[Engine] args[0] must be between 0 and 255 included");
+        int g = std::stoi(args[1], &last_valid_index);
+        if (last_valid_index != args[1].size() || g < 0 || g > 255) throw std::invalid_argument("[Engine] args[1] must be between 0 and 255 included");
+        int b = std::stoi(args[2], &last_valid_index);
+        if (last_valid_index != args[2].size() || b < 0 || b > 255) throw std::invalid_argument("[Engine] args[2] must be between 0 and 255 included");
+
+        _clearColor = glm::vec4((float) r / 255.0f, (float) g / 255.0f, (float) b / 255.0f, 1.0f);
+      } 
+      // la dite erreur
+      catch (const std::out_of_range& e) 
+      {
+        dispatcher.enqueue(DevConsoleMessageEvent{
+          .level = DebugLevel::WARNING,
+          .buffer = helper,
+        });
+        std::cerr << e.what() << "\n";
+      }
+      catch (const std::invalid_argument& e)
+      {
+        dispatcher.enqueue(DevConsoleMessageEvent{
+          .level = DebugLevel::WARNING,
+          .buffer = helper,
+        });
+        std::cerr << e.what() << "\n";
+      }
+    }
+  });
+
+
+  helper = "$occlusion <toggle> --> 'toggle' must be 0 or 1";
+  command_manager.Register(Command{
+    .name = "occlusion",
+    .helper = helper,
+    .func = [this, &dispatcher, helper](auto& args)
+    {
+      try {
+        if (args.size() != 1) throw std::out_of_range("[Engine] $occlusion needs only 1 arg");
+
+        size_t last_valid_index;
+        int toggle = std::stoi(args[0], &last_valid_index);
+        if (last_valid_index != args[0].size() || (toggle != 0 && toggle != 1)) throw std::invalid_argument("[Engine] args[0] must be 1 or 0");
+
+        _useOcclusion = (bool) toggle;
+      }
+      catch (const std::out_of_range& e) 
+      {
+        dispatcher.enqueue(DevConsoleMessageEvent{
+          .level = DebugLevel::WARNING,
+          .buffer = helper,
+        });
+        std::cerr << e.what() << "\n";
+      }
+      catch (const std::invalid_argument& e)
+      {
+        dispatcher.enqueue(DevConsoleMessageEvent{
+          .level = DebugLevel::WARNING,
+          .buffer = helper,
+        });
+        std::cerr << e.what() << "\n";
+      }
+    }
+  });
+
+
+  helper = "$dynamic_resolution <toggle> --> 'toggle' must be 0 or 1";
+  command_manager.Register(Command{
+    .name = "dynamic_resolution",
+    .helper = helper,
+    .func = [this, &dispatcher, helper](auto& args)
+    {
+      try {
+        if (args.size() != 1) throw std::out_of_range("[Engine] $dynamic_resolution needs only 1 arg");
+
+        size_t last_valid_index;
+        int toggle = std::stoi(args[0], &last_valid_index);
+        if (last_valid_index != args[0].size() || (toggle != 0 && toggle != 1)) throw std::invalid_argument("[Engine] args[0] must be 1 or 0");
+
+        _useDynamicResolution = (bool) toggle;
+        _dynamicResolution.Reset();
+      }
+      catch (const std::out_of_range& e) 
+      {
+        dispatcher.enqueue(DevConsoleMessageEvent{
+          .level = DebugLevel::WARNING,
+          .buffer = helper,
+        });
+        std::cerr << e.what() << "\n";
+      }
+      catch (const std::invalid_argument& e)
+      {
+        dispatcher.enqueue(DevConsoleMessageEvent{
+          .level = DebugLevel::WARNING,
+          .buffer = helper,
+        });
+        std::cerr << e.what() << "\n";
+      }
+    }
+  });
+
+
+  helper = "$dynamic_resolution_target <milliseconds> --> 'milliseconds' must be a positive number (GPU time per frame)";
+  command_manager.Register(Command{
+    .name = "dynamic_resolution_target",
+    .helper = helper,
+    .func = [this, &dispatcher, helper](auto& args)
+    {
+      try {
+        if (args.size() != 1) throw std::out_of_range("[Engine] $dynamic_resolution_target needs only 1 arg");
+
+        size_t last_valid_index;
+        float milliseconds = std::stof(args[0], &last_valid_index);
+        if (last_valid_index != args[0].size() || milliseconds <= 0.0f) throw std::invalid_argument("[Engine] args[0] must be a positive number");
+
+        _dynamicResolution.SetTarget(milliseconds);
+      }
+      catch (const std::out_of_range& e) 
+      {
+        dispatcher.enqueue(DevConsoleMessageEvent{
+          .level = DebugLevel::WARNING,
+          .buffer = helper,
+        });
+        std::cerr << e.what() << "\n";
+      }
+      catch (const std::invalid_argument& e)
+      {
+        dispatcher.enqueue(DevConsoleMessageEvent{
+          .level = DebugLevel::WARNING,
+          .buffer = helper,
+        });
+        std::cerr << e.what() << "\n";
+      }
+    }
+  });
+
+
+  registerBenchCommand();
+  registerCullingBenchCommand();
+  registerOcclusionBenchCommand();
+}
+
+
+void Renderer::registerBenchCommand()
+{
+  auto& command_manager = _pRegistry->ctx().get<CommandManager>();
+  auto& dispatcher = _pRegistry->ctx().get<entt::dispatcher>();
+
+  // mesure le coût CPU du rendu (génération du texte, extraction du snapshot, soumission) sans toucher au GPU
+  std::string helper = "$bench_render <frames> --> 'frames' must be a positive integer";
+  command_manager.Register(Command{
+    .name = "bench_render",
+    .helper = helper,
+    .func = [this, &dispatcher, helper](auto& args)
+    {
+      try {
+        if (args.size() != 1) throw std::out_of_range("[Engine] $bench_render needs only 1 arg");
+
+        size_t last_valid_index;
+        int frames = std::stoi(args[0], &last_valid_index);
+        if (last_valid_index != args[0].size() || frames <= 0) throw std::invalid_argument("[Engine] args[0] must be a positive integer");
+
+        NullRenderBackend null_backend(false);
+        StreamBuffer null_stream(null_backend, RENDER_STREAM_REGION_SIZE);
+        RenderResources null_resources = createResources(null_backend, null_stream, 0, 0, 0, 0);
+
+        double meshing_ms = 0.0;
+        double extract_ms = 0.0;
+        double execute_ms = 0.0;
+        TextMesh scratch;
+        RenderSnapshot snapshot;
+
+        for (int i = 0; i < frames; i++)
+        {
+          null_backend.ResetStats();
+          null_stream.BeginFrame();
+
+          auto start = std::chrono::steady_clock::now();
+          _pRegistry->view<Text>().each([&scratch](const Text& text)
+          {
+            if (text.pFont) BuildTextMeshGeometry(scratch, text);
+          });
+          auto meshed = std::chrono::steady_clock::now();
+          extractScene(snapshot);
+          auto extracted = std::chrono::steady_clock::now();
+          Execute(null_backend, null_resources, snapshot);
+          null_stream.EndFrame();
+          auto executed = std::chrono::steady_clock::now();
+
+          meshing_ms += std::chrono::duration<double, std::milli>(meshed - start).count();
+          extract_ms += std::chrono::duration<double, std::milli>(extracted - meshed).count();
+          execute_ms += std::chrono::duration<double, std::milli>(executed - extracted).count();
+        }
+
+        const RenderStats& stats = null_backend.GetStats();
+        dispatcher.enqueue(DevConsoleMessageEvent{
+          .level = DebugLevel::INFO,
+          .buffer = "[bench_render] " + std::to_string(frames) + " frames"
+            + "\ntext meshing: " + std::to_string(meshing_ms / frames) + " ms/frame"
+            + "\nextract: " + std::to_string(extract_ms / frames) + " ms/frame"
+            + "\nexecute: " + std::to_string(execute_ms / frames) + " ms/frame"
+            + "\ndraws: " + std::to_string(stats.drawCalls)
+            + ", instances: " + std::to_string(stats.instances)
+            + ", pipeline binds: " + std::to_string(stats.pipelineBinds)
+            + ", uniforms: " + std::to_string(stats.uniformUploads)
+        });
+      }
+      catch (const std::out_of_range& e) 
+      {
+        dispatcher.enqueue(DevConsoleMessageEvent{
+          .level = DebugLevel::WARNING,
+          .buffer = helper,
+        });
+        std::cerr << e.what() << "\n";
+      }
+      catch (const std::invalid_argument& e)
+      {
+        dispatcher.enqueue(DevConsoleMessageEvent{
+          .level = DebugLevel::WARNING,
+          .buffer = helper,
+        });
+        std::cerr << e.what() << "\n";
+      }
+    }
+  });
+}
+
+
+void Renderer::registerCullingBenchCommand()
+{
+  auto& command_manager = _pRegistry->ctx().get<CommandManager>();
+  auto& dispatcher = _pRegistry->ctx().get<entt::dispatcher>();
+
+  // boites aléatoires dans un cube de 1000 unités, caméra à l'origine qui regarde vers -Z
+  std::string helper = "$bench_culling <count> --> 'count' must be a positive integer";
+  command_manager.Register(Command{
+    .name = "bench_culling",
+    .helper = helper,
+    .func = [&dispatcher, helper](auto& args)
+    {
+      try {
+        if (args.size() != 1) throw std::out_of_range("[Engine] $bench_culling needs only 1 arg");
+
+        size_t last_valid_index;
+        int count = std::stoi(args[0], &last_valid_index);
+        if (last_valid_index != args[0].size() || count <= 0) throw std::invalid_argument("[Engine] args[0] must be a positive integer");
+
+        std::mt19937 rng(1337);
+        std::uniform_real_distribution<float> position(-500.0f, 500.0f);
+        std::uniform_real_distribution<float> size(0.5f, 4.0f);
+
+        VisibilitySet set;
+        for (int i = 0; i < count; i++)
+        {
+          glm::vec3 min(position(rng), position(rng), position(rng));
+          set.Set((uint32_t)i, min, min + glm::vec3(size(rng)));
+        }
+
+        Camera camera{};
+        Frustum frustum = ExtractFrustum(GetProjectionMatrix(camera, 16.0f / 9.0f) * GetViewMatrix(glm::mat4(1.0f)));
+
+        constexpr int iterations = 100;
+        std::vector<uint32_t> visible;
+        visible.reserve(count);
+
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; i++) set.Cull(frustum, visible);
+        double cull_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / iterations;
+
+        dispatcher.enqueue(DevConsoleMessageEvent{
+          .level = DebugLevel::INFO,
+          .buffer = "[bench_culling] " + std::to_string(count) + " aabbs"
+            + "\ncull: " + std::to_string(cull_ms) + " ms"
+            + "\nvisible: " + std::to_string(visible.size())
+        });
+      }
+      catch (const std::out_of_range& e) 
+      {
+        dispatcher.enqueue(DevConsoleMessageEvent{
+          .level = DebugLevel::WARNING,
+          .buffer = helper,
+        });
+        std::cerr << e.what() << "\n";
+      }
+      catch (const std::invalid_argument& e)
+      {
+        dispatcher.enqueue(DevConsoleMessageEvent{
+          .level = DebugLevel::WARNING,
+          .buffer = helper,
+        });
+        std::cerr << e.what() << "\n";
+      }
+    }
+  });
+}
+
+
+void Renderer::registerOcclusionBenchCommand()
+{
+  auto& command_manager = _pRegistry->ctx().get<CommandManager>();
+  auto& dispatcher = _pRegistry->ctx().get<entt::dispatcher>();
+
+  // une rangée de piliers à 50 unités devant la caméra, des boites aléatoires derrière
+  std::string helper = "$bench_occlusion <count> --> 'count' must be a positive integer";
+  command_manager.Register(Command{
+    .name = "bench_occlusion",
+    .helper = helper,
+    .func = [this, &dispatcher, helper](auto& args)
+    {
+      try {
+        if (args.size() != 1) throw std::out_of_range("[Engine] $bench_occlusion needs only 1 arg");
+
+        size_t last_valid_index;
+        int count = std::stoi(args[0], &last_valid_index);
+        if (last_valid_index != args[0].size() || count <= 0) throw std::invalid_argument("[Engine] args[0] must be a positive integer");
+
+        std::mt19937 rng(1337);
+        std::uniform_real_distribution<float> position_xy(-200.0f, 200.0f);
+        std::uniform_real_distribution<float> position_z(-500.0f, -60.0f);
+        std::uniform_real_distribution<float> size(0.5f, 4.0f);
+
+        VisibilitySet set;
+        for (int i = 0; i < count; i++)
+        {
+          glm::vec3 min(position_xy(rng), position_xy(rng), position_z(rng));
+          set.Set((uint32_t)i, min, min + glm::vec3(size(rng)));
+        }
+
+        Camera camera{};
+        glm::mat4 view_projection = GetProjectionMatrix(camera, 16.0f / 9.0f) * GetViewMatrix(glm::mat4(1.0f));
+        Frustum frustum = ExtractFrustum(view_projection);
+        JobSystem* pJobs = _pRegistry->ctx().find<JobSystem>();
+
+        constexpr int iterations = 100;
+        OcclusionBuffer occlusion;
+        std::vector<uint32_t> in_frustum;
+        std::vector<uint32_t> visible;
+        in_frustum.reserve(count);
+        visible.reserve(count);
+        set.Cull(frustum, in_frustum);
+
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; i++)
+        {
+          occlusion.Begin(view_projection);
+          for (int pillar = -8; pillar < 8; pillar++)
+          {
+            float x = (float)pillar * 12.0f;
+            occlusion.AddOccluderBox(glm::vec3(x, -60.0f, -52.0f), glm::vec3(x + 9.0f, 60.0f, -48.0f));
+          }
+          occlusion.Rasterize(pJobs);
+        }
+        double raster_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / iterations;
+
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; i++)
+        {
+          visible = in_frustum;
+          set.CullOccluded(occlusion, visible);
+        }
+        double test_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / iterations;
+
+        dispatcher.enqueue(DevConsoleMessageEvent{
+          .level = DebugLevel::INFO,
+          .buffer = "[bench_occlusion] " + std::to_string(count) + " aabbs, " + std::to_string(occlusion.GetTriangleCount()) + " occluder triangles"
+            + "\nraster + hi-z: " + std::to_string(raster_ms) + " ms"
+            + "\ntest: " + std::to_string(test_ms) + " ms"
+            + "\nin frustum: " + std::to_string(in_frustum.size())
+            + "\nvisible: " + std::to_string(visible.size())
+        });
+      }
+      catch (const std::out_of_range& e) 
+      {
+        dispatcher.enqueue(DevConsoleMessageEvent{
+          .level = DebugLevel::WARNING,
+          .buffer = helper,
+        });
+        std::cerr << e.what() << "\n";
+      }
+      catch (const std::invalid_argument& e)
+      {
+        dispatcher.enqueue(DevConsoleMessageEvent{
+          .level = DebugLevel::WARNING,
+          .buffer = helper,
+        });
+        std::cerr << e.what() << "\n";
+      }
+    }
+  });
+}
+
+
+void Renderer::onResize(const ResizeEvent& e)
 {
   int width = e.width;
   int height = e.height;
   std::cout << "[Renderer] " << e.name << "[" << width << ", " << height << "]" << " called\n";
-  glViewport(0, 0, width, height);
+  // appliqué par le thread qui dessine, via le snapshot de la prochaine frame
+  _viewportWidth = width;
+  _viewportHeight = height;
   _ortho = glm::ortho(0.0f, (float)width, 0.0f, (float)height, -1.0f, 1.0f);
+}
+
+void Renderer::onMeshBuffersChanged(const MeshBuffersChangedEvent& e)
+{
+  // sans thread de rendu les VAO des Mesh sont utilisés tels quels, rien à recréer
+  if (_useRenderThread) _changedMeshes.push_back(getMeshKey(e.vertexBuffer, e.indexBuffer));
 }
\ No newline at end of file
@@ -0,0 +1,95 @@
+#include "graphics/stream_buffer.h"
+
+
+#include <iostream>
+
+
+StreamBuffer::StreamBuffer(RenderBackend& backend, size_t regionSize)
+  : _backend(backend),
+    _buffer(0),
+    _pMapped(nullptr),
+    _regionSize(regionSize),
+    _region(0),
+    _head(0),
+    _stallCount(0),
+    _hasWarnedOverflow(false)
+{
+  void* mapped = nullptr;
+  _buffer = _backend.CreatePersistentBuffer(_regionSize * STREAM_BUFFER_REGIONS, &mapped);
+  _pMapped = (uint8_t*)mapped;
+
+  if (!_buffer || !_pMapped)
+  {
+    std::cerr << "[StreamBuffer] Failed to create persistent buffer\n";
+    _buffer = 0;
+    _pMapped = nullptr;
+  }
+}
+
+
+StreamBuffer::~StreamBuffer()
+{
+  for (uint64_t fence: _fences)
+  {
+    _backend.WaitFence(fence, UINT64_MAX);
+    _backend.DeleteFence(fence);
+  }
+
+  _backend.DestroyBuffer(_buffer);
+}
+
+
+void StreamBuffer::BeginFrame()
+{
+  _region = (_region + 1) % STREAM_BUFFER_REGIONS;
+  _head = _region * _regionSize;
+
+  uint64_t& fence = _fences[_region];
+  if (!fence) return;
+
+  // timeout nul d'abord pour savoir si on bloque vraiment, sinon on attend pour de bon
+  if (!_backend.WaitFence(fence, 0))
+  {
+    _stallCount++;
+    _backend.WaitFence(fence, UINT64_MAX);
+  }
+
+  _backend.DeleteFence(fence);
+  fence = 0;
+}
+
+
+void StreamBuffer::EndFrame()
+{
+  uint64_t& fence = _fences[_region];
+  if (fence) _backend.DeleteFence(fence);
+  fence = _backend.InsertFence();
+}
+
+
+StreamAllocation StreamBuffer::Allocate(size_t size, size_t alignment)
+{
+  if (!_pMapped || size == 0) return StreamAllocation{};
+
+  size_t offset = _head;
+  if (alignment > 1) offset = ((offset + alignment - 1) / alignment) * alignment;
+
+  size_t region_end = (_region + 1) * _regionSize;
+  if (offset + size > region_end)
+  {
+    if (!_hasWarnedOverflow)
+    {
+      std::cerr << "[StreamBuffer] Region full (" << _regionSize << " bytes), allocation of " << size << " bytes dropped\n";
+      _hasWarnedOverflow = true;
+    }
+    return StreamAllocation{};
+  }
+
+  _head = offset + size;
+
+  return StreamAllocation{
+    .pData = _pMapped + offset,
+    .offset = offset,
+    .size = size,
+  };
+}
\ No newline at end of file
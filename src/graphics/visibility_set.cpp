@@ -0,0 +1,182 @@
+#include "graphics/visibility_set.h"
+
+
+#include "graphics/occlusion_buffer.h"
+
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define VOXL_CULL_AVX
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define VOXL_CULL_SSE
+#endif
+
+
+void VisibilitySet::Set(uint32_t id, const glm::vec3& min, const glm::vec3& max)
+{
+  if (id >= _slots.size()) _slots.resize(id + 1, INVALID_SLOT);
+
+  uint32_t slot = _slots[id];
+  if (slot == INVALID_SLOT)
+  {
+    slot = (uint32_t)_ids.size();
+    _slots[id] = slot;
+    _ids.push_back(id);
+    _minX.push_back(min.x);
+    _minY.push_back(min.y);
+    _minZ.push_back(min.z);
+    _maxX.push_back(max.x);
+    _maxY.push_back(max.y);
+    _maxZ.push_back(max.z);
+    return;
+  }
+
+  _minX[slot] = min.x;
+  _minY[slot] = min.y;
+  _minZ[slot] = min.z;
+  _maxX[slot] = max.x;
+  _maxY[slot] = max.y;
+  _maxZ[slot] = max.z;
+}
+
+
+void VisibilitySet::Remove(uint32_t id)
+{
+  if (!Contains(id)) return;
+
+  // on déplace le dernier slot dans le trou pour garder les tableaux compacts
+  uint32_t slot = _slots[id];
+  uint32_t last = (uint32_t)_ids.size() - 1;
+
+  _ids[slot] = _ids[last];
+  _minX[slot] = _minX[last];
+  _minY[slot] = _minY[last];
+  _minZ[slot] = _minZ[last];
+  _maxX[slot] = _maxX[last];
+  _maxY[slot] = _maxY[last];
+  _maxZ[slot] = _maxZ[last];
+  _slots[_ids[slot]] = slot;
+
+  _ids.pop_back();
+  _minX.pop_back();
+  _minY.pop_back();
+  _minZ.pop_back();
+  _maxX.pop_back();
+  _maxY.pop_back();
+  _maxZ.pop_back();
+  _slots[id] = INVALID_SLOT;
+}
+
+
+void VisibilitySet::Clear()
+{
+  _ids.clear();
+  _slots.clear();
+  _minX.clear();
+  _minY.clear();
+  _minZ.clear();
+  _maxX.clear();
+  _maxY.clear();
+  _maxZ.clear();
+}
+
+
+void VisibilitySet::Cull(const Frustum& frustum, std::vector<uint32_t>& visible) const
+{
+  visible.clear();
+
+  const size_t count = _ids.size();
+
+  // pour chaque plan on prend le coin de l'AABB le plus loin dans la direction de la normale (p-vertex)
+  // le signe de la normale est le même pour toutes les boites, donc le choix min/max se fait une fois par plan
+  const float* px[6];
+  const float* py[6];
+  const float* pz[6];
+  for (int p = 0; p < 6; p++)
+  {
+    const glm::vec4& plane = frustum.planes[p];
+    px[p] = (plane.x >= 0.0f) ? _maxX.data() : _minX.data();
+    py[p] = (plane.y >= 0.0f) ? _maxY.data() : _minY.data();
+    pz[p] = (plane.z >= 0.0f) ? _maxZ.data() : _minZ.data();
+  }
+
+  size_t i = 0;
+
+#if defined(VOXL_CULL_AVX)
+  for (; i + 8 <= count; i += 8)
+  {
+    __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+    for (int p = 0; p < 6; p++)
+    {
+      const glm::vec4& plane = frustum.planes[p];
+      __m256 distance = _mm256_add_ps(
+        _mm256_add_ps(
+          _mm256_mul_ps(_mm256_loadu_ps(px[p] + i), _mm256_set1_ps(plane.x)),
+          _mm256_mul_ps(_mm256_loadu_ps(py[p] + i), _mm256_set1_ps(plane.y))),
+        _mm256_add_ps(
+          _mm256_mul_ps(_mm256_loadu_ps(pz[p] + i), _mm256_set1_ps(plane.z)),
+          _mm256_set1_ps(plane.w)));
+      inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, _mm256_setzero_ps(), _CMP_GE_OQ));
+    }
+
+    int mask = _mm256_movemask_ps(inside);
+    if (!mask) continue;
+    for (int bit = 0; bit < 8; bit++)
+    {
+      if (mask & (1 << bit)) visible.push_back(_ids[i + bit]);
+    }
+  }
+#elif defined(VOXL_CULL_SSE)
+  for (; i + 4 <= count; i += 4)
+  {
+    __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+    for (int p = 0; p < 6; p++)
+    {
+      const glm::vec4& plane = frustum.planes[p];
+      __m128 distance = _mm_add_ps(
+        _mm_add_ps(
+          _mm_mul_ps(_mm_loadu_ps(px[p] + i), _mm_set1_ps(plane.x)),
+          _mm_mul_ps(_mm_loadu_ps(py[p] + i), _mm_set1_ps(plane.y))),
+        _mm_add_ps(
+          _mm_mul_ps(_mm_loadu_ps(pz[p] + i), _mm_set1_ps(plane.z)),
+          _mm_set1_ps(plane.w)));
+      inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, _mm_setzero_ps()));
+    }
+
+    int mask = _mm_movemask_ps(inside);
+    if (!mask) continue;
+    for (int bit = 0; bit < 4; bit++)
+    {
+      if (mask & (1 << bit)) visible.push_back(_ids[i + bit]);
+    }
+  }
+#endif
+
+  // reste (ou tout si pas de SIMD)
+  for (; i < count; i++)
+  {
+    bool inside = true;
+    for (int p = 0; p < 6 && inside; p++)
+    {
+      const glm::vec4& plane = frustum.planes[p];
+      float distance = px[p][i] * plane.x + py[p][i] * plane.y + pz[p][i] * plane.z + plane.w;
+      inside = distance >= 0.0f;
+    }
+    if (inside) visible.push_back(_ids[i]);
+  }
+}
+
+
+void VisibilitySet::CullOccluded(const OcclusionBuffer& occlusion, std::vector<uint32_t>& visible) const
+{
+  size_t kept = 0;
+  for (uint32_t id: visible)
+  {
+    const uint32_t slot = _slots[id];
+    glm::vec3 min(_minX[slot], _minY[slot], _minZ[slot]);
+    glm::vec3 max(_maxX[slot], _maxY[slot], _maxZ[slot]);
+    if (occlusion.IsVisible(min, max)) visible[kept++] = id;
+  }
+  visible.resize(kept);
+}
\ No newline at end of file
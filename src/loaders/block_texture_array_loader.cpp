@@ -0,0 +1,286 @@
+#include "loaders/block_texture_array_loader.h"
+
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <unordered_map>
+
+#include <glad/glad.h>
+#include <nlohmann/json.hpp>
+#include <stb_image.h>
+
+#include "core/job_system.h"
+#include "loaders/texture_cooker.h"
+
+
+struct BlockManifest
+{
+  uint32_t tileSize = 16;
+  std::vector<std::string> blockNames;
+  std::vector<std::array<uint16_t, (size_t)BlockFace::COUNT>> blockLayers; // layer de chaque face, 0 = manquant
+  std::vector<std::string> files; // layer i + 1
+};
+
+
+static std::string getManifestPath(const std::string& manifestName)
+{
+  return std::string("assets/blocks/") + manifestName + std::string(".json");
+}
+
+
+static std::string getBlockTexturePath(const std::string& file)
+{
+  return std::string("assets/blocks/") + file;
+}
+
+
+static bool parseManifest(const std::string& manifestName, BlockManifest& manifest)
+{
+  std::string manifest_path = getManifestPath(manifestName);
+
+  std::fstream f(manifest_path);
+  if (!f.is_open())
+  {
+    std::cerr << "Failed to open '" << manifest_path << "'\n";
+    return false;
+  }
+
+  nlohmann::json j = nlohmann::json::parse(f, nullptr, false);
+  if (j.is_discarded() || !j.contains("blocks") || !j["blocks"].is_array())
+  {
+    std::cerr << "Failed to parse '" << manifest_path << "'\n";
+    return false;
+  }
+
+  manifest.tileSize = j.value("tileSize", 16u);
+  if (manifest.tileSize == 0 || (manifest.tileSize & (manifest.tileSize - 1)) != 0)
+  {
+    std::cerr << "[BlockTextureArray] " << manifest_path << " - tileSize must be a power of 2\n";
+    return false;
+  }
+
+  // la face la plus précise l'emporte : all < side < face
+  static const char* face_names[(size_t)BlockFace::COUNT] = { "east", "west", "top", "bottom", "south", "north" };
+  static const bool is_side[(size_t)BlockFace::COUNT] = { true, true, false, false, true, true };
+
+  std::unordered_map<std::string, uint16_t> file_layers;
+  auto get_layer = [&](const nlohmann::json& value) -> uint16_t
+  {
+    if (!value.is_string()) return BLOCK_MISSING_LAYER;
+
+    const std::string file = value.get<std::string>();
+    auto [it, inserted] = file_layers.try_emplace(file, (uint16_t)(manifest.files.size() + 1));
+    if (inserted) manifest.files.push_back(file);
+    return it->second;
+  };
+
+  for (const auto& block: j["blocks"])
+  {
+    if (!block.is_object() || !block.contains("name") || !block["name"].is_string()) continue;
+
+    const nlohmann::json textures = block.value("textures", nlohmann::json::object());
+    std::array<uint16_t, (size_t)BlockFace::COUNT> layers;
+    for (size_t face = 0; face < (size_t)BlockFace::COUNT; face++)
+    {
+      if (textures.contains(face_names[face])) layers[face] = get_layer(textures[face_names[face]]);
+      else if (is_side[face] && textures.contains("side")) layers[face] = get_layer(textures["side"]);
+      else if (textures.contains("all")) layers[face] = get_layer(textures["all"]);
+      else layers[face] = BLOCK_MISSING_LAYER;
+    }
+
+    manifest.blockNames.push_back(block["name"].get<std::string>());
+    manifest.blockLayers.push_back(layers);
+  }
+
+  return true;
+}
+
+
+// damier magenta et noir, bien visible en jeu
+static void createMissingLayer(uint32_t tileSize, std::vector<MipLevel>& levels)
+{
+  levels.assign(1, MipLevel{ .width = tileSize, .height = tileSize });
+  levels[0].rgba.resize((size_t)tileSize * tileSize * 4);
+
+  const uint32_t half = std::max(1u, tileSize / 2);
+  for (uint32_t y = 0; y < tileSize; y++)
+  {
+    for (uint32_t x = 0; x < tileSize; x++)
+    {
+      const bool magenta = ((x / half) + (y / half)) % 2 == 0;
+      uint8_t* pixel = &levels[0].rgba[((size_t)y * tileSize + x) * 4];
+      pixel[0] = magenta ? 255 : 0;
+      pixel[1] = 0;
+      pixel[2] = magenta ? 255 : 0;
+      pixel[3] = 255;
+    }
+  }
+
+  GenerateMipChain(levels, nullptr);
+}
+
+
+// appelé sur un worker, un layer entier par tâche : ses mips restent sur le même thread
+static bool loadLayer(const std::string& path, uint32_t tileSize, std::vector<MipLevel>& levels)
+{
+  int width;
+  int height;
+  int channels;
+
+  // le flag global de stb_image n'est pas fait pour plusieurs threads
+  stbi_set_flip_vertically_on_load_thread(true);
+  unsigned char* pixels = stbi_load(path.c_str(), &width, &height, &channels, 4);
+  if (!pixels)
+  {
+    std::cerr << "[BlockTextureArray] Failed to load '" << path << "': " << stbi_failure_reason() << "\n";
+    return false;
+  }
+
+  if ((uint32_t)width != tileSize || (uint32_t)height != tileSize)
+  {
+    std::cerr << "[BlockTextureArray] '" << path << "' is " << width << "x" << height << ", expected " << tileSize << "x" << tileSize << "\n";
+    stbi_image_free(pixels);
+    return false;
+  }
+
+  levels.assign(1, MipLevel{ .width = tileSize, .height = tileSize });
+  levels[0].rgba.assign(pixels, pixels + (size_t)tileSize * tileSize * 4);
+  stbi_image_free(pixels);
+
+  GenerateMipChain(levels, nullptr);
+  return true;
+}
+
+
+// pPrevious : tableau actuel lors d'un rechargement, son handle est réutilisé si le stockage est identique
+static bool buildBlockTextures(const std::string& manifestName, BlockTextureArray& result, const BlockTextureArray* pPrevious)
+{
+  auto start = std::chrono::steady_clock::now();
+
+  BlockManifest manifest;
+  if (!parseManifest(manifestName, manifest)) return false;
+
+  const uint32_t layer_count = (uint32_t)manifest.files.size() + 1;
+  std::vector<std::vector<MipLevel>> layers(layer_count);
+
+  auto build_layers = [&](uint32_t first, uint32_t last)
+  {
+    for (uint32_t layer = first; layer < last; layer++)
+    {
+      if (layer == BLOCK_MISSING_LAYER || !loadLayer(getBlockTexturePath(manifest.files[layer - 1]), manifest.tileSize, layers[layer]))
+        createMissingLayer(manifest.tileSize, layers[layer]);
+    }
+  };
+
+  // un layer par tâche, décodage PNG compris
+  if (JobSystem* pJobs = BlockTextureArrayLoader::pJobSystem)
+  {
+    pJobs->ParallelFor("BlockTextureArray", layer_count, 1, [&build_layers](uint32_t start, uint32_t end, uint32_t threadnum)
+    {
+      build_layers(start, end);
+    });
+  }
+  else build_layers(0, layer_count);
+
+  result.tileSize = manifest.tileSize;
+  result.layerCount = layer_count;
+  result.levelCount = (uint32_t)layers[0].size();
+
+  const bool reuse = pPrevious && pPrevious->handle && pPrevious->tileSize == result.tileSize
+    && pPrevious->layerCount == result.layerCount && pPrevious->levelCount == result.levelCount;
+  if (reuse) result.handle = pPrevious->handle;
+  else
+  {
+    glCreateTextures(GL_TEXTURE_2D_ARRAY, 1, &result.handle);
+    glTextureStorage3D(result.handle, (int)result.levelCount, GL_RGBA8, (int)result.tileSize, (int)result.tileSize, (int)result.layerCount);
+
+    // pixel art net de près, mips au loin, REPEAT pour les faces fusionnées par le mesher
+    glTextureParameteri(result.handle, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_LINEAR);
+    glTextureParameteri(result.handle, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTextureParameteri(result.handle, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTextureParameteri(result.handle, GL_TEXTURE_WRAP_T, GL_REPEAT);
+  }
+
+  if (!result.handle)
+  {
+    std::cerr << "Failed to create GL Texture\n";
+    return false;
+  }
+
+  for (uint32_t layer = 0; layer < layer_count; layer++)
+  {
+    for (uint32_t level = 0; level < result.levelCount; level++)
+    {
+      const MipLevel& mip = layers[layer][level];
+      glTextureSubImage3D(result.handle, (int)level, 0, 0, (int)layer, (int)mip.width, (int)mip.height, 1, GL_RGBA, GL_UNSIGNED_BYTE, mip.rgba.data());
+    }
+  }
+
+  // table compacte pour le mesher, indexée par les ids de block_ids.h et non par l'ordre du manifest
+  // les chunks sauvegardés gardent leurs textures quel que soit l'ordre des blocs dans le fichier
+  result.faceLayers.assign((size_t)BLOCK_COUNT * (size_t)BlockFace::COUNT, BLOCK_MISSING_LAYER);
+  result.blockIds.clear();
+  for (size_t i = 0; i < manifest.blockNames.size(); i++)
+  {
+    const uint16_t block_id = FindBlockId(manifest.blockNames[i]);
+    if (block_id == BLOCK_AIR)
+    {
+      std::cerr << "[BlockTextureArray] Unknown block '" << manifest.blockNames[i] << "' in " << manifestName << ", add it to block_ids.h\n";
+      continue;
+    }
+    if (!result.blockIds.try_emplace(manifest.blockNames[i], block_id).second)
+    {
+      std::cerr << "[BlockTextureArray] Duplicate block name '" << manifest.blockNames[i] << "'\n";
+      continue;
+    }
+
+    for (size_t face = 0; face < (size_t)BlockFace::COUNT; face++)
+      result.faceLayers[block_id * (size_t)BlockFace::COUNT + face] = manifest.blockLayers[i][face];
+  }
+
+  for (uint16_t block_id = BLOCK_AIR + 1; block_id < BLOCK_COUNT; block_id++)
+  {
+    if (!result.blockIds.contains(std::string(BLOCK_NAMES[block_id])))
+      std::cerr << "[BlockTextureArray] No textures for block '" << BLOCK_NAMES[block_id] << "' in " << manifestName << "\n";
+  }
+
+  double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+  std::cout << "[BlockTextureArray] " << manifestName << ": " << manifest.blockNames.size() << " blocks, " << layer_count << " layers of "
+            << result.tileSize << "x" << result.tileSize << " in " << elapsed << " ms\n";
+  return true;
+}
+
+
+BlockTextureArrayLoader::result_type BlockTextureArrayLoader::operator()(const std::string& manifestName)
+{
+  BlockTextureArray block_textures{};
+  if (!buildBlockTextures(manifestName, block_textures, nullptr)) return nullptr;
+  return std::make_shared<BlockTextureArray>(std::move(block_textures));
+}
+
+
+std::vector<std::string> BlockTextureArrayLoader::GetAssetPaths(const std::string& manifestName)
+{
+  std::vector<std::string> paths = { getManifestPath(manifestName) };
+
+  BlockManifest manifest;
+  if (parseManifest(manifestName, manifest))
+  {
+    for (const auto& file: manifest.files) paths.push_back(getBlockTexturePath(file));
+  }
+  return paths;
+}
+
+
+bool BlockTextureArrayLoader::Reload(BlockTextureArray& blockTextures, const std::vector<std::string>& changedPaths, RetiredGLObjects& retired, const std::string& manifestName)
+{
+  BlockTextureArray fresh{};
+  if (!buildBlockTextures(manifestName, fresh, &blockTextures)) return false;
+
+  if (blockTextures.handle && fresh.handle != blockTextures.handle) retired.textures.push_back(blockTextures.handle);
+  blockTextures = std::move(fresh);
+  return true;
+}
\ No newline at end of file
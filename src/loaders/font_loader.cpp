@@ -1,6 +1,7 @@
 #include "loaders/font_loader.h"
 
 
+#include <algorithm>
 #include <cstdint>
 #include <iostream>
 #include <fstream>
@@ -10,75 +11,125 @@
 #include "utils/glyph.h"
 
 
-FontLoader::result_type FontLoader::operator()(const std::string& fontName)
+static std::string getMetricsPath(const std::string& fontName)
 {
-  Font font;
+  return std::string("assets/fonts/") + fontName + std::string("/metrics.json");
+}
+
+
+static std::string getAtlasPath(const std::string& fontName)
+{
+  return std::string("assets/fonts/") + fontName + std::string("/atlas.png");
+}
+
 
-  std::string font_metrics_path = std::string("assets/fonts/") + fontName + std::string("/metrics.json");
+// remplit pixelRange et glyphs
+static bool loadMetrics(const std::string& fontName, Font& font)
+{
+  std::string font_metrics_path = getMetricsPath(fontName);
 
   std::fstream f(font_metrics_path);
   if (!f.is_open())
   {
     std::cerr << "Failed to open '" << font_metrics_path << "'\n";
-    return nullptr;
+    return false;
   }
-  nlohmann::json j = nlohmann::json::parse(f);
 
-  font.pixelRange = (float)j["atlas"].value("distanceRange", 4.0);
-  float atlasWidth = (float)j["atlas"]["width"];
-  float atlasHeight = (float)j["atlas"]["height"];
-
-  for (const auto& glyphData: j["glyphs"])
+  // un fichier à moitié écrit (rechargement à chaud) ne doit pas faire planter le moteur
+  nlohmann::json j = nlohmann::json::parse(f, nullptr, false);
+  if (j.is_discarded())
   {
-    uint32_t unicode = glyphData["unicode"];
+    std::cerr << "Failed to parse '" << font_metrics_path << "'\n";
+    return false;
+  }
 
-    Glyph g;
-    g.advance = glyphData["advance"];
+  try
+  {
+    font.pixelRange = (float)j["atlas"].value("distanceRange", 4.0);
+    float atlasWidth = (float)j["atlas"]["width"];
+    float atlasHeight = (float)j["atlas"]["height"];
 
-    if (glyphData.contains("planeBounds"))
+    for (const auto& glyphData: j["glyphs"])
     {
-      auto plane_bounds = glyphData["planeBounds"];
-      g.planeBounds = glm::vec4(plane_bounds["left"], plane_bounds["bottom"], plane_bounds["right"], plane_bounds["top"]);
-      
-      auto atlas_bounds = glyphData["atlasBounds"];
-      g.atlasBounds = glm::vec4(
-        (float)atlas_bounds["left"] / atlasWidth, 
-        (float)atlas_bounds["bottom"] / atlasHeight, 
-        (float)atlas_bounds["right"] / atlasWidth, 
-        (float)atlas_bounds["top"] / atlasHeight
-      );
+      uint32_t unicode = glyphData["unicode"];
+
+      Glyph g;
+      g.advance = glyphData["advance"];
+
+      if (glyphData.contains("planeBounds"))
+      {
+        auto plane_bounds = glyphData["planeBounds"];
+        g.planeBounds = glm::vec4(plane_bounds["left"], plane_bounds["bottom"], plane_bounds["right"], plane_bounds["top"]);
+        
+        auto atlas_bounds = glyphData["atlasBounds"];
+        g.atlasBounds = glm::vec4(
+          (float)atlas_bounds["left"] / atlasWidth, 
+          (float)atlas_bounds["bottom"] / atlasHeight, 
+          (float)atlas_bounds["right"] / atlasWidth, 
+          (float)atlas_bounds["top"] / atlasHeight
+        );
+      }
+      else 
+      {
+        g.planeBounds = glm::vec4(0.0f);
+        g.atlasBounds = glm::vec4(0.0f);
+      }
+
+      font.glyphs.insert_or_assign(unicode, g);
     }
-    else 
-    {
-      g.planeBounds = glm::vec4(0.0f);
-      g.atlasBounds = glm::vec4(0.0f);
-    }
-
-    font.glyphs.insert_or_assign(unicode, g);
+  }
+  catch (const nlohmann::json::exception& e)
+  {
+    std::cerr << "Invalid font metrics '" << font_metrics_path << "': " << e.what() << "\n";
+    return false;
   }
 
-  int width;
-  int height;
+  return true;
+}
+
+
+// renvoie des pixels RGB à libérer avec stbi_image_free, ou nullptr
+static unsigned char* loadAtlasPixels(const std::string& fontName, int& width, int& height)
+{
   int channels;
-  std::string font_atlas_path = std::string("assets/fonts/") + fontName + std::string("/atlas.png");
+  std::string font_atlas_path = getAtlasPath(fontName);
   const char* font_atlas_path_c = font_atlas_path.c_str();
 
   stbi_set_flip_vertically_on_load(true);
   unsigned char* pixels = stbi_load(font_atlas_path_c, &width, &height, &channels, 3); // on veut du RGB
-  if (!pixels)
-  {
-    std::cerr << "Failed to load '" << font_atlas_path_c << "': " << stbi_failure_reason() << "\n";
-    return nullptr;
-  }
+  if (!pixels) std::cerr << "Failed to load '" << font_atlas_path_c << "': " << stbi_failure_reason() << "\n";
+  return pixels;
+}
+
+
+static unsigned int createAtlasTexture(int width, int height, const unsigned char* pixels)
+{
+  unsigned int handle = 0;
+  glCreateTextures(GL_TEXTURE_2D, 1, &handle);
+  glTextureStorage2D(handle, 1, GL_RGB8, width, height); // pas de mipmap
+  glTextureSubImage2D(handle, 0, 0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, pixels);
 
-  glCreateTextures(GL_TEXTURE_2D, 1, &font.textureHandle);
-  glTextureStorage2D(font.textureHandle, 1, GL_RGB8, width, height); // pas de mipmap
-  glTextureSubImage2D(font.textureHandle, 0, 0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, pixels);
+  glTextureParameteri(handle, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+  glTextureParameteri(handle, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  glTextureParameteri(handle, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTextureParameteri(handle, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 
-  glTextureParameteri(font.textureHandle, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-  glTextureParameteri(font.textureHandle, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-  glTextureParameteri(font.textureHandle, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-  glTextureParameteri(font.textureHandle, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  return handle;
+}
+
+
+FontLoader::result_type FontLoader::operator()(const std::string& fontName)
+{
+  Font font;
+
+  if (!loadMetrics(fontName, font)) return nullptr;
+
+  int width;
+  int height;
+  unsigned char* pixels = loadAtlasPixels(fontName, width, height);
+  if (!pixels) return nullptr;
+
+  font.textureHandle = createAtlasTexture(width, height, pixels);
 
   stbi_image_free(pixels);
 
@@ -89,4 +140,63 @@ FontLoader::result_type FontLoader::operator()(const std::string& fontName)
   }
 
   return std::make_shared<Font>(font);
+}
+
+
+std::vector<std::string> FontLoader::GetAssetPaths(const std::string& fontName)
+{
+  return { getMetricsPath(fontName), getAtlasPath(fontName) };
+}
+
+
+bool FontLoader::Reload(Font& font, const std::vector<std::string>& changedPaths, RetiredGLObjects& retired, const std::string& fontName)
+{
+  auto has_changed = [&changedPaths](const std::string& path)
+  {
+    return std::find(changedPaths.begin(), changedPaths.end(), path) != changedPaths.end();
+  };
+
+  // tout est lu avant de toucher à la Font, un échec la laisse intacte
+  Font metrics;
+  const bool reload_metrics = has_changed(getMetricsPath(fontName));
+  if (reload_metrics && !loadMetrics(fontName, metrics)) return false;
+
+  unsigned int new_texture = 0;
+  if (has_changed(getAtlasPath(fontName)))
+  {
+    int width;
+    int height;
+    unsigned char* pixels = loadAtlasPixels(fontName, width, height);
+    if (!pixels) return false;
+
+    int current_width = 0;
+    int current_height = 0;
+    if (font.textureHandle)
+    {
+      glGetTextureLevelParameteriv(font.textureHandle, 0, GL_TEXTURE_WIDTH, &current_width);
+      glGetTextureLevelParameteriv(font.textureHandle, 0, GL_TEXTURE_HEIGHT, &current_height);
+    }
+
+    // même taille : ré-upload dans la texture existante, sinon nouvelle texture (stockage immuable)
+    if (current_width == width && current_height == height)
+      glTextureSubImage2D(font.textureHandle, 0, 0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, pixels);
+    else
+      new_texture = createAtlasTexture(width, height, pixels);
+
+    stbi_image_free(pixels);
+  }
+
+  if (reload_metrics)
+  {
+    font.pixelRange = metrics.pixelRange;
+    font.glyphs = std::move(metrics.glyphs);
+  }
+
+  if (new_texture)
+  {
+    if (font.textureHandle) retired.textures.push_back(font.textureHandle);
+    font.textureHandle = new_texture;
+  }
+
+  return true;
 }
\ No newline at end of file
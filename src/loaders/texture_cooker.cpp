@@ -0,0 +1,523 @@
+#include "loaders/texture_cooker.h"
+#define STB_DXT_IMPLEMENTATION
+
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include <stb_dxt.h>
+#include <stb_image.h>
+
+#include "core/job_system.h"
+#include "utils/hash_strings.h"
+#include "utils/normalize_asset_path.h"
+
+
+// f(start, end) sur [0, count[, découpé sur les workers si le travail en vaut la peine
+template<typename F>
+static void parallelFor(JobSystem* pJobs, uint32_t count, F&& f)
+{
+  if (!pJobs)
+  {
+    f(0u, count);
+    return;
+  }
+
+  pJobs->ParallelFor("TextureCooker", count, TEXTURE_COOK_ROWS_PER_TASK, [&f](uint32_t start, uint32_t end, uint32_t threadnum)
+  {
+    f(start, end);
+  });
+}
+
+
+// filtre boîte 2x2, les bords impairs répètent la dernière colonne/ligne
+static void downsample(const MipLevel& source, MipLevel& destination, JobSystem* pJobs)
+{
+  destination.width = std::max(1u, source.width / 2);
+  destination.height = std::max(1u, source.height / 2);
+  destination.rgba.resize((size_t)destination.width * destination.height * 4);
+
+  parallelFor(pJobs, destination.height, [&](uint32_t start, uint32_t end)
+  {
+    for (uint32_t y = start; y < end; y++)
+    {
+      const uint32_t y0 = std::min(y * 2, source.height - 1);
+      const uint32_t y1 = std::min(y * 2 + 1, source.height - 1);
+
+      for (uint32_t x = 0; x < destination.width; x++)
+      {
+        const uint32_t x0 = std::min(x * 2, source.width - 1);
+        const uint32_t x1 = std::min(x * 2 + 1, source.width - 1);
+
+        const uint8_t* p00 = &source.rgba[((size_t)y0 * source.width + x0) * 4];
+        const uint8_t* p01 = &source.rgba[((size_t)y0 * source.width + x1) * 4];
+        const uint8_t* p10 = &source.rgba[((size_t)y1 * source.width + x0) * 4];
+        const uint8_t* p11 = &source.rgba[((size_t)y1 * source.width + x1) * 4];
+        uint8_t* out = &destination.rgba[((size_t)y * destination.width + x) * 4];
+
+        for (int c = 0; c < 4; c++) out[c] = (uint8_t)((p00[c] + p01[c] + p10[c] + p11[c] + 2) / 4);
+      }
+    }
+  });
+}
+
+
+// BC7 mode 6 : un seul sous-ensemble, extrémités RGBA 7 bits + p-bit, indices sur 4 bits
+// extrémités prises sur l'axe principal du bloc, sans recherche de partitions : rapide et proche de BC3 en qualité sur nos textures
+static constexpr int BC7_WEIGHTS_4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+
+struct BitWriter
+{
+  uint8_t* pData;
+  uint32_t bit = 0;
+
+  void Write(uint32_t value, uint32_t count)
+  {
+    for (uint32_t i = 0; i < count; i++, bit++)
+    {
+      if ((value >> i) & 1) pData[bit / 8] |= (uint8_t)(1 << (bit % 8));
+    }
+  }
+};
+
+
+// quantifie une extrémité 8 bits en 7 bits + p-bit partagé par les 4 canaux, garde le p-bit qui fait le moins d'erreur
+static void quantizeBC7Endpoint(const float endpoint[4], uint8_t quantized[4], uint8_t& pbit)
+{
+  float best_error = -1.0f;
+  for (uint8_t p = 0; p < 2; p++)
+  {
+    uint8_t candidate[4];
+    float error = 0.0f;
+    for (int c = 0; c < 4; c++)
+    {
+      int q = std::clamp((int)std::lround((endpoint[c] - p) / 2.0f), 0, 127);
+      candidate[c] = (uint8_t)q;
+      float delta = (float)((q << 1) | p) - endpoint[c];
+      error += delta * delta;
+    }
+
+    if (best_error < 0.0f || error < best_error)
+    {
+      best_error = error;
+      std::memcpy(quantized, candidate, 4);
+      pbit = p;
+    }
+  }
+}
+
+
+static void encodeBC7Block(uint8_t* destination, const uint8_t* rgba)
+{
+  float mean[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+  for (int i = 0; i < 16; i++)
+    for (int c = 0; c < 4; c++) mean[c] += rgba[i * 4 + c] / 16.0f;
+
+  float covariance[4][4] = {};
+  for (int i = 0; i < 16; i++)
+  {
+    float d[4];
+    for (int c = 0; c < 4; c++) d[c] = rgba[i * 4 + c] - mean[c];
+    for (int a = 0; a < 4; a++)
+      for (int b = 0; b < 4; b++) covariance[a][b] += d[a] * d[b];
+  }
+
+  // axe principal par itération de puissance
+  float axis[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+  for (int iteration = 0; iteration < 8; iteration++)
+  {
+    float next[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    for (int a = 0; a < 4; a++)
+      for (int b = 0; b < 4; b++) next[a] += covariance[a][b] * axis[b];
+
+    float length = std::sqrt(next[0] * next[0] + next[1] * next[1] + next[2] * next[2] + next[3] * next[3]);
+    if (length < 1e-6f) break; // bloc uniforme
+    for (int c = 0; c < 4; c++) axis[c] = next[c] / length;
+  }
+
+  float min_t = 0.0f;
+  float max_t = 0.0f;
+  for (int i = 0; i < 16; i++)
+  {
+    float t = 0.0f;
+    for (int c = 0; c < 4; c++) t += (rgba[i * 4 + c] - mean[c]) * axis[c];
+    min_t = std::min(min_t, t);
+    max_t = std::max(max_t, t);
+  }
+
+  float endpoints[2][4];
+  for (int c = 0; c < 4; c++)
+  {
+    endpoints[0][c] = std::clamp(mean[c] + axis[c] * min_t, 0.0f, 255.0f);
+    endpoints[1][c] = std::clamp(mean[c] + axis[c] * max_t, 0.0f, 255.0f);
+  }
+
+  uint8_t quantized[2][4];
+  uint8_t pbits[2];
+  quantizeBC7Endpoint(endpoints[0], quantized[0], pbits[0]);
+  quantizeBC7Endpoint(endpoints[1], quantized[1], pbits[1]);
+
+  int palette[16][4];
+  for (int c = 0; c < 4; c++)
+  {
+    int e0 = (quantized[0][c] << 1) | pbits[0];
+    int e1 = (quantized[1][c] << 1) | pbits[1];
+    for (int i = 0; i < 16; i++) palette[i][c] = ((64 - BC7_WEIGHTS_4[i]) * e0 + BC7_WEIGHTS_4[i] * e1 + 32) >> 6;
+  }
+
+  uint8_t indices[16];
+  for (int i = 0; i < 16; i++)
+  {
+    int best_error = -1;
+    for (int p = 0; p < 16; p++)
+    {
+      int error = 0;
+      for (int c = 0; c < 4; c++)
+      {
+        int delta = palette[p][c] - rgba[i * 4 + c];
+        error += delta * delta;
+      }
+      if (best_error < 0 || error < best_error)
+      {
+        best_error = error;
+        indices[i] = (uint8_t)p;
+      }
+    }
+  }
+
+  // le bit de poids fort de l'indice du premier pixel est implicite (0) : on inverse les extrémités si besoin
+  if (indices[0] & 8)
+  {
+    std::swap(quantized[0], quantized[1]);
+    std::swap(pbits[0], pbits[1]);
+    for (int i = 0; i < 16; i++) indices[i] = (uint8_t)(15 - indices[i]);
+  }
+
+  std::memset(destination, 0, 16);
+  BitWriter writer{ .pData = destination };
+  writer.Write(1 << 6, 7); // mode 6
+  for (int c = 0; c < 4; c++)
+  {
+    writer.Write(quantized[0][c], 7);
+    writer.Write(quantized[1][c], 7);
+  }
+  writer.Write(pbits[0], 1);
+  writer.Write(pbits[1], 1);
+  writer.Write(indices[0], 3);
+  for (int i = 1; i < 16; i++) writer.Write(indices[i], 4);
+}
+
+
+static void encodeBlock(TextureCompression compression, uint8_t* destination, const uint8_t* rgba)
+{
+  switch (compression)
+  {
+    case TextureCompression::BC1:
+      stb_compress_dxt_block(destination, rgba, 0, STB_DXT_HIGHQUAL);
+    break;
+
+    case TextureCompression::BC3:
+      stb_compress_dxt_block(destination, rgba, 1, STB_DXT_HIGHQUAL);
+    break;
+
+    case TextureCompression::BC4:
+    {
+      uint8_t red[16];
+      for (int i = 0; i < 16; i++) red[i] = rgba[i * 4];
+      stb_compress_bc4_block(destination, red);
+    }
+    break;
+
+    case TextureCompression::BC5:
+    {
+      uint8_t red_green[32];
+      for (int i = 0; i < 16; i++)
+      {
+        red_green[i * 2] = rgba[i * 4];
+        red_green[i * 2 + 1] = rgba[i * 4 + 1];
+      }
+      stb_compress_bc5_block(destination, red_green);
+    }
+    break;
+
+    default:
+      encodeBC7Block(destination, rgba);
+    break;
+  }
+}
+
+
+static TextureCompression resolveCompression(const TextureCookSettings& settings, int channels)
+{
+  TextureCompression compression = settings.compression;
+  if (compression == TextureCompression::AUTO)
+  {
+    switch (channels)
+    {
+      case 1: compression = TextureCompression::BC4; break;
+      case 2: compression = TextureCompression::BC5; break;
+      case 3: compression = TextureCompression::BC1; break;
+      default: compression = TextureCompression::BC7; break;
+    }
+  }
+
+  if (!settings.allowS3TC && (compression == TextureCompression::BC1 || compression == TextureCompression::BC3))
+    compression = TextureCompression::BC7;
+
+  return compression;
+}
+
+
+static const char* getCompressionName(TextureCompression compression)
+{
+  switch (compression)
+  {
+    case TextureCompression::BC1: return "BC1";
+    case TextureCompression::BC3: return "BC3";
+    case TextureCompression::BC4: return "BC4";
+    case TextureCompression::BC5: return "BC5";
+    case TextureCompression::BC7: return "BC7";
+    default: return "AUTO";
+  }
+}
+
+
+void GenerateMipChain(std::vector<MipLevel>& levels, JobSystem* pJobs)
+{
+  while ((levels.back().width > 1 || levels.back().height > 1) && levels.size() < COOKED_TEXTURE_MAX_LEVELS)
+  {
+    MipLevel next;
+    downsample(levels.back(), next, pJobs);
+    levels.push_back(std::move(next));
+  }
+}
+
+
+std::string GetCookedTexturePath(const std::string& texPath)
+{
+  return COOKED_TEXTURE_DIRECTORY + NormalizeAssetPath(texPath) + ".vxtx";
+}
+
+
+uint64_t GetCookedTextureKey(const std::string& sourcePath, const TextureCookSettings& settings)
+{
+  std::error_code error;
+  auto size = std::filesystem::file_size(sourcePath, error);
+  if (error) return 0;
+  auto write_time = std::filesystem::last_write_time(sourcePath, error);
+  if (error) return 0;
+
+  return HashStrings({
+    std::to_string(size),
+    std::to_string(write_time.time_since_epoch().count()),
+    std::to_string(COOKED_TEXTURE_VERSION),
+    std::to_string((uint32_t)settings.compression),
+    settings.allowS3TC ? "s3tc" : "bptc"
+  });
+}
+
+
+bool IsCookedTextureValid(const uint8_t* data, size_t size, uint64_t key)
+{
+  if (!data || size < sizeof(CookedTextureHeader)) return false;
+
+  CookedTextureHeader header;
+  std::memcpy(&header, data, sizeof(header));
+  if (header.magic != COOKED_TEXTURE_MAGIC || header.version != COOKED_TEXTURE_VERSION || header.sourceKey != key) return false;
+  if (header.levelCount == 0 || header.levelCount > COOKED_TEXTURE_MAX_LEVELS) return false;
+  if (header.compression == (uint32_t)TextureCompression::AUTO || header.compression > (uint32_t)TextureCompression::BC7) return false;
+  if (size < sizeof(CookedTextureHeader) + header.levelCount * sizeof(CookedTextureLevel)) return false;
+
+  // un fichier tronqué (crash pendant l'écriture, disque plein) ne doit jamais arriver jusqu'à GL
+  const TextureCompression compression = (TextureCompression)header.compression;
+  for (uint32_t i = 0; i < header.levelCount; i++)
+  {
+    CookedTextureLevel level;
+    std::memcpy(&level, data + sizeof(CookedTextureHeader) + i * sizeof(CookedTextureLevel), sizeof(level));
+    if (level.size != GetCompressedLevelSize(compression, level.width, level.height)) return false;
+    if (level.offset > size || level.size > size - level.offset) return false;
+  }
+
+  return true;
+}
+
+
+bool CookTexture(const std::string& sourcePath, const std::string& cookedPath, uint64_t key, const TextureCookSettings& settings, JobSystem* pJobs)
+{
+  auto start = std::chrono::steady_clock::now();
+
+  int width;
+  int height;
+  int channels;
+  if (!stbi_info(sourcePath.c_str(), &width, &height, &channels))
+  {
+    std::cerr << "[TextureCooker] Failed to read '" << sourcePath << "': " << stbi_failure_reason() << "\n";
+    return false;
+  }
+
+  // même orientation que le chargement direct par stb_image
+  stbi_set_flip_vertically_on_load(true);
+  unsigned char* pixels = stbi_load(sourcePath.c_str(), &width, &height, &channels, 4);
+  if (!pixels)
+  {
+    std::cerr << "[TextureCooker] Failed to load '" << sourcePath << "': " << stbi_failure_reason() << "\n";
+    return false;
+  }
+
+  const TextureCompression compression = resolveCompression(settings, channels);
+
+  std::vector<MipLevel> levels(1);
+  levels[0].width = (uint32_t)width;
+  levels[0].height = (uint32_t)height;
+  levels[0].rgba.assign(pixels, pixels + (size_t)width * height * 4);
+  stbi_image_free(pixels);
+
+  // gris + alpha : stb_image le donne en (g, g, g, a), BC5 veut (g, a) dans R et G comme GL_RG8
+  if (channels == 2)
+  {
+    for (size_t i = 0; i < levels[0].rgba.size(); i += 4) levels[0].rgba[i + 1] = levels[0].rgba[i + 3];
+  }
+
+  GenerateMipChain(levels, pJobs);
+
+  const uint32_t level_count = (uint32_t)levels.size();
+  const uint32_t block_size = GetCompressedBlockSize(compression);
+
+  std::vector<CookedTextureLevel> level_table(level_count);
+  std::vector<uint32_t> first_block_row(level_count + 1, 0); // lignes de blocs de tous les niveaux mises bout à bout
+  uint64_t offset = sizeof(CookedTextureHeader) + level_count * sizeof(CookedTextureLevel);
+  for (uint32_t i = 0; i < level_count; i++)
+  {
+    offset = (offset + COOKED_TEXTURE_ALIGNMENT - 1) / COOKED_TEXTURE_ALIGNMENT * COOKED_TEXTURE_ALIGNMENT;
+    level_table[i] = CookedTextureLevel{
+      .offset = offset,
+      .size = GetCompressedLevelSize(compression, levels[i].width, levels[i].height),
+      .width = levels[i].width,
+      .height = levels[i].height,
+      .padding = 0
+    };
+    offset += level_table[i].size;
+    first_block_row[i + 1] = first_block_row[i] + (levels[i].height + 3) / 4;
+  }
+
+  // les blocs sont encodés directement à leur place dans le fichier
+  std::vector<uint8_t> file_data(offset, 0);
+
+  CookedTextureHeader header{
+    .magic = COOKED_TEXTURE_MAGIC,
+    .version = COOKED_TEXTURE_VERSION,
+    .sourceKey = key,
+    .compression = (uint32_t)compression,
+    .width = (uint32_t)width,
+    .height = (uint32_t)height,
+    .levelCount = level_count
+  };
+  std::memcpy(file_data.data(), &header, sizeof(header));
+  std::memcpy(file_data.data() + sizeof(header), level_table.data(), level_count * sizeof(CookedTextureLevel));
+
+  // une tâche = quelques lignes de blocs, tous niveaux confondus, pour que les petits mips ne restent pas seuls
+  parallelFor(pJobs, first_block_row[level_count], [&](uint32_t start, uint32_t end)
+  {
+    for (uint32_t row = start; row < end; row++)
+    {
+      uint32_t level_index = (uint32_t)(std::upper_bound(first_block_row.begin(), first_block_row.end(), row) - first_block_row.begin()) - 1;
+      const MipLevel& level = levels[level_index];
+      const uint32_t block_y = row - first_block_row[level_index];
+      const uint32_t blocks_x = (level.width + 3) / 4;
+      uint8_t* destination = file_data.data() + level_table[level_index].offset + (size_t)block_y * blocks_x * block_size;
+
+      for (uint32_t block_x = 0; block_x < blocks_x; block_x++)
+      {
+        // les blocs qui dépassent du bord répètent les derniers pixels
+        uint8_t block[64];
+        for (uint32_t y = 0; y < 4; y++)
+        {
+          const uint32_t source_y = std::min(block_y * 4 + y, level.height - 1);
+          for (uint32_t x = 0; x < 4; x++)
+          {
+            const uint32_t source_x = std::min(block_x * 4 + x, level.width - 1);
+            std::memcpy(&block[(y * 4 + x) * 4], &level.rgba[((size_t)source_y * level.width + source_x) * 4], 4);
+          }
+        }
+
+        encodeBlock(compression, destination + block_x * block_size, block);
+      }
+    }
+  });
+
+  std::error_code error;
+  std::filesystem::create_directories(std::filesystem::path(cookedPath).parent_path(), error);
+  if (error)
+  {
+    std::cerr << "[TextureCooker] Failed to create directory for '" << cookedPath << "': " << error.message() << "\n";
+    return false;
+  }
+
+  // écrit à côté puis renomme, un crash pendant l'écriture ne laisse pas de fichier tronqué
+  std::string temporary_path = cookedPath + ".tmp";
+  {
+    std::ofstream file(temporary_path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) return false;
+    file.write(reinterpret_cast<const char*>(file_data.data()), (std::streamsize)file_data.size());
+    if (!file) return false;
+  }
+
+  std::filesystem::rename(temporary_path, cookedPath, error);
+  if (error)
+  {
+    std::cerr << "[TextureCooker] Failed to write '" << cookedPath << "': " << error.message() << "\n";
+    return false;
+  }
+
+  double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+  std::cout << "[TextureCooker] " << sourcePath << " -> " << width << "x" << height << " " << getCompressionName(compression)
+            << ", " << level_count << " levels, " << file_data.size() / 1024 << " KB in " << elapsed << " ms\n";
+  return true;
+}
+
+
+size_t CookTextures(const TextureCookSettings& settings, JobSystem* pJobs)
+{
+  const std::filesystem::path root = "assets/textures/";
+  size_t cooked = 0;
+
+  std::error_code error;
+  for (auto it = std::filesystem::recursive_directory_iterator(root, error); !error && it != std::filesystem::recursive_directory_iterator(); it.increment(error))
+  {
+    if (!it->is_regular_file(error)) continue;
+
+    std::string extension = it->path().extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+    if (extension != ".png" && extension != ".jpg" && extension != ".jpeg" && extension != ".tga" && extension != ".bmp") continue;
+
+    std::string source_path = NormalizeAssetPath(it->path().string());
+    std::string tex_path = NormalizeAssetPath(std::filesystem::relative(it->path(), root, error).string());
+    if (error) continue;
+
+    std::string cooked_path = GetCookedTexturePath(tex_path);
+    uint64_t key = GetCookedTextureKey(source_path, settings);
+    if (!key) continue;
+
+    // déjà à jour : seul l'en-tête est lu
+    {
+      std::ifstream file(cooked_path, std::ios::binary);
+      CookedTextureHeader header{};
+      if (file.read(reinterpret_cast<char*>(&header), sizeof(header)) && header.magic == COOKED_TEXTURE_MAGIC && header.version == COOKED_TEXTURE_VERSION && header.sourceKey == key)
+        continue;
+    }
+
+    if (CookTexture(source_path, cooked_path, key, settings, pJobs)) cooked++;
+  }
+
+  return cooked;
+}
@@ -1,76 +1,226 @@
 #include "loaders/texture_loader.h"
 
 
+#include <cstring>
 #include <iostream>
 
+#include <SDL3/SDL_video.h>
 #include <glad/glad.h>
 #include <stb_image.h>
 
+#include "loaders/texture_cooker.h"
+#include "platform/mapped_file.h"
+
+
+static std::string getTexturePath(const std::string& texPath)
+{
+  return std::string("assets/textures/") + texPath;
+}
+
+
+static void getTextureFormat(int channels, unsigned int& internalFormat, unsigned int& format)
+{
+  switch (channels) 
+  {
+    case 1:
+      internalFormat = GL_R8;
+      format = GL_RED;
+    break;
+
+    case 2:
+      internalFormat = GL_RG8;
+      format = GL_RG;
+    break;
+
+    case 3:
+      internalFormat = GL_RGB8;
+      format = GL_RGB;
+    break;
+
+    case 4:
+      internalFormat = GL_RGBA8;
+      format = GL_RGBA;
+    break;
+
+    default:
+      internalFormat = GL_RGB8;
+      format = GL_RGB;
+    break;
+  }
+}
+
+
+static unsigned int getCompressedFormat(TextureCompression compression)
+{
+  switch (compression)
+  {
+    case TextureCompression::BC1: return COMPRESSED_RGB_S3TC_DXT1_EXT;
+    case TextureCompression::BC3: return COMPRESSED_RGBA_S3TC_DXT5_EXT;
+    case TextureCompression::BC4: return GL_COMPRESSED_RED_RGTC1;
+    case TextureCompression::BC5: return GL_COMPRESSED_RG_RGTC2;
+    default: return GL_COMPRESSED_RGBA_BPTC_UNORM;
+  }
+}
+
+
+// true si handle a déjà exactement ce stockage, ses niveaux peuvent alors être réécrits sans changer de handle
+static bool isStorageCompatible(unsigned int handle, int width, int height, unsigned int internalFormat, int levelCount)
+{
+  if (!handle) return false;
+
+  int current_width = 0;
+  int current_height = 0;
+  int current_internal_format = 0;
+  int current_level_count = 0;
+  glGetTextureLevelParameteriv(handle, 0, GL_TEXTURE_WIDTH, &current_width);
+  glGetTextureLevelParameteriv(handle, 0, GL_TEXTURE_HEIGHT, &current_height);
+  glGetTextureLevelParameteriv(handle, 0, GL_TEXTURE_INTERNAL_FORMAT, &current_internal_format);
+  glGetTextureParameteriv(handle, GL_TEXTURE_IMMUTABLE_LEVELS, &current_level_count);
+
+  return current_width == width && current_height == height && (unsigned int)current_internal_format == internalFormat && current_level_count == levelCount;
+}
+
+
+// glTextureStorage2D est immuable : reuseHandle est gardé s'il convient, sinon on crée une nouvelle texture
+static unsigned int createStorage(unsigned int reuseHandle, int width, int height, unsigned int internalFormat, int levelCount)
+{
+  if (isStorageCompatible(reuseHandle, width, height, internalFormat, levelCount)) return reuseHandle;
+
+  unsigned int handle = 0;
+  glCreateTextures(GL_TEXTURE_2D, 1, &handle);
+  glTextureStorage2D(handle, levelCount, internalFormat, width, height);
+
+  glTextureParameteri(handle, GL_TEXTURE_MIN_FILTER, levelCount > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+  glTextureParameteri(handle, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  glTextureParameteri(handle, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTextureParameteri(handle, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+  return handle;
+}
+
+
+// les niveaux sont lus directement dans la projection du fichier
+static unsigned int uploadCooked(const MappedFile& file, unsigned int reuseHandle)
+{
+  CookedTextureHeader header;
+  std::memcpy(&header, file.GetData(), sizeof(header));
+
+  const unsigned int internal_format = getCompressedFormat((TextureCompression)header.compression);
+  unsigned int handle = createStorage(reuseHandle, (int)header.width, (int)header.height, internal_format, (int)header.levelCount);
+
+  for (uint32_t i = 0; i < header.levelCount; i++)
+  {
+    CookedTextureLevel level;
+    std::memcpy(&level, file.GetData() + sizeof(CookedTextureHeader) + i * sizeof(CookedTextureLevel), sizeof(level));
+    glCompressedTextureSubImage2D(handle, (int)i, 0, 0, (int)level.width, (int)level.height, internal_format, (int)level.size, file.GetData() + level.offset);
+  }
+
+  return handle;
+}
+
+
+// 0 si la texture n'a pas pu être cuite, l'appelant retombe alors sur le PNG
+static unsigned int loadCooked(const std::string& texPath, unsigned int reuseHandle)
+{
+  TextureCookSettings settings{ .allowS3TC = TextureLoader::isS3TCSupported };
+
+  std::string source_path = getTexturePath(texPath);
+  uint64_t key = GetCookedTextureKey(source_path, settings);
+  if (!key) return 0;
+
+  std::string cooked_path = GetCookedTexturePath(texPath);
+  MappedFile file;
+  if (!file.Open(cooked_path) || !IsCookedTextureValid(file.GetData(), file.GetSize(), key))
+  {
+    // un fichier projeté ne peut pas être remplacé sous Windows
+    file.Close();
+    if (!CookTexture(source_path, cooked_path, key, settings, TextureLoader::pJobSystem)) return 0;
+    if (!file.Open(cooked_path) || !IsCookedTextureValid(file.GetData(), file.GetSize(), key)) return 0;
+  }
+
+  return uploadCooked(file, reuseHandle);
+}
+
+
+static unsigned int loadPixels(const std::string& texPath, unsigned int reuseHandle)
+{
+  int width;
+  int height;
+  int channels;
+  std::string tex_final_path = getTexturePath(texPath);
+  const char* tex_final_path_c = tex_final_path.c_str();
+
+  stbi_set_flip_vertically_on_load(true);
+  unsigned char* pixels = stbi_load(tex_final_path_c, &width, &height, &channels, 0);
+  if (!pixels)
+  {
+    std::cerr << "Failed to load '" << tex_final_path_c << "': " << stbi_failure_reason() << "\n";
+    return 0;
+  }
+
+  unsigned int internal_format = 0;
+  unsigned int format = 0;
+  getTextureFormat(channels, internal_format, format);
+
+  unsigned int handle = createStorage(reuseHandle, width, height, internal_format, 1); // pas de mipmap
+  glTextureSubImage2D(handle, 0, 0, 0, width, height, format, GL_UNSIGNED_BYTE, pixels);
+
+  stbi_image_free(pixels);
+  return handle;
+}
+
+
+static unsigned int loadTexture(const std::string& texPath, unsigned int reuseHandle)
+{
+  unsigned int handle = loadCooked(texPath, reuseHandle);
+  if (handle) return handle;
+
+  std::cerr << "[TextureLoader] Using uncompressed '" << texPath << "'\n";
+  return loadPixels(texPath, reuseHandle);
+}
+
+
+void TextureLoader::EnableCompression()
+{
+  isS3TCSupported = SDL_GL_ExtensionSupported("GL_EXT_texture_compression_s3tc");
+}
+
 
 TextureLoader::result_type TextureLoader::operator()(const std::string& texPath)
 {
-    Texture tex;
-
-    int width;
-    int height;
-    int channels;
-    std::string tex_final_path = std::string("assets/textures/") + texPath;
-    const char* tex_final_path_c = tex_final_path.c_str();
-
-    stbi_set_flip_vertically_on_load(true);
-    unsigned char* pixels = stbi_load(tex_final_path_c, &width, &height, &channels, 0);
-    if (!pixels)
-    {
-      std::cerr << "Failed to load '" << tex_final_path_c << "': " << stbi_failure_reason() << "\n";
-      return nullptr;
-    }
-
-    unsigned int internal_format = 0;
-    unsigned int format = 0;
-    switch (channels) 
-    {
-      case 1:
-        internal_format = GL_R8;
-        format = GL_RED;
-      break;
-
-      case 2:
-        internal_format = GL_RG8;
-        format = GL_RG;
-      break;
-
-      case 3:
-        internal_format = GL_RGB8;
-        format = GL_RGB;
-      break;
-
-      case 4:
-        internal_format = GL_RGBA8;
-        format = GL_RGBA;
-      break;
-
-      default:
-        internal_format = GL_RGB8;
-        format = GL_RGB;
-      break;
-    }
-
-    glCreateTextures(GL_TEXTURE_2D, 1, &tex.handle);
-    glTextureStorage2D(tex.handle, 1, internal_format, width, height); // pas de mipmap
-    glTextureSubImage2D(tex.handle, 0, 0, 0, width, height, format, GL_UNSIGNED_BYTE, pixels);
-
-    glTextureParameteri(tex.handle, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTextureParameteri(tex.handle, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTextureParameteri(tex.handle, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTextureParameteri(tex.handle, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-
-    stbi_image_free(pixels);
-
-    if (!tex.handle)
-    {
-      std::cerr << "Failed to create GL Texture\n";
-      return nullptr;
-    }
-
-    return std::make_shared<Texture>(tex);
-  }
\ No newline at end of file
+  Texture tex;
+  tex.handle = loadTexture(texPath, 0);
+
+  if (!tex.handle)
+  {
+    std::cerr << "Failed to create GL Texture\n";
+    return nullptr;
+  }
+
+  return std::make_shared<Texture>(tex);
+}
+
+
+std::vector<std::string> TextureLoader::GetAssetPaths(const std::string& texPath)
+{
+  return { getTexturePath(texPath) };
+}
+
+
+bool TextureLoader::Reload(Texture& texture, const std::vector<std::string>& changedPaths, RetiredGLObjects& retired, const std::string& texPath)
+{
+  // la clé de la version cuite suit la date de la source, elle est donc recuite ici
+  unsigned int handle = loadTexture(texPath, texture.handle);
+  if (!handle)
+  {
+    std::cerr << "[HotReload] Failed to reload '" << texPath << "'\n";
+    return false;
+  }
+
+  if (handle != texture.handle)
+  {
+    if (texture.handle) retired.textures.push_back(texture.handle);
+    texture.handle = handle;
+  }
+  return true;
+}
\ No newline at end of file
@@ -0,0 +1,118 @@
+#include "platform/mapped_file.h"
+
+
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+MappedFile::~MappedFile()
+{
+  Close();
+}
+
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+{
+  *this = std::move(other);
+}
+
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+  if (this == &other) return *this;
+
+  Close();
+  std::swap(_pData, other._pData);
+  std::swap(_size, other._size);
+#ifdef _WIN32
+  std::swap(_file, other._file);
+  std::swap(_mapping, other._mapping);
+#endif
+  return *this;
+}
+
+
+bool MappedFile::Open(const std::string& path, bool allowWriters)
+{
+  Close();
+
+#ifdef _WIN32
+  const DWORD share_mode = allowWriters ? FILE_SHARE_READ | FILE_SHARE_WRITE : FILE_SHARE_READ;
+  HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, share_mode, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file == INVALID_HANDLE_VALUE) return false;
+
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+  {
+    CloseHandle(file);
+    return false;
+  }
+
+  HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (!mapping)
+  {
+    CloseHandle(file);
+    return false;
+  }
+
+  void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  if (!data)
+  {
+    CloseHandle(mapping);
+    CloseHandle(file);
+    return false;
+  }
+
+  _file = file;
+  _mapping = mapping;
+  _pData = static_cast<const uint8_t*>(data);
+  _size = (size_t)size.QuadPart;
+#else
+  (void)allowWriters; // mmap ne verrouille pas le fichier
+  int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) return false;
+
+  struct stat info;
+  if (fstat(fd, &info) != 0 || info.st_size == 0)
+  {
+    close(fd);
+    return false;
+  }
+
+  void* data = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd); // la projection garde sa propre référence sur le fichier
+  if (data == MAP_FAILED) return false;
+
+  _pData = static_cast<const uint8_t*>(data);
+  _size = (size_t)info.st_size;
+#endif
+
+  return true;
+}
+
+
+void MappedFile::Close()
+{
+#ifdef _WIN32
+  if (_pData) UnmapViewOfFile(_pData);
+  if (_mapping) CloseHandle(_mapping);
+  if (_file) CloseHandle(_file);
+  _mapping = nullptr;
+  _file = nullptr;
+#else
+  if (_pData) munmap(const_cast<uint8_t*>(_pData), _size);
+#endif
+
+  _pData = nullptr;
+  _size = 0;
+}
\ No newline at end of file
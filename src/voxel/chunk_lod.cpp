@@ -0,0 +1,115 @@
+#include "voxel/chunk_lod.h"
+
+
+#include <algorithm>
+
+
+void DownsampleChunk(const uint16_t* pBlocks, int factor, uint16_t* pCells, const glm::ivec3& cellOrigin)
+{
+  const int cell_count = CHUNK_SIZE / factor;
+  const int cell_volume = factor * factor * factor;
+
+  // blocs différents d'une couche de cellule, au plus 8 x 8
+  uint16_t layer_blocks[64];
+  uint16_t layer_counts[64];
+
+  for (int cell_y = 0; cell_y < cell_count; cell_y++)
+  {
+    for (int cell_z = 0; cell_z < cell_count; cell_z++)
+    {
+      for (int cell_x = 0; cell_x < cell_count; cell_x++)
+      {
+        int solid = 0;
+        uint16_t top = BLOCK_AIR;
+        for (int y = factor - 1; y >= 0; y--)
+        {
+          int entry_count = 0;
+          for (int z = 0; z < factor; z++)
+          {
+            const uint16_t* pRow = pBlocks + GetBlockIndex(cell_x * factor, cell_y * factor + y, cell_z * factor + z);
+            for (int x = 0; x < factor; x++)
+            {
+              const uint16_t block = pRow[x];
+              if (block == BLOCK_AIR) continue;
+
+              solid++;
+              if (top != BLOCK_AIR) continue;
+
+              int entry = 0;
+              while (entry < entry_count && layer_blocks[entry] != block) entry++;
+              if (entry == entry_count)
+              {
+                layer_blocks[entry_count] = block;
+                layer_counts[entry_count++] = 0;
+              }
+              layer_counts[entry]++;
+            }
+          }
+
+          if (top == BLOCK_AIR && entry_count > 0) top = layer_blocks[std::max_element(layer_counts, layer_counts + entry_count) - layer_counts];
+        }
+
+        pCells[GetBlockIndex(cellOrigin.x + cell_x, cellOrigin.y + cell_y, cellOrigin.z + cell_z)] = 2 * solid >= cell_volume ? top : BLOCK_AIR;
+      }
+    }
+  }
+}
+
+
+void GenerateLodCells(const TerrainGenerator& generator, int level, const glm::ivec2& node, int cellHeight, ChunkLodScratch& scratch)
+{
+  const int factor = 1 << level;
+  const float node_size = (float)(CHUNK_SIZE * factor);
+  const float center = (float)(factor / 2);
+
+  scratch.heights.resize(CHUNK_AREA);
+  scratch.cells.resize((size_t)cellHeight * CHUNK_AREA);
+  generator.GenerateHeights((float)node.x * node_size + center, (float)node.y * node_size + center, (float)factor, scratch.heights.data());
+
+  const int32_t* pHeights = scratch.heights.data();
+  const int32_t bottom_y = generator.GetSettings().bottomChunkY * CHUNK_SIZE;
+  for (int y = 0; y < cellHeight; y++)
+  {
+    const int32_t cell_y = bottom_y + y * factor;
+    uint16_t* pLayer = scratch.cells.data() + (size_t)y * CHUNK_AREA;
+    for (int i = 0; i < CHUNK_AREA; i++)
+    {
+      // blocs pleins de la colonne dans la cellule : de cell_y jusqu'à l'herbe comprise
+      const int32_t height = pHeights[i];
+      const int32_t solid = std::clamp(height + 1 - cell_y, 0, factor);
+      pLayer[i] = 2 * solid >= factor ? generator.GetColumnBlock(std::min(height, cell_y + factor - 1), height) : BLOCK_AIR;
+    }
+  }
+}
+
+
+void BuildLodMesh(int level, int sectionCount, const std::vector<uint16_t>& faceLayers, ChunkLodScratch& scratch, ChunkMeshScratch& output)
+{
+  output.vertices.clear();
+  output.indices.clear();
+
+  scratch.sections.resize(sectionCount);
+  for (int i = 0; i < sectionCount; i++) scratch.sections[i].Encode(scratch.cells.data() + (size_t)i * CHUNK_VOLUME);
+
+  const float factor = (float)(1 << level);
+  for (int i = 0; i < sectionCount; i++)
+  {
+    // seules les tranches du même noeud sont voisines, le reste est de l'air
+    ChunkNeighbors neighbors;
+    if (i + 1 < sectionCount) neighbors.pSections[(size_t)BlockFace::TOP] = &scratch.sections[i + 1];
+    if (i > 0) neighbors.pSections[(size_t)BlockFace::BOTTOM] = &scratch.sections[i - 1];
+
+    BuildChunkMesh(scratch.sections[i], neighbors, faceLayers, scratch.mesh);
+    if (scratch.mesh.indices.empty()) continue;
+
+    const unsigned int first = (unsigned int)output.vertices.size();
+    const glm::vec3 offset(0.0f, (float)(i * CHUNK_SIZE), 0.0f);
+    for (Vertex vertex: scratch.mesh.vertices)
+    {
+      vertex.position = (vertex.position + offset) * factor;
+      vertex.textureCoordinates *= factor;
+      output.vertices.push_back(vertex);
+    }
+    for (unsigned int index: scratch.mesh.indices) output.indices.push_back(first + index);
+  }
+}
\ No newline at end of file
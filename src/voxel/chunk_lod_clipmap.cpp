@@ -0,0 +1,521 @@
+#include "voxel/chunk_lod_clipmap.h"
+
+
+#include <algorithm>
+#include <chrono>
+#include <utility>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "components/mesh.h"
+#include "components/tags.h"
+#include "components/world_matrix.h"
+#include "core/job_system.h"
+#include "voxel/chunk_streamer.h"
+#include "voxel/region_file.h"
+#include "voxel/voxel_world.h"
+
+
+void ChunkLodJob::ExecuteRange(enki::TaskSetPartition range, uint32_t threadnum)
+{
+  if (isCancelled.load(std::memory_order_relaxed))
+  {
+    output.vertices.clear();
+    output.indices.clear();
+    pOwner->_completed.Push(slot);
+    return;
+  }
+
+  ChunkLodClipmap& owner = *pOwner;
+  ChunkLodScratch& scratch = owner._scratches[threadnum];
+  const int section_count = owner._sectionCounts[level];
+  GenerateLodCells(owner._generator, level, node, section_count * CHUNK_SIZE, scratch);
+
+  // les chunks sauvegardés (donc modifiés) remplacent le terrain généré, réduits à la taille des cellules
+  if (owner._pStorage)
+  {
+    const int size = 1 << level;
+    const int cells_per_chunk = CHUNK_SIZE / size;
+    const int bottom_y = owner._generator.GetSettings().bottomChunkY;
+    ChunkSection section;
+    scratch.blocks.resize(CHUNK_VOLUME);
+    for (int z = 0; z < size && !isCancelled.load(std::memory_order_relaxed); z++)
+    {
+      for (int x = 0; x < size; x++)
+      {
+        for (int chunk_y = bottom_y; chunk_y <= CHUNK_STREAM_TOP_Y; chunk_y++)
+        {
+          if (!owner._pStorage->LoadChunk(ChunkCoord{ node.x * size + x, chunk_y, node.y * size + z }, section)) continue;
+
+          section.Decode(scratch.blocks.data());
+          DownsampleChunk(scratch.blocks.data(), size, scratch.cells.data(), glm::ivec3(x, chunk_y - bottom_y, z) * cells_per_chunk);
+        }
+      }
+    }
+  }
+
+  BuildLodMesh(level, section_count, faceLayers, scratch, output);
+  bounds = ComputeBounds(output.vertices);
+
+  // jamais plein : il y a au plus CHUNK_LOD_MAX_JOBS slots
+  owner._completed.Push(slot);
+}
+
+
+ChunkLodClipmap::ChunkLodClipmap(entt::registry* registry, RenderBackend* pUploadBackend, ChunkMeshPool* pMeshPool, JobSystem* pJobs, RegionStorage* pStorage,
+  const TerrainSettings& settings)
+  : _pRegistry(registry),
+    _pUploadBackend(pUploadBackend),
+    _pMeshPool(pMeshPool),
+    _pScheduler(pJobs ? &pJobs->GetScheduler() : nullptr),
+    _pStorage(pStorage),
+    _generator(settings),
+    _levelCount(CHUNK_LOD_DEFAULT_LEVELS),
+    _nextRequest(0),
+    _triangleCount(0),
+    _viewerColumn(0),
+    _viewerForward(0.0f),
+    _radius(0),
+    _isViewDirty(true)
+{
+  // même hauteur de terrain que le streamer, arrondie aux tranches de CHUNK_SIZE cellules
+  const int chunk_height = CHUNK_STREAM_TOP_Y - settings.bottomChunkY + 1;
+  for (int level = 0; level <= CHUNK_LOD_MAX_LEVELS; level++) _sectionCounts[level] = (chunk_height + (1 << level) - 1) >> level;
+
+  _scratches.resize(pJobs ? pJobs->GetThreadCount() : 1);
+
+  _jobs.reserve(CHUNK_LOD_MAX_JOBS);
+  _freeSlots.reserve(CHUNK_LOD_MAX_JOBS);
+  for (uint32_t slot = 0; slot < CHUNK_LOD_MAX_JOBS; slot++)
+  {
+    auto job = std::make_unique<ChunkLodJob>();
+    job->pOwner = this;
+    job->slot = slot;
+    _jobs.push_back(std::move(job));
+    _freeSlots.push_back(CHUNK_LOD_MAX_JOBS - 1 - slot);
+  }
+}
+
+
+ChunkLodClipmap::~ChunkLodClipmap()
+{
+  for (const auto& job: _jobs) job->isCancelled.store(true, std::memory_order_relaxed);
+  WaitAll();
+}
+
+
+void ChunkLodClipmap::SetLevelCount(int levelCount)
+{
+  _levelCount = std::clamp(levelCount, 0, CHUNK_LOD_MAX_LEVELS);
+  _isViewDirty = true;
+}
+
+
+void ChunkLodClipmap::WaitAll()
+{
+  if (!_pScheduler) return;
+
+  for (const auto& job: _jobs)
+  {
+    if (!job->GetIsComplete()) _pScheduler->WaitforTask(job.get());
+  }
+}
+
+
+void ChunkLodClipmap::Clear(uint64_t frameIndex)
+{
+  for (auto& [key, node]: _nodes) destroyNodeEntity(node, frameIndex);
+  _nodes.clear();
+  _requests.clear();
+  _nextRequest = 0;
+  _retired.clear();
+  _overlapped.clear();
+  _isViewDirty = true;
+}
+
+
+void ChunkLodClipmap::Update(VoxelWorld& world, int radius, const glm::vec3& viewerPosition, const glm::vec3& viewerForward, uint64_t frameIndex)
+{
+  const ChunkCoord viewer = GetChunkCoord(glm::ivec3(glm::floor(viewerPosition)));
+  const glm::ivec2 viewer_column(viewer.x, viewer.z);
+
+  glm::vec2 forward(viewerForward.x, viewerForward.z);
+  const float forward_length = glm::length(forward);
+  forward = forward_length > 1e-3f ? forward / forward_length : glm::vec2(0.0f);
+
+  const bool has_turned = glm::dot(forward, _viewerForward) < CHUNK_STREAM_TURN_COS && (forward != glm::vec2(0.0f) || _viewerForward != glm::vec2(0.0f));
+  _viewerForward = has_turned ? forward : _viewerForward;
+
+  if (_isViewDirty || radius != _radius || viewer_column != _viewerColumn)
+  {
+    _viewerColumn = viewer_column;
+    _radius = radius;
+    _isViewDirty = false;
+    refreshNodes();
+  }
+  else if (has_turned)
+  {
+    // mêmes noeuds, seul l'ordre des constructions restantes change
+    for (size_t i = _nextRequest; i < _requests.size(); i++) _requests[i].first = getPriority(_requests[i].second);
+    std::sort(_requests.begin() + _nextRequest, _requests.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+  }
+
+  // d'abord les uploads, qui libèrent des slots et rendent des remplaçants prêts
+  uint32_t slot;
+  while (_completed.Pop(slot)) _ready.push_back(_jobs[slot].get());
+  uploadNodes(frameIndex);
+
+  updateOverlapped(world, frameIndex);
+  retireNodes(world, frameIndex);
+  submitNodes();
+}
+
+
+bool ChunkLodClipmap::IsColumnCovered(int x, int z) const
+{
+  for (int level = 1; level <= _levelCount; level++)
+  {
+    auto it = _nodes.find(NodeKey{ level, x >> level, z >> level });
+    if (it != _nodes.end() && it->second.isActive) return it->second.isBuilt;
+  }
+  return true;
+}
+
+
+void ChunkLodClipmap::InvalidateColumn(int x, int z)
+{
+  for (int level = 1; level <= _levelCount; level++)
+  {
+    const NodeKey key{ level, x >> level, z >> level };
+    auto it = _nodes.find(key);
+    if (it == _nodes.end() || !it->second.isActive) continue;
+
+    // un job en vol a peut-être lu les régions avant la modification
+    Node& node = it->second;
+    if (node.pJob)
+    {
+      node.pJob->isCancelled.store(true, std::memory_order_relaxed);
+      node.pJob = nullptr;
+    }
+    node.isBuilt = false;
+    _requests.insert(_requests.begin() + _nextRequest, std::make_pair(0.0f, key));
+    return;
+  }
+}
+
+
+void ChunkLodClipmap::SetFaceLayers(const std::vector<uint16_t>& faceLayers)
+{
+  if (faceLayers == _faceLayers) return;
+  _faceLayers = faceLayers;
+
+  // comme InvalidateColumn pour tous les noeuds, les anciens meshes restent affichés en attendant
+  for (auto& [key, node]: _nodes)
+  {
+    if (!node.isActive) continue;
+
+    if (node.pJob)
+    {
+      node.pJob->isCancelled.store(true, std::memory_order_relaxed);
+      node.pJob = nullptr;
+    }
+    node.isBuilt = false;
+  }
+  _isViewDirty = true;
+}
+
+
+float ChunkLodClipmap::getPriority(const NodeKey& key) const
+{
+  // centre du noeud en colonnes
+  const float size = (float)(1 << key.level);
+  const glm::vec2 center = (glm::vec2((float)key.x, (float)key.z) + 0.5f) * size;
+  return GetViewWeightedDistance(center - glm::vec2(_viewerColumn) - 0.5f, _viewerForward);
+}
+
+
+void ChunkLodClipmap::refreshNodes()
+{
+  for (auto& [key, node]: _nodes) node.isActive = false;
+  _requests.clear();
+  _nextRequest = 0;
+  _overlapped.clear();
+
+  // les noeuds du niveau le plus grossier qui touchent le disque extérieur, subdivisés vers la caméra
+  if (_levelCount > 0 && _radius > 0)
+  {
+    const int64_t limit = (int64_t)_radius << _levelCount;
+    const glm::ivec2 min_node = (_viewerColumn - (int)limit) >> _levelCount;
+    const glm::ivec2 max_node = (_viewerColumn + (int)limit) >> _levelCount;
+    for (int z = min_node.y; z <= max_node.y; z++)
+    {
+      for (int x = min_node.x; x <= max_node.x; x++)
+      {
+        if (GetLodNodeDistance2(_viewerColumn, _levelCount, glm::ivec2(x, z)) > limit * limit) continue;
+        activate(_levelCount, glm::ivec2(x, z));
+      }
+    }
+  }
+
+  // plus voulus : construction annulée, l'affichage reste jusqu'au remplaçant
+  _retired.clear();
+  for (auto it = _nodes.begin(); it != _nodes.end();)
+  {
+    Node& node = it->second;
+    if (node.isActive)
+    {
+      ++it;
+      continue;
+    }
+
+    if (node.pJob)
+    {
+      node.pJob->isCancelled.store(true, std::memory_order_relaxed);
+      node.pJob = nullptr;
+    }
+
+    if (node.entity == entt::null)
+    {
+      it = _nodes.erase(it);
+      continue;
+    }
+
+    _retired.push_back(it->first);
+    ++it;
+  }
+
+  std::sort(_requests.begin(), _requests.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+}
+
+
+void ChunkLodClipmap::activate(int level, const glm::ivec2& node)
+{
+  if (IsLodNodeSubdivided(_viewerColumn, level, node, _radius))
+  {
+    // au niveau 1, les colonnes pleine résolution du ChunkStreamer
+    if (level == 1) return;
+
+    for (int z = 0; z < 2; z++)
+      for (int x = 0; x < 2; x++) activate(level - 1, node * 2 + glm::ivec2(x, z));
+    return;
+  }
+
+  const NodeKey key{ level, node.x, node.y };
+  Node& state = _nodes[key];
+  state.isActive = true;
+
+  // dans la marge de déchargement du streamer, les colonnes sont peut-être encore là : voir updateOverlapped
+  const int keep_radius = _radius + CHUNK_STREAM_UNLOAD_MARGIN;
+  if (level == 1 && GetLodNodeDistance2(_viewerColumn, 1, node) <= (int64_t)keep_radius * keep_radius)
+  {
+    _overlapped.push_back(key);
+    return;
+  }
+
+  if (!state.isBuilt && !state.pJob) _requests.emplace_back(getPriority(key), key);
+}
+
+
+bool ChunkLodClipmap::isColumnCovered(const VoxelWorld& world, int level, const glm::ivec2& node) const
+{
+  const int size = 1 << level;
+  for (int z = 0; z < size; z++)
+  {
+    for (int x = 0; x < size; x++)
+    {
+      if (!world.IsColumnReady(node.x * size + x, node.y * size + z)) return false;
+    }
+  }
+  return true;
+}
+
+
+// tout ce qui est actif dans la surface du noeud est affiché
+bool ChunkLodClipmap::isAreaReady(const VoxelWorld& world, int level, const glm::ivec2& node) const
+{
+  if (level == 0) return world.IsColumnReady(node.x, node.y);
+
+  auto it = _nodes.find(NodeKey{ level, node.x, node.y });
+  if (it != _nodes.end() && it->second.isActive) return it->second.isBuilt || (level == 1 && isColumnCovered(world, 1, node));
+
+  // ni actif ni subdivisé : hors des anneaux, rien à attendre
+  if (!IsLodNodeSubdivided(_viewerColumn, level, node, _radius)) return true;
+
+  for (int z = 0; z < 2; z++)
+  {
+    for (int x = 0; x < 2; x++)
+    {
+      if (!isAreaReady(world, level - 1, node * 2 + glm::ivec2(x, z))) return false;
+    }
+  }
+  return true;
+}
+
+
+bool ChunkLodClipmap::isCovered(const VoxelWorld& world, const NodeKey& key) const
+{
+  // un ancêtre actif remplace le noeud entier
+  glm::ivec2 node(key.x, key.z);
+  for (int level = key.level + 1; level <= _levelCount; level++)
+  {
+    node >>= 1;
+    auto it = _nodes.find(NodeKey{ level, node.x, node.y });
+    if (it != _nodes.end() && it->second.isActive) return it->second.isBuilt;
+  }
+
+  // sinon des descendants, ou des colonnes pleine résolution
+  return isAreaReady(world, key.level, glm::ivec2(key.x, key.z));
+}
+
+
+// un noeud de niveau 1 n'est pas affiché tant que ses colonnes pleine résolution le sont, même dans la marge du streamer
+void ChunkLodClipmap::updateOverlapped(const VoxelWorld& world, uint64_t frameIndex)
+{
+  size_t requested = 0;
+  for (const NodeKey& key: _overlapped)
+  {
+    auto it = _nodes.find(key);
+    if (it == _nodes.end() || !it->second.isActive) continue;
+
+    Node& node = it->second;
+    if (isColumnCovered(world, 1, glm::ivec2(key.x, key.z)))
+    {
+      destroyNodeEntity(node, frameIndex);
+      node.isBuilt = false;
+      continue;
+    }
+
+    // le plus proche de tous les noeuds, il passe devant les requêtes triées
+    if (node.isBuilt || node.pJob || requested >= _freeSlots.size()) continue;
+    _requests.insert(_requests.begin() + _nextRequest, std::make_pair(0.0f, key));
+    requested++;
+  }
+}
+
+
+void ChunkLodClipmap::retireNodes(const VoxelWorld& world, uint64_t frameIndex)
+{
+  size_t count = 0;
+  for (size_t i = 0; i < _retired.size(); i++)
+  {
+    const NodeKey key = _retired[i];
+    auto it = _nodes.find(key);
+    if (it == _nodes.end() || it->second.isActive) continue;
+
+    if (isCovered(world, key))
+    {
+      destroyNodeEntity(it->second, frameIndex);
+      _nodes.erase(it);
+      continue;
+    }
+    _retired[count++] = key;
+  }
+  _retired.resize(count);
+}
+
+
+void ChunkLodClipmap::uploadNodes(uint64_t frameIndex)
+{
+  if (_ready.empty()) return;
+
+  // les plus importants d'abord, l'ordre d'arrivée dépend des workers
+  std::sort(_ready.begin(), _ready.end(), [this](const ChunkLodJob* a, const ChunkLodJob* b)
+  {
+    return getPriority(NodeKey{ a->level, a->node.x, a->node.y }) < getPriority(NodeKey{ b->level, b->node.x, b->node.y });
+  });
+
+  const auto start = std::chrono::steady_clock::now();
+  size_t uploaded = 0;
+  for (; uploaded < _ready.size(); uploaded++)
+  {
+    ChunkLodJob* pJob = _ready[uploaded];
+
+    // annulé, ou noeud retiré puis redemandé à un autre job
+    auto it = _nodes.find(NodeKey{ pJob->level, pJob->node.x, pJob->node.y });
+    if (pJob->isCancelled.load(std::memory_order_relaxed) || it == _nodes.end() || it->second.pJob != pJob)
+    {
+      release(pJob);
+      continue;
+    }
+
+    if (uploaded > 0 && std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count() > CHUNK_LOD_UPLOAD_BUDGET_MS) break;
+
+    Node& node = it->second;
+    node.pJob = nullptr;
+    node.isBuilt = true;
+    destroyNodeEntity(node, frameIndex);
+
+    // pas d'entité pour un noeud sans face visible
+    if (!pJob->output.indices.empty())
+    {
+      const int size = CHUNK_SIZE << pJob->level;
+      const glm::vec3 origin((float)(pJob->node.x * size), (float)(_generator.GetSettings().bottomChunkY * CHUNK_SIZE), (float)(pJob->node.y * size));
+
+      node.entity = _pRegistry->create();
+      _pRegistry->emplace<WorldMatrix>(node.entity, WorldMatrix{ glm::translate(glm::mat4(1.0f), origin) });
+      _pRegistry->emplace<Bounds>(node.entity, pJob->bounds);
+      _pRegistry->emplace<Terrain>(node.entity);
+      Mesh& mesh = _pRegistry->emplace<Mesh>(node.entity);
+      _pMeshPool->Upload(*_pUploadBackend, mesh, pJob->output, frameIndex);
+
+      node.triangleCount = (uint32_t)pJob->output.GetTriangleCount();
+      _triangleCount += node.triangleCount;
+    }
+
+    release(pJob);
+  }
+
+  _ready.erase(_ready.begin(), _ready.begin() + uploaded);
+}
+
+
+void ChunkLodClipmap::submitNodes()
+{
+  while (!_freeSlots.empty() && _nextRequest < _requests.size())
+  {
+    const NodeKey key = _requests[_nextRequest++].second;
+    auto it = _nodes.find(key);
+    if (it == _nodes.end() || !it->second.isActive || it->second.isBuilt || it->second.pJob) continue;
+
+    ChunkLodJob* pJob = _jobs[_freeSlots.back()].get();
+    _freeSlots.pop_back();
+
+    // le slot est rendu après le Push du worker, enkiTS peut ne pas avoir encore marqué la tâche finie
+    if (_pScheduler && !pJob->GetIsComplete()) _pScheduler->WaitforTask(pJob);
+
+    pJob->level = key.level;
+    pJob->node = glm::ivec2(key.x, key.z);
+    pJob->isCancelled.store(false, std::memory_order_relaxed);
+    pJob->faceLayers = _faceLayers;
+    it->second.pJob = pJob;
+
+    // sans JobSystem, un noeud par frame sur le thread principal
+    if (!_pScheduler)
+    {
+      pJob->ExecuteRange(enki::TaskSetPartition{ 0, 1 }, 0);
+      break;
+    }
+
+    pJob->m_SetSize = 1;
+    pJob->m_Priority = enki::TASK_PRIORITY_LOW;
+    _pScheduler->AddTaskSetToPipe(pJob);
+  }
+}
+
+
+void ChunkLodClipmap::destroyNodeEntity(Node& node, uint64_t frameIndex)
+{
+  if (node.entity == entt::null) return;
+
+  if (Mesh* pMesh = _pRegistry->try_get<Mesh>(node.entity)) _pMeshPool->Release(*pMesh, frameIndex);
+  _pRegistry->destroy(node.entity);
+  node.entity = entt::null;
+  _triangleCount -= node.triangleCount;
+  node.triangleCount = 0;
+}
+
+
+void ChunkLodClipmap::release(ChunkLodJob* pJob)
+{
+  _freeSlots.push_back(pJob->slot);
+}
\ No newline at end of file
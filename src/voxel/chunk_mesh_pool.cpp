@@ -0,0 +1,150 @@
+#include "voxel/chunk_mesh_pool.h"
+
+
+#include <entt/entt.hpp>
+
+#include "events/mesh_buffers_changed_event.h"
+
+
+// puissances de 2 : un chunk qui grandit un peu retombe sur la même taille de buffer
+static inline uint32_t getVertexCapacity(uint32_t sizeClass)
+{
+  return CHUNK_MESH_MIN_VERTICES << sizeClass;
+}
+
+
+// des quads : 4 sommets, 6 indices
+static inline uint32_t getIndexCapacity(uint32_t sizeClass)
+{
+  return getVertexCapacity(sizeClass) / 4 * 6;
+}
+
+
+static inline uint32_t getSizeClass(uint32_t vertexCount, uint32_t indexCount)
+{
+  uint32_t size_class = 0;
+  while (size_class + 1 < CHUNK_MESH_SIZE_CLASSES && (getVertexCapacity(size_class) < vertexCount || getIndexCapacity(size_class) < indexCount)) size_class++;
+  return size_class;
+}
+
+
+ChunkMeshPool::ChunkMeshPool(entt::dispatcher* pDispatcher)
+  : _pDispatcher(pDispatcher),
+    _freeCount(0)
+{}
+
+
+void ChunkMeshPool::Upload(RenderBackend& backend, Mesh& mesh, const ChunkMeshScratch& scratch, uint64_t frameIndex)
+{
+  Release(mesh, frameIndex);
+  if (scratch.indices.empty()) return;
+
+  Buffers buffers = acquire(backend, (uint32_t)scratch.vertices.size(), (uint32_t)scratch.indices.size(), frameIndex);
+  backend.UpdateBuffer(buffers.vbo, 0, scratch.vertices.size() * sizeof(Vertex), scratch.vertices.data());
+  backend.UpdateBuffer(buffers.ebo, 0, scratch.indices.size() * sizeof(unsigned int), scratch.indices.data());
+
+  mesh.vao = buffers.vao;
+  mesh.vbo = buffers.vbo;
+  mesh.ebo = buffers.ebo;
+  mesh.indiceCount = (int)scratch.indices.size();
+  _live.emplace(buffers.vbo, buffers);
+}
+
+
+void ChunkMeshPool::Release(Mesh& mesh, uint64_t frameIndex)
+{
+  auto it = _live.find(mesh.vbo);
+  if (mesh.vbo && it != _live.end())
+  {
+    it->second.releaseFrame = frameIndex;
+    _free[it->second.sizeClass].push_back(it->second);
+    _freeCount++;
+    _live.erase(it);
+  }
+
+  mesh.vao = 0;
+  mesh.vbo = 0;
+  mesh.ebo = 0;
+  mesh.indiceCount = 0;
+}
+
+
+void ChunkMeshPool::Trim(RenderBackend& backend, uint64_t frameIndex)
+{
+  for (std::deque<Buffers>& free_buffers: _free)
+  {
+    while (!free_buffers.empty() && frameIndex >= free_buffers.front().releaseFrame + CHUNK_MESH_TRIM_FRAMES)
+    {
+      destroy(backend, free_buffers.front());
+      free_buffers.pop_front();
+      _freeCount--;
+    }
+  }
+}
+
+
+void ChunkMeshPool::Destroy(RenderBackend& backend)
+{
+  for (std::deque<Buffers>& free_buffers: _free)
+  {
+    for (const Buffers& buffers: free_buffers)
+    {
+      backend.DestroyVertexArray(buffers.vao);
+      backend.DestroyBuffer(buffers.vbo);
+      backend.DestroyBuffer(buffers.ebo);
+    }
+    free_buffers.clear();
+  }
+  _freeCount = 0;
+  _live.clear();
+}
+
+
+ChunkMeshPool::Buffers ChunkMeshPool::acquire(RenderBackend& backend, uint32_t vertexCount, uint32_t indexCount, uint64_t frameIndex)
+{
+  // la tête est la plus ancienne de sa classe : si elle n'est pas encore réutilisable, aucune ne l'est
+  const uint32_t size_class = getSizeClass(vertexCount, indexCount);
+  std::deque<Buffers>& free_buffers = _free[size_class];
+  if (!free_buffers.empty() && frameIndex >= free_buffers.front().releaseFrame + CHUNK_MESH_REUSE_FRAMES)
+  {
+    Buffers buffers = free_buffers.front();
+    free_buffers.pop_front();
+    _freeCount--;
+
+    // le thread de rendu a peut-être un VAO sur ces buffers, attaché avant leur nouveau contenu
+    if (_pDispatcher) _pDispatcher->trigger(MeshBuffersChangedEvent{ .vertexBuffer = buffers.vbo, .indexBuffer = buffers.ebo });
+    return buffers;
+  }
+
+  Buffers buffers{
+    .sizeClass = size_class,
+    .releaseFrame = 0
+  };
+  buffers.vbo = backend.CreateBuffer(getVertexCapacity(size_class) * sizeof(Vertex), nullptr, BufferUsage::DYNAMIC);
+  buffers.ebo = backend.CreateBuffer(getIndexCapacity(size_class) * sizeof(unsigned int), nullptr, BufferUsage::DYNAMIC);
+
+  // même layout que OBJLoader
+  VertexLayout layout{
+    .stride = sizeof(Vertex),
+    .attributes = {
+      {0, 3, offsetof(Vertex, position)}, // position => 0
+      {1, 3, offsetof(Vertex, normal)}, // normal => 1
+      {2, 2, offsetof(Vertex, textureCoordinates)}, // textureCoordinates => 2
+      {3, 4, offsetof(Vertex, color)}, // color => 3
+    }
+  };
+  buffers.vao = backend.CreateVertexArray(layout, buffers.vbo, buffers.ebo);
+
+  return buffers;
+}
+
+
+void ChunkMeshPool::destroy(RenderBackend& backend, const Buffers& buffers)
+{
+  // avant la destruction : GL peut redonner ces noms tout de suite, le VAO du thread de rendu ne doit pas leur survivre
+  if (_pDispatcher) _pDispatcher->trigger(MeshBuffersChangedEvent{ .vertexBuffer = buffers.vbo, .indexBuffer = buffers.ebo });
+
+  backend.DestroyVertexArray(buffers.vao);
+  backend.DestroyBuffer(buffers.vbo);
+  backend.DestroyBuffer(buffers.ebo);
+}
\ No newline at end of file
@@ -0,0 +1,121 @@
+#include "voxel/chunk_mesh_scheduler.h"
+
+
+#include <utility>
+
+#include "core/job_system.h"
+
+
+void ChunkMeshJob::ExecuteRange(enki::TaskSetPartition range, uint32_t threadnum)
+{
+  if (isCancelled.load(std::memory_order_relaxed))
+  {
+    output.vertices.clear();
+    output.indices.clear();
+    pOwner->_completed.Push(slot);
+    return;
+  }
+
+  ChunkMeshScratch& scratch = pOwner->_scratches[threadnum];
+
+  ChunkNeighbors chunk_neighbors;
+  for (size_t face = 0; face < (size_t)BlockFace::COUNT; face++) chunk_neighbors.pSections[face] = hasNeighbor[face] ? &neighbors[face] : nullptr;
+
+  BuildChunkMesh(section, chunk_neighbors, faceLayers, scratch);
+  bounds = ComputeBounds(scratch.vertices);
+  hasOccluder = FindOccluderBox(section, occluder);
+
+  // le scratch récupère les anciens vecteurs du job, les capacités tournent sans réallocation
+  std::swap(output.vertices, scratch.vertices);
+  std::swap(output.indices, scratch.indices);
+
+  // jamais plein : il y a au plus CHUNK_MESH_MAX_JOBS slots
+  pOwner->_completed.Push(slot);
+}
+
+
+ChunkMeshScheduler::ChunkMeshScheduler(JobSystem* pJobs)
+  : _pScheduler(pJobs ? &pJobs->GetScheduler() : nullptr)
+{
+  _scratches.resize(pJobs ? pJobs->GetThreadCount() : 1);
+
+  _jobs.reserve(CHUNK_MESH_MAX_JOBS);
+  _freeSlots.reserve(CHUNK_MESH_MAX_JOBS);
+  for (uint32_t slot = 0; slot < CHUNK_MESH_MAX_JOBS; slot++)
+  {
+    auto job = std::make_unique<ChunkMeshJob>();
+    job->pOwner = this;
+    job->slot = slot;
+    _jobs.push_back(std::move(job));
+
+    // les premiers slots sortent en premier
+    _freeSlots.push_back(CHUNK_MESH_MAX_JOBS - 1 - slot);
+  }
+}
+
+
+ChunkMeshScheduler::~ChunkMeshScheduler()
+{
+  WaitAll();
+}
+
+
+ChunkMeshJob* ChunkMeshScheduler::Submit(ChunkCoord coord, uint64_t version, const ChunkSection& section, const ChunkNeighbors& neighbors, const std::vector<uint16_t>& faceLayers, bool isUrgent)
+{
+  if (_freeSlots.empty()) return nullptr;
+
+  ChunkMeshJob* pJob = _jobs[_freeSlots.back()].get();
+  _freeSlots.pop_back();
+
+  // le slot est rendu après le Push du worker, enkiTS peut ne pas avoir encore marqué la tâche finie
+  if (_pScheduler && !pJob->GetIsComplete()) _pScheduler->WaitforTask(pJob);
+
+  // copies par affectation, les vecteurs des sections du job gardent leur capacité
+  pJob->coord = coord;
+  pJob->version = version;
+  pJob->isUrgent = isUrgent;
+  pJob->isCancelled.store(false, std::memory_order_relaxed);
+  pJob->section = section;
+  for (size_t face = 0; face < (size_t)BlockFace::COUNT; face++)
+  {
+    pJob->hasNeighbor[face] = neighbors.pSections[face] != nullptr;
+    if (pJob->hasNeighbor[face]) pJob->neighbors[face] = *neighbors.pSections[face];
+  }
+  pJob->faceLayers = faceLayers;
+
+  if (!_pScheduler)
+  {
+    pJob->ExecuteRange(enki::TaskSetPartition{ 0, 1 }, 0);
+    return pJob;
+  }
+
+  pJob->m_SetSize = 1;
+  pJob->m_Priority = isUrgent ? enki::TASK_PRIORITY_HIGH : enki::TASK_PRIORITY_LOW;
+  _pScheduler->AddTaskSetToPipe(pJob);
+  return pJob;
+}
+
+
+ChunkMeshJob* ChunkMeshScheduler::PopCompleted()
+{
+  uint32_t slot;
+  if (!_completed.Pop(slot)) return nullptr;
+  return _jobs[slot].get();
+}
+
+
+void ChunkMeshScheduler::Release(ChunkMeshJob* pJob)
+{
+  _freeSlots.push_back(pJob->slot);
+}
+
+
+void ChunkMeshScheduler::WaitAll()
+{
+  if (!_pScheduler) return;
+
+  for (const auto& job: _jobs)
+  {
+    if (!job->GetIsComplete()) _pScheduler->WaitforTask(job.get());
+  }
+}
\ No newline at end of file
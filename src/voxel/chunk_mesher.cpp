@@ -0,0 +1,242 @@
+#include "voxel/chunk_mesher.h"
+
+
+#include <algorithm>
+#include <cstring>
+
+
+// une ombre fixe par face pour distinguer le relief, dans l'ordre de BlockFace
+static constexpr float FACE_SHADES[(size_t)BlockFace::COUNT] = { 0.8f, 0.8f, 1.0f, 0.5f, 0.65f, 0.65f };
+
+// déplacement dans padded pour +1 sur x, y, z
+static constexpr int PADDED_STRIDES[3] = { 1, CHUNK_PADDED_SIZE * CHUNK_PADDED_SIZE, CHUNK_PADDED_SIZE };
+static constexpr int PADDED_ORIGIN = PADDED_STRIDES[0] + PADDED_STRIDES[1] + PADDED_STRIDES[2]; // bloc (0, 0, 0) du chunk
+
+
+static inline int getPaddedIndex(int x, int y, int z)
+{
+  return PADDED_ORIGIN + x * PADDED_STRIDES[0] + y * PADDED_STRIDES[1] + z * PADDED_STRIDES[2];
+}
+
+
+static inline uint16_t getFaceLayer(const std::vector<uint16_t>& faceLayers, uint16_t block, BlockFace face)
+{
+  const size_t index = (size_t)block * (size_t)BlockFace::COUNT + (size_t)face;
+  return index < faceLayers.size() ? faceLayers[index] : BLOCK_MISSING_LAYER;
+}
+
+
+// une face d'un voisin : la couche qui touche ce chunk, lue avec Get (ou recopiée si le voisin est uniforme)
+static void copyNeighborLayer(std::vector<uint16_t>& padded, const ChunkSection* pNeighbor, BlockFace face)
+{
+  if (!pNeighbor) return;
+
+  const int axis = (int)face / 2;
+  const bool positive = ((int)face % 2) == 0;
+  const int u_axis = (axis + 1) % 3;
+  const int v_axis = (axis + 2) % 3;
+
+  int dst[3];
+  int src[3];
+  dst[axis] = positive ? CHUNK_SIZE : -1;
+  src[axis] = positive ? 0 : CHUNK_SIZE - 1;
+
+  for (int v = 0; v < CHUNK_SIZE; v++)
+  {
+    for (int u = 0; u < CHUNK_SIZE; u++)
+    {
+      dst[u_axis] = src[u_axis] = u;
+      dst[v_axis] = src[v_axis] = v;
+      padded[getPaddedIndex(dst[0], dst[1], dst[2])] = pNeighbor->IsUniform() ? pNeighbor->GetUniformBlock() : pNeighbor->Get(src[0], src[1], src[2]);
+    }
+  }
+}
+
+
+static void fillPadded(const ChunkSection& section, const ChunkNeighbors& neighbors, ChunkMeshScratch& scratch)
+{
+  scratch.blocks.resize(CHUNK_VOLUME);
+  scratch.padded.assign(CHUNK_PADDED_VOLUME, BLOCK_AIR);
+  section.Decode(scratch.blocks.data());
+
+  for (int y = 0; y < CHUNK_SIZE; y++)
+  {
+    for (int z = 0; z < CHUNK_SIZE; z++)
+    {
+      std::memcpy(scratch.padded.data() + getPaddedIndex(0, y, z), scratch.blocks.data() + GetBlockIndex(0, y, z), CHUNK_SIZE * sizeof(uint16_t));
+    }
+  }
+
+  for (size_t face = 0; face < (size_t)BlockFace::COUNT; face++) copyNeighborLayer(scratch.padded, neighbors.pSections[face], (BlockFace)face);
+}
+
+
+// un quad de w x h blocs sur le plan 'plane' de l'axe de la face, coins (u, v) -> (u + w, v + h)
+static void emitQuad(ChunkMeshScratch& scratch, BlockFace face, int plane, int u, int v, int w, int h, uint16_t layer)
+{
+  const int axis = (int)face / 2;
+  const bool positive = ((int)face % 2) == 0;
+  const int u_axis = (axis + 1) % 3;
+  const int v_axis = (axis + 2) % 3;
+
+  glm::vec3 normal(0.0f);
+  normal[axis] = positive ? 1.0f : -1.0f;
+  // l'ombre de la face dans rgb, le layer du BlockTextureArray dans a (exact en float jusqu'à 2^24)
+  const float shade = FACE_SHADES[(size_t)face];
+  const glm::vec4 color(shade, shade, shade, (float)layer);
+
+  // (u, v, axe) est direct : ce ordre est anti-horaire vu depuis +axe, inversé pour les faces négatives
+  const int corners[4][2] = { {0, 0}, {w, 0}, {w, h}, {0, h} };
+  const unsigned int first = (unsigned int)scratch.vertices.size();
+  for (int i = 0; i < 4; i++)
+  {
+    const int* pCorner = corners[positive ? i : 3 - i];
+
+    glm::vec3 position;
+    position[axis] = (float)plane;
+    position[u_axis] = (float)(u + pCorner[0]);
+    position[v_axis] = (float)(v + pCorner[1]);
+
+    // en unités de bloc pour que la texture se répète sur un quad fusionné
+    scratch.vertices.push_back(Vertex{
+      .position = position,
+      .normal = normal,
+      .textureCoordinates = glm::vec2((float)pCorner[0], (float)pCorner[1]),
+      .color = color
+    });
+  }
+
+  scratch.indices.insert(scratch.indices.end(), { first, first + 1, first + 2, first + 2, first + 3, first });
+}
+
+
+static void buildMesh(const ChunkSection& section, const ChunkNeighbors& neighbors, const std::vector<uint16_t>& faceLayers, ChunkMeshScratch& scratch, bool greedy)
+{
+  scratch.vertices.clear();
+  scratch.indices.clear();
+
+  if (section.IsUniform() && section.GetUniformBlock() == BLOCK_AIR) return;
+
+  fillPadded(section, neighbors, scratch);
+  scratch.mask.resize(CHUNK_AREA);
+
+  const uint16_t* pPadded = scratch.padded.data();
+  uint16_t* pMask = scratch.mask.data();
+
+  for (size_t face_index = 0; face_index < (size_t)BlockFace::COUNT; face_index++)
+  {
+    const BlockFace face = (BlockFace)face_index;
+    const int axis = (int)face / 2;
+    const bool positive = ((int)face % 2) == 0;
+    const int axis_stride = PADDED_STRIDES[axis];
+    const int u_stride = PADDED_STRIDES[(axis + 1) % 3];
+    const int v_stride = PADDED_STRIDES[(axis + 2) % 3];
+    const int neighbor_offset = positive ? axis_stride : -axis_stride;
+
+    for (int slice = 0; slice < CHUNK_SIZE; slice++)
+    {
+      // masque de la tranche : bloc plein dont le voisin dans la direction de la face est de l'air
+      // on y met le layer et pas le bloc, deux blocs qui partagent une texture sur cette face fusionnent aussi
+      bool has_face = false;
+      for (int v = 0; v < CHUNK_SIZE; v++)
+      {
+        const int row = PADDED_ORIGIN + slice * axis_stride + v * v_stride;
+        for (int u = 0; u < CHUNK_SIZE; u++)
+        {
+          const int index = row + u * u_stride;
+          const uint16_t block = pPadded[index];
+          const bool visible = block != BLOCK_AIR && pPadded[index + neighbor_offset] == BLOCK_AIR;
+          pMask[v * CHUNK_SIZE + u] = visible ? getFaceLayer(faceLayers, block, face) + 1 : 0;
+          has_face |= visible;
+        }
+      }
+      if (!has_face) continue;
+
+      const int plane = positive ? slice + 1 : slice;
+      for (int v = 0; v < CHUNK_SIZE; v++)
+      {
+        for (int u = 0; u < CHUNK_SIZE; )
+        {
+          const uint16_t entry = pMask[v * CHUNK_SIZE + u];
+          if (entry == 0)
+          {
+            u++;
+            continue;
+          }
+
+          // on étend d'abord en largeur, puis ligne par ligne tant que toute la largeur correspond
+          int width = 1;
+          int height = 1;
+          if (greedy)
+          {
+            while (u + width < CHUNK_SIZE && pMask[v * CHUNK_SIZE + u + width] == entry) width++;
+
+            while (v + height < CHUNK_SIZE)
+            {
+              const uint16_t* pRow = pMask + (v + height) * CHUNK_SIZE + u;
+              if (!std::all_of(pRow, pRow + width, [entry](uint16_t other){ return other == entry; })) break;
+              height++;
+            }
+
+            for (int row = 0; row < height; row++) std::fill_n(pMask + (v + row) * CHUNK_SIZE + u, width, (uint16_t)0);
+          }
+
+          emitQuad(scratch, face, plane, u, v, width, height, (uint16_t)(entry - 1));
+          u += width;
+        }
+      }
+    }
+  }
+}
+
+
+void BuildChunkMesh(const ChunkSection& section, const ChunkNeighbors& neighbors, const std::vector<uint16_t>& faceLayers, ChunkMeshScratch& scratch)
+{
+  buildMesh(section, neighbors, faceLayers, scratch, true);
+}
+
+
+void BuildChunkMeshNaive(const ChunkSection& section, const ChunkNeighbors& neighbors, const std::vector<uint16_t>& faceLayers, ChunkMeshScratch& scratch)
+{
+  buildMesh(section, neighbors, faceLayers, scratch, false);
+}
+
+
+bool FindOccluderBox(const ChunkSection& section, Bounds& box)
+{
+  int best_start = 0;
+  int best_count = 0;
+
+  if (section.IsUniform())
+  {
+    if (section.GetUniformBlock() == BLOCK_AIR) return false;
+    best_count = CHUNK_SIZE;
+  }
+  else
+  {
+    // la terre est en couches : sous la surface d'une section tout est plein, on s'arrête au premier bloc d'air de chaque couche
+    int run_start = 0;
+    for (int y = 0; y < CHUNK_SIZE; y++)
+    {
+      const uint32_t layer_start = GetBlockIndex(0, y, 0);
+      bool is_full = true;
+      for (uint32_t i = layer_start; i < layer_start + (uint32_t)CHUNK_AREA && is_full; i++) is_full = section.Get(i) != BLOCK_AIR;
+
+      if (!is_full)
+      {
+        run_start = y + 1;
+        continue;
+      }
+      if (y + 1 - run_start > best_count)
+      {
+        best_start = run_start;
+        best_count = y + 1 - run_start;
+      }
+    }
+    if (best_count == 0) return false;
+  }
+
+  box.min = glm::vec3(0.0f, (float)best_start, 0.0f);
+  box.max = glm::vec3((float)CHUNK_SIZE, (float)(best_start + best_count), (float)CHUNK_SIZE);
+  return true;
+}
\ No newline at end of file
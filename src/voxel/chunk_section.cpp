@@ -0,0 +1,422 @@
+#include "voxel/chunk_section.h"
+
+
+#include <algorithm>
+
+#if defined(__AVX__) || defined(__SSSE3__)
+#include <immintrin.h>
+#define VOXL_SECTION_SSSE3 // pshufb sert de table de palette pour les indices de 4 bits ou moins
+#endif
+
+
+// les indices sont lus octet par octet dans les mots de 64 bits, ce qui suppose du little-endian (x86, ARM)
+static_assert(CHUNK_VOLUME % 128 == 0, "Decode traite les indices par paquets de 8 octets");
+
+
+ChunkSection::ChunkSection(uint16_t block)
+{
+  Fill(block);
+}
+
+
+void ChunkSection::Set(int x, int y, int z, uint16_t block)
+{
+  Set(GetBlockIndex(x, y, z), block);
+}
+
+
+void ChunkSection::Set(uint32_t index, uint16_t block)
+{
+  const uint16_t old_entry = getPaletteIndex(index);
+  if (_palette[old_entry] == block) return;
+
+  // peut faire grandir les indices, old_entry reste valide (pas de renumérotation)
+  int entry = findEntry(block);
+  if (entry < 0) entry = addEntry(block);
+
+  setPaletteIndex(index, (uint16_t)entry);
+  _counts[entry]++;
+
+  if (--_counts[old_entry] == 0)
+  {
+    releaseEntry(old_entry);
+    shrink();
+  }
+}
+
+
+void ChunkSection::Fill(uint16_t block)
+{
+  _palette.assign(1, block);
+  _counts.assign(1, (uint16_t)CHUNK_VOLUME);
+  _freeEntries.clear();
+  _paletteIndex.clear();
+
+  _words.clear();
+  _words.shrink_to_fit();
+  setBits(0);
+}
+
+
+void ChunkSection::Decode(uint16_t* pBlocks) const
+{
+  if (_bits == 0)
+  {
+    std::fill(pBlocks, pBlocks + CHUNK_VOLUME, _palette[0]);
+    return;
+  }
+
+  const uint8_t* pBytes = reinterpret_cast<const uint8_t*>(_words.data());
+
+  if (_bits == 8)
+  {
+    for (uint32_t i = 0; i < CHUNK_VOLUME; i++) pBlocks[i] = _palette[pBytes[i]];
+    return;
+  }
+
+  if (_bits == 16)
+  {
+    const uint16_t* pEntries = reinterpret_cast<const uint16_t*>(pBytes);
+    for (uint32_t i = 0; i < CHUNK_VOLUME; i++) pBlocks[i] = _palette[pEntries[i]];
+    return;
+  }
+
+#if defined(VOXL_SECTION_SSSE3)
+  // palette de 16 entrées au plus, coupée en octets bas et hauts pour deux pshufb
+  alignas(16) uint8_t palette_low[16] = {};
+  alignas(16) uint8_t palette_high[16] = {};
+  for (size_t i = 0; i < _palette.size(); i++)
+  {
+    palette_low[i] = (uint8_t)(_palette[i] & 0xFF);
+    palette_high[i] = (uint8_t)(_palette[i] >> 8);
+  }
+  const __m128i low_table = _mm_load_si128(reinterpret_cast<const __m128i*>(palette_low));
+  const __m128i high_table = _mm_load_si128(reinterpret_cast<const __m128i*>(palette_high));
+
+  // 16 indices (un par octet) -> 16 blocs
+  auto store = [&](__m128i indices, uint16_t* pOut)
+  {
+    __m128i low = _mm_shuffle_epi8(low_table, indices);
+    __m128i high = _mm_shuffle_epi8(high_table, indices);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(pOut), _mm_unpacklo_epi8(low, high));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(pOut + 8), _mm_unpackhi_epi8(low, high));
+  };
+
+  // 8 octets d'indices par tour, déroulés dans l'ordre des blocs avec des unpack
+  const size_t byte_count = (size_t)CHUNK_VOLUME * _bits / 8;
+  uint16_t* pOut = pBlocks;
+  if (_bits == 4)
+  {
+    const __m128i mask = _mm_set1_epi8(0x0F);
+    for (size_t offset = 0; offset < byte_count; offset += 8, pOut += 16)
+    {
+      __m128i bytes = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(pBytes + offset));
+      __m128i e0 = _mm_and_si128(bytes, mask);
+      __m128i e1 = _mm_and_si128(_mm_srli_epi16(bytes, 4), mask);
+      store(_mm_unpacklo_epi8(e0, e1), pOut);
+    }
+  }
+  else if (_bits == 2)
+  {
+    const __m128i mask = _mm_set1_epi8(0x03);
+    for (size_t offset = 0; offset < byte_count; offset += 8, pOut += 32)
+    {
+      __m128i bytes = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(pBytes + offset));
+      __m128i e0 = _mm_and_si128(bytes, mask);
+      __m128i e1 = _mm_and_si128(_mm_srli_epi16(bytes, 2), mask);
+      __m128i e2 = _mm_and_si128(_mm_srli_epi16(bytes, 4), mask);
+      __m128i e3 = _mm_and_si128(_mm_srli_epi16(bytes, 6), mask);
+      __m128i e01 = _mm_unpacklo_epi8(e0, e1);
+      __m128i e23 = _mm_unpacklo_epi8(e2, e3);
+      store(_mm_unpacklo_epi16(e01, e23), pOut);
+      store(_mm_unpackhi_epi16(e01, e23), pOut + 16);
+    }
+  }
+  else
+  {
+    const __m128i mask = _mm_set1_epi8(0x01);
+    for (size_t offset = 0; offset < byte_count; offset += 8, pOut += 64)
+    {
+      __m128i bytes = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(pBytes + offset));
+      __m128i e01 = _mm_unpacklo_epi8(_mm_and_si128(bytes, mask), _mm_and_si128(_mm_srli_epi16(bytes, 1), mask));
+      __m128i e23 = _mm_unpacklo_epi8(_mm_and_si128(_mm_srli_epi16(bytes, 2), mask), _mm_and_si128(_mm_srli_epi16(bytes, 3), mask));
+      __m128i e45 = _mm_unpacklo_epi8(_mm_and_si128(_mm_srli_epi16(bytes, 4), mask), _mm_and_si128(_mm_srli_epi16(bytes, 5), mask));
+      __m128i e67 = _mm_unpacklo_epi8(_mm_and_si128(_mm_srli_epi16(bytes, 6), mask), _mm_and_si128(_mm_srli_epi16(bytes, 7), mask));
+      __m128i e0123_low = _mm_unpacklo_epi16(e01, e23);
+      __m128i e0123_high = _mm_unpackhi_epi16(e01, e23);
+      __m128i e4567_low = _mm_unpacklo_epi16(e45, e67);
+      __m128i e4567_high = _mm_unpackhi_epi16(e45, e67);
+      store(_mm_unpacklo_epi32(e0123_low, e4567_low), pOut);
+      store(_mm_unpackhi_epi32(e0123_low, e4567_low), pOut + 16);
+      store(_mm_unpacklo_epi32(e0123_high, e4567_high), pOut + 32);
+      store(_mm_unpackhi_epi32(e0123_high, e4567_high), pOut + 48);
+    }
+  }
+#else
+  // un mot à la fois, sans recalculer la position de chaque indice
+  const uint32_t per_word = 64u >> _log2Bits;
+  uint16_t* pOut = pBlocks;
+  for (uint64_t word: _words)
+  {
+    for (uint32_t i = 0; i < per_word; i++)
+    {
+      *pOut++ = _palette[word & _mask];
+      word >>= _bits;
+    }
+  }
+#endif
+}
+
+
+void ChunkSection::Encode(const uint16_t* pBlocks)
+{
+  _palette.clear();
+  _counts.clear();
+  _freeEntries.clear();
+  _paletteIndex.clear();
+
+  // premier passage : palette et entrée de chaque bloc, le dernier bloc vu évite la plupart des recherches
+  std::vector<uint16_t> entries(CHUNK_VOLUME);
+  uint16_t last_block = pBlocks[0];
+  uint16_t last_entry = 0;
+  _palette.push_back(last_block);
+  _counts.push_back(0);
+
+  for (uint32_t i = 0; i < CHUNK_VOLUME; i++)
+  {
+    const uint16_t block = pBlocks[i];
+    if (block != last_block)
+    {
+      int entry = findEntry(block);
+      if (entry < 0)
+      {
+        entry = (int)_palette.size();
+        _palette.push_back(block);
+        _counts.push_back(0);
+        if (_palette.size() > SECTION_PALETTE_LINEAR_LIMIT)
+        {
+          if (_paletteIndex.empty())
+          {
+            for (size_t e = 0; e < _palette.size(); e++) _paletteIndex.emplace(_palette[e], (uint16_t)e);
+          }
+          else _paletteIndex.emplace(block, (uint16_t)entry);
+        }
+      }
+      last_block = block;
+      last_entry = (uint16_t)entry;
+    }
+
+    // findEntry ignore les entrées à 0, on compte donc au fur et à mesure
+    entries[i] = last_entry;
+    _counts[last_entry]++;
+  }
+
+  if (_palette.size() == 1)
+  {
+    Fill(_palette[0]);
+    return;
+  }
+
+  int bits = 1;
+  while ((size_t)1 << bits < _palette.size()) bits *= 2;
+
+  // deuxième passage : empaquetage direct à la bonne taille
+  setBits(bits);
+  _words.assign((size_t)CHUNK_VOLUME * bits / 64, 0);
+  for (uint32_t i = 0; i < CHUNK_VOLUME; i++) setPaletteIndex(i, entries[i]);
+}
+
+
+bool ChunkSection::Assign(int bits, std::vector<uint16_t> palette, std::vector<uint64_t> words)
+{
+  if (bits == 0)
+  {
+    if (palette.empty() || !words.empty()) return false;
+    Fill(palette[0]);
+    return true;
+  }
+
+  const bool is_valid_bits = bits == 1 || bits == 2 || bits == 4 || bits == 8 || bits == 16;
+  if (!is_valid_bits || palette.empty() || palette.size() > ((size_t)1 << bits) || words.size() != (size_t)CHUNK_VOLUME * bits / 64) return false;
+
+  // les compteurs ne sont pas sauvegardés, on les refait en lisant tous les indices
+  std::vector<uint64_t> previous_words;
+  previous_words.swap(_words);
+  const int previous_bits = _bits;
+  _words.swap(words);
+  setBits(bits);
+
+  std::vector<uint16_t> counts(palette.size(), 0);
+  for (uint32_t i = 0; i < CHUNK_VOLUME; i++)
+  {
+    const uint16_t entry = getPaletteIndex(i);
+    if (entry >= palette.size())
+    {
+      _words.swap(previous_words);
+      setBits(previous_bits);
+      return false;
+    }
+    counts[entry]++;
+  }
+
+  _palette.swap(palette);
+  _counts.swap(counts);
+  _freeEntries.clear();
+  _paletteIndex.clear();
+  for (size_t entry = 0; entry < _palette.size(); entry++)
+  {
+    if (_counts[entry] == 0) _freeEntries.push_back((uint16_t)entry);
+  }
+  if (_palette.size() > SECTION_PALETTE_LINEAR_LIMIT)
+  {
+    for (size_t entry = 0; entry < _palette.size(); entry++)
+    {
+      if (_counts[entry] > 0) _paletteIndex.emplace(_palette[entry], (uint16_t)entry);
+    }
+  }
+
+  // une section sauvegardée juste avant un shrink peut n'avoir plus qu'un bloc
+  if (GetPaletteSize() == 1) shrink();
+  return true;
+}
+
+
+size_t ChunkSection::GetMemoryUsage() const
+{
+  // estimation pour le map : un noeud et un bucket par entrée
+  return sizeof(ChunkSection)
+    + _palette.capacity() * sizeof(uint16_t)
+    + _counts.capacity() * sizeof(uint16_t)
+    + _freeEntries.capacity() * sizeof(uint16_t)
+    + _paletteIndex.size() * (sizeof(void*) * 3 + sizeof(uint16_t) * 2)
+    + _words.capacity() * sizeof(uint64_t);
+}
+
+
+int ChunkSection::findEntry(uint16_t block) const
+{
+  if (!_paletteIndex.empty())
+  {
+    auto it = _paletteIndex.find(block);
+    return it != _paletteIndex.end() ? (int)it->second : -1;
+  }
+
+  for (size_t entry = 0; entry < _palette.size(); entry++)
+  {
+    if (_palette[entry] == block && _counts[entry] > 0) return (int)entry;
+  }
+  return -1;
+}
+
+
+uint16_t ChunkSection::addEntry(uint16_t block)
+{
+  uint16_t entry;
+  if (!_freeEntries.empty())
+  {
+    entry = _freeEntries.back();
+    _freeEntries.pop_back();
+    _palette[entry] = block;
+  }
+  else
+  {
+    if (_palette.size() >= ((size_t)1 << _bits)) repack(_bits == 0 ? 1 : _bits * 2, nullptr);
+
+    entry = (uint16_t)_palette.size();
+    _palette.push_back(block);
+    _counts.push_back(0);
+  }
+
+  if (!_paletteIndex.empty()) _paletteIndex[block] = entry;
+  else if (_palette.size() > SECTION_PALETTE_LINEAR_LIMIT)
+  {
+    for (size_t e = 0; e < _palette.size(); e++)
+    {
+      if (_counts[e] > 0 || e == entry) _paletteIndex.emplace(_palette[e], (uint16_t)e);
+    }
+  }
+
+  return entry;
+}
+
+
+void ChunkSection::releaseEntry(uint16_t entry)
+{
+  _freeEntries.push_back(entry);
+  if (!_paletteIndex.empty()) _paletteIndex.erase(_palette[entry]);
+}
+
+
+void ChunkSection::setBits(int bits)
+{
+  _bits = bits;
+  _log2Bits = 0;
+  while ((1 << _log2Bits) < bits) _log2Bits++;
+  _mask = bits == 0 ? 0 : (bits >= 16 ? 0xFFFFull : ((1ull << bits) - 1));
+}
+
+
+// pRemap : ancienne entrée -> nouvelle, nullptr pour garder la numérotation
+void ChunkSection::repack(int bits, const uint16_t* pRemap)
+{
+  std::vector<uint64_t> words((size_t)CHUNK_VOLUME * bits / 64, 0);
+
+  int log2_bits = 0;
+  while ((1 << log2_bits) < bits) log2_bits++;
+  const uint32_t shift = 6 - log2_bits;
+  const uint32_t offset_mask = (1u << shift) - 1;
+
+  for (uint32_t i = 0; i < CHUNK_VOLUME; i++)
+  {
+    uint16_t entry = getPaletteIndex(i);
+    if (pRemap) entry = pRemap[entry];
+    words[i >> shift] |= (uint64_t)entry << ((i & offset_mask) << log2_bits);
+  }
+
+  _words.swap(words);
+  setBits(bits);
+}
+
+
+// une seule entrée vivante : uniforme, sinon on descend d'un cran quand la palette tient dans la moitié de la taille inférieure
+// la marge évite de repacker à chaque edit autour d'une limite
+void ChunkSection::shrink()
+{
+  const size_t live_count = _palette.size() - _freeEntries.size();
+
+  if (live_count == 1)
+  {
+    for (size_t entry = 0; entry < _palette.size(); entry++)
+    {
+      if (_counts[entry] > 0)
+      {
+        Fill(_palette[entry]);
+        return;
+      }
+    }
+  }
+
+  if (_bits < 2 || live_count > ((size_t)1 << (_bits / 2)) / 2) return;
+
+  std::vector<uint16_t> remap(_palette.size(), 0);
+  std::vector<uint16_t> palette;
+  std::vector<uint16_t> counts;
+  for (size_t entry = 0; entry < _palette.size(); entry++)
+  {
+    if (_counts[entry] == 0) continue;
+    remap[entry] = (uint16_t)palette.size();
+    palette.push_back(_palette[entry]);
+    counts.push_back(_counts[entry]);
+  }
+
+  repack(_bits / 2, remap.data());
+  _palette.swap(palette);
+  _counts.swap(counts);
+  _freeEntries.clear();
+
+  _paletteIndex.clear();
+  if (_palette.size() > SECTION_PALETTE_LINEAR_LIMIT)
+  {
+    for (size_t entry = 0; entry < _palette.size(); entry++) _paletteIndex.emplace(_palette[entry], (uint16_t)entry);
+  }
+}
\ No newline at end of file
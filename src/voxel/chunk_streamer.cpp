@@ -0,0 +1,340 @@
+#include "voxel/chunk_streamer.h"
+
+
+#include <algorithm>
+#include <utility>
+
+#include "core/job_system.h"
+#include "voxel/region_file.h"
+#include "voxel/voxel_world.h"
+
+
+void ChunkColumnJob::ExecuteRange(enki::TaskSetPartition range, uint32_t threadnum)
+{
+  ChunkStreamer& owner = *pOwner;
+  ChunkColumnScratch& scratch = owner._scratches[threadnum];
+  const TerrainGenerator& generator = owner._generator;
+
+  // les hauteurs ne sont calculées qu'au premier chunk absent des régions
+  bool has_heights = false;
+  for (int chunk_y = generator.GetSettings().bottomChunkY; chunk_y <= CHUNK_STREAM_TOP_Y; chunk_y++)
+  {
+    // annulé par le thread principal : le reste de la colonne n'est pas fait
+    if (isCancelled.load(std::memory_order_relaxed)) break;
+
+    const ChunkCoord coord{ column.x, chunk_y, column.z };
+    ChunkSection section;
+    if (owner._pStorage && owner._pStorage->LoadChunk(coord, section))
+    {
+      chunks.push_back(GeneratedChunk{ coord, std::move(section) });
+      continue;
+    }
+
+    if (!has_heights)
+    {
+      generator.GenerateColumn(column.x, column.z, *scratch.pColumn);
+      has_heights = true;
+    }
+    if (generator.GenerateSection(*scratch.pColumn, chunk_y, section, scratch.blocks.data())) chunks.push_back(GeneratedChunk{ coord, std::move(section) });
+  }
+
+  // jamais plein : il y a au plus CHUNK_STREAM_MAX_JOBS slots
+  owner._completed.Push(slot);
+}
+
+
+ChunkStreamer::ChunkStreamer(JobSystem* pJobs, RegionStorage* pStorage, const TerrainSettings& settings)
+  : _pScheduler(pJobs ? &pJobs->GetScheduler() : nullptr),
+    _pStorage(pStorage),
+    _generator(settings),
+    _radius(CHUNK_STREAM_DEFAULT_RADIUS),
+    _nextRequest(0),
+    _viewerColumn(0),
+    _viewerForward(0.0f),
+    _isViewDirty(true),
+    _cancelledCount(0)
+{
+  _scratches.resize(pJobs ? pJobs->GetThreadCount() : 1);
+  for (ChunkColumnScratch& scratch: _scratches)
+  {
+    scratch.pColumn = std::make_unique<TerrainColumn>();
+    scratch.blocks.resize(CHUNK_VOLUME);
+  }
+
+  _jobs.reserve(CHUNK_STREAM_MAX_JOBS);
+  _freeSlots.reserve(CHUNK_STREAM_MAX_JOBS);
+  for (uint32_t slot = 0; slot < CHUNK_STREAM_MAX_JOBS; slot++)
+  {
+    auto job = std::make_unique<ChunkColumnJob>();
+    job->pOwner = this;
+    job->slot = slot;
+    _jobs.push_back(std::move(job));
+    _freeSlots.push_back(CHUNK_STREAM_MAX_JOBS - 1 - slot);
+  }
+}
+
+
+ChunkStreamer::~ChunkStreamer()
+{
+  for (const auto& job: _jobs) job->isCancelled.store(true, std::memory_order_relaxed);
+  WaitAll();
+}
+
+
+void ChunkStreamer::SetRadius(int radius)
+{
+  _radius = std::max(radius, 0);
+  _isViewDirty = true;
+}
+
+
+void ChunkStreamer::WaitAll()
+{
+  if (!_pScheduler) return;
+
+  for (const auto& job: _jobs)
+  {
+    if (!job->GetIsComplete()) _pScheduler->WaitforTask(job.get());
+  }
+}
+
+
+void ChunkStreamer::Update(VoxelWorld& world, const glm::vec3& viewerPosition, const glm::vec3& viewerForward)
+{
+  const auto start = std::chrono::steady_clock::now();
+
+  const ChunkCoord viewer = GetChunkCoord(glm::ivec3(glm::floor(viewerPosition)));
+  const glm::ivec2 viewer_column(viewer.x, viewer.z);
+
+  // seule la direction horizontale compte, regarder droit vers le bas ne favorise aucune colonne
+  glm::vec2 forward(viewerForward.x, viewerForward.z);
+  const float forward_length = glm::length(forward);
+  forward = forward_length > 1e-3f ? forward / forward_length : glm::vec2(0.0f);
+
+  // l'ordre n'est refait qu'après un changement de colonne ou une vraie rotation, pas à chaque petit mouvement de souris
+  const bool has_turned = glm::dot(forward, _viewerForward) < CHUNK_STREAM_TURN_COS && (forward != glm::vec2(0.0f) || _viewerForward != glm::vec2(0.0f));
+  if (_isViewDirty || viewer_column != _viewerColumn || has_turned)
+  {
+    _viewerColumn = viewer_column;
+    _viewerForward = forward;
+    _isViewDirty = false;
+    refreshRequests();
+  }
+
+  collectColumns();
+  applyColumns(world, start);
+  unloadColumns(world, start);
+  submitColumns();
+}
+
+
+bool ChunkStreamer::isInRange(ChunkCoord column, int radius) const
+{
+  // même test que les noeuds LOD : une colonne est chargée quand son noeud de niveau 1 est subdivisé
+  return IsLodNodeSubdivided(_viewerColumn, 1, glm::ivec2(column.x >> 1, column.z >> 1), radius);
+}
+
+
+float ChunkStreamer::getPriority(ChunkCoord column) const
+{
+  return GetViewWeightedDistance(glm::vec2(column.x - _viewerColumn.x, column.z - _viewerColumn.y), _viewerForward);
+}
+
+
+void ChunkStreamer::refreshRequests()
+{
+  // colonnes sorties du rayon : annulées si en vol, déchargées sous budget sinon
+  // la marge évite de décharger et recharger une colonne quand le joueur fait des allers-retours sur une frontière
+  const int keep_radius = _radius > 0 ? _radius + CHUNK_STREAM_UNLOAD_MARGIN : 0;
+  _unloadQueue.clear();
+  for (auto it = _columns.begin(); it != _columns.end();)
+  {
+    if (isInRange(it->first, keep_radius))
+    {
+      ++it;
+      continue;
+    }
+
+    if (it->second.pJob)
+    {
+      cancel(it->second.pJob);
+      it = _columns.erase(it);
+      continue;
+    }
+
+    _unloadQueue.push_back(it->first);
+    ++it;
+  }
+
+  // les plus lointaines en premier, le déchargement les prend par la fin
+  std::sort(_unloadQueue.begin(), _unloadQueue.end(), [this](ChunkCoord a, ChunkCoord b) { return getPriority(a) < getPriority(b); });
+
+  // toutes les colonnes voulues, en vol comprises, de la plus importante à la moins importante
+  _requests.clear();
+  _nextRequest = 0;
+  // le noeud de niveau 1 le plus proche peut déborder d'une colonne au delà du rayon
+  const int extent = _radius + 1;
+  for (int dz = -extent; dz <= extent; dz++)
+  {
+    for (int dx = -extent; dx <= extent; dx++)
+    {
+      const ChunkCoord column{ _viewerColumn.x + dx, 0, _viewerColumn.y + dz };
+      if (!isInRange(column, _radius)) continue;
+
+      auto it = _columns.find(column);
+      if (it != _columns.end() && !it->second.pJob) continue;
+      _requests.emplace_back(getPriority(column), column);
+    }
+  }
+  std::sort(_requests.begin(), _requests.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+
+  // un job en vol derrière les CHUNK_STREAM_MAX_JOBS premières colonnes voulues laisse sa place (rotation, téléportation)
+  // les autres, et ceux déjà finis, restent en vol et sortent de la liste
+  size_t count = 0;
+  for (size_t i = 0; i < _requests.size(); i++)
+  {
+    const ChunkCoord column = _requests[i].second;
+    auto it = _columns.find(column);
+    if (it != _columns.end())
+    {
+      if (i < CHUNK_STREAM_MAX_JOBS || it->second.pJob->GetIsComplete()) continue;
+
+      cancel(it->second.pJob);
+      _columns.erase(it);
+    }
+    _requests[count++] = _requests[i];
+  }
+  _requests.resize(count);
+}
+
+
+void ChunkStreamer::collectColumns()
+{
+  uint32_t slot;
+  while (_completed.Pop(slot))
+  {
+    ChunkColumnJob* pJob = _jobs[slot].get();
+
+    // annulé, ou colonne redemandée à un autre job entre temps
+    auto it = _columns.find(pJob->column);
+    if (pJob->isCancelled.load(std::memory_order_relaxed) || it == _columns.end() || it->second.pJob != pJob)
+    {
+      release(pJob);
+      continue;
+    }
+    _ready.push_back(pJob);
+  }
+}
+
+
+void ChunkStreamer::applyColumns(VoxelWorld& world, std::chrono::steady_clock::time_point start)
+{
+  if (_ready.empty()) return;
+
+  // les plus importantes d'abord, l'ordre d'arrivée dépend des workers
+  std::sort(_ready.begin(), _ready.end(), [this](const ChunkColumnJob* a, const ChunkColumnJob* b) { return getPriority(a->column) < getPriority(b->column); });
+
+  size_t applied = 0;
+  for (; applied < _ready.size(); applied++)
+  {
+    if (applied > 0 && std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count() > CHUNK_STREAM_BUDGET_MS) break;
+
+    ChunkColumnJob* pJob = _ready[applied];
+    if (pJob->isCancelled.load(std::memory_order_relaxed))
+    {
+      release(pJob);
+      continue;
+    }
+
+    for (GeneratedChunk& chunk: pJob->chunks)
+    {
+      // un chunk déjà là (Load, $generate_terrain) peut avoir des modifications pas encore sauvegardées
+      if (world.GetSection(chunk.coord)) continue;
+
+      // une section générée se refait à l'identique depuis la seed, elle compte comme sauvegardée
+      world.SetChunk(chunk.coord, chunk.section, true);
+    }
+
+    _columns[pJob->column].pJob = nullptr;
+    release(pJob);
+  }
+
+  _ready.erase(_ready.begin(), _ready.begin() + applied);
+}
+
+
+void ChunkStreamer::unloadColumns(VoxelWorld& world, std::chrono::steady_clock::time_point start)
+{
+  const int keep_radius = _radius > 0 ? _radius + CHUNK_STREAM_UNLOAD_MARGIN : 0;
+  const int bottom_y = _generator.GetSettings().bottomChunkY;
+
+  size_t waiting = 0;
+  while (_unloadQueue.size() > waiting)
+  {
+    if (std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count() > CHUNK_STREAM_BUDGET_MS) break;
+
+    const ChunkCoord column = _unloadQueue.back();
+    _unloadQueue.pop_back();
+
+    // revenue dans le rayon, ou déjà déchargée
+    auto it = _columns.find(column);
+    if (it == _columns.end() || it->second.pJob || isInRange(column, keep_radius)) continue;
+
+    // le noeud LOD qui la remplace n'est pas encore construit : elle repasse en tête de file
+    if (!world.CanUnloadColumn(column.x, column.z))
+    {
+      _unloadQueue.insert(_unloadQueue.begin(), column);
+      waiting++;
+      continue;
+    }
+
+    for (int chunk_y = bottom_y; chunk_y <= CHUNK_STREAM_TOP_Y; chunk_y++) world.UnloadChunk(ChunkCoord{ column.x, chunk_y, column.z });
+    _columns.erase(it);
+  }
+}
+
+
+void ChunkStreamer::submitColumns()
+{
+  while (!_freeSlots.empty() && _nextRequest < _requests.size())
+  {
+    const ChunkCoord column = _requests[_nextRequest++].second;
+    if (_columns.count(column)) continue;
+
+    ChunkColumnJob* pJob = _jobs[_freeSlots.back()].get();
+    _freeSlots.pop_back();
+
+    // le slot est rendu après le Push du worker, enkiTS peut ne pas avoir encore marqué la tâche finie
+    if (_pScheduler && !pJob->GetIsComplete()) _pScheduler->WaitforTask(pJob);
+
+    pJob->column = column;
+    pJob->isCancelled.store(false, std::memory_order_relaxed);
+    pJob->chunks.clear();
+    _columns[column] = Column{ pJob };
+
+    // sans JobSystem, une colonne par frame sur le thread principal
+    if (!_pScheduler)
+    {
+      pJob->ExecuteRange(enki::TaskSetPartition{ 0, 1 }, 0);
+      break;
+    }
+
+    pJob->m_SetSize = 1;
+    pJob->m_Priority = enki::TASK_PRIORITY_LOW;
+    _pScheduler->AddTaskSetToPipe(pJob);
+  }
+}
+
+
+void ChunkStreamer::cancel(ChunkColumnJob* pJob)
+{
+  // le slot revient par _completed, collectColumns le rend
+  pJob->isCancelled.store(true, std::memory_order_relaxed);
+  _cancelledCount++;
+}
+
+
+void ChunkStreamer::release(ChunkColumnJob* pJob)
+{
+  _freeSlots.push_back(pJob->slot);
+}
\ No newline at end of file
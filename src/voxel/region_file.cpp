@@ -0,0 +1,466 @@
+#include "voxel/region_file.h"
+
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <iostream>
+#include <system_error>
+
+
+static constexpr uint8_t REGION_FORMAT_PALETTE_RLE = 1;
+static constexpr uint16_t REGION_RUN_BIT = 0x8000; // un mot répété, sinon une suite de mots recopiés tels quels
+static constexpr uint16_t REGION_MAX_RUN = 0x7FFF;
+
+
+// FNV-1a sur le payload, un secteur abîmé ne doit pas donner une section valide mais fausse
+static uint32_t hashPayload(const uint8_t* pData, size_t size)
+{
+  uint32_t hash = 2166136261u;
+  for (size_t i = 0; i < size; i++) hash = (hash ^ pData[i]) * 16777619u;
+  return hash;
+}
+
+
+template<typename T>
+static void appendValue(std::vector<uint8_t>& bytes, const T& value)
+{
+  const uint8_t* pValue = reinterpret_cast<const uint8_t*>(&value);
+  bytes.insert(bytes.end(), pValue, pValue + sizeof(T));
+}
+
+
+template<typename T>
+static bool readValue(const uint8_t*& pData, const uint8_t* pEnd, T& value)
+{
+  if ((size_t)(pEnd - pData) < sizeof(T)) return false;
+  std::memcpy(&value, pData, sizeof(T));
+  pData += sizeof(T);
+  return true;
+}
+
+
+// longueur, hash, format, bits par bloc, palette, puis les mots d'indices en RLE (le vide et la roche font de longues suites identiques)
+// la section est déjà compressée par sa palette, le RLE ne fait que retirer les répétitions
+static void compressSection(const ChunkSection& section, std::vector<uint8_t>& payload)
+{
+  payload.clear();
+  appendValue<uint32_t>(payload, 0); // longueur et hash, écrits à la fin
+  appendValue<uint32_t>(payload, 0);
+  appendValue<uint8_t>(payload, REGION_FORMAT_PALETTE_RLE);
+  appendValue<uint8_t>(payload, (uint8_t)section.GetBitsPerBlock());
+
+  const std::vector<uint16_t>& palette = section.GetPalette();
+  appendValue<uint16_t>(payload, (uint16_t)palette.size());
+  const uint8_t* pPalette = reinterpret_cast<const uint8_t*>(palette.data());
+  payload.insert(payload.end(), pPalette, pPalette + palette.size() * sizeof(uint16_t));
+
+  const std::vector<uint64_t>& words = section.GetWords();
+  size_t i = 0;
+  while (i < words.size())
+  {
+    size_t run = 1;
+    while (i + run < words.size() && run < REGION_MAX_RUN && words[i + run] == words[i]) run++;
+    if (run > 1)
+    {
+      appendValue<uint16_t>(payload, (uint16_t)(REGION_RUN_BIT | run));
+      appendValue<uint64_t>(payload, words[i]);
+      i += run;
+      continue;
+    }
+
+    // recopie jusqu'au début de la prochaine répétition
+    size_t literal = 1;
+    while (i + literal < words.size() && literal < REGION_MAX_RUN
+      && !(i + literal + 1 < words.size() && words[i + literal] == words[i + literal + 1])) literal++;
+    appendValue<uint16_t>(payload, (uint16_t)literal);
+    const uint8_t* pWords = reinterpret_cast<const uint8_t*>(words.data() + i);
+    payload.insert(payload.end(), pWords, pWords + literal * sizeof(uint64_t));
+    i += literal;
+  }
+
+  const size_t header_size = 2 * sizeof(uint32_t);
+  const uint32_t length = (uint32_t)(payload.size() - header_size);
+  const uint32_t hash = hashPayload(payload.data() + header_size, length);
+  std::memcpy(payload.data(), &length, sizeof(uint32_t));
+  std::memcpy(payload.data() + sizeof(uint32_t), &hash, sizeof(uint32_t));
+}
+
+
+static bool decompressSection(const uint8_t* pData, size_t size, ChunkSection& section)
+{
+  const uint8_t* pEnd = pData + size;
+  uint32_t length;
+  uint32_t hash;
+  if (!readValue(pData, pEnd, length) || !readValue(pData, pEnd, hash) || length > (size_t)(pEnd - pData)) return false;
+  pEnd = pData + length;
+  if (hashPayload(pData, length) != hash) return false;
+
+  uint8_t format;
+  uint8_t bits;
+  uint16_t palette_size;
+  if (!readValue(pData, pEnd, format) || format != REGION_FORMAT_PALETTE_RLE) return false;
+  if (!readValue(pData, pEnd, bits) || bits > 16) return false;
+  if (!readValue(pData, pEnd, palette_size) || palette_size == 0) return false;
+
+  if ((size_t)(pEnd - pData) < palette_size * sizeof(uint16_t)) return false;
+  std::vector<uint16_t> palette(palette_size);
+  std::memcpy(palette.data(), pData, palette_size * sizeof(uint16_t));
+  pData += palette_size * sizeof(uint16_t);
+
+  const size_t word_count = (size_t)CHUNK_VOLUME * bits / 64;
+  std::vector<uint64_t> words(word_count);
+  size_t i = 0;
+  while (i < word_count)
+  {
+    uint16_t control;
+    if (!readValue(pData, pEnd, control)) return false;
+
+    const size_t count = control & REGION_MAX_RUN;
+    if (count == 0 || count > word_count - i) return false;
+
+    if (control & REGION_RUN_BIT)
+    {
+      uint64_t word;
+      if (!readValue(pData, pEnd, word)) return false;
+      std::fill(words.begin() + i, words.begin() + i + count, word);
+    }
+    else
+    {
+      if ((size_t)(pEnd - pData) < count * sizeof(uint64_t)) return false;
+      std::memcpy(words.data() + i, pData, count * sizeof(uint64_t));
+      pData += count * sizeof(uint64_t);
+    }
+    i += count;
+  }
+
+  return section.Assign(bits, std::move(palette), std::move(words));
+}
+
+
+RegionFile::~RegionFile()
+{
+  Close();
+}
+
+
+bool RegionFile::Open(const std::string& path)
+{
+  Close();
+  _path = path;
+  std::memset(_locations, 0, sizeof(_locations));
+  std::memset(_timestamps, 0, sizeof(_timestamps));
+
+  _file.open(path, std::ios::in | std::ios::out | std::ios::binary);
+  if (!_file.is_open())
+  {
+    // nouveau fichier : l'en-tête vide seulement
+    _file.clear();
+    _file.open(path, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!_file.is_open()) return false;
+
+    std::vector<char> header(REGION_HEADER_SECTORS * REGION_SECTOR_SIZE, 0);
+    if (!_file.write(header.data(), header.size()).flush())
+    {
+      Close();
+      return false;
+    }
+  }
+  else if (!_file.read(reinterpret_cast<char*>(_locations), sizeof(_locations)) || !_file.read(reinterpret_cast<char*>(_timestamps), sizeof(_timestamps)))
+  {
+    // plus court qu'un en-tête : on ne réécrit pas par dessus un fichier qu'on ne comprend pas
+    std::cerr << "[RegionFile] Invalid header in " << path << "\n";
+    Close();
+    return false;
+  }
+
+  _file.seekg(0, std::ios::end);
+  const uint64_t size = (uint64_t)_file.tellg();
+  _usedSectors.assign((size_t)((size + REGION_SECTOR_SIZE - 1) / REGION_SECTOR_SIZE), false);
+  std::fill(_usedSectors.begin(), _usedSectors.begin() + REGION_HEADER_SECTORS, true);
+
+  // un emplacement hors du fichier ou qui chevauche un autre est oublié, le chunk sera régénéré
+  for (uint32_t index = 0; index < REGION_CHUNK_COUNT; index++)
+  {
+    const uint32_t location = _locations[index];
+    if (location == 0) continue;
+
+    const uint32_t sector = location >> 8;
+    const uint32_t sector_count = location & 0xFF;
+    bool is_valid = sector >= REGION_HEADER_SECTORS && sector_count > 0 && (size_t)sector + sector_count <= _usedSectors.size();
+    for (uint32_t s = sector; is_valid && s < sector + sector_count; s++) is_valid = !_usedSectors[s];
+    if (!is_valid)
+    {
+      _locations[index] = 0;
+      continue;
+    }
+
+    std::fill(_usedSectors.begin() + sector, _usedSectors.begin() + sector + sector_count, true);
+  }
+
+  return true;
+}
+
+
+void RegionFile::Close()
+{
+  _mapping.Close();
+  if (_file.is_open()) _file.close();
+  _file.clear();
+  _usedSectors.clear();
+}
+
+
+size_t RegionFile::GetFreeSectorCount() const
+{
+  return (size_t)std::count(_usedSectors.begin(), _usedSectors.end(), false);
+}
+
+
+bool RegionFile::ReadChunk(uint32_t index, ChunkSection& section)
+{
+  const uint32_t location = _locations[index];
+  if (location == 0) return false;
+
+  // la projection couvre tout le fichier, la lecture d'un chunk ne touche que ses pages
+  if (!_mapping.IsOpen() && !_mapping.Open(_path, true)) return false;
+
+  const size_t offset = (size_t)(location >> 8) * REGION_SECTOR_SIZE;
+  if (offset >= _mapping.GetSize()) return false;
+  const size_t size = std::min((size_t)(location & 0xFF) * REGION_SECTOR_SIZE, _mapping.GetSize() - offset);
+
+  return decompressSection(_mapping.GetData() + offset, size, section);
+}
+
+
+bool RegionFile::WriteChunk(uint32_t index, const ChunkSection& section, uint32_t timestamp)
+{
+  if (!IsOpen()) return false;
+
+  compressSection(section, _payload);
+  const uint32_t sector_count = (uint32_t)((_payload.size() + REGION_SECTOR_SIZE - 1) / REGION_SECTOR_SIZE);
+  if (sector_count > REGION_MAX_CHUNK_SECTORS) return false;
+  _payload.resize((size_t)sector_count * REGION_SECTOR_SIZE, 0);
+
+  // la projection ne verrait pas la fin du fichier agrandi, elle est rouverte à la prochaine lecture
+  _mapping.Close();
+
+  // jamais par dessus l'ancienne copie, elle reste valide tant que l'en-tête pointe dessus
+  // flush avant l'en-tête : le système ne peut pas recevoir le nouvel emplacement avant les données qu'il désigne
+  const uint32_t sector = allocateSectors(sector_count);
+  const uint32_t location = sector << 8 | sector_count;
+  if (!writeAt((uint64_t)sector * REGION_SECTOR_SIZE, _payload.data(), _payload.size()) || !_file.flush())
+  {
+    _file.clear();
+    releaseSectors(location);
+    return false;
+  }
+
+  const uint32_t previous_location = _locations[index];
+  const uint32_t previous_timestamp = _timestamps[index];
+  _locations[index] = location;
+  _timestamps[index] = timestamp;
+  if (!writeHeaderEntry(index))
+  {
+    _locations[index] = previous_location;
+    _timestamps[index] = previous_timestamp;
+    releaseSectors(location);
+    return false;
+  }
+
+  if (previous_location != 0) releaseSectors(previous_location);
+  return (bool)_file.flush();
+}
+
+
+bool RegionFile::RemoveChunk(uint32_t index)
+{
+  const uint32_t location = _locations[index];
+  if (!IsOpen() || location == 0) return false;
+
+  _locations[index] = 0;
+  _timestamps[index] = 0;
+  if (!writeHeaderEntry(index) || !_file.flush())
+  {
+    _locations[index] = location;
+    return false;
+  }
+
+  releaseSectors(location);
+  return true;
+}
+
+
+// premier trou assez grand, sinon à la fin du fichier en reprenant les secteurs libres qui la précèdent
+uint32_t RegionFile::allocateSectors(uint32_t count)
+{
+  size_t run_start = 0;
+  size_t run_length = 0;
+  for (size_t s = REGION_HEADER_SECTORS; s < _usedSectors.size(); s++)
+  {
+    if (_usedSectors[s])
+    {
+      run_length = 0;
+      continue;
+    }
+
+    if (run_length == 0) run_start = s;
+    if (++run_length == count)
+    {
+      std::fill(_usedSectors.begin() + run_start, _usedSectors.begin() + run_start + count, true);
+      return (uint32_t)run_start;
+    }
+  }
+
+  const size_t start = run_length > 0 ? run_start : _usedSectors.size();
+  _usedSectors.resize(start + count, false);
+  std::fill(_usedSectors.begin() + start, _usedSectors.end(), true);
+  return (uint32_t)start;
+}
+
+
+void RegionFile::releaseSectors(uint32_t location)
+{
+  const size_t sector = location >> 8;
+  const size_t sector_count = location & 0xFF;
+  std::fill(_usedSectors.begin() + sector, _usedSectors.begin() + sector + sector_count, false);
+}
+
+
+bool RegionFile::writeAt(uint64_t offset, const void* pData, size_t size)
+{
+  _file.seekp((std::streamoff)offset);
+  _file.write(static_cast<const char*>(pData), (std::streamsize)size);
+  if (_file) return true;
+
+  _file.clear();
+  return false;
+}
+
+
+bool RegionFile::writeHeaderEntry(uint32_t index)
+{
+  return writeAt((uint64_t)index * sizeof(uint32_t), &_locations[index], sizeof(uint32_t))
+    && writeAt((uint64_t)(REGION_CHUNK_COUNT + index) * sizeof(uint32_t), &_timestamps[index], sizeof(uint32_t));
+}
+
+
+RegionStorage::RegionStorage(const std::string& directory)
+  : _directory(directory)
+{}
+
+
+bool RegionStorage::LoadChunk(ChunkCoord coord, ChunkSection& section)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  RegionFile* pRegion = getRegion(GetRegionCoord(coord), false);
+  return pRegion && pRegion->ReadChunk(GetRegionIndex(coord), section);
+}
+
+
+bool RegionStorage::SaveChunk(ChunkCoord coord, const ChunkSection& section)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  RegionFile* pRegion = getRegion(GetRegionCoord(coord), true);
+  return pRegion && pRegion->WriteChunk(GetRegionIndex(coord), section, (uint32_t)std::time(nullptr));
+}
+
+
+bool RegionStorage::RemoveChunk(ChunkCoord coord)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  RegionFile* pRegion = getRegion(GetRegionCoord(coord), false);
+  return pRegion && pRegion->RemoveChunk(GetRegionIndex(coord));
+}
+
+
+bool RegionStorage::HasChunk(ChunkCoord coord)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  RegionFile* pRegion = getRegion(GetRegionCoord(coord), false);
+  return pRegion && pRegion->HasChunk(GetRegionIndex(coord));
+}
+
+
+// r.<x>.<y>.<z>.vxr
+static bool parseRegionName(const std::string& name, RegionCoord& coord)
+{
+  const char* pCursor = name.data();
+  const char* pEnd = name.data() + name.size();
+  if (name.size() < 2 || name[0] != 'r' || name[1] != '.') return false;
+  pCursor += 2;
+
+  int* pValues[3] = { &coord.x, &coord.y, &coord.z };
+  for (int* pValue: pValues)
+  {
+    auto [pNext, error] = std::from_chars(pCursor, pEnd, *pValue);
+    if (error != std::errc() || pNext == pEnd || *pNext != '.') return false;
+    pCursor = pNext + 1;
+  }
+
+  return std::string(pCursor, pEnd) == "vxr";
+}
+
+
+void RegionStorage::ListChunks(std::vector<ChunkCoord>& coords)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  std::error_code error;
+  for (const auto& entry: std::filesystem::directory_iterator(_directory, error))
+  {
+    RegionCoord region_coord;
+    if (!entry.is_regular_file(error) || !parseRegionName(entry.path().filename().string(), region_coord)) continue;
+
+    RegionFile* pRegion = getRegion(region_coord, false);
+    if (!pRegion) continue;
+
+    for (uint32_t index = 0; index < REGION_CHUNK_COUNT; index++)
+    {
+      if (pRegion->HasChunk(index)) coords.push_back(GetRegionChunkCoord(region_coord, index));
+    }
+  }
+}
+
+
+void RegionStorage::Close()
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  _regions.clear();
+}
+
+
+RegionFile* RegionStorage::getRegion(RegionCoord coord, bool create)
+{
+  auto it = _regions.find(coord);
+  if (it != _regions.end() && (it->second || !create)) return it->second.get();
+
+  const std::string path = getRegionPath(coord);
+  std::error_code error;
+  if (!create && !std::filesystem::exists(path, error))
+  {
+    // les prochains chargements dans cette région ne touchent plus au disque
+    _regions[coord] = nullptr;
+    return nullptr;
+  }
+  if (create) std::filesystem::create_directories(_directory, error);
+
+  auto region = std::make_unique<RegionFile>();
+  if (!region->Open(path))
+  {
+    std::cerr << "[RegionStorage] Failed to open " << path << "\n";
+    _regions[coord] = nullptr;
+    return nullptr;
+  }
+
+  RegionFile* pRegion = region.get();
+  _regions[coord] = std::move(region);
+  return pRegion;
+}
+
+
+std::string RegionStorage::getRegionPath(RegionCoord coord) const
+{
+  return _directory + "r." + std::to_string(coord.x) + "." + std::to_string(coord.y) + "." + std::to_string(coord.z) + ".vxr";
+}
\ No newline at end of file
@@ -0,0 +1,119 @@
+#include "voxel/terrain_generator.h"
+
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <memory>
+
+#include "core/job_system.h"
+
+
+TerrainGenerator::TerrainGenerator(const TerrainSettings& settings)
+  : _settings(settings)
+{}
+
+
+void TerrainGenerator::GenerateColumn(int chunkX, int chunkZ, TerrainColumn& column) const
+{
+  column.chunkX = chunkX;
+  column.chunkZ = chunkZ;
+  GenerateHeights((float)(chunkX * CHUNK_SIZE), (float)(chunkZ * CHUNK_SIZE), 1.0f, column.heights);
+
+  column.minHeight = INT32_MAX;
+  column.maxHeight = INT32_MIN;
+  for (int i = 0; i < CHUNK_AREA; i++)
+  {
+    column.minHeight = std::min(column.minHeight, column.heights[i]);
+    column.maxHeight = std::max(column.maxHeight, column.heights[i]);
+  }
+}
+
+
+void TerrainGenerator::GenerateHeights(float originX, float originZ, float step, int32_t* pHeights) const
+{
+  float positions_x[CHUNK_AREA];
+  float positions_z[CHUNK_AREA];
+  float noise[CHUNK_AREA];
+  for (int z = 0; z < CHUNK_SIZE; z++)
+  {
+    for (int x = 0; x < CHUNK_SIZE; x++)
+    {
+      positions_x[z * CHUNK_SIZE + x] = originX + step * (float)x;
+      positions_z[z * CHUNK_SIZE + x] = originZ + step * (float)z;
+    }
+  }
+
+  WarpedNoise2D(_settings.noise, positions_x, positions_z, noise, CHUNK_AREA);
+
+  for (int i = 0; i < CHUNK_AREA; i++) pHeights[i] = (int32_t)std::floor(_settings.baseHeight + _settings.heightAmplitude * noise[i]);
+}
+
+
+bool TerrainGenerator::GenerateSection(const TerrainColumn& column, int chunkY, ChunkSection& section, uint16_t* pBlocks) const
+{
+  // décalage arithmétique : les hauteurs négatives tombent dans les chunks négatifs
+  if (chunkY < _settings.bottomChunkY || chunkY > (column.maxHeight >> CHUNK_SHIFT)) return false;
+
+  // entièrement sous la terre : section uniforme, sans indices
+  const int32_t origin_y = chunkY * CHUNK_SIZE;
+  if (origin_y + CHUNK_SIZE - 1 < column.minHeight - _settings.dirtDepth)
+  {
+    section.Fill(_settings.stoneBlock);
+    return true;
+  }
+
+  for (int y = 0; y < CHUNK_SIZE; y++)
+  {
+    const int32_t world_y = origin_y + y;
+    for (int z = 0; z < CHUNK_SIZE; z++)
+    {
+      const int32_t* pHeights = column.heights + z * CHUNK_SIZE;
+      uint16_t* pRow = pBlocks + GetBlockIndex(0, y, z);
+      for (int x = 0; x < CHUNK_SIZE; x++) pRow[x] = GetColumnBlock(world_y, pHeights[x]);
+    }
+  }
+
+  section.Encode(pBlocks);
+  return true;
+}
+
+
+void TerrainGenerator::GenerateSections(const TerrainColumn& column, std::vector<GeneratedChunk>& chunks, uint16_t* pBlocks) const
+{
+  for (int chunk_y = _settings.bottomChunkY; chunk_y <= (column.maxHeight >> CHUNK_SHIFT); chunk_y++)
+  {
+    GeneratedChunk& chunk = chunks.emplace_back(GeneratedChunk{ ChunkCoord{ column.chunkX, chunk_y, column.chunkZ }, ChunkSection() });
+    GenerateSection(column, chunk_y, chunk.section, pBlocks);
+  }
+}
+
+
+void TerrainGenerator::GenerateColumns(JobSystem* pJobs, const std::vector<glm::ivec2>& columns, std::vector<std::vector<GeneratedChunk>>& chunks) const
+{
+  chunks.resize(columns.size());
+
+  // chaque partition a ses propres tampons, les colonnes n'écrivent que dans leur entrée de chunks
+  auto generate = [&](uint32_t start, uint32_t end)
+  {
+    auto column = std::make_unique<TerrainColumn>();
+    std::vector<uint16_t> blocks(CHUNK_VOLUME);
+    for (uint32_t i = start; i < end; i++)
+    {
+      chunks[i].clear();
+      GenerateColumn(columns[i].x, columns[i].y, *column);
+      GenerateSections(*column, chunks[i], blocks.data());
+    }
+  };
+
+  if (!pJobs)
+  {
+    generate(0, (uint32_t)columns.size());
+    return;
+  }
+
+  pJobs->ParallelFor("TerrainGenerator", (uint32_t)columns.size(), TERRAIN_COLUMNS_PER_TASK, [&generate](uint32_t start, uint32_t end, uint32_t threadnum)
+  {
+    generate(start, end);
+  });
+}
\ No newline at end of file
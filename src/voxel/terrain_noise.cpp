@@ -0,0 +1,285 @@
+#include "voxel/terrain_noise.h"
+
+
+#include <bit>
+
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define VOXL_NOISE_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#if defined(__SSE4_1__) || defined(__AVX__)
+#include <smmintrin.h>
+#define VOXL_NOISE_SSE41 // pmulld, sinon la multiplication 32 bits passe par deux pmuludq
+#else
+#include <emmintrin.h>
+#endif
+#define VOXL_NOISE_SSE
+#endif
+
+
+static constexpr float NOISE_SKEW = 0.366025403f; // (sqrt(3) - 1) / 2, du plan vers la grille triangulaire
+static constexpr float NOISE_UNSKEW = 0.211324865f; // (3 - sqrt(3)) / 6, retour vers le plan
+static constexpr float NOISE_UNSKEW_LAST = 2.0f * NOISE_UNSKEW - 1.0f; // décalage du dernier coin
+static constexpr float NOISE_SCALE = 45.0f; // le maximum mesuré est 0.0221, ramené juste sous 1
+
+static constexpr uint32_t NOISE_PRIME_X = 501125321u;
+static constexpr uint32_t NOISE_PRIME_Y = 1136930381u;
+static constexpr uint32_t NOISE_HASH_MULTIPLIER = 0x27d4eb2du;
+static constexpr uint32_t NOISE_OCTAVE_SEED_STEP = 0x632be5abu; // chaque octave a son propre réseau de gradients
+static constexpr uint32_t NOISE_WARP_SEED_X = 0x9e3779b9u;
+static constexpr uint32_t NOISE_WARP_SEED_Y = 0x85ebca6bu;
+
+
+// le même noyau est écrit une seule fois pour toutes les largeurs, chaque Lanes donne les opérations d'un registre
+// les opérations et leur ordre sont les mêmes partout : les résultats ne dépendent pas du jeu d'instructions
+struct ScalarLanes
+{
+  using F = float;
+  using I = uint32_t;
+  static constexpr size_t COUNT = 1;
+
+  static inline F Load(const float* p) { return *p; }
+  static inline void Store(float* p, F v) { *p = v; }
+  static inline F Set(float v) { return v; }
+  static inline I SetInt(uint32_t v) { return v; }
+
+  static inline F Add(F a, F b) { return a + b; }
+  static inline F Sub(F a, F b) { return a - b; }
+  static inline F Mul(F a, F b) { return a * b; }
+  static inline F Max(F a, F b) { return a > b ? a : b; } // même règle que maxps pour les zéros signés
+  static inline F OneIfGreater(F a, F b) { return a > b ? 1.0f : 0.0f; }
+
+  static inline I ToInt(F v) { return (uint32_t)(int32_t)v; }
+  static inline F ToFloat(I v) { return (float)(int32_t)v; }
+  static inline I IAdd(I a, I b) { return a + b; }
+  static inline I IMul(I a, I b) { return a * b; }
+  static inline I IXor(I a, I b) { return a ^ b; }
+  template<int N> static inline I IShr(I a) { return a >> N; }
+  template<int N> static inline I IShl(I a) { return a << N; }
+
+  // inverse le signe de v là où le bit 31 de bits est mis
+  static inline F FlipSign(F v, I bits) { return std::bit_cast<float>(std::bit_cast<uint32_t>(v) ^ (bits & 0x80000000u)); }
+  static inline F SelectBit(I h, I bit, F a, F b) { return (h & bit) ? a : b; }
+};
+
+
+#if defined(VOXL_NOISE_AVX2)
+struct SimdLanes
+{
+  using F = __m256;
+  using I = __m256i;
+  static constexpr size_t COUNT = 8;
+
+  static inline F Load(const float* p) { return _mm256_loadu_ps(p); }
+  static inline void Store(float* p, F v) { _mm256_storeu_ps(p, v); }
+  static inline F Set(float v) { return _mm256_set1_ps(v); }
+  static inline I SetInt(uint32_t v) { return _mm256_set1_epi32((int)v); }
+
+  static inline F Add(F a, F b) { return _mm256_add_ps(a, b); }
+  static inline F Sub(F a, F b) { return _mm256_sub_ps(a, b); }
+  static inline F Mul(F a, F b) { return _mm256_mul_ps(a, b); }
+  static inline F Max(F a, F b) { return _mm256_max_ps(a, b); }
+  static inline F OneIfGreater(F a, F b) { return _mm256_and_ps(_mm256_cmp_ps(a, b, _CMP_GT_OQ), _mm256_set1_ps(1.0f)); }
+
+  static inline I ToInt(F v) { return _mm256_cvttps_epi32(v); }
+  static inline F ToFloat(I v) { return _mm256_cvtepi32_ps(v); }
+  static inline I IAdd(I a, I b) { return _mm256_add_epi32(a, b); }
+  static inline I IMul(I a, I b) { return _mm256_mullo_epi32(a, b); }
+  static inline I IXor(I a, I b) { return _mm256_xor_si256(a, b); }
+  template<int N> static inline I IShr(I a) { return _mm256_srli_epi32(a, N); }
+  template<int N> static inline I IShl(I a) { return _mm256_slli_epi32(a, N); }
+
+  static inline F FlipSign(F v, I bits) { return _mm256_xor_ps(v, _mm256_castsi256_ps(_mm256_and_si256(bits, _mm256_set1_epi32((int)0x80000000u)))); }
+  static inline F SelectBit(I h, I bit, F a, F b)
+  {
+    const __m256 mask = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(h, bit), bit));
+    return _mm256_blendv_ps(b, a, mask);
+  }
+};
+#elif defined(VOXL_NOISE_SSE)
+struct SimdLanes
+{
+  using F = __m128;
+  using I = __m128i;
+  static constexpr size_t COUNT = 4;
+
+  static inline F Load(const float* p) { return _mm_loadu_ps(p); }
+  static inline void Store(float* p, F v) { _mm_storeu_ps(p, v); }
+  static inline F Set(float v) { return _mm_set1_ps(v); }
+  static inline I SetInt(uint32_t v) { return _mm_set1_epi32((int)v); }
+
+  static inline F Add(F a, F b) { return _mm_add_ps(a, b); }
+  static inline F Sub(F a, F b) { return _mm_sub_ps(a, b); }
+  static inline F Mul(F a, F b) { return _mm_mul_ps(a, b); }
+  static inline F Max(F a, F b) { return _mm_max_ps(a, b); }
+  static inline F OneIfGreater(F a, F b) { return _mm_and_ps(_mm_cmpgt_ps(a, b), _mm_set1_ps(1.0f)); }
+
+  static inline I ToInt(F v) { return _mm_cvttps_epi32(v); }
+  static inline F ToFloat(I v) { return _mm_cvtepi32_ps(v); }
+  static inline I IAdd(I a, I b) { return _mm_add_epi32(a, b); }
+  static inline I IMul(I a, I b)
+  {
+#if defined(VOXL_NOISE_SSE41)
+    return _mm_mullo_epi32(a, b);
+#else
+    // produits des lignes paires puis impaires, on garde les 32 bits du bas de chacun
+    const __m128i even = _mm_mul_epu32(a, b);
+    const __m128i odd = _mm_mul_epu32(_mm_srli_si128(a, 4), _mm_srli_si128(b, 4));
+    return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)), _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+#endif
+  }
+  static inline I IXor(I a, I b) { return _mm_xor_si128(a, b); }
+  template<int N> static inline I IShr(I a) { return _mm_srli_epi32(a, N); }
+  template<int N> static inline I IShl(I a) { return _mm_slli_epi32(a, N); }
+
+  static inline F FlipSign(F v, I bits) { return _mm_xor_ps(v, _mm_castsi128_ps(_mm_and_si128(bits, _mm_set1_epi32((int)0x80000000u)))); }
+  static inline F SelectBit(I h, I bit, F a, F b)
+  {
+    const __m128 mask = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(h, bit), bit));
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+  }
+};
+#else
+using SimdLanes = ScalarLanes;
+#endif
+
+
+// troncature corrigée pour les négatifs, roundps n'existe pas avant SSE4.1
+template<typename L>
+static inline typename L::F floorLanes(typename L::F v)
+{
+  const typename L::F truncated = L::ToFloat(L::ToInt(v));
+  return L::Sub(truncated, L::OneIfGreater(truncated, v));
+}
+
+
+template<typename L>
+static inline typename L::I hashCorner(typename L::I seed, typename L::I i, typename L::I j)
+{
+  typename L::I hash = L::IXor(seed, L::IXor(L::IMul(i, L::SetInt(NOISE_PRIME_X)), L::IMul(j, L::SetInt(NOISE_PRIME_Y))));
+  hash = L::IMul(hash, L::SetInt(NOISE_HASH_MULTIPLIER));
+  return L::IXor(hash, L::template IShr<15>(hash));
+}
+
+
+// 8 gradients (±1, ±2) et (±2, ±1) : le bit 29 du hash échange x et y, les bits 31 et 30 donnent les signes
+template<typename L>
+static inline typename L::F cornerContribution(typename L::I hash, typename L::F x, typename L::F y)
+{
+  const typename L::I swap_bit = L::SetInt(1u << 29);
+  const typename L::F u = L::SelectBit(hash, swap_bit, y, x);
+  const typename L::F v = L::SelectBit(hash, swap_bit, x, y);
+  const typename L::F gradient = L::Add(L::FlipSign(u, hash), L::FlipSign(L::Add(v, v), L::template IShl<1>(hash)));
+
+  typename L::F falloff = L::Max(L::Sub(L::Sub(L::Set(0.5f), L::Mul(x, x)), L::Mul(y, y)), L::Set(0.0f));
+  falloff = L::Mul(falloff, falloff);
+  return L::Mul(L::Mul(falloff, falloff), gradient);
+}
+
+
+template<typename L>
+static inline typename L::F simplex(typename L::I seed, typename L::F x, typename L::F y)
+{
+  // cellule de la grille triangulaire
+  const typename L::F skew = L::Mul(L::Add(x, y), L::Set(NOISE_SKEW));
+  const typename L::F cell_x = floorLanes<L>(L::Add(x, skew));
+  const typename L::F cell_y = floorLanes<L>(L::Add(y, skew));
+  const typename L::F unskew = L::Mul(L::Add(cell_x, cell_y), L::Set(NOISE_UNSKEW));
+  const typename L::F x0 = L::Sub(x, L::Sub(cell_x, unskew));
+  const typename L::F y0 = L::Sub(y, L::Sub(cell_y, unskew));
+
+  // le coin du milieu est (1, 0) ou (0, 1) selon le triangle de la cellule
+  const typename L::F step_x = L::OneIfGreater(x0, y0);
+  const typename L::F step_y = L::Sub(L::Set(1.0f), step_x);
+  const typename L::F x1 = L::Add(L::Sub(x0, step_x), L::Set(NOISE_UNSKEW));
+  const typename L::F y1 = L::Add(L::Sub(y0, step_y), L::Set(NOISE_UNSKEW));
+  const typename L::F x2 = L::Add(x0, L::Set(NOISE_UNSKEW_LAST));
+  const typename L::F y2 = L::Add(y0, L::Set(NOISE_UNSKEW_LAST));
+
+  const typename L::I i = L::ToInt(cell_x);
+  const typename L::I j = L::ToInt(cell_y);
+  const typename L::I one = L::SetInt(1);
+  const typename L::I hash0 = hashCorner<L>(seed, i, j);
+  const typename L::I hash1 = hashCorner<L>(seed, L::IAdd(i, L::ToInt(step_x)), L::IAdd(j, L::ToInt(step_y)));
+  const typename L::I hash2 = hashCorner<L>(seed, L::IAdd(i, one), L::IAdd(j, one));
+
+  const typename L::F sum = L::Add(L::Add(cornerContribution<L>(hash0, x0, y0), cornerContribution<L>(hash1, x1, y1)), cornerContribution<L>(hash2, x2, y2));
+  return L::Mul(sum, L::Set(NOISE_SCALE));
+}
+
+
+template<typename L>
+static inline typename L::F fractal(uint32_t seed, const NoiseOctaves& octaves, typename L::F x, typename L::F y)
+{
+  typename L::F sum = L::Set(0.0f);
+  float frequency = octaves.frequency;
+  float amplitude = 1.0f;
+  float total = 0.0f;
+  for (int octave = 0; octave < octaves.octaves; octave++)
+  {
+    const typename L::I octave_seed = L::SetInt(seed + (uint32_t)octave * NOISE_OCTAVE_SEED_STEP);
+    const typename L::F noise = simplex<L>(octave_seed, L::Mul(x, L::Set(frequency)), L::Mul(y, L::Set(frequency)));
+    sum = L::Add(sum, L::Mul(noise, L::Set(amplitude)));
+
+    total += amplitude;
+    frequency *= octaves.lacunarity;
+    amplitude *= octaves.gain;
+  }
+
+  return total > 0.0f ? L::Mul(sum, L::Set(1.0f / total)) : sum;
+}
+
+
+template<typename L>
+static inline typename L::F warped(const WarpedNoiseSettings& settings, typename L::F x, typename L::F y)
+{
+  const typename L::F amplitude = L::Set(settings.warpAmplitude);
+  const typename L::F warped_x = L::Add(x, L::Mul(fractal<L>(settings.seed ^ NOISE_WARP_SEED_X, settings.warp, x, y), amplitude));
+  const typename L::F warped_y = L::Add(y, L::Mul(fractal<L>(settings.seed ^ NOISE_WARP_SEED_Y, settings.warp, x, y), amplitude));
+  return fractal<L>(settings.seed, settings.octaves, warped_x, warped_y);
+}
+
+
+float SimplexNoise2D(uint32_t seed, float x, float y)
+{
+  return simplex<ScalarLanes>(seed, x, y);
+}
+
+
+void FractalNoise2D(uint32_t seed, const NoiseOctaves& octaves, const float* pX, const float* pY, float* pOut, size_t count)
+{
+  size_t i = 0;
+  for (; i + SimdLanes::COUNT <= count; i += SimdLanes::COUNT)
+    SimdLanes::Store(pOut + i, fractal<SimdLanes>(seed, octaves, SimdLanes::Load(pX + i), SimdLanes::Load(pY + i)));
+  for (; i < count; i++) pOut[i] = fractal<ScalarLanes>(seed, octaves, pX[i], pY[i]);
+}
+
+
+void WarpedNoise2D(const WarpedNoiseSettings& settings, const float* pX, const float* pY, float* pOut, size_t count)
+{
+  size_t i = 0;
+  for (; i + SimdLanes::COUNT <= count; i += SimdLanes::COUNT)
+    SimdLanes::Store(pOut + i, warped<SimdLanes>(settings, SimdLanes::Load(pX + i), SimdLanes::Load(pY + i)));
+  for (; i < count; i++) pOut[i] = warped<ScalarLanes>(settings, pX[i], pY[i]);
+}
+
+
+void WarpedNoise2DScalar(const WarpedNoiseSettings& settings, const float* pX, const float* pY, float* pOut, size_t count)
+{
+  for (size_t i = 0; i < count; i++) pOut[i] = warped<ScalarLanes>(settings, pX[i], pY[i]);
+}
+
+
+const char* GetNoiseInstructionSet()
+{
+#if defined(VOXL_NOISE_AVX2)
+  return "AVX2";
+#elif defined(VOXL_NOISE_SSE41)
+  return "SSE4.1";
+#elif defined(VOXL_NOISE_SSE)
+  return "SSE2";
+#else
+  return "scalar";
+#endif
+}
\ No newline at end of file
@@ -0,0 +1,410 @@
+#include "voxel/voxel_world.h"
+
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+#include <glm/gtc/matrix_transform.hpp>
+using namespace entt::literals;
+
+#include "core/job_system.h"
+#include "core/resource_manager.h"
+#include "components/bounds.h"
+#include "components/mesh.h"
+#include "components/occluder_box.h"
+#include "components/tags.h"
+#include "components/world_matrix.h"
+
+
+// déplacement vers la voisine de chaque face, dans l'ordre de BlockFace
+static constexpr int FACE_OFFSETS[(size_t)BlockFace::COUNT][3] = {
+  { 1, 0, 0 }, { -1, 0, 0 }, { 0, 1, 0 }, { 0, -1, 0 }, { 0, 0, 1 }, { 0, 0, -1 }
+};
+
+static constexpr uint64_t DISPATCH_DEFERRED_BIT = 1ull << 62; // clé de tri : les rebuilds non urgents après tous les urgents
+
+
+static inline ChunkCoord getNeighborCoord(ChunkCoord coord, size_t face)
+{
+  return coord.Offset(FACE_OFFSETS[face][0], FACE_OFFSETS[face][1], FACE_OFFSETS[face][2]);
+}
+
+
+VoxelWorld::VoxelWorld(entt::registry* registry, RenderBackend* pUploadBackend)
+  : _pRegistry(registry),
+    _pUploadBackend(pUploadBackend),
+    _meshScheduler(registry->ctx().find<JobSystem>()),
+    _meshPool(registry->ctx().find<entt::dispatcher>()),
+    _streamer(registry->ctx().find<JobSystem>(), &_storage),
+    _lod(registry, pUploadBackend, &_meshPool, registry->ctx().find<JobSystem>(), &_storage),
+    _versionCounter(0),
+    _viewerChunk(0),
+    _viewerForward(0.0f),
+    _frameIndex(0)
+{}
+
+
+VoxelWorld::~VoxelWorld()
+{
+  // plus aucun job ne doit écrire dans un slot pendant qu'on rend les buffers
+  _streamer.WaitAll();
+  _lod.WaitAll();
+  _meshScheduler.WaitAll();
+
+  _lod.Clear(_frameIndex);
+  for (auto& [coord, chunk]: _chunks) destroyChunkEntity(chunk);
+  _meshPool.Destroy(*_pUploadBackend);
+}
+
+
+void VoxelWorld::SetChunk(ChunkCoord coord, const ChunkSection& section, bool isSaved)
+{
+  Chunk& chunk = _chunks[coord];
+  chunk.section = section;
+  chunk.version = ++_versionCounter;
+  chunk.isSaved = isSaved;
+  requestMesh(coord, false);
+
+  // les faces des voisines contre ce chunk apparaissent ou disparaissent
+  for (size_t face = 0; face < (size_t)BlockFace::COUNT; face++) touchNeighbor(getNeighborCoord(coord, face), false);
+}
+
+
+void VoxelWorld::RemoveChunk(ChunkCoord coord)
+{
+  auto it = _chunks.find(coord);
+  if (it == _chunks.end()) return;
+
+  // un job en vol pour ce chunk sera jeté à son retour (chunk absent ou version différente), autant qu'il ne meshe pas
+  if (it->second.pMeshJob) it->second.pMeshJob->isCancelled.store(true, std::memory_order_relaxed);
+  destroyChunkEntity(it->second);
+  _chunks.erase(it);
+  _pending.erase(coord);
+
+  for (size_t face = 0; face < (size_t)BlockFace::COUNT; face++) touchNeighbor(getNeighborCoord(coord, face), false);
+}
+
+
+bool VoxelWorld::UnloadChunk(ChunkCoord coord)
+{
+  auto it = _chunks.find(coord);
+  if (it == _chunks.end()) return true;
+
+  if (!it->second.isSaved && !_storage.SaveChunk(coord, it->second.section))
+  {
+    std::cerr << "[VoxelWorld] Failed to save chunk (" << coord.x << ", " << coord.y << ", " << coord.z << ") before unloading\n";
+    return false;
+  }
+
+  RemoveChunk(coord);
+  return true;
+}
+
+
+const ChunkSection* VoxelWorld::GetSection(ChunkCoord coord) const
+{
+  auto it = _chunks.find(coord);
+  return it != _chunks.end() ? &it->second.section : nullptr;
+}
+
+
+bool VoxelWorld::IsColumnReady(int x, int z) const
+{
+  if (!_streamer.IsColumnLoaded(x, z)) return false;
+
+  for (int chunk_y = _streamer.GetGenerator().GetSettings().bottomChunkY; chunk_y <= CHUNK_STREAM_TOP_Y; chunk_y++)
+  {
+    auto it = _chunks.find(ChunkCoord{ x, chunk_y, z });
+    if (it != _chunks.end() && it->second.meshedVersion == 0) return false;
+  }
+  return true;
+}
+
+
+bool VoxelWorld::CanUnloadColumn(int x, int z)
+{
+  bool has_saved = false;
+  for (int chunk_y = _streamer.GetGenerator().GetSettings().bottomChunkY; chunk_y <= CHUNK_STREAM_TOP_Y; chunk_y++)
+  {
+    const ChunkCoord coord{ x, chunk_y, z };
+    auto it = _chunks.find(coord);
+    if (it == _chunks.end() || it->second.isSaved) continue;
+
+    // en cas d'échec, UnloadChunk réessaiera et gardera le chunk
+    if (!_storage.SaveChunk(coord, it->second.section)) continue;
+    it->second.isSaved = true;
+    has_saved = true;
+  }
+
+  if (has_saved) _lod.InvalidateColumn(x, z);
+  return _lod.IsColumnCovered(x, z);
+}
+
+
+uint16_t VoxelWorld::GetBlock(const glm::ivec3& block) const
+{
+  const ChunkCoord coord = GetChunkCoord(block);
+  const ChunkSection* pSection = GetSection(coord);
+  if (!pSection) return BLOCK_AIR;
+
+  const glm::ivec3 local = block - coord.GetOrigin();
+  return pSection->Get(local.x, local.y, local.z);
+}
+
+
+void VoxelWorld::SetBlock(const glm::ivec3& block, uint16_t id)
+{
+  const ChunkCoord coord = GetChunkCoord(block);
+  auto it = _chunks.find(coord);
+  if (it == _chunks.end()) return;
+
+  Chunk& chunk = it->second;
+  const glm::ivec3 local = block - coord.GetOrigin();
+  if (chunk.section.Get(local.x, local.y, local.z) == id) return;
+
+  chunk.section.Set(local.x, local.y, local.z, id);
+  chunk.version = ++_versionCounter;
+  chunk.isSaved = false;
+  requestMesh(coord, true);
+
+  // un bloc au bord est aussi dans la bordure de la voisine
+  if (local.x == CHUNK_SIZE - 1) touchNeighbor(coord.Offset(1, 0, 0), true);
+  if (local.x == 0) touchNeighbor(coord.Offset(-1, 0, 0), true);
+  if (local.y == CHUNK_SIZE - 1) touchNeighbor(coord.Offset(0, 1, 0), true);
+  if (local.y == 0) touchNeighbor(coord.Offset(0, -1, 0), true);
+  if (local.z == CHUNK_SIZE - 1) touchNeighbor(coord.Offset(0, 0, 1), true);
+  if (local.z == 0) touchNeighbor(coord.Offset(0, 0, -1), true);
+}
+
+
+size_t VoxelWorld::Save()
+{
+  size_t saved = 0;
+  for (auto& [coord, chunk]: _chunks)
+  {
+    if (chunk.isSaved) continue;
+    if (!_storage.SaveChunk(coord, chunk.section))
+    {
+      std::cerr << "[VoxelWorld] Failed to save chunk (" << coord.x << ", " << coord.y << ", " << coord.z << ")\n";
+      continue;
+    }
+
+    chunk.isSaved = true;
+    saved++;
+  }
+  return saved;
+}
+
+
+size_t VoxelWorld::Load()
+{
+  std::vector<ChunkCoord> coords;
+  _storage.ListChunks(coords);
+
+  size_t loaded = 0;
+  ChunkSection section;
+  for (ChunkCoord coord: coords)
+  {
+    if (!_storage.LoadChunk(coord, section)) continue;
+    SetChunk(coord, section, true);
+    loaded++;
+  }
+  return loaded;
+}
+
+
+void VoxelWorld::Update(const glm::vec3& viewerPosition, const glm::vec3& viewerForward, uint64_t frameIndex)
+{
+  _frameIndex = frameIndex;
+  const ChunkCoord viewer = GetChunkCoord(glm::ivec3(glm::floor(viewerPosition)));
+  _viewerChunk = glm::ivec3(viewer.x, viewer.y, viewer.z);
+  const float forward_length = glm::length(viewerForward);
+  _viewerForward = forward_length > 1e-3f ? viewerForward / forward_length : glm::vec3(0.0f);
+
+  refreshFaceLayers();
+
+  // les colonnes reçues passent en attente de mesh dès cette frame
+  _streamer.Update(*this, viewerPosition, viewerForward);
+
+  // d'abord les uploads, qui libèrent des slots pour les jobs de cette frame
+  uploadMeshes(frameIndex);
+  dispatchMeshes();
+
+  // après les uploads : un noeud LOD remplacé par des colonnes disparaît la frame où leurs meshes arrivent
+  _lod.Update(*this, _streamer.GetRadius(), viewerPosition, viewerForward, frameIndex);
+
+  _meshPool.Trim(*_pUploadBackend, frameIndex);
+}
+
+
+// le tableau de textures est chargé par Renderer::Init après la création du monde, et peut être rechargé à chaud
+void VoxelWorld::refreshFaceLayers()
+{
+  ResourceManager* pResources = _pRegistry->ctx().find<ResourceManager>();
+  if (!pResources) return;
+
+  entt::resource<BlockTextureArray> block_textures = pResources->GetByID<BlockTextureArray>("block_textures"_hs);
+  if (!block_textures || block_textures->faceLayers == _faceLayers) return;
+
+  // tous les meshes affichés ont été construits avec les anciens layers
+  _faceLayers = block_textures->faceLayers;
+  for (auto& [coord, chunk]: _chunks)
+  {
+    chunk.version = ++_versionCounter;
+    requestMesh(coord, false);
+  }
+  _lod.SetFaceLayers(_faceLayers);
+}
+
+
+void VoxelWorld::requestMesh(ChunkCoord coord, bool isEdit)
+{
+  auto [it, inserted] = _pending.emplace(coord, isEdit);
+  if (!inserted) it->second = it->second || isEdit;
+}
+
+
+void VoxelWorld::touchNeighbor(ChunkCoord coord, bool isEdit)
+{
+  auto it = _chunks.find(coord);
+  if (it == _chunks.end()) return;
+
+  it->second.version = ++_versionCounter;
+  requestMesh(coord, isEdit);
+}
+
+
+// edits proches du joueur d'abord, puis tout le reste du plus proche au plus loin, ce qui est devant la caméra avant ce qui est derrière
+void VoxelWorld::dispatchMeshes()
+{
+  const size_t free_count = _meshScheduler.GetFreeCount();
+  if (_pending.empty() || free_count == 0) return;
+
+  _dispatchOrder.clear();
+  for (const auto& [coord, is_edit]: _pending)
+  {
+    const Chunk& chunk = _chunks.at(coord);
+    if (chunk.meshingVersion != 0) continue;
+
+    const glm::ivec3 delta = glm::ivec3(coord.x, coord.y, coord.z) - _viewerChunk;
+    const bool is_urgent = is_edit && std::max({ std::abs(delta.x), std::abs(delta.y), std::abs(delta.z) }) <= CHUNK_URGENT_RADIUS;
+    const uint64_t distance = (uint64_t)(GetViewWeightedDistance(glm::vec3(delta), _viewerForward) * 1024.0f);
+    _dispatchOrder.emplace_back(is_urgent ? distance : (distance | DISPATCH_DEFERRED_BIT), coord);
+  }
+
+  const size_t count = std::min(free_count, _dispatchOrder.size());
+  std::partial_sort(_dispatchOrder.begin(), _dispatchOrder.begin() + count, _dispatchOrder.end(),
+    [](const auto& a, const auto& b) { return a.first < b.first; });
+
+  for (size_t i = 0; i < count; i++)
+  {
+    const auto& [key, coord] = _dispatchOrder[i];
+    Chunk& chunk = _chunks.at(coord);
+    _pending.erase(coord);
+
+    // déjà à jour, par exemple une voisine touchée puis remeshée avant qu'on arrive ici
+    if (chunk.version == chunk.meshedVersion) continue;
+
+    ChunkNeighbors neighbors;
+    for (size_t face = 0; face < (size_t)BlockFace::COUNT; face++) neighbors.pSections[face] = GetSection(getNeighborCoord(coord, face));
+
+    chunk.pMeshJob = _meshScheduler.Submit(coord, chunk.version, chunk.section, neighbors, _faceLayers, (key & DISPATCH_DEFERRED_BIT) == 0);
+    if (!chunk.pMeshJob) break;
+    chunk.meshingVersion = chunk.version;
+  }
+}
+
+
+void VoxelWorld::uploadMeshes(uint64_t frameIndex)
+{
+  while (ChunkMeshJob* pJob = _meshScheduler.PopCompleted()) _ready.push_back(pJob);
+  if (_ready.empty()) return;
+
+  // les edits urgents d'abord, le reste dans l'ordre d'arrivée
+  std::stable_partition(_ready.begin(), _ready.end(), [](const ChunkMeshJob* pJob) { return pJob->isUrgent; });
+
+  const auto start = std::chrono::steady_clock::now();
+  size_t bytes = 0;
+  size_t uploaded = 0;
+  for (; uploaded < _ready.size(); uploaded++)
+  {
+    ChunkMeshJob* pJob = _ready[uploaded];
+
+    // chunk retiré ou recréé depuis l'envoi du job
+    auto it = _chunks.find(pJob->coord);
+    if (it == _chunks.end() || it->second.meshingVersion != pJob->version)
+    {
+      _meshScheduler.Release(pJob);
+      continue;
+    }
+
+    const size_t size = pJob->output.vertices.size() * sizeof(Vertex) + pJob->output.indices.size() * sizeof(unsigned int);
+    if (bytes > 0 && bytes + size > CHUNK_UPLOAD_BUDGET_BYTES) break;
+    if (bytes > 0 && std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count() > CHUNK_UPLOAD_BUDGET_MS) break;
+    bytes += size;
+
+    uploadMesh(it->second, *pJob, frameIndex);
+    _meshScheduler.Release(pJob);
+  }
+
+  _ready.erase(_ready.begin(), _ready.begin() + uploaded);
+}
+
+
+void VoxelWorld::uploadMesh(Chunk& chunk, ChunkMeshJob& job, uint64_t frameIndex)
+{
+  chunk.meshedVersion = job.version;
+  chunk.meshingVersion = 0;
+  chunk.pMeshJob = nullptr;
+
+  // la roche enterrée n'a pas de mesh mais cache tout ce qui est derrière elle
+  if (job.hasOccluder)
+  {
+    if (chunk.occluder == entt::null) chunk.occluder = _pRegistry->create();
+    const glm::vec3 origin(job.coord.GetOrigin());
+    _pRegistry->emplace_or_replace<OccluderBox>(chunk.occluder, OccluderBox{ origin + job.occluder.min, origin + job.occluder.max });
+  }
+  else if (chunk.occluder != entt::null)
+  {
+    _pRegistry->destroy(chunk.occluder);
+    chunk.occluder = entt::null;
+  }
+
+  // pas d'entité pour un chunk sans face visible (air, roche enterrée)
+  if (chunk.entity == entt::null)
+  {
+    if (job.output.indices.empty()) return;
+
+    chunk.entity = _pRegistry->create();
+    _pRegistry->emplace<WorldMatrix>(chunk.entity, WorldMatrix{ glm::translate(glm::mat4(1.0f), glm::vec3(job.coord.GetOrigin())) });
+    _pRegistry->emplace<Bounds>(chunk.entity, job.bounds);
+    _pRegistry->emplace<Terrain>(chunk.entity);
+    Mesh& mesh = _pRegistry->emplace<Mesh>(chunk.entity);
+    _meshPool.Upload(*_pUploadBackend, mesh, job.output, frameIndex);
+    return;
+  }
+
+  // Bounds d'abord : le patch du Mesh prévient VisibilitySystem, qui relit les Bounds des meshes sans sommets CPU
+  _pRegistry->emplace_or_replace<Bounds>(chunk.entity, job.bounds);
+  _pRegistry->patch<Mesh>(chunk.entity, [&](Mesh& mesh)
+  {
+    _meshPool.Upload(*_pUploadBackend, mesh, job.output, frameIndex);
+  });
+}
+
+
+void VoxelWorld::destroyChunkEntity(Chunk& chunk)
+{
+  if (chunk.occluder != entt::null)
+  {
+    _pRegistry->destroy(chunk.occluder);
+    chunk.occluder = entt::null;
+  }
+  if (chunk.entity == entt::null) return;
+
+  if (Mesh* pMesh = _pRegistry->try_get<Mesh>(chunk.entity)) _meshPool.Release(*pMesh, _frameIndex);
+  _pRegistry->destroy(chunk.entity);
+  chunk.entity = entt::null;
+}
\ No newline at end of file